@@ -0,0 +1,68 @@
+#ifndef _AUX_STR_ACM_H_
+#define _AUX_STR_ACM_H_ 1
+
+// 引用: Aho, Corasick. Efficient string matching: an aid to bibliographic search. CACM 1975.
+//
+// 多模式匹配自动机：先由全部模式串建立字典树，再按广度优先顺序计算失败链接，
+// 并把失败链接展开成稠密转移表（DFA），扫描时每个字节只查一次表。
+// 转移表按字节类别压缩：未出现在任何模式串中的字节归为同一类别，表宽等于类别数。
+
+#include "types.h"
+
+#define STR_ACM_NO_OUTPUT (-1)
+
+typedef struct STR_ACM {
+    uint32_t        states;         // 状态数，0 号是初始状态
+    uint32_t        classes;        // 字节类别数，即转移表宽度
+    uint32_t        patterns;       // 模式串数
+    int32_t         lead;           // 唯一的模式首字节，-1 表示有多个
+    uint8_t         cls[256];       // 字节到类别的映射
+    uint8_t         first[256];     // 是否某个模式的首字节，用于在初始状态快速跳过
+    uint32_t *      next;           // 转移表，states × classes
+    uint32_t *      emit;           // 状态的第一个输出状态（可能是自身），0 表示无输出
+    uint32_t *      dict;           // 输出状态在输出链上的下一个输出状态，0 表示结束
+    int32_t *       out;            // 输出状态对应的模式编号
+    uint32_t *      depth;          // 状态在字典树中的深度，用于区分字典树的边和展开的失败转移
+    str_size_t *    lens;           // 各模式串的字节数
+} str_acm_t, *str_acm_p;
+
+// 功能：编译模式串集合
+// 参数：
+//     needles  IN  各模式串的起始地址
+//     bytes    IN  各模式串的字节数，均不能为 0
+//     n        IN  模式串数量
+// 返回值：
+//     non-NULL     自动机，模式编号即模式串在数组中的下标
+//     NULL         内存不足
+// 说明：
+//     内容相同的模式串只报告编号最小者。编译完成后不再引用模式串。
+extern str_acm_p str_acm_new(const char_t ** needles, const str_size_t * bytes, uint32_t n);
+
+// 删除自动机
+extern void str_acm_delete(str_acm_p ac);
+
+// 功能：从给定状态继续扫描，直到进入有输出的状态
+// 参数：
+//     ac       IN  自动机
+//     pos      IN  扫描起始地址
+//     end      IN  扫描结束地址
+//     state    IO  入参：扫描前的状态
+//                  出参：扫描后的状态
+// 返回值：
+//     non-NULL     匹配结尾的下一个地址，*state 是有输出的状态
+//     NULL         扫描到结尾也没有匹配
+extern const char_t * str_acm_scan(str_acm_p ac, const char_t * pos, const char_t * end, uint32_t * state);
+
+// 功能：查找以给定位置开头的最长模式串（用于最左最长匹配）
+// 参数：
+//     ac       IN  自动机
+//     pos      IN  起始地址
+//     end      IN  结束地址
+// 返回值：
+//     >= 0                 最长模式串的编号
+//     STR_ACM_NO_OUTPUT    没有以该位置开头的模式串
+// 说明：
+//     沿字典树的边前进，经失败转移离开字典树路径时停止，耗时不超过最长模式串的字节数。
+extern int32_t str_acm_longest(str_acm_p ac, const char_t * pos, const char_t * end);
+
+#endif // _AUX_STR_ACM_H_
@@ -10,12 +10,92 @@ inline static uint32_t ascii_measure(const char_t * pos)
 } // ascii_measure
 
 // 计算给定字节范围内有多少个 ASCII 字符
-bool ascii_count_plain(const char_t * start, uint32_t * bytes, uint32_t * chars);
+bool ascii_count_plain(const char_t * start, str_size_t * bytes, str_size_t * chars);
 
 // 计算给定字节范围内有多少个 ASCII 字符（加速版）
-bool ascii_count_unroll(const char_t * start, uint32_t * bytes, uint32_t * chars);
+bool ascii_count_unroll(const char_t * start, str_size_t * bytes, str_size_t * chars);
 
 #define ascii_count ascii_count_unroll
 
+// 功能：校验给定范围是否只包含 ASCII 字符（0x01 ~ 0x7F），不计算字符数
+// 参数：
+//     start    IN  起始地址，不能为 NULL
+//     bytes    IO  入参：范围长度（字节数），不能为 NULL
+//                  出参：正确编码部分的字节数
+// 返回值：
+//     true         编码正确
+//     false        存在异常字节
+extern bool ascii_validate(const char_t * start, str_size_t * bytes);
+
+// 计算给定范围开头有多少个连续的 7 位字节（0x00 ~ 0x7F），等于范围长度说明是纯 ASCII 内容
+extern str_size_t ascii_span(const char_t * start, str_size_t bytes);
+
+// 计算给定范围开头有多少个连续的小于 limit 的字节（limit 不小于 0x80），ascii_span() 是 limit 为 0x80 的特例
+extern str_size_t ascii_span_below(const char_t * start, str_size_t bytes, char_t limit);
+
+// 计算给定范围内有多少个 ASCII 字符，不校验编码
+inline static str_size_t ascii_chars(const char_t * start, str_size_t bytes)
+{
+    return bytes;
+} // ascii_chars
+
+// 从结尾向前计算至多 *chars 个 ASCII 字符占用的字节数，*chars 返回实际经过的字符数
+inline static str_size_t ascii_rseek(const char_t * start, str_size_t bytes, str_size_t * chars)
+{
+    if (*chars > bytes) *chars = bytes;
+    return *chars;
+} // ascii_rseek
+
+// ASCII 大小写折叠：大写字母转为小写，其余字节不变
+inline static char_t ascii_fold(char_t ch)
+{
+    return ch | (((uint32_t)(ch - 'A') < 26) << 5);
+} // ascii_fold
+
+// 标记 8 字节整块中属于 [lo, lo + 25] 的字节（lo 为 'A' 或 'a'），该字节 0x20 位置 1 ，其余位为 0
+inline static uint64_t ascii_case_bits(uint64_t word, char_t lo)
+{
+    uint64_t low = word & 0x7F7F7F7F7F7F7F7FULL;
+    uint64_t ge = low + (0x80 - lo) * 0x0101010101010101ULL;          // 不小于 lo 的字节最高位为 1 ，无跨字节进位
+    uint64_t gt = low + (0x80 - lo - 26) * 0x0101010101010101ULL;     // 大于 lo + 25 的字节最高位为 1
+    return (ge & ~gt & ~word & 0x8080808080808080ULL) >> 2;
+} // ascii_case_bits
+
+// 将 8 字节整块中的 ASCII 大写字母转为小写
+inline static uint64_t ascii_fold_word(uint64_t word)
+{
+    return word | ascii_case_bits(word, 'A');
+} // ascii_fold_word
+
+// 功能：按 ASCII 大小写折叠比较两个等长字节范围
+// 参数：
+//     p1       IN  第一个范围的起始地址
+//     p2       IN  第二个范围的起始地址
+//     bytes    IN  范围长度（字节数）
+// 返回值：
+//     >= 0         开头折叠后相同部分的字节数，等于 bytes 说明完全相同
+// 说明：
+//     只折叠 A~Z ，不小于 0x80 的字节按原值比较。定义 __SSE2__ 时每次比较 16 字节，其余部分按 8 字节整块比较。
+extern str_size_t ascii_fold_prefix(const char_t * p1, const char_t * p2, str_size_t bytes);
+
+// 功能：计算给定范围开头有多少个不属于 [lo, lo + 25] 的字节
+// 参数：
+//     start    IN  起始地址
+//     bytes    IN  范围长度（字节数）
+//     lo       IN  'A' 表示查找大写字母，'a' 表示查找小写字母
+// 返回值：
+//     >= 0         等于 bytes 说明不需要转换大小写
+extern str_size_t ascii_case_span(const char_t * start, str_size_t bytes, char_t lo);
+
+// 功能：转换 ASCII 字母的大小写，属于 [lo, lo + 25] 的字节异或 0x20 ，其余字节原样复制
+// 参数：
+//     dst      OUT 目标地址，可以与 src 相同
+//     src      IN  源地址
+//     bytes    IN  范围长度（字节数）
+//     lo       IN  'A' 表示转为小写，'a' 表示转为大写
+// 说明：
+//     定义 __SSE2__ 时每次处理 16 字节，其余部分按 8 字节整块处理。
+extern void ascii_case_convert(char_t * dst, const char_t * src, str_size_t bytes, char_t lo);
+
 #endif // _AUX_ASCII_H_
 
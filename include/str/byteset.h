@@ -0,0 +1,48 @@
+#ifndef _AUX_STR_BYTESET_H_
+#define _AUX_STR_BYTESET_H_ 1
+
+// 字节集合：256 位成员表，另编译成按半字节查表的形式（shufti），便于向量化扫描。
+//
+// 字节 b 属于集合，当且仅当 lo[b & 0xF] & hi[b >> 4] 非零。
+// 高半字节相同的成员共用一个低半字节掩码，掩码相同的高半字节共用一个桶（位），共 8 个桶。
+// 不同掩码超过 8 种时，多余的掩码并入最后一个桶，查表结果可能误报，需要再查成员表确认。
+//
+// 定义 __SSSE3__ 时（如开启 AUX_STR_SIMD 选项）每次检查 16 字节，否则逐字节查成员表。
+
+#include "types.h"
+
+typedef struct STR_BYTESET {
+    uint8_t         lo[16];         // 低半字节所属的桶
+    uint8_t         hi[16];         // 高半字节所属的桶
+    uint8_t         exact;          // 查表结果是否精确（无误报）
+    uint8_t         member[256];    // 成员表
+} str_byteset_t, *str_byteset_p;
+
+// ASCII 空白字符集合（SPACE/TAB/NL/VT/FF/CR）
+extern const str_byteset_t str_byteset_space;
+
+// 功能：编译字节集合
+// 参数：
+//     set      OUT 字节集合
+//     bytes    IN  成员字节，可以重复
+//     n        IN  成员字节数，可以为 0
+extern void str_byteset_init(str_byteset_p set, const char_t * bytes, str_size_t n);
+
+// 功能：查找第一个属于集合的字节（同 strpbrk）
+// 返回值：
+//     non-NULL     该字节的地址
+//     NULL         找不到
+extern const char_t * str_byteset_find(const str_byteset_t * set, const char_t * start, const char_t * end);
+
+// 功能：跳过属于集合的字节，返回第一个不属于集合的字节（同 strspn）
+// 返回值：
+//     non-NULL     该字节的地址
+//     NULL         全部属于集合
+extern const char_t * str_byteset_skip(const str_byteset_t * set, const char_t * start, const char_t * end);
+
+// 功能：从结尾向前跳过属于集合的字节
+// 返回值：
+//     最后一个不属于集合的字节之后的地址，全部属于集合时返回 start
+extern const char_t * str_byteset_rskip(const str_byteset_t * set, const char_t * start, const char_t * end);
+
+#endif // _AUX_STR_BYTESET_H_
@@ -0,0 +1,49 @@
+#ifndef _AUX_STR_LZ4_H_
+#define _AUX_STR_LZ4_H_ 1
+
+// 引用: https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md
+//
+// LZ4 块格式由若干序列组成，每个序列包含一个令牌、字面量和一个匹配：
+//
+// +-------+----------------+----------+--------+----------------+
+// | token | literal length | literals | offset | match length   |
+// | 1 B   | 0 ~ n B        | 0 ~ n B  | 2 B    | 0 ~ n B        |
+// +-------+----------------+----------+--------+----------------+
+//
+// 令牌高 4 位是字面量长度，低 4 位是匹配长度减 4 ，等于 15 时后接追加长度字节（每个 255 继续）。
+// 最后一个序列只有字面量。最后 5 个字节总是字面量，最后一个匹配至少在结尾前 12 个字节开始。
+
+#include "types.h"
+
+// 计算压缩结果的最大字节数
+inline static str_size_t lz4_bound(str_size_t bytes)
+{
+    return bytes + bytes / 255 + 16;
+} // lz4_bound
+
+// 功能：按 LZ4 块格式压缩字节范围
+// 参数：
+//     src      IN  源数据起始地址
+//     bytes    IN  源数据字节数
+//     dst      OUT 压缩结果缓冲区
+//     cap      IN  缓冲区容量，不小于 lz4_bound(bytes) 时一定成功
+// 返回值：
+//     > 0          压缩结果字节数
+//     0            缓冲区容量不足
+// 说明：
+//     使用 4096 项散列表的单遍贪心匹配，不依赖外部库。
+extern str_size_t lz4_compress(const char_t * src, str_size_t bytes, char_t * dst, str_size_t cap);
+
+// 功能：解压 LZ4 块格式数据
+// 参数：
+//     src      IN  压缩数据起始地址
+//     bytes    IN  压缩数据字节数
+//     dst      OUT 解压结果缓冲区
+//     cap      IO  入参：缓冲区容量，不能为 NULL
+//                  出参：解压结果字节数
+// 返回值：
+//     true         解压成功
+//     false        数据格式错误或缓冲区容量不足
+extern bool lz4_decompress(const char_t * src, str_size_t bytes, char_t * dst, str_size_t * cap);
+
+#endif // _AUX_STR_LZ4_H_
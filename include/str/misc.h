@@ -30,7 +30,7 @@ inline static uint64_t str_round_up(uint64_t integer, uint64_t alignment)
 //     B = 有效字节（范围内）
 //     L = 前导字节
 //     T = 后随字节
-inline static void str_span(const char_t * start, const uint32_t bytes, const uint32_t alignment, const char_t ** begin, uint32_t * leads, uint32_t * chunks, uint32_t * tails, const char_t ** end)
+inline static void str_span(const char_t * start, const str_size_t bytes, const uint32_t alignment, const char_t ** begin, uint32_t * leads, str_size_t * chunks, uint32_t * tails, const char_t ** end)
 {
     //    +--> begin
     //   /    +--> start
@@ -55,4 +55,12 @@ inline static void str_span(const char_t * start, const uint32_t bytes, const ui
     *chunks = (*chunks == 0) ? *chunks : (*end - *begin - str_round_up(*leads, alignment) - str_round_up(*tails, alignment)) / alignment;
 } // str_span
 
+// 功能：计算字节范围的 64 位散列值
+// 参数：
+//     start        IN      字节范围起始地址
+//     bytes        IN      字节范围长度
+// 返回值：
+//     散列值，仅用于进程内查找，不保证跨平台一致
+extern uint64_t str_hash(const char_t * start, str_size_t bytes);
+
 #endif // _AUX_STR_MISC_H_
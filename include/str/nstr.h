@@ -6,10 +6,78 @@
 
 #include "types.h"
 
-struct NSTR;
-typedef struct NSTR * nstr_p;
+struct ENTITY;
+
+#define NSTR_CHARS_UNKNOWN STR_SIZE_MAX  // 字符数未知，首次需要时计算
+#define NSTR_INDEX_END (STR_SIZE_MAX >> 1)  // 最大的非负下标，必然超出范围，用于定位串尾而不计算字符数
+
+// 切片布局公开，仅供 NSTR_LITERAL 等宏静态初始化使用，其它场合请调用接口函数
+typedef struct NSTR {
+    str_size_t      bytes;          // 串内容占用字节数
+    str_size_t      chars;          // 编码后的字符个数，NSTR_CHARS_UNKNOWN 表示尚未计算
+
+    uint32_t        need_free:1;    // 是否释放内存
+    uint32_t        ascii:1;        // 全部字节是否都小于 0x80 ，是则字符下标等于字节偏移量
+    uint32_t        fixed:1;        // 是否为定长内嵌串，内容存放于紧随 nstr_fixed_t 的缓冲区
+    uint32_t        unused:23;
+    uint32_t        encoding:6;     // 编码方案，支持最多 64 种
+
+    struct ENTITY * ent;            // 数据实体指针
+
+    const char_t *  start;          // 字符数据起始地址
+} nstr_t, *nstr_p;
 typedef nstr_p * nstr_array_p;
 
+// 预编译的子串查找器，布局不公开
+typedef struct NSTR_SEARCHER nstr_searcher_t, *nstr_searcher_p;
+
+// 多模式关键字集合，布局不公开
+typedef struct NSTR_KEYWORDS nstr_keywords_t, *nstr_keywords_p;
+
+// 多对替换表，布局不公开
+typedef struct NSTR_REPLACER nstr_replacer_t, *nstr_replacer_p;
+
+// 关键字查找游标，使用前全部置 0
+typedef struct NSTR_KEYWORD_CURSOR {
+    const char_t *  start;          // 本次匹配的起始地址，NULL 表示从头开始或已经结束
+    str_size_t      offset;         // 本次匹配的字节偏移量
+    str_size_t      index;          // 本次匹配的字符下标
+    str_size_t      bytes;          // 本次匹配的字节数
+
+    // 以下为内部状态
+    const char_t *  pos;            // 下次扫描的起始地址
+    str_size_t      counted;        // 已计数的字节数
+    str_size_t      chars;          // 已计数部分的字符数
+    uint32_t        state;          // 自动机状态
+    uint32_t        pending;        // 尚未报告的输出状态，0 表示无
+} nstr_keyword_cursor_t, *nstr_keyword_cursor_p;
+
+// 正则表达式，布局不公开
+typedef struct NSTR_REGEX nstr_regex_t, *nstr_regex_p;
+
+// 正则匹配游标，使用前全部置 0
+typedef struct NSTR_REGEX_CURSOR {
+    const char_t *  start;          // 本次匹配的起始地址，NULL 表示从头开始或已经结束
+    str_size_t      offset;         // 本次匹配的字节偏移量
+    str_size_t      index;          // 本次匹配的字符下标
+    str_size_t      bytes;          // 本次匹配的字节数
+
+    // 以下为内部状态
+    const char_t *  pos;            // 下次查找的起始地址，NULL 表示已到结尾
+    str_size_t      counted;        // 已计数的字节数
+    str_size_t      chars;          // 已计数部分的字符数
+} nstr_regex_cursor_t, *nstr_regex_cursor_p;
+
+// 借用视图：不持有实体引用，仅在源串存活期间有效
+typedef struct NSTR_VIEW {
+    const char_t *  start;          // 字符数据起始地址
+    str_size_t      bytes;          // 字节数
+    uint32_t        chars:26;       // 字符数，等于 STR_VIEW_CHARS_UNKNOWN 时按需计算
+    uint32_t        encoding:6;     // 编码方案，支持最多 64 种
+} nstr_view_t, *nstr_view_p;
+
+#define STR_VIEW_CHARS_UNKNOWN ((1U << 26) - 1)
+
 typedef enum STR_ENCODING {
     STR_ENC_ASCII = 0,
     STR_ENC_UTF8  = 1,
@@ -21,17 +89,152 @@ typedef enum STR_ENCODING {
 enum {
     STR_OUT_OF_MEMORY = -1,
     STR_UNKNOWN_BYTE = -2,
+    STR_BAD_PATTERN = -3,
     STR_NOT_FOUND = -101,
 };
 
+typedef enum STR_MMAP_ADVICE {
+    STR_MAP_NORMAL     = 0,
+    STR_MAP_SEQUENTIAL = (1 << 0),  // 顺序访问，积极预读并尽早回收已读页面
+    STR_MAP_RANDOM     = (1 << 1),  // 随机访问，关闭预读
+    STR_MAP_WILLNEED   = (1 << 2),  // 即将访问，提前异步读入页面
+    STR_MAP_HUGEPAGE   = (1 << 3),  // 尽量使用大页（需内核支持）
+} str_mmap_advice_t;
+
 typedef enum STR_LOCALE {
-    STR_LOC_C = 0,
+    STR_LOC_C = 0,                  // 按字节比较
+    STR_LOC_ROOT = 1,               // Unicode 排序算法的根排序规则（DUCET 13.0.0 ，可变权重不可忽略，比较到第三级）
+    STR_LOC_USER = 2,               // 第一个由 nstr_add_locale() 添加的裁剪排序规则
 } str_locale_t;
 
+// 排序规则裁剪：令 ch（及其大小写形式）在给定级别上紧随 anchor 之后，布局与 ucd_coll_rule_t 相同
+// 如 {0x00F1, 'n', 1} 表示西班牙语中 ñ 是排在 n 之后的独立字母
+typedef struct STR_COLLATION_RULE {
+    uchar_t         ch;             // 被调整的字符
+    uchar_t         anchor;         // 参照字符，必须有主权重（字母、数字、符号等）
+    uint32_t        level;          // 差异级别：1 基本字母，2 变音符号，3 大小写
+} str_collation_rule_t;
+
+// Unicode 规范化形式（UAX #15）
+typedef enum STR_NORM_FORM {
+    STR_NFC  = 0,   // 规范分解后再规范组合
+    STR_NFD  = 1,   // 规范分解
+    STR_NFKC = 2,   // 兼容分解后再规范组合
+    STR_NFKD = 3,   // 兼容分解
+} str_norm_form_t;
+
+// 功能：外部缓冲区释放回调
+// 参数：
+//     ctx      IN  入参：生成串时传入的回调上下文
+//     buf      IN  入参：外部缓冲区起始地址
+//     bytes    IN  入参：外部缓冲区字节数
+typedef void (*str_release_t)(void * ctx, const char_t * buf, str_size_t bytes);
+
+// 实体内存使用情况
+typedef struct STR_USAGE {
+    const void *    entity;         // 实体标识
+    str_size_t      held;           // 实体持有的字节数
+    str_size_t      referenced;     // 全部切片引用的字节数之和，重叠部分重复计算
+    uint32_t        slices;         // 引用实体的切片数
+    uint64_t        waste;          // 未被任何切片引用的字节数（估算）
+    str_size_t      packed;         // 冷存储压缩后的字节数，0 表示未压缩
+} str_usage_t, *str_usage_p;
+
+typedef struct STR_DEDUP_STATS {
+    uint64_t        lookups;        // 查找次数
+    uint64_t        hits;           // 命中次数，即未分配新实体的次数
+    uint64_t        collisions;     // 散列值相同但内容不同的次数
+    uint64_t        saved;          // 命中累计节省的字节数
+    uint32_t        entries;        // 存储中的实体数
+} str_dedup_stats_t, *str_dedup_stats_p;
+
+// 字面量串引用的静态实体，永不释放
+extern struct ENTITY nstr_literal_entity;
+
+// 编译期统计 UTF-8 字面量的字符数（非跟随字节数），最多统计 32 字节
+#define NSTR_LIT_HEAD(lit, i) ((i) < sizeof(lit) - 1 && ((lit)[i] & 0xC0) != 0x80)
+#define NSTR_LIT_HEADS4(lit, i) (NSTR_LIT_HEAD(lit, i) + NSTR_LIT_HEAD(lit, i + 1) + NSTR_LIT_HEAD(lit, i + 2) + NSTR_LIT_HEAD(lit, i + 3))
+#define NSTR_LIT_HEADS32(lit) ( \
+    NSTR_LIT_HEADS4(lit, 0) + NSTR_LIT_HEADS4(lit, 4) + NSTR_LIT_HEADS4(lit, 8) + NSTR_LIT_HEADS4(lit, 12) + \
+    NSTR_LIT_HEADS4(lit, 16) + NSTR_LIT_HEADS4(lit, 20) + NSTR_LIT_HEADS4(lit, 24) + NSTR_LIT_HEADS4(lit, 28) \
+)
+
+#if defined(__GNUC__)
+// GCC/Clang 可在静态初始化中折叠字面量下标运算
+#define NSTR_LIT_CHARS(lit) ((sizeof(lit) - 1 <= 32) ? NSTR_LIT_HEADS32(lit) : NSTR_CHARS_UNKNOWN)
+#else
+#define NSTR_LIT_CHARS(lit) NSTR_CHARS_UNKNOWN
+#endif
+
+// 功能：字面量串的初始化列表
+// 参数：
+//     lit      IN  字符串字面量
+//     enc      IN  编码方案，只支持 STR_ENC_ASCII 或 STR_ENC_UTF8
+// 说明：
+//     字节数取自 sizeof ，UTF-8 字面量的字符数尽量在编译期计算，否则首次需要时计算并缓存。
+//     字面量不做编码校验，不持有实体引用，不能调用 nstr_delete() 删除。
+//     用法：static nstr_t kw = NSTR_LITERAL_INIT("关键字", STR_ENC_UTF8);
+#define NSTR_LITERAL_INIT(lit, enc) { \
+    .bytes = sizeof(lit) - 1, \
+    .chars = ((enc) == STR_ENC_UTF8) ? NSTR_LIT_CHARS(lit) : sizeof(lit) - 1, \
+    .need_free = 0, \
+    .ascii = ((enc) == STR_ENC_UTF8 && NSTR_LIT_CHARS(lit) == sizeof(lit) - 1), \
+    .encoding = (enc), \
+    .ent = &nstr_literal_entity, \
+    .start = (const char_t *)(lit), \
+}
+
+// 字面量串，在文件作用域中是静态存储，在函数中生存期与所在语句块相同
+#define NSTR_LITERAL(lit) (&(nstr_t)NSTR_LITERAL_INIT(lit, STR_ENC_ASCII))
+#define NSTR_LITERAL_UTF8(lit) (&(nstr_t)NSTR_LITERAL_INIT(lit, STR_ENC_UTF8))
+
+// 定长内嵌串的头部，缓冲区紧随其后
+typedef struct NSTR_FIXED {
+    nstr_t          str;            // 串头部，可直接传给各接口函数
+    str_size_t      cap;            // 缓冲区容量，不包含结尾的 NUL 字符
+} nstr_fixed_t, *nstr_fixed_p;
+
+// 定长内嵌串引用的静态实体，永不释放
+extern struct ENTITY nstr_fixed_entity;
+
+// 功能：定长内嵌串类型，头部和容量为 capacity 字节的缓冲区一起内嵌于结构体或栈帧
+// 说明：
+//     定长串本身即可作为 nstr_p 传给只读接口，也可作为结果参数 r 接收变换结果：
+//     结果复制到缓冲区，超出容量时接口返回 NULL ，原内容不变。
+//     从定长串生成的其它切片借用其缓冲区，不能比定长串存活得更久。
+//     缓冲区地址记录于头部，定长串不能按值复制，复制后须重新初始化。
+#define NSTR_FIXED_TYPE(capacity) struct { nstr_fixed_t head; char_t buf[(capacity) + 1]; }
+
+// 定长串变量的初始化列表，var 是正在声明的变量本身
+#define NSTR_FIXED_INIT(var) { \
+    .head = { \
+        .str = { \
+            .bytes = 0, \
+            .chars = 0, \
+            .need_free = 0, \
+            .ascii = 1, \
+            .fixed = 1, \
+            .encoding = STR_ENC_ASCII, \
+            .ent = &nstr_fixed_entity, \
+            .start = (var).buf, \
+        }, \
+        .cap = sizeof((var).buf) - 1, \
+    }, \
+}
+
+// 声明并初始化定长串变量，用法：NSTR_FIXED(key, 64); nstr_concat2(a, b, NSTR_FIXED_STR(key));
+#define NSTR_FIXED(name, capacity) NSTR_FIXED_TYPE(capacity) name = NSTR_FIXED_INIT(name)
+
+// 定长串变量的 nstr_p 形式
+#define NSTR_FIXED_STR(var) (&(var).head.str)
+
+// 初始化结构体成员等无法静态初始化的定长串，内容为空串
+#define nstr_fixed_init(var) nstr_init_fixed(&(var).head, sizeof((var).buf) - 1)
+
 // ---- 功能函数 ---- //
 
 // 引用一个新串
-extern nstr_p nstr_new(const char_t * src, uint32_t bytes, bool copy);
+extern nstr_p nstr_new(const char_t * src, str_size_t bytes, bool copy);
 
 // 引用一个新空串
 extern nstr_p nstr_new_blank(str_encoding_t encoding);
@@ -43,6 +246,47 @@ inline static nstr_p nstr_new_reference(const char_t * src)
     return nstr_new(src, strlen((void *)src), false);
 } // nstr_new_reference
 
+// 功能：映射文件内容，生成新串
+// 参数：
+//     fd       IN  入参：已打开的可读文件描述符
+//     offset   IN  入参：起始偏移量，无需页对齐
+//     bytes    IN  入参：映射字节数，0 表示映射到文件末尾
+//     advice   IN  入参：访问提示，str_mmap_advice_t 的按位组合
+// 返回值：
+//     non-NULL     新串，最后一个切片被删除时解除映射
+//     NULL         发生错误，errno 记录错误原因（偏移量或映射范围超出文件末尾时为 EINVAL）
+// 说明：
+//     映射成功后即可关闭文件描述符。内容不作拷贝，页面在首次访问时才读入内存。
+//     映射区不保证以 NUL 字符结尾。
+extern nstr_p nstr_new_mmap_fd(int fd, uint64_t offset, str_size_t bytes, int advice);
+
+// 映射给定路径的文件内容，生成新串，参数含义同 nstr_new_mmap_fd()
+extern nstr_p nstr_new_mmap(const char * path, uint64_t offset, str_size_t bytes, int advice);
+
+// 功能：引用调用方拥有的缓冲区，生成新串（零拷贝）
+// 参数：
+//     src      IN  入参：外部缓冲区起始地址
+//     bytes    IN  入参：外部缓冲区字节数
+//     release  IN  入参：释放回调，NULL 表示无需通知
+//     ctx      IN  入参：回调上下文，原样传给 release
+// 返回值：
+//     non-NULL     新串，最后一个切片被删除时调用 release 归还缓冲区
+//     NULL         内存不足，缓冲区所有权仍归调用方，不会调用 release
+// 说明：
+//     在 release 被调用前，调用方不得修改或释放缓冲区。缓冲区不要求以 NUL 字符结尾。
+extern nstr_p nstr_new_external(const char_t * src, str_size_t bytes, str_release_t release, void * ctx);
+
+// 对切片所在的映射区页面施加访问提示，非映射串返回 false
+extern bool nstr_advise(nstr_p s, int advice);
+
+// 功能：初始化定长串头部，通常经由 nstr_fixed_init() 调用
+// 参数：
+//     fx       OUT 出参：定长串头部，其后须紧跟 cap + 1 字节的缓冲区
+//     cap      IN  入参：缓冲区容量，不包含结尾的 NUL 字符
+// 返回值：
+//     定长串的 nstr_p 形式
+extern nstr_p nstr_init_fixed(nstr_fixed_p fx, str_size_t cap);
+
 // 复制源串（深拷贝）
 extern nstr_p nstr_clone(nstr_p s);
 
@@ -52,6 +296,85 @@ extern nstr_p nstr_duplicate(nstr_p s);
 // 删除字符串
 extern void nstr_delete(nstr_p s);
 
+// ---- 内存管理 ---- //
+
+// 功能：压缩切片，将内容复制到大小合适的新实体，解除对原实体的引用
+// 参数：
+//     s        IO  入参：源串或切片
+//                  出参：引用新实体的切片
+// 返回值：
+//     true         已压缩
+//     false        无需压缩（切片覆盖整个实体或引用静态实体），或内存不足
+extern bool nstr_compact(nstr_p s);
+
+// 功能：设置自动压缩策略
+// 参数：
+//     min_held     IN  入参：实体持有字节数下限，0 表示关闭自动压缩
+//     max_waste    IN  入参：浪费比例上限（百分比）
+// 说明：
+//     开启后，nstr_slice()/nstr_split()/nstr_duplicate()/nstr_from_view() 生成新切片时，
+//     如实体持有字节数不低于 min_held，且未被新切片引用的部分超过 max_waste% ，则自动压缩新切片。
+extern void nstr_set_compact_policy(str_size_t min_held, uint32_t max_waste);
+
+// 功能：设置字符下标索引策略
+// 参数：
+//     min_bytes    IN  入参：建立索引的实体字节数下限，0 表示关闭索引
+//     step         IN  入参：检查点间隔字符数，0 表示使用默认值 256
+// 说明：
+//     索引记录实体中每隔 step 个字符的字节偏移量，每个检查点占用 4 字节，由同一实体的全部切片共享。
+//     已校验为 UTF-8 、且不是纯 ASCII 内容的实体，在 nstr_narrow_down()/nstr_slice()/nstr_replace() 等
+//     首次按下标定位时建立索引，此后从最近的检查点开始计数，最多计数 step 个字符。
+//     step 越小定位越快，内存占用也越大。修改策略只影响之后建立的索引。
+extern void nstr_set_index_policy(str_size_t min_bytes, uint32_t step);
+
+// 功能：设置去重策略
+// 参数：
+//     max_bytes    IN  入参：参与去重的实体字节数上限，0 表示关闭
+// 说明：
+//     开启后，nstr_clone()/nstr_new(..., true)/nstr_concat() 等复制或拼接生成新实体时，
+//     先按内容散列值查找存储，散列值相同再逐字节比较，内容相同则引用已有实体，不再分配。
+//     存储只登记开启期间生成的堆实体，实体释放时自动移出。关闭后已登记的实体仍保留至释放。
+extern void nstr_set_dedup_policy(str_size_t max_bytes);
+
+// 功能：查询去重统计
+// 参数：
+//     stats        OUT 出参：累计统计
+//     reset        IN  入参：查询后是否清零计数（entries 除外）
+extern void nstr_dedup_stats(str_dedup_stats_p stats, bool reset);
+
+// 功能：设置冷存储策略
+// 参数：
+//     min_bytes    IN  入参：可压缩实体的字节数下限，0 表示关闭
+//     idle_sweeps  IN  入参：连续多少次清扫期间未被访问的实体才压缩，0 视为 1
+// 说明：
+//     开启后新生成的大实体存放于独立的匿名映射区，之前生成的实体不受影响。
+//     实体被 nstr_sweep_cold() 压缩后，映射区的物理内存归还系统，但地址保持不变，
+//     任何读取内容的函数都会先在原地解压。
+//     nstr_byte_range()/nstr_view()/nstr_cstr() 借出字符数据地址后，所在实体不再压缩，借出的指针和视图始终可读。
+extern void nstr_set_cold_policy(str_size_t min_bytes, uint32_t idle_sweeps);
+
+// 功能：清扫一轮，压缩长期未访问的大实体
+// 返回值：
+//     >= 0         本轮归还系统的字节数
+// 说明：
+//     由调用方在空闲时显式调用。压缩率低于 1/8 的实体、已借出字符数据地址的实体保持原样。
+//     压缩结果先试解压校验，校验失败或内存不足时实体保持原样。
+extern uint64_t nstr_sweep_cold(void);
+
+// 查询切片所引用实体的内存使用情况
+extern void nstr_usage(nstr_p s, str_usage_p usage);
+
+// 开启或关闭实体登记，只有开启后生成的实体才会被 nstr_worst_wastes() 统计
+extern void nstr_track_entities(bool enabled);
+
+// 功能：列出浪费字节数最多的实体
+// 参数：
+//     list     OUT 出参：按浪费字节数降序排列的使用情况
+//     n        IN  入参：list 容量
+// 返回值：
+//     >= 0         list 中的有效元素个数
+extern int nstr_worst_wastes(str_usage_p list, int n);
+
 // 删除切分后的字符串数组
 extern void nstr_delete_strings(nstr_p * as, int n);
 
@@ -59,28 +382,33 @@ extern void nstr_delete_strings(nstr_p * as, int n);
 extern str_encoding_t nstr_encoding(nstr_p s);
 
 // 返回字节数，不包含最后的 NUL 字符
-extern uint32_t nstr_bytes(nstr_p s);
+extern str_size_t nstr_bytes(nstr_p s);
 
-inline static uint32_t nstr_size(nstr_p s)
+inline static str_size_t nstr_size(nstr_p s)
 {
     return nstr_bytes(s);
 } // nstr_size
 
-// 返回字符数，不包含最后的 NUL 字符
-extern uint32_t nstr_chars(nstr_p s);
+// 返回字符数，不包含最后的 NUL 字符（首次调用时计算并缓存）
+extern str_size_t nstr_chars(nstr_p s);
 
-inline static uint32_t nstr_length(nstr_p s)
+inline static str_size_t nstr_length(nstr_p s)
 {
     return nstr_chars(s);
 } // nstr_length
 
+// 功能：返回扩展字素簇（用户感知的字符，UAX #29）个数，不缓存
+// 说明：
+//     UTF-8 串成段跳过 ASCII 字节，其余字符查两级属性表判断分界；其它编码按单字节字符计算，只有 CR LF 同簇。
+extern str_size_t nstr_graphemes(nstr_p s);
+
 // 测试是否为空字符串
 inline static bool nstr_is_blank(nstr_p s)
 {
-    return nstr_chars(s) == 0;
+    return nstr_bytes(s) == 0;
 } // nstr_is_blank
 
-// 测试是否存在子串
+// 测试是否存在子串，每次调用都要编译模式串，反复查找同一子串时应改用 nstr_contain_by()
 extern bool nstr_contain(nstr_p s, nstr_p sub);
 
 // 测试是否存在单字节字符
@@ -98,9 +426,31 @@ extern bool nstr_end_with(nstr_p s, nstr_p sub);
 // 测试串尾是否为给定单字节字符
 extern bool nstr_end_with_char(nstr_p s, char_t ch);
 
-// 比较字符串（排序）
+// 功能：比较字符串（排序）
+// 参数：
+//     locale   IN  入参：STR_LOC_C 按字节比较，其它按 Unicode 排序算法比较，未注册的代号按 STR_LOC_ROOT 处理
+// 返回值：
+//     < 0          s1 较小
+//     == 0         相同（排序键相同，如规范等价的串）
+//     > 0          s1 较大
+// 说明：
+//     按 Unicode 排序算法比较时，先生成两个串的排序键（二进制串），再按字节比较排序键。
+//     排序键缓存在动态分配的实体上（按切片范围和排序规则，每个实体保留最近几个），
+//     对 N 个串排序只需生成 N 次排序键，其余都是 memcmp 比较。内存不足时退回按字节比较。
 extern int nstr_compare(nstr_p s1, nstr_p s2, str_locale_t locale);
 
+// 功能：添加裁剪排序规则（在根排序规则基础上调整若干字符的位置）
+// 参数：
+//     rules    IN  入参：裁剪规则，同一参照字符、同一级别的多条规则按先后次序排列
+//     n        IN  入参：规则条数，不超过 250
+// 返回值：
+//     >= STR_LOC_USER      新排序规则的代号，可传给 nstr_compare()
+//     STR_BAD_PATTERN      规则无效
+//     STR_OUT_OF_MEMORY    内存不足
+// 说明：
+//     规则按规范分解序列匹配，预组合字符和分解形式（如 ñ 与 n + U+0303）结果相同。
+extern int nstr_add_locale(const str_collation_rule_t * rules, int n);
+
 inline static bool nstr_equal(nstr_p s1, nstr_p s2, str_locale_t locale)
 {
     return nstr_compare(s1, s2, locale) == 0;
@@ -126,6 +476,30 @@ inline static bool nstr_greater_or_equal(nstr_p s1, nstr_p s2, str_locale_t loca
     return nstr_compare(s1, s2, locale) >= 0;
 } // nstr_greater_or_equal
 
+// 功能：忽略大小写比较字符串
+// 返回值：
+//     < 0          s1 较小
+//     == 0         折叠后相同
+//     > 0          s1 较大
+// 说明：
+//     按 ASCII 折叠成块比较，不分配内存。UTF-8 串在非 ASCII 字符处不同时，改按 Unicode 简单大小写折叠逐个字符比较。
+//     排序结果按折叠后的码点值，与 nstr_compare() 的字节序不完全相同。
+extern int nstr_compare_nocase(nstr_p s1, nstr_p s2);
+
+inline static bool nstr_equal_nocase(nstr_p s1, nstr_p s2)
+{
+    return nstr_compare_nocase(s1, s2) == 0;
+} // nstr_equal_nocase
+
+// 忽略大小写测试是否存在子串
+extern bool nstr_contain_nocase(nstr_p s, nstr_p sub);
+
+// 忽略大小写测试串头是否为给定子串
+extern bool nstr_start_with_nocase(nstr_p s, nstr_p sub);
+
+// 忽略大小写测试串尾是否为给定子串
+extern bool nstr_end_with_nocase(nstr_p s, nstr_p sub);
+
 // 功能：获取字符数据区的起止地址
 // 参数：
 //     s      IN    入参：源串或切片，不能为 NULL
@@ -137,6 +511,19 @@ inline static bool nstr_greater_or_equal(nstr_p s1, nstr_p s2, str_locale_t loca
 //     无
 extern void nstr_byte_range(nstr_p s, const char_t ** start, const char_t ** end);
 
+// 功能：获取以 NUL 结尾的 C 字符串地址
+// 参数：
+//     s      IO    入参：源串或切片，不能为 NULL
+//                  出参：必要时改为引用新实体的切片
+// 返回值：
+//     非 NULL      C 字符串地址，在切片被删除或重设前有效
+//     NULL         内存不足
+// 说明：
+//     切片之后紧跟 NUL 字符时（如覆盖整个字符串的切片），直接返回切片起始地址。
+//     否则将切片内容复制到以 NUL 结尾的新实体，并令切片改为引用新实体，再次调用时无需复制。
+//     复制后，此前从该切片取得的地址和视图只在原实体存活期间有效。
+extern const char_t * nstr_cstr(nstr_p s);
+
 // 功能：获取下一字符
 // 参数：
 //     s      IN    入参：源串或切片，指向一个非零长度的串
@@ -144,31 +531,231 @@ extern void nstr_byte_range(nstr_p s, const char_t ** start, const char_t ** end
 // 返回值：
 //     0 <          跳过字节数，累加可得字节下标
 //     == 0         没有更多字符，遍历结束
-extern uint32_t nstr_next_char(nstr_p s, const char_t ** start, uint32_t * index, nstr_p ch);
+extern str_size_t nstr_next_char(nstr_p s, const char_t ** start, str_size_t * index, nstr_p ch);
+
+// 功能：从串尾向前获取上一字符
+// 参数：
+//     s      IN    入参：源串或切片
+//     start  IO    入参：遍历状态变量的指针，首次调用前置 NULL
+//                  出参：字符在源串中的起始地址，遍历结束时置 NULL
+//     index  IO    入参：遍历状态变量的指针
+//                  出参：字符的负下标，最后一个字符为 -1 ，可直接传给 nstr_slice() 等函数
+//     ch     IO    入参：任意非定长串的切片，遍历期间不能修改
+//                  出参：字符的切片，引用其在源串中的正确位置
+// 返回值：
+//     0 <          字符字节数
+//     == 0         没有更多字符，遍历结束
+// 说明：
+//     下标从串尾倒数，无需计算源串的字符数。
+extern str_size_t nstr_prev_char(nstr_p s, const char_t ** start, str_size_t * index, nstr_p ch);
+
+// 功能：获取下一个以空白字符（SPACE/TAB/CR/NL等）分隔的单词
+// 参数：
+//     s      IN    入参：源串或切片
+//     start  IO    入参：遍历状态变量的指针，首次调用前置 NULL
+//                  出参：单词在源串中的起始地址，遍历结束时置 NULL
+//     index  IO    入参：遍历状态变量的指针
+//                  出参：单词在源串中的字符下标
+//     tok    IO    入参：任意非定长串的切片，遍历期间不能修改
+//                  出参：单词的切片，引用其在源串中的正确位置
+// 返回值：
+//     0 <          单词字节数
+//     == 0         没有更多单词，遍历结束
+extern str_size_t nstr_next_token(nstr_p s, const char_t ** start, str_size_t * index, nstr_p tok);
+
+// 功能：获取下一个扩展字素簇（用户感知的字符，UAX #29）
+// 参数：
+//     s      IN    入参：源串或切片
+//     start  IO    入参：遍历状态变量的指针，首次调用前置 NULL
+//                  出参：字素簇在源串中的起始地址，遍历结束时置 NULL
+//     index  IO    入参：遍历状态变量的指针
+//                  出参：字素簇首字符在源串中的字符下标
+//     g      IO    入参：任意非定长串的切片，遍历期间不能修改
+//                  出参：字素簇的切片，引用其在源串中的正确位置
+// 返回值：
+//     0 <          字素簇字节数
+//     == 0         没有更多字素簇，遍历结束
+// 说明：
+//     可用于按显示单位截断、移动光标等，不会拆开组合字符、表情符号序列和韩文音节。
+extern str_size_t nstr_next_grapheme(nstr_p s, const char_t ** start, str_size_t * index, nstr_p g);
 
 // 功能：查找子串
 // 参数：
 //     s      IN    入参：源串或切片，指向一个非零长度的串
-//     sub    IO    入参：目标子串，指向一个非零长度的切片
-//                  出参：目标子串，引用其在源串中的正确位置
+//     sub    IN    入参：目标子串，指向一个非零长度的切片
+//     start  IO    入参：遍历状态变量的指针，首次调用前置 NULL
+//                  出参：目标子串在源串中的起始地址，查找结束时置 NULL
+//     index  IO    入参：遍历状态变量的指针
+//                  出参：目标子串在源串中的字符下标
 // 返回值：
-//     >= 0                 目标子串前的字符数，累加可得子串下标
+//     >= 0                 距离上个子串结尾（或源串开头）的字节数
 //     STR_NOT_FOUND        没有找到子串，查找结束
 //     STR_UNKNOWN_BYTE     源串包含异常字节（未正确编码）
 // 说明：
-//     本函数在源串中查找子串，并修改子串的引用位置。查找结束后，如再次以相同对象调用，则会绕回到源串开头，启动新一轮查找。
-extern uint32_t nstr_next_sub(nstr_p s, nstr_p sub, const char_t ** start, uint32_t * index);
+//     本函数在源串中查找子串，下次调用从本次找到的子串之后继续。查找结束后，如再次以相同对象调用，则会绕回到源串开头，启动新一轮查找。
+//     每次调用都要重新编译子串（长模式需重建 Horspool 跳跃表），遍历全部匹配时应改用 nstr_next_match() 。
+extern str_size_t nstr_next_sub(nstr_p s, nstr_p sub, const char_t ** start, str_size_t * index);
+
+// 功能：从串尾向前查找子串（同 rfind）
+// 参数：
+//     s      IN    入参：源串或切片，指向一个非零长度的串
+//     sub    IN    入参：目标子串，指向一个非零长度的切片
+//     start  IO    入参：遍历状态变量的指针，首次调用前置 NULL
+//                  出参：目标子串在源串中的起始地址，查找结束时置 NULL
+//     index  IO    入参：遍历状态变量的指针
+//                  出参：目标子串的负下标，从串尾倒数
+// 返回值：
+//     >= 0                 距离上个子串开头（或源串结尾）的字节数
+//     STR_NOT_FOUND        没有找到更多子串，查找结束
+// 说明：
+//     下次调用只在本次找到的子串之前查找，各次结果互不重叠。只计算经过部分的字符数。
+//     每次调用都要重新编译子串。
+extern str_size_t nstr_prev_sub(nstr_p s, nstr_p sub, const char_t ** start, str_size_t * index);
+
+// 功能：忽略大小写查找子串
+// 参数：
+//     s      IN    入参：源串或切片，指向一个非零长度的串
+//     sub    IN    入参：目标子串，指向一个非零长度的切片
+//     start  IO    入参：遍历状态变量的指针，首次调用前置 NULL
+//                  出参：找到的子串在源串中的起始地址，查找结束时置 NULL
+//     index  IO    入参：遍历状态变量的指针
+//                  出参：找到的子串在源串中的字符下标
+//     bytes  IO    入参：遍历状态变量的指针
+//                  出参：找到的子串在源串中占用的字节数
+// 返回值：
+//     >= 0                 距离上个子串结尾（或源串开头）的字节数
+//     STR_NOT_FOUND        没有找到子串，查找结束
+// 说明：
+//     用法同 nstr_next_sub() 。只含 ASCII 字节时按 ASCII 折叠成块过滤候选位置，不分配内存。
+//     含有非 ASCII 字符的 UTF-8 串按 Unicode 简单大小写折叠逐个字符位置比较，折叠前后的字符可能占用不同字节数，因此由 bytes 返回匹配长度。
+extern str_size_t nstr_next_sub_nocase(nstr_p s, nstr_p sub, const char_t ** start, str_size_t * index, str_size_t * bytes);
+
+// 功能：编译模式串，生成可重复使用的查找器
+// 参数：
+//     pattern  IN  入参：模式串，不能是空串
+// 返回值：
+//     non-NULL     查找器，持有模式串的引用
+//     NULL         内存不足
+// 说明：
+//     按模式串长度选择算法：单字节用 memchr() ，短模式按首尾字节成块过滤，长模式用 Horspool 算法。
+//     在同一模式串上反复查找时（如 nstr_split_by()/nstr_substitute_by()），可省去每次调用的准备开销。
+extern nstr_searcher_p nstr_new_searcher(nstr_p pattern);
+
+// 删除查找器
+extern void nstr_delete_searcher(nstr_searcher_p sr);
+
+// 使用查找器查找下一个子串，参数和返回值同 nstr_next_sub()
+extern str_size_t nstr_next_match(nstr_p s, nstr_searcher_p sr, const char_t ** start, str_size_t * index);
+
+// 使用查找器判断是否包含子串
+extern bool nstr_contain_by(nstr_p s, nstr_searcher_p sr);
+
+// 功能：编译关键字集合（Aho-Corasick 自动机）
+// 参数：
+//     needles  IN  入参：关键字数组，均不能是空串
+//     n        IN  入参：关键字数量
+// 返回值：
+//     non-NULL     关键字集合，编译后不再引用 needles
+//     NULL         内存不足
+// 说明：
+//     转移表按字节类别压缩，在初始状态下成段跳过不能开始匹配的字节。
+//     扫描一遍即可找出全部关键字的全部出现，耗时与关键字数量无关。
+extern nstr_keywords_p nstr_new_keywords(nstr_p * needles, int n);
+
+// 删除关键字集合
+extern void nstr_delete_keywords(nstr_keywords_p kw);
+
+// 功能：查找下一个关键字
+// 参数：
+//     s        IN  入参：源串或切片，须与关键字编码相同
+//     kw       IN  入参：关键字集合
+//     cur      IO  入参：查找游标，start 为 NULL 时从头开始
+//                  出参：本次匹配的起始地址、字节偏移量、字符下标和字节数
+// 返回值：
+//     >= 0         关键字在 needles 中的下标
+//     STR_NOT_FOUND 找不到更多关键字，cur->start 置为 NULL
+// 说明：
+//     匹配按结尾位置先后报告，重叠的匹配全部报告，同一结尾处较长的关键字在前。
+//     内容相同的关键字只报告下标最小者。
+//     用法：while ((id = nstr_next_keyword(s, kw, &cur)) >= 0) { ... }
+extern int32_t nstr_next_keyword(nstr_p s, nstr_keywords_p kw, nstr_keyword_cursor_p cur);
+
+// 功能：编译正则表达式
+// 参数：
+//     pattern  IN  入参：模式串，须为 ASCII 或 UTF-8 编码
+//     err      OUT 出参：失败原因，可以为 NULL
+// 返回值：
+//     non-NULL     正则表达式，编译后不再引用模式串
+//     NULL         编译失败，*err 为 STR_BAD_PATTERN（语法错误或规模过大）或 STR_OUT_OF_MEMORY
+// 说明：
+//     语法见 str/regex.h 。先用惰性 DFA 定位匹配，只在需要分组时运行 Pike VM ，
+//     DFA 状态缓存有字节数上限，超出时清空重建。模式以字面量开头时先用子串查找器过滤候选位置。
+//     正则表达式带有可变的缓存，不能在多个线程中同时使用。
+extern nstr_regex_p nstr_new_regex(nstr_p pattern, int32_t * err);
+
+// 删除正则表达式
+extern void nstr_delete_regex(nstr_regex_p re);
+
+// 返回分组数，包含代表整个匹配的 0 号分组
+extern int nstr_regex_groups(nstr_regex_p re);
+
+// 判断源串是否包含匹配，只运行 DFA
+extern bool nstr_regex_test(nstr_p s, nstr_regex_p re);
+
+// 功能：查找下一个匹配
+// 参数：
+//     s        IN  入参：源串或切片，须为 ASCII 或 UTF-8 编码
+//     re       IN  入参：正则表达式
+//     cur      IO  入参：查找游标，start 为 NULL 时从头开始
+//                  出参：本次匹配的起始地址、字节偏移量、字符下标和字节数
+//     caps     IO  入参：分组切片数组，元素为 NULL 时新建切片，否则设置该切片
+//                  出参：各分组对应的切片，与源串共享实体；未参与匹配的分组为空串
+//     n        IN  入参：caps 的元素个数，可以为 0
+// 返回值：
+//     >= 0                 写入 caps 的分组数
+//     STR_NOT_FOUND        找不到更多匹配，cur->start 置为 NULL
+//     STR_OUT_OF_MEMORY    内存不足
+// 说明：
+//     匹配互不重叠，下次从本次匹配结尾继续查找；空匹配之后先前进一个字符。
+//     用法：while (nstr_next_regex(s, re, &cur, caps, n) >= 0) { ... }
+extern int32_t nstr_next_regex(nstr_p s, nstr_regex_p re, nstr_regex_cursor_p cur, nstr_p * caps, int n);
+
+// 返回开头连续属于 set 的字符数（同 strspn），set 只能包含 ASCII 字符
+extern str_size_t nstr_span(nstr_p s, nstr_p set);
+
+// 返回第一个属于 set 的字符的下标（同 strpbrk），找不到时返回 STR_NOT_FOUND ，set 只能包含 ASCII 字符
+extern str_size_t nstr_find_any_of(nstr_p s, nstr_p set);
 
 #define nstr_find next_next_sub
 
-// 设置编码
+// 功能：设置编码
+// 参数：
+//     s        IO  入参：源串或切片
+//     encoding IN  入参：编码方案
+// 返回值：
+//     true         编码正确，已设置
+//     false        编码错误，保持原编码
+// 说明：
+//     只校验不计数，字符数在首次需要时计算。实体内容已按相同编码校验过时跳过校验。
 extern bool nstr_set_encoding(nstr_p s, str_encoding_t encoding);
 
-// 收窄切片范围
-extern void nstr_narrow_down(nstr_p s, uint32_t index, uint32_t chars);
+// 只校验编码，不修改源串
+extern bool nstr_validate(nstr_p s, str_encoding_t encoding);
+
+// 只计数，假定源串已通过校验，返回并缓存字符数
+extern str_size_t nstr_count_chars(nstr_p s);
+
+// 功能：收窄切片范围
+// 参数：
+//     s        IO  入参：源串或切片
+//     index    IN  入参：起始字符下标，转为 str_ssize_t 后为负数时从串尾倒数（-1 是最后一个字符），超出串头时从串头开始
+//     chars    IN  入参：字符数，超出剩余部分时截到串尾
+// 说明：
+//     负下标从串尾向前计数，不经过串头部分。已知字符数时，非负下标也从较近的一端开始计数。
+extern void nstr_narrow_down(nstr_p s, str_size_t index, str_size_t chars);
 
-// 基于字符范围，生成或设置切片
-extern nstr_p nstr_slice(nstr_p s, uint32_t index, uint32_t chars, nstr_p r);
+// 基于字符范围，生成或设置切片，index 和 chars 的含义同 nstr_narrow_down()
+extern nstr_p nstr_slice(nstr_p s, str_size_t index, str_size_t chars, nstr_p r);
 
 // 功能：切分字符串
 // 参数：
@@ -181,6 +768,9 @@ extern nstr_p nstr_slice(nstr_p s, uint32_t index, uint32_t chars, nstr_p r);
 //     NULL         发生错误，内存不足
 extern int nstr_split(nstr_p s, nstr_p deli, int max, nstr_array_p * as);
 
+// 使用查找器切分字符串，参数和返回值同 nstr_split()
+extern int nstr_split_by(nstr_p s, nstr_searcher_p sr, int max, nstr_array_p * as);
+
 // 重复拼接字符串
 extern nstr_p nstr_repeat(nstr_p s, int n, nstr_p r);
 
@@ -205,20 +795,20 @@ inline static nstr_p nstr_join2(nstr_p deli, nstr_p s1, nstr_p s2, nstr_p r)
     return nstr_concat3(s1, deli, s2, r);
 } // nstr_join2
 
-// 将给定位置处的固定长度子串替换成新串
-extern nstr_p nstr_replace(nstr_p s, uint32_t index, uint32_t chars, nstr_p to, nstr_p r);
+// 将给定位置处的固定长度子串替换成新串，负下标从串尾倒数，下标超出串尾时追加到串尾
+extern nstr_p nstr_replace(nstr_p s, str_size_t index, str_size_t chars, nstr_p to, nstr_p r);
 
 // 将给定位置处的固定长度子串替换成单字节字符
-extern nstr_p nstr_replace_with_char(nstr_p s, uint32_t index, uint32_t chars, char_t ch, nstr_p r);
+extern nstr_p nstr_replace_with_char(nstr_p s, str_size_t index, str_size_t chars, char_t ch, nstr_p r);
 
 // 在给定位置插入子串
-inline static nstr_p nstr_insert(nstr_p s, uint32_t index, nstr_p sub, nstr_p r)
+inline static nstr_p nstr_insert(nstr_p s, str_size_t index, nstr_p sub, nstr_p r)
 {
     return nstr_replace(s, index, 0, sub, r);
 } // nstr_insert
 
 // 在给定位置插入单字节字符
-inline static nstr_p nstr_insert_char(nstr_p s, uint32_t index, char_t ch, nstr_p r)
+inline static nstr_p nstr_insert_char(nstr_p s, str_size_t index, char_t ch, nstr_p r)
 {
     return nstr_replace_with_char(s, index, 0, ch, r);
 } // nstr_insert_char
@@ -238,28 +828,28 @@ inline static nstr_p nstr_prepend_char(nstr_p s, char_t ch, nstr_p r)
 // 在串尾后插入子串
 inline static nstr_p nstr_append(nstr_p s, nstr_p sub, nstr_p r)
 {
-    return nstr_replace(s, nstr_chars(s), 0, sub, r);
+    return nstr_replace(s, NSTR_INDEX_END, 0, sub, r);
 } // nstr_append
 
 // 在串尾后插入单字节字符
 inline static nstr_p nstr_append_char(nstr_p s, char_t ch, nstr_p r)
 {
-    return nstr_replace_with_char(s, nstr_chars(s), 0, ch, r);
+    return nstr_replace_with_char(s, NSTR_INDEX_END, 0, ch, r);
 } // nstr_append_char
 
 // 删除定位置处的固定长度子串
-extern nstr_p nstr_remove(nstr_p s, uint32_t index, uint32_t chars, nstr_p r);
+extern nstr_p nstr_remove(nstr_p s, str_size_t index, str_size_t chars, nstr_p r);
 
 // 删除串头的固定长度子串
-extern nstr_p nstr_cut_head(nstr_p s, uint32_t chars, nstr_p r);
+extern nstr_p nstr_cut_head(nstr_p s, str_size_t chars, nstr_p r);
 
 // 删除串尾的固定长度子串
-extern nstr_p nstr_cut_tail(nstr_p s, uint32_t chars, nstr_p r);
+extern nstr_p nstr_cut_tail(nstr_p s, str_size_t chars, nstr_p r);
 
-// 删除串尾的换行符（以及可能的回车符）
+// 删除串尾的换行符（以及其前紧邻的回车符），单独的回车符保留，结果是源串的切片
 extern nstr_p nstr_chomp(nstr_p s, nstr_p r);
 
-// 删除串头和串尾的空白字符（SPACE/TAB/CR/NL等）
+// 删除串头和串尾的空白字符（SPACE/TAB/CR/NL等），结果是源串的切片
 extern nstr_p nstr_trim(nstr_p s, nstr_p r);
 
 // 删除串头的空白字符（SPACE/TAB/CR/NL等）
@@ -268,8 +858,119 @@ extern nstr_p nstr_ltrim(nstr_p s, nstr_p r);
 // 删除串尾的空白字符（SPACE/TAB/CR/NL等）
 extern nstr_p nstr_rtrim(nstr_p s, nstr_p r);
 
-// 替换子串
+// 替换子串，from 不能是空串；替换全部子串时只查找一遍并一次复制到新实体，没有匹配时引用源串
 extern nstr_p nstr_substitute(nstr_p s, bool all, nstr_p from, nstr_p to, nstr_p r);
 
+// 使用查找器替换子串
+extern nstr_p nstr_substitute_by(nstr_p s, bool all, nstr_searcher_p sr, nstr_p to, nstr_p r);
+
+// 功能：编译多对替换表（同 strtr）
+// 参数：
+//     pairs    IN  入参：替换对数组，共 2n 个元素，依次为 from0, to0, from1, to1 ... ，from 均不能是空串
+//     n        IN  入参：替换对数量
+// 返回值：
+//     non-NULL     替换表，持有各 to 串的引用，编译后不再引用 from 串
+//     NULL         内存不足
+extern nstr_replacer_p nstr_new_replacer(nstr_p * pairs, int n);
+
+// 删除替换表
+extern void nstr_delete_replacer(nstr_replacer_p rp);
+
+// 功能：一次扫描完成多对替换
+// 参数：
+//     s        IN  入参：源串或切片，须与各 from 串编码相同
+//     pairs    IN  入参：替换对数组，同 nstr_new_replacer()
+//     n        IN  入参：替换对数量
+//     r        IO  入参：NULL 表示生成新切片，否则重设该切片
+// 返回值：
+//     non-NULL     结果，没有匹配时引用源串
+//     NULL         内存不足
+// 说明：
+//     从左到右扫描，每个位置取最长的 from 串替换，替换结果不再参与匹配（同 PHP strtr()）。
+//     先用字节集合成块跳过不能开始匹配的字节，再沿字典树求最长匹配；按准确长度一次复制到新实体。
+extern nstr_p nstr_substitute_pairs(nstr_p s, nstr_p * pairs, int n, nstr_p r);
+
+// 使用替换表完成多对替换，参数和返回值同 nstr_substitute_pairs()
+extern nstr_p nstr_substitute_with(nstr_p s, nstr_replacer_p rp, nstr_p r);
+
+// 功能：转换为小写/大写/完全大小写折叠形式
+// 参数：
+//     s        IN  入参：源串或切片
+//     r        IO  入参：NULL 表示生成新切片，否则重设该切片
+// 返回值：
+//     non-NULL     结果串
+//     NULL         内存不足
+// 说明：
+//     ASCII 字母成块转换（范围比较后异或 0x20 ）；UTF-8 串的非 ASCII 字符按 Unicode 完全映射查表，
+//     结果可能改变字节数和字符数（如 ß 转为大写 SS ），先计算确切长度再一次写入新实体。
+//     映射与上下文、语言无关（不处理词尾 Σ 等规则）。已是目标形式时直接引用源串，不复制内容。
+extern nstr_p nstr_to_lower(nstr_p s, nstr_p r);
+extern nstr_p nstr_to_upper(nstr_p s, nstr_p r);
+extern nstr_p nstr_case_fold(nstr_p s, nstr_p r);
+
+// 功能：Unicode 规范化
+// 参数：
+//     s        IN  入参：源串或切片
+//     form     IN  入参：规范化形式
+//     r        IO  入参：NULL 表示生成新切片，否则重设该切片
+// 返回值：
+//     non-NULL     结果串
+//     NULL         内存不足
+// 说明：
+//     先做快速检查：首字节低于阈值的字符成块跳过，其余字符查 ccc 和快速检查属性，
+//     只有检查不通过的片段（到前后的稳定字符为止）才完全分解、排序和组合。
+//     已是规范化形式时直接引用源串，不复制内容；ASCII 串和非 UTF-8 串总是直接引用源串。
+extern nstr_p nstr_normalize(nstr_p s, str_norm_form_t form, nstr_p r);
+
+// 功能：检查是否已是规范化形式，参数同 nstr_normalize()
+// 返回值：
+//     true         是
+//     false        不是，或内存不足
+extern bool nstr_is_normalized(nstr_p s, str_norm_form_t form);
+
+// ---- 视图函数 ---- //
+
+// 借用源串或切片的字节范围，不增加引用计数
+extern nstr_view_t nstr_view(nstr_p s);
+
+// 借用外部字节范围
+extern nstr_view_t nstr_view_of(const char_t * src, str_size_t bytes, str_encoding_t encoding);
+
+// 功能：将视图转换为持有引用的切片
+// 参数：
+//     owner    IN  入参：视图所借用的源串或切片
+//     v        IN  入参：视图，必须位于 owner 的字节范围内
+//     r        IO  入参：NULL 表示生成新切片，否则重设该切片
+// 返回值：
+//     non-NULL     引用 owner 实体的切片（零拷贝）
+//     NULL         内存不足
+extern nstr_p nstr_from_view(nstr_p owner, nstr_view_p v, nstr_p r);
+
+// 返回视图包含的字符数
+extern str_size_t nstr_view_chars(nstr_view_p v);
+
+// 获取视图中的下一字符，用法同 nstr_next_char()
+extern str_size_t nstr_view_next_char(nstr_view_p v, const char_t ** start, str_size_t * index, nstr_view_p ch);
+
+// 在视图中查找子串，用法同 nstr_next_sub() ，同样每次调用都要重新编译子串
+extern str_size_t nstr_view_next_sub(nstr_view_p v, nstr_view_p sub, const char_t ** start, str_size_t * index);
+
+// 测试视图是否包含子串，查找算法同 nstr_contain()
+extern bool nstr_view_contain(nstr_view_p v, nstr_view_p sub);
+
+// 测试视图头部是否为给定子串
+extern bool nstr_view_start_with(nstr_view_p v, nstr_view_p sub);
+
+// 测试视图尾部是否为给定子串
+extern bool nstr_view_end_with(nstr_view_p v, nstr_view_p sub);
+
+// 比较视图（排序），参数同 nstr_compare() ，视图不持有实体，每次都生成排序键
+extern int nstr_view_compare(nstr_view_p v1, nstr_view_p v2, str_locale_t locale);
+
+inline static bool nstr_view_equal(nstr_view_p v1, nstr_view_p v2)
+{
+    return v1->bytes == v2->bytes && memcmp(v1->start, v2->start, v1->bytes) == 0;
+} // nstr_view_equal
+
 #endif // _AUX_STRING_H_
 
@@ -0,0 +1,66 @@
+#ifndef _AUX_STR_REGEX_H_
+#define _AUX_STR_REGEX_H_ 1
+
+// 正则表达式引擎：模式串按 UTF-8 解析，编译成字节级 NFA 程序，
+// 先用惰性构造、容量有限的 DFA 判定是否匹配并确定范围，再用 Pike VM 求捕获分组。
+//
+// 支持的语法：
+//     字符         任意 UTF-8 字符，元字符须用 \ 转义
+//     .            除 \n 外的任意字符
+//     [...]        字符集，支持范围 a-z 、取反 [^...] 及 \d \w \s 等
+//     \d \w \s     数字、单词字符、空白字符（仅 ASCII），大写形式取反
+//     \n \t \r \f \v \0     控制字符
+//     ^ $          源串开头、结尾
+//     (...)        捕获分组，(?:...) 不捕获
+//     a|b          选择，左侧优先
+//     * + ? {n} {n,} {n,m}  重复，默认贪婪，后加 ? 变为非贪婪
+//
+// 匹配语义为最左优先，按分支和重复的优先次序选取第一个成功的匹配。
+// 重复体能匹配空串时按 RE2 的规则处理，与 Perl/PCRE 不同：重复体匹配空串的一轮不结束重复，也不记录其中的分组，
+// 如 (x*)* 匹配 "a" 时分组 1 未参与匹配（Perl 为空串），(?:[ab]??|c*[ab]+?)+b*? 匹配 "caacabaa" 的范围是 0..8（Perl 为 0..0）。
+
+#include "types.h"
+
+enum {
+    STR_REGEX_OUT_OF_MEMORY = -1,   // 与 STR_OUT_OF_MEMORY 相同
+    STR_REGEX_BAD_SYNTAX = -3,      // 模式串语法错误
+    STR_REGEX_TOO_LARGE = -4,       // 编译结果超出指令数上限
+};
+
+#define STR_REGEX_DFA_BUDGET (256 * 1024)   // 每个 DFA 缓存的字节数上限，超出时清空重建
+
+typedef struct STR_REGEX str_regex_t, *str_regex_p;
+
+// 功能：编译正则表达式
+// 参数：
+//     pattern  IN  模式串起始地址
+//     bytes    IN  模式串字节数
+//     err      OUT 错误码，可以为 NULL
+//     err_pos  OUT 语法错误位置（字节偏移量），可以为 NULL
+// 返回值：
+//     non-NULL     正则表达式对象，编译后不再引用模式串
+//     NULL         编译失败，*err 记录原因
+extern str_regex_p str_regex_new(const char_t * pattern, str_size_t bytes, int32_t * err, str_size_t * err_pos);
+
+// 删除正则表达式对象
+extern void str_regex_delete(str_regex_p re);
+
+// 返回分组数，包含代表整个匹配的 0 号分组
+extern uint32_t str_regex_groups(str_regex_p re);
+
+// 功能：查找第一个匹配
+// 参数：
+//     re       IN  正则表达式对象，查找期间会修改其 DFA 缓存，不能在多个线程中同时使用
+//     begin    IN  源串起始地址，^ 只匹配此处
+//     end      IN  源串结尾地址，$ 只匹配此处
+//     from     IN  查找起始地址
+//     caps     OUT 各分组的起止地址，第 i 组为 caps[2i] 和 caps[2i + 1] ，未参与匹配的分组为 NULL
+//     n        IN  caps 可容纳的分组数，0 表示只判定是否匹配
+// 返回值：
+//     true         找到匹配
+//     false        找不到
+// 说明：
+//     模式以字面量开头时，先用子串查找器定位候选位置，再从候选位置锚定匹配。
+extern bool str_regex_find(str_regex_p re, const char_t * begin, const char_t * end, const char_t * from, const char_t ** caps, uint32_t n);
+
+#endif // _AUX_STR_REGEX_H_
@@ -0,0 +1,62 @@
+#ifndef _AUX_STR_SEARCH_H_
+#define _AUX_STR_SEARCH_H_ 1
+
+#include "types.h"
+
+// 按模式串长度选用的查找算法
+typedef enum STR_SEARCH_ALGO {
+    STR_SEARCH_BYTE     = 0,    // 单字节，使用 memchr()
+    STR_SEARCH_PAIR     = 1,    // 短模式，按首尾字节逐块过滤候选位置，再比较中间部分
+    STR_SEARCH_HORSPOOL = 2,    // 长模式，按窗口末字节跳跃（Boyer-Moore-Horspool）
+    STR_SEARCH_NOCASE   = 3,    // 忽略 ASCII 大小写，按折叠后的首尾字节逐块过滤候选位置
+} str_search_algo_t;
+
+#define STR_SEARCH_LONG 32      // 使用 Horspool 算法的模式串字节数下限
+
+// 预编译的子串查找器，可在多个字节范围中重复使用
+typedef struct STR_SEARCHER {
+    const char_t *  needle;     // 模式串，由调用方保证在查找器使用期间存活
+    str_size_t      bytes;      // 模式串字节数
+    uint32_t        algo;       // 查找算法
+    uint8_t         shift[256]; // Horspool 跳跃表，超过 255 的跳跃距离按 255 计算（仍然正确）
+} str_searcher_t, *str_searcher_p;
+
+// 功能：编译模式串
+// 参数：
+//     sr       OUT 查找器
+//     needle   IN  模式串起始地址
+//     bytes    IN  模式串字节数，不能为 0
+extern void str_searcher_init(str_searcher_p sr, const char_t * needle, str_size_t bytes);
+
+// 功能：编译忽略 ASCII 大小写的模式串
+// 参数：
+//     sr       OUT 查找器
+//     needle   IN  模式串起始地址
+//     bytes    IN  模式串字节数，不能为 0
+// 说明：
+//     只折叠 A~Z ，不分配内存。查找器只能用于 str_searcher_find() 。
+extern void str_searcher_init_nocase(str_searcher_p sr, const char_t * needle, str_size_t bytes);
+
+// 功能：在字节范围中查找模式串的第一次出现
+// 参数：
+//     sr       IN  查找器
+//     start    IN  字节范围起始地址
+//     bytes    IN  字节范围长度
+// 返回值：
+//     non-NULL     模式串首次出现的地址
+//     NULL         找不到
+extern const char_t * str_searcher_find(str_searcher_p sr, const char_t * start, str_size_t bytes);
+
+// 功能：在字节范围中查找模式串的最后一次出现
+// 参数：
+//     sr       IN  查找器
+//     start    IN  字节范围起始地址
+//     bytes    IN  字节范围长度
+// 返回值：
+//     non-NULL     模式串最后一次出现的地址
+//     NULL         找不到
+// 说明：
+//     不支持忽略大小写的查找器。单字节模式使用 memrchr() ，其余模式从结尾向前按首尾字节逐块过滤候选位置（Horspool 跳跃表只用于正向查找）。
+extern const char_t * str_searcher_rfind(str_searcher_p sr, const char_t * start, str_size_t bytes);
+
+#endif // _AUX_STR_SEARCH_H_
@@ -0,0 +1,220 @@
+#ifndef _AUX_STR_UCD_H_
+#define _AUX_STR_UCD_H_ 1
+
+// Unicode 字符属性（UCD）：数据表 src/str/ucd_table.h 由 src/str/ucd.py 根据 Python 的 unicodedata 模块生成，随源码提交。
+// 排序权重取自随源码提交的 DUCET（src/str/allkeys.txt ，版本 13.0.0）。
+//
+// 各属性均按两级表存储：一级表按码点高位给出块号，二级表按码点低位给出属性值，内容相同的块只保存一份。
+
+#include "types.h"
+
+// 功能：简单大小写折叠（CaseFolding.txt 的 C+S 项，一个码点映射为一个码点）
+// 参数：
+//     ch       IN  Unicode 码点值
+// 返回值：
+//     折叠结果，没有对应的折叠形式时返回 ch 本身
+extern uchar_t ucd_fold(uchar_t ch);
+
+// 功能：检查给定范围是否包含折叠结果与某个非 ASCII 字符相同的 ASCII 字母（如 k 与 KELVIN SIGN）
+// 返回值：
+//     true         包含，不能只按 ASCII 折叠比较
+//     false        不包含
+extern bool ucd_fold_aliased_in(const char_t * start, str_size_t bytes);
+
+// 功能：按简单大小写折叠逐个比较两个 UTF-8 字节范围中的字符
+// 参数：
+//     p1/b1    IN  第一个范围的起始地址和字节数
+//     p2/b2    IN  第二个范围的起始地址和字节数
+//     m1/m2    OUT 两个范围中折叠后相同部分的字节数，可以为 NULL
+// 返回值：
+//     < 0          第一个范围较小（包括是第二个范围的前缀）
+//     == 0         折叠后相同
+//     > 0          第一个范围较大
+// 说明：
+//     异常字节按单字节字符处理，按字节值比较。
+extern int ucd_fold_compare(const char_t * p1, str_size_t b1, const char_t * p2, str_size_t b2, str_size_t * m1, str_size_t * m2);
+
+// 功能：按简单大小写折叠检查 UTF-8 字节范围的结尾部分
+// 参数：
+//     p1/b1    IN  被检查范围的起始地址和字节数
+//     p2/b2    IN  结尾部分的起始地址和字节数
+// 返回值：
+//     true         p1 范围以 p2 范围结尾（折叠后）
+//     false        不是
+// 说明：
+//     从两个范围的结尾向前逐个字符比较，折叠前后的字符可能占用不同字节数。
+extern bool ucd_fold_suffix(const char_t * p1, str_size_t b1, const char_t * p2, str_size_t b2);
+
+// 大小写映射类型
+enum {
+    UCD_CASE_LOWER = 0,     // 小写
+    UCD_CASE_UPPER = 1,     // 大写
+    UCD_CASE_FOLD  = 2,     // 完全大小写折叠（如 ß 折叠为 ss ）
+};
+
+#define UCD_CASE_MAX 3      // 一个字符的映射结果至多包含的字符数
+
+// 功能：完全大小写映射（SpecialCasing.txt 中与上下文、语言无关的部分）
+// 参数：
+//     ch       IN  Unicode 码点值
+//     kind     IN  映射类型
+//     out      OUT 映射结果
+// 返回值：
+//     1 ~ UCD_CASE_MAX     映射结果包含的字符数，没有对应的映射时 out[0] 是 ch 本身
+extern int32_t ucd_case(uchar_t ch, uint32_t kind, uchar_t out[UCD_CASE_MAX]);
+
+// 功能：计算 UTF-8 字节范围按大小写映射后的字节数
+// 参数：
+//     start    IN  起始地址
+//     bytes    IN  范围长度（字节数）
+//     kind     IN  映射类型
+//     first    OUT 第一个发生变化的字节的偏移量，没有变化时等于 bytes
+//     extra    OUT 映射后增加的字符数
+// 返回值：
+//     >= 0         映射后的字节数
+// 说明：
+//     成段跳过 ASCII 字符，只对非 ASCII 字符查表。异常字节原样保留。
+extern str_size_t ucd_case_measure(const char_t * start, str_size_t bytes, uint32_t kind, str_size_t * first, str_size_t * extra);
+
+// 功能：按大小写映射转换 UTF-8 字节范围
+// 参数：
+//     dst      OUT 目标缓冲区，容量不少于 ucd_case_measure() 的结果
+//     start    IN  起始地址
+//     bytes    IN  范围长度（字节数）
+//     kind     IN  映射类型
+// 返回值：
+//     转换结果的结尾地址
+extern char_t * ucd_case_convert(char_t * dst, const char_t * start, str_size_t bytes, uint32_t kind);
+
+// 规范化形式
+enum {
+    UCD_NFC  = 0,   // 规范分解后再规范组合
+    UCD_NFD  = 1,   // 规范分解
+    UCD_NFKC = 2,   // 兼容分解后再规范组合
+    UCD_NFKD = 3,   // 兼容分解
+};
+
+// 可增长的输出缓冲区，由调用方初始化为全零并负责释放 data
+typedef struct UCD_BUFFER {
+    char_t *        data;
+    str_size_t      used;           // 已写入字节数
+    str_size_t      cap;            // 容量
+} ucd_buffer_t, *ucd_buffer_p;
+
+// 返回字符的规范组合类（Canonical_Combining_Class），0 表示起始字符
+extern uint32_t ucd_ccc(uchar_t ch);
+
+// 功能：快速检查（UAX #15 Quick Check），查找 UTF-8 字节范围中第一段需要规范化的部分
+// 参数：
+//     start    IN  起始地址
+//     bytes    IN  范围长度（字节数）
+//     form     IN  规范化形式
+//     end      OUT 需要规范化部分的结尾偏移量
+// 返回值：
+//     < bytes      需要规范化部分的起始偏移量
+//     == bytes     已是规范化形式
+// 说明：
+//     首字节小于 UCD_XXX_QUICK 的字符都是 ccc 为 0 且检查结果为 YES 的稳定字符，成块跳过。
+//     检查结果为 NO/MAYBE 或组合类顺序不对的字符，连同其前后直到稳定字符为止的部分都需要规范化。
+//     检查结果为 MAYBE 的部分规范化后可能保持不变。
+extern str_size_t ucd_norm_span(const char_t * start, str_size_t bytes, uint32_t form, str_size_t * end);
+
+// 功能：规范化 UTF-8 字节范围，结果追加到缓冲区
+// 参数：
+//     start    IN  起始地址
+//     bytes    IN  范围长度（字节数）
+//     form     IN  规范化形式
+//     out      IO  输出缓冲区
+// 返回值：
+//     true         成功
+//     false        内存不足
+// 说明：
+//     依次完全分解、按组合类排序、规范组合（NFC/NFKC），韩文音节按算法分解和组合。异常字节原样保留。
+extern bool ucd_normalize(const char_t * start, str_size_t bytes, uint32_t form, ucd_buffer_p out);
+
+// 扩展字素簇分界属性（UAX #29 Grapheme_Cluster_Break），另将 Extended_Pictographic 并入同一属性
+enum {
+    UCD_GCB_OTHER        = 0,
+    UCD_GCB_CR           = 1,
+    UCD_GCB_LF           = 2,
+    UCD_GCB_CONTROL      = 3,
+    UCD_GCB_EXTEND       = 4,
+    UCD_GCB_ZWJ          = 5,
+    UCD_GCB_RI           = 6,   // Regional_Indicator
+    UCD_GCB_PREPEND      = 7,
+    UCD_GCB_SPACING_MARK = 8,
+    UCD_GCB_L            = 9,   // 韩文初声
+    UCD_GCB_V            = 10,  // 韩文中声
+    UCD_GCB_T            = 11,  // 韩文终声
+    UCD_GCB_LV           = 12,
+    UCD_GCB_LVT          = 13,
+    UCD_GCB_EXT_PICT     = 14,  // Extended_Pictographic
+};
+
+// 返回字符的字素簇分界属性
+extern uint32_t ucd_gcb(uchar_t ch);
+
+// 功能：计算 UTF-8 字节范围中第一个扩展字素簇的长度
+// 参数：
+//     start    IN  起始地址
+//     bytes    IN  范围长度（字节数），不能为 0
+//     chars    OUT 字素簇包含的字符数，可以为 NULL
+// 返回值：
+//     > 0          字素簇的字节数
+// 说明：
+//     按 UAX #29 的 GB3~GB13 规则判断分界，不处理 GB9c（印度系文字辅音连缀）。异常字节按控制字符处理，自成一簇。
+extern str_size_t ucd_grapheme(const char_t * start, str_size_t bytes, str_size_t * chars);
+
+// 功能：计算 UTF-8 字节范围包含的扩展字素簇个数
+// 说明：
+//     ASCII 字符前总有分界（CR LF 除外），成段跳过 ASCII 字节，每段只需检查 CR LF 及最后一个字节。
+extern str_size_t ucd_graphemes(const char_t * start, str_size_t bytes);
+
+enum {
+    UCD_OUT_OF_MEMORY = -1,         // 与 STR_OUT_OF_MEMORY 相同
+    UCD_BAD_RULE = -3,              // 裁剪规则无效
+};
+
+// 排序规则裁剪：令 ch 在给定级别上紧随 anchor 之后，如 {0x00F1, 'n', UCD_LEVEL_PRIMARY} 表示 ñ 是 n 之后的独立字母
+typedef struct UCD_COLL_RULE {
+    uchar_t         ch;             // 被调整的字符，其大小写形式同时调整
+    uchar_t         anchor;         // 参照字符
+    uint32_t        level;          // 差异级别
+} ucd_coll_rule_t;
+
+// 排序差异级别
+enum {
+    UCD_LEVEL_PRIMARY   = 1,    // 基本字母不同
+    UCD_LEVEL_SECONDARY = 2,    // 变音符号不同
+    UCD_LEVEL_TERTIARY  = 3,    // 大小写或兼容形式不同
+};
+
+// 编译后的裁剪表，布局不公开
+typedef struct UCD_TAILOR ucd_tailor_t, *ucd_tailor_p;
+
+// 功能：编译排序规则裁剪表
+// 参数：
+//     rules    IN  裁剪规则，同一参照字符、同一级别的多条规则按先后次序排列
+//     n        IN  规则条数，不超过 250
+//     err      OUT 失败原因：UCD_BAD_RULE（参照字符没有主权重或排序元素多于 4 个、级别无效、规则过多）或 UCD_OUT_OF_MEMORY
+// 返回值：
+//     non-NULL     裁剪表，用 free() 释放
+//     NULL         失败
+extern ucd_tailor_p ucd_tailor_new(const ucd_coll_rule_t * rules, int n, int * err);
+
+// 功能：生成 UTF-8 字节范围的排序键（Unicode 排序算法，UTS #10），结果追加到缓冲区
+// 参数：
+//     start    IN  起始地址
+//     bytes    IN  范围长度（字节数）
+//     tailor   IN  裁剪表，NULL 表示根排序规则
+//     out      IO  输出缓冲区
+// 返回值：
+//     true         成功
+//     false        内存不足
+// 说明：
+//     先规范分解（NFD），再按 DUCET 查找排序元素（包括连续与不连续的收缩），不在表中的码点按 UTS #10 计算隐式权重，
+//     依次输出主要（2 字节）、次要、第三级权重（各 1 字节），级间以 0x01 分隔，排序键按字节比较（memcmp）的结果即排序结果。
+//     可变权重字符按不可忽略处理（non-ignorable），不比较第四级。Unicode 14.0 新增的字符不在 DUCET 13.0.0 中，按未分配码点处理。
+extern bool ucd_coll_key(const char_t * start, str_size_t bytes, const ucd_tailor_t * tailor, ucd_buffer_p out);
+
+#endif // _AUX_STR_UCD_H_
@@ -79,9 +79,56 @@ inline static uint32_t utf8_measure_by_addup(const char_t * pos)
 // 返回值：
 //     true         编码正确
 //     false        编码错误
-extern bool utf8_count(const char_t * start, uint32_t * bytes, uint32_t * chars);
+extern bool utf8_count(const char_t * start, str_size_t * bytes, str_size_t * chars);
 
-extern bool utf8_verify_plain(const char_t * start, uint32_t * bytes, uint32_t * chars);
+// 功能：校验给定范围是否为正确的 UTF-8 编码，不计算字符数
+// 参数：
+//     start    IN  起始地址，不能为 NULL
+//     bytes    IO  入参：范围长度（字节数），不能为 NULL
+//                  出参：正确编码部分的字节数
+// 返回值：
+//     true         编码正确
+//     false        编码错误
+// 说明：
+//     按 8 字节整块跳过 ASCII 字符，只对多字节字符逐个检查。
+extern bool utf8_validate(const char_t * start, str_size_t * bytes);
+
+// 功能：计算给定范围包含多少个 UTF-8 字符，不校验编码
+// 参数：
+//     start    IN  起始地址，不能为 NULL
+//     bytes    IN  范围长度（字节数）
+// 返回值：
+//     >= 0         字符数（非跟随字节数）
+// 说明：
+//     假定范围已通过校验，按 8 字节整块统计非跟随字节。
+extern str_size_t utf8_chars(const char_t * start, str_size_t bytes);
+
+// 功能：记录每隔 step 个字符的字符起始偏移量（检查点）
+// 参数：
+//     start    IN  起始地址，不能为 NULL
+//     bytes    IN  范围长度（字节数）
+//     step     IN  检查点间隔字符数，必须大于 0
+//     offs     OUT 检查点数组，第 k 个元素是第 k * step 个字符的字节偏移量
+//     max      IN  检查点数组容量
+// 返回值：
+//     >= 0         记录的检查点个数
+// 说明：
+//     假定范围已通过校验。按 8 字节整块统计字符数，整块内没有检查点时直接跳过。
+extern str_size_t utf8_checkpoints(const char_t * start, str_size_t bytes, uint32_t step, str_size_t * offs, str_size_t max);
+
+// 功能：从结尾向前计算至多 *chars 个 UTF-8 字符占用的字节数，不校验编码
+// 参数：
+//     start    IN  起始地址，不能为 NULL
+//     bytes    IN  范围长度（字节数）
+//     chars    IO  入参：最大字符数，不能为 NULL
+//                  出参：实际经过的字符数，范围内字符不足时小于入参
+// 返回值：
+//     >= 0         范围结尾处 *chars 个字符占用的字节数
+// 说明：
+//     假定范围已通过校验。按 8 字节整块向前统计非跟随字节，整块内不会到达目标字符时直接跳过。
+extern str_size_t utf8_rseek(const char_t * start, str_size_t bytes, str_size_t * chars);
+
+extern bool utf8_verify_plain(const char_t * start, str_size_t * bytes, str_size_t * chars);
 
 enum {
     UTF8_VSS_START = 0,
@@ -93,9 +140,9 @@ enum {
     UTF8_VSS_ERROR = 5,
 };
 
-extern uint8_t utf8_verify_by_lookup_in_stream(const uint8_t sts, const char_t * const start, uint32_t * const bytes, uint32_t * const chars);
+extern uint8_t utf8_verify_by_lookup_in_stream(const uint8_t sts, const char_t * const start, str_size_t * const bytes, str_size_t * const chars);
 
-inline static bool utf8_verify_by_lookup(const char_t * const start, uint32_t * const bytes, uint32_t * const chars)
+inline static bool utf8_verify_by_lookup(const char_t * const start, str_size_t * const bytes, str_size_t * const chars)
 {
     uint8_t sts = 0;
     *chars = 0;
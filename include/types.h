@@ -4,9 +4,25 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <inttypes.h>
 
 typedef unsigned char char_t;
 typedef uint32_t uchar_t;
 
+// 字符串长度类型：默认 32 位，定义 AUX_STR_LARGE 编译时为 64 位，以支持超过 4 GiB 的串
+#ifdef AUX_STR_LARGE
+typedef uint64_t str_size_t;
+typedef int64_t str_ssize_t;
+#define STR_SIZE_MAX UINT64_MAX
+#define STR_SIZE_FMT PRIu64     // printf 格式，用法："%" STR_SIZE_FMT
+#define STR_SSIZE_FMT PRId64
+#else
+typedef uint32_t str_size_t;
+typedef int32_t str_ssize_t;
+#define STR_SIZE_MAX UINT32_MAX
+#define STR_SIZE_FMT PRIu32
+#define STR_SSIZE_FMT PRId32
+#endif
+
 #endif // _AUX_TYPES_H_
 
@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "str/acm.h"
+
+// 统计字节类别：出现在模式串中的字节各占一类，其余字节共用 0 号类别
+static void classify(str_acm_p ac, const char_t ** needles, const str_size_t * bytes, uint32_t n)
+{
+    uint8_t seen[256] = {0};
+    uint32_t used = 0;
+    uint32_t leads = 0;
+    uint32_t cls = 0;
+    uint32_t i = 0;
+    str_size_t k = 0;
+
+    for (i = 0; i < n; ++i) {
+        for (k = 0; k < bytes[i]; ++k) seen[needles[i][k]] = 1;
+        ac->first[needles[i][0]] = 1;
+    } // for
+
+    for (i = 0; i < 256; ++i) {
+        used += seen[i];
+        leads += ac->first[i];
+    } // for
+
+    // 全部 256 个字节都出现时无需共用类别
+    cls = (used < 256) ? 1 : 0;
+    for (i = 0; i < 256; ++i) ac->cls[i] = seen[i] ? cls++ : 0;
+    ac->classes = cls;
+
+    ac->lead = -1;
+    for (i = 0; leads == 1 && i < 256; ++i) {
+        if (ac->first[i]) ac->lead = i;
+    } // for
+} // classify
+
+// 按广度优先顺序计算失败链接，同时把缺失的转移展开成失败状态的转移
+static bool link_states(str_acm_p ac)
+{
+    uint32_t * fail = NULL;
+    uint32_t * queue = NULL;
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t u = 0;
+    uint32_t v = 0;
+    uint32_t c = 0;
+
+    fail = calloc(ac->states, sizeof(fail[0]));
+    queue = malloc(sizeof(queue[0]) * ac->states);
+    if (! fail || ! queue) {
+        free(queue);
+        free(fail);
+        return false;
+    } // if
+
+    queue[tail++] = 0;
+    while (head < tail) {
+        u = queue[head++];
+
+        // 处理 u 时其转移行仍只有字典树的边，而失败状态更浅，转移行已经展开
+        for (c = 0; c < ac->classes; ++c) {
+            v = ac->next[u * ac->classes + c];
+            if (v) {
+                fail[v] = u ? ac->next[fail[u] * ac->classes + c] : 0;
+                queue[tail++] = v;
+            } else if (u) {
+                ac->next[u * ac->classes + c] = ac->next[fail[u] * ac->classes + c];
+            } // if
+        } // for
+
+        if (u) {
+            ac->dict[u] = ac->emit[fail[u]];
+            ac->emit[u] = (ac->out[u] != STR_ACM_NO_OUTPUT) ? u : ac->dict[u];
+        } // if
+    } // while
+
+    free(queue);
+    free(fail);
+    return true;
+} // link_states
+
+str_acm_p str_acm_new(const char_t ** needles, const str_size_t * bytes, uint32_t n)
+{
+    str_acm_p ac = NULL;
+    uint32_t * next = NULL;
+    uint64_t max = 1;
+    uint32_t st = 0;
+    uint32_t i = 0;
+    str_size_t k = 0;
+
+    ac = calloc(1, sizeof(str_acm_t));
+    if (! ac) return NULL;
+
+    classify(ac, needles, bytes, n);
+    for (i = 0; i < n; ++i) max += bytes[i]; // 字典树状态数上限
+
+    ac->patterns = n;
+    ac->next = calloc(max * ac->classes, sizeof(ac->next[0]));
+    ac->out = malloc(sizeof(ac->out[0]) * max);
+    ac->depth = malloc(sizeof(ac->depth[0]) * max);
+    ac->lens = malloc(sizeof(ac->lens[0]) * (n ? n : 1));
+    if (! ac->next || ! ac->out || ! ac->depth || ! ac->lens) goto STR_ACM_NEW_ERROR;
+
+    // 建立字典树，0 表示没有边（字典树的边不会指向初始状态）
+    ac->states = 1;
+    ac->out[0] = STR_ACM_NO_OUTPUT;
+    ac->depth[0] = 0;
+    for (i = 0; i < n; ++i) {
+        for (st = 0, k = 0; k < bytes[i]; ++k) {
+            if (! ac->next[st * ac->classes + ac->cls[needles[i][k]]]) {
+                ac->out[ac->states] = STR_ACM_NO_OUTPUT;
+                ac->depth[ac->states] = k + 1;
+                ac->next[st * ac->classes + ac->cls[needles[i][k]]] = ac->states++;
+            } // if
+            st = ac->next[st * ac->classes + ac->cls[needles[i][k]]];
+        } // for
+        if (ac->out[st] == STR_ACM_NO_OUTPUT) ac->out[st] = i; // 重复的模式只保留编号最小者
+        ac->lens[i] = bytes[i];
+    } // for
+
+    // 释放多余的转移表空间
+    next = realloc(ac->next, sizeof(ac->next[0]) * ac->states * ac->classes);
+    if (next) ac->next = next;
+
+    ac->emit = calloc(ac->states, sizeof(ac->emit[0]));
+    ac->dict = calloc(ac->states, sizeof(ac->dict[0]));
+    if (! ac->emit || ! ac->dict || ! link_states(ac)) goto STR_ACM_NEW_ERROR;
+    return ac;
+
+STR_ACM_NEW_ERROR:
+    str_acm_delete(ac);
+    return NULL;
+} // str_acm_new
+
+void str_acm_delete(str_acm_p ac)
+{
+    if (! ac) return; // NULL 指针
+
+    free(ac->lens);
+    free(ac->depth);
+    free(ac->out);
+    free(ac->dict);
+    free(ac->emit);
+    free(ac->next);
+    free(ac);
+} // str_acm_delete
+
+const char_t * str_acm_scan(str_acm_p ac, const char_t * pos, const char_t * end, uint32_t * state)
+{
+    uint32_t st = *state;
+
+    while (pos < end) {
+        if (st == 0) {
+            // 初始状态下只有模式首字节能前进，其余字节成段跳过
+            if (ac->lead >= 0) {
+                pos = memchr(pos, ac->lead, end - pos);
+                if (! pos) break;
+            } else {
+                while (pos < end && ! ac->first[*pos]) ++pos;
+                if (pos == end) break;
+            } // if
+        } // if
+
+        st = ac->next[st * ac->classes + ac->cls[*pos++]];
+        if (ac->emit[st]) {
+            *state = st;
+            return pos;
+        } // if
+    } // while
+
+    *state = 0;
+    return NULL;
+} // str_acm_scan
+
+int32_t str_acm_longest(str_acm_p ac, const char_t * pos, const char_t * end)
+{
+    uint32_t st = 0;
+    uint32_t nx = 0;
+    uint32_t d = 0; // 当前深度
+    int32_t id = STR_ACM_NO_OUTPUT;
+
+    for (; pos < end; ++pos) {
+        // 失败转移的目标不比当前状态深，只有字典树的边使深度加 1
+        nx = ac->next[st * ac->classes + ac->cls[*pos]];
+        if (ac->depth[nx] != ++d) break;
+
+        st = nx;
+        if (ac->out[st] != STR_ACM_NO_OUTPUT) id = ac->out[st];
+    } // for
+    return id;
+} // str_acm_longest
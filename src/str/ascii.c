@@ -1,13 +1,18 @@
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "str/ascii.h"
 
-bool ascii_count_plain(const char_t * start, uint32_t * bytes, uint32_t * chars)
+bool ascii_count_plain(const char_t * start, str_size_t * bytes, str_size_t * chars)
 {
     const char_t * pos = NULL;
-    uint32_t i = 0;
-    uint32_t max = 0;
+    str_size_t i = 0;
+    str_size_t max = 0;
 
     assert(bytes != NULL);
     assert(chars != NULL);
@@ -20,31 +25,174 @@ bool ascii_count_plain(const char_t * start, uint32_t * bytes, uint32_t * chars)
     return i == max;
 } // ascii_count_plain
 
-bool ascii_count_unroll(const char_t * start, uint32_t * bytes, uint32_t * chars)
+bool ascii_count_unroll(const char_t * start, str_size_t * bytes, str_size_t * chars)
 {
     const char_t * pos = start;
     uint32_t ena = 1;
-    uint32_t i = 0;
-    uint32_t cnt = 0;
-    uint32_t max = 0;
+    str_size_t i = 0;
+    str_size_t cnt = 0;
+    str_size_t max = 0;
 
     assert(bytes != NULL);
     assert(chars != NULL);
 
     max = *bytes < *chars ? *bytes : *chars;
     pos = start;
-    i = max / 4;
-    switch (max % 4) {
-        do {
-                cnt += (ena &= ascii_measure(pos++));
-        case 3: cnt += (ena &= ascii_measure(pos++));
-        case 2: cnt += (ena &= ascii_measure(pos++));
-        case 1: cnt += (ena &= ascii_measure(pos++));
-        } while ((ena * i--) > 0);
-        default: break;
-    } // switch
+    i = (max + 3) / 4;
+    if (max > 0) {
+        switch (max % 4) {
+            case 0:
+            do {
+                    cnt += (ena &= ascii_measure(pos++));
+            case 3: cnt += (ena &= ascii_measure(pos++));
+            case 2: cnt += (ena &= ascii_measure(pos++));
+            case 1: cnt += (ena &= ascii_measure(pos++));
+            } while (ena && --i > 0);
+            default: break;
+        } // switch
+    } // if
 
     *bytes = cnt;
     *chars = cnt;
     return cnt == max;
 } // ascii_count_unroll
+
+bool ascii_validate(const char_t * start, str_size_t * bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + *bytes;
+    uint64_t word = 0;
+
+    for (; end - pos >= 8; pos += 8) {
+        memcpy(&word, pos, sizeof(word));
+        // 整块不含 NUL 字节且最高位均为 0
+        if (((word - 0x0101010101010101ULL) | word) & 0x8080808080808080ULL) break;
+    } // for
+    for (; pos < end && ascii_measure(pos) > 0; ++pos) ;
+
+    *bytes = pos - start;
+    return pos == end;
+} // ascii_validate
+
+str_size_t ascii_span(const char_t * start, str_size_t bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    uint64_t word = 0;
+
+    for (; end - pos >= 8; pos += 8) {
+        memcpy(&word, pos, sizeof(word));
+        if (word & 0x8080808080808080ULL) break; // 整块中存在最高位为 1 的字节
+    } // for
+    for (; pos < end && pos[0] < 0x80; ++pos) ;
+
+    return pos - start;
+} // ascii_span
+
+str_size_t ascii_span_below(const char_t * start, str_size_t bytes, char_t limit)
+{
+    str_size_t i = 0;
+    uint64_t word = 0;
+#ifdef __SSE2__
+    __m128i top = _mm_set1_epi8(limit - 1);
+    __m128i v;
+    uint32_t below = 0;
+
+    for (; bytes - i >= 16; i += 16) {
+        v = _mm_loadu_si128((const __m128i *)(start + i));
+        below = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, top), top)); // 不大于 limit - 1 的字节
+        if (below != 0xFFFF) return i + __builtin_ctz(~below);
+    } // for
+#endif
+
+    for (; bytes - i >= 8; i += 8) {
+        memcpy(&word, start + i, sizeof(word));
+        // 最高位为 1 的字节减去 0x80 后与 limit - 0x80 比较，无跨字节进位
+        if (word & ((word & 0x7F7F7F7F7F7F7F7FULL) + (0x100 - limit) * 0x0101010101010101ULL) & 0x8080808080808080ULL) break;
+    } // for
+    for (; i < bytes && start[i] < limit; ++i) ;
+    return i;
+} // ascii_span_below
+
+#ifdef __SSE2__
+// 标记 16 字节中属于 [lo, lo + 25] 的字节（全 1 ），有符号比较，不小于 0x80 的字节是负数，不在范围内
+inline static __m128i case_vector(__m128i v, char_t lo)
+{
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(lo - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(lo + 26), v));
+} // case_vector
+
+inline static __m128i fold_vector(__m128i v)
+{
+    return _mm_or_si128(v, _mm_and_si128(case_vector(v, 'A'), _mm_set1_epi8(0x20)));
+} // fold_vector
+#endif
+
+str_size_t ascii_fold_prefix(const char_t * p1, const char_t * p2, str_size_t bytes)
+{
+    str_size_t i = 0;
+    uint64_t w1 = 0;
+    uint64_t w2 = 0;
+#ifdef __SSE2__
+    __m128i v1;
+    __m128i v2;
+    uint32_t same = 0;
+
+    for (; bytes - i >= 16; i += 16) {
+        v1 = fold_vector(_mm_loadu_si128((const __m128i *)(p1 + i)));
+        v2 = fold_vector(_mm_loadu_si128((const __m128i *)(p2 + i)));
+        same = _mm_movemask_epi8(_mm_cmpeq_epi8(v1, v2));
+        if (same != 0xFFFF) return i + __builtin_ctz(~same);
+    } // for
+#endif
+
+    for (; bytes - i >= 8; i += 8) {
+        memcpy(&w1, p1 + i, sizeof(w1));
+        memcpy(&w2, p2 + i, sizeof(w2));
+        if (ascii_fold_word(w1) != ascii_fold_word(w2)) break; // 在块内逐字节找出不同之处
+    } // for
+    for (; i < bytes && ascii_fold(p1[i]) == ascii_fold(p2[i]); ++i) ;
+    return i;
+} // ascii_fold_prefix
+
+str_size_t ascii_case_span(const char_t * start, str_size_t bytes, char_t lo)
+{
+    str_size_t i = 0;
+    uint64_t word = 0;
+#ifdef __SSE2__
+    uint32_t hit = 0;
+
+    for (; bytes - i >= 16; i += 16) {
+        hit = _mm_movemask_epi8(case_vector(_mm_loadu_si128((const __m128i *)(start + i)), lo));
+        if (hit) return i + __builtin_ctz(hit);
+    } // for
+#endif
+
+    for (; bytes - i >= 8; i += 8) {
+        memcpy(&word, start + i, sizeof(word));
+        if (ascii_case_bits(word, lo)) break; // 在块内逐字节找出第一个字母
+    } // for
+    for (; i < bytes && (uint32_t)(start[i] - lo) >= 26; ++i) ;
+    return i;
+} // ascii_case_span
+
+void ascii_case_convert(char_t * dst, const char_t * src, str_size_t bytes, char_t lo)
+{
+    str_size_t i = 0;
+    uint64_t word = 0;
+#ifdef __SSE2__
+    __m128i v;
+
+    for (; bytes - i >= 16; i += 16) {
+        v = _mm_loadu_si128((const __m128i *)(src + i));
+        v = _mm_xor_si128(v, _mm_and_si128(case_vector(v, lo), _mm_set1_epi8(0x20)));
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    } // for
+#endif
+
+    for (; bytes - i >= 8; i += 8) {
+        memcpy(&word, src + i, sizeof(word));
+        word ^= ascii_case_bits(word, lo);
+        memcpy(dst + i, &word, sizeof(word));
+    } // for
+    for (; i < bytes; ++i) dst[i] = src[i] ^ (((uint32_t)(src[i] - lo) < 26) << 5);
+} // ascii_case_convert
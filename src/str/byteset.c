@@ -0,0 +1,142 @@
+#include <string.h>
+
+#ifdef __SSSE3__
+#include <tmmintrin.h>
+#endif
+
+#include "str/byteset.h"
+
+// 9~13 共用高半字节 0 ，归入 1 号桶；空格的高半字节为 2 ，归入 2 号桶
+const str_byteset_t str_byteset_space = {
+    .lo = {[0x0] = 0x02, [0x9] = 0x01, [0xA] = 0x01, [0xB] = 0x01, [0xC] = 0x01, [0xD] = 0x01},
+    .hi = {[0x0] = 0x01, [0x2] = 0x02},
+    .exact = 1,
+    .member = {['\t'] = 1, ['\n'] = 1, ['\v'] = 1, ['\f'] = 1, ['\r'] = 1, [' '] = 1},
+};
+
+void str_byteset_init(str_byteset_p set, const char_t * bytes, str_size_t n)
+{
+    uint16_t masks[16] = {0};   // 各高半字节对应的低半字节掩码
+    uint16_t buckets[8] = {0};  // 各桶的低半字节掩码
+    uint32_t used = 0;
+    uint32_t h = 0;
+    uint32_t l = 0;
+    uint32_t k = 0;
+    str_size_t i = 0;
+
+    memset(set, 0, sizeof(str_byteset_t));
+    for (i = 0; i < n; ++i) {
+        set->member[bytes[i]] = 1;
+        masks[bytes[i] >> 4] |= 1u << (bytes[i] & 0xF);
+    } // for
+
+    set->exact = 1;
+    for (h = 0; h < 16; ++h) {
+        if (! masks[h]) continue;
+
+        for (k = 0; k < used && buckets[k] != masks[h]; ++k) ;
+        if (k == used) {
+            if (used < 8) {
+                buckets[used++] = masks[h];
+            } else {
+                // 桶已用完，并入最后一个桶
+                k = 7;
+                buckets[k] |= masks[h];
+                set->exact = 0;
+            } // if
+        } // if
+        set->hi[h] |= 1u << k;
+    } // for
+
+    for (k = 0; k < used; ++k) {
+        for (l = 0; l < 16; ++l) {
+            if ((buckets[k] >> l) & 1) set->lo[l] |= 1u << k;
+        } // for
+    } // for
+} // str_byteset_init
+
+#ifdef __SSSE3__
+// 按半字节查表，返回 16 个字节中可能属于集合者的位掩码
+inline static uint32_t candidates(__m128i lo, __m128i hi, const char_t * pos)
+{
+    __m128i v = _mm_loadu_si128((const __m128i *)pos);
+    __m128i nib = _mm_set1_epi8(0x0F);
+    __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, nib));
+    __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(v, 4), nib));
+    return ~_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(l, h), _mm_setzero_si128())) & 0xFFFF;
+} // candidates
+
+// 返回 16 个字节中不属于集合者的位掩码
+inline static uint32_t misses(const str_byteset_t * set, __m128i lo, __m128i hi, const char_t * pos)
+{
+    uint32_t bits = candidates(lo, hi, pos);
+    uint32_t miss = ~bits & 0xFFFF;  // 不是候选的字节一定不属于集合
+    uint32_t k = 0;
+
+    if (! set->exact) {
+        for (k = bits; k; k &= k - 1) {
+            if (! set->member[pos[__builtin_ctz(k)]]) miss |= 1u << __builtin_ctz(k);
+        } // for
+    } // if
+    return miss;
+} // misses
+#endif
+
+const char_t * str_byteset_find(const str_byteset_t * set, const char_t * start, const char_t * end)
+{
+    const char_t * pos = start;
+#ifdef __SSSE3__
+    __m128i lo = _mm_loadu_si128((const __m128i *)set->lo);
+    __m128i hi = _mm_loadu_si128((const __m128i *)set->hi);
+    uint32_t bits = 0;
+
+    for (; end - pos >= 16; pos += 16) {
+        for (bits = candidates(lo, hi, pos); bits; bits &= bits - 1) {
+            if (set->exact || set->member[pos[__builtin_ctz(bits)]]) return pos + __builtin_ctz(bits);
+        } // for
+    } // for
+#endif
+
+    for (; pos < end; ++pos) {
+        if (set->member[*pos]) return pos;
+    } // for
+    return NULL;
+} // str_byteset_find
+
+const char_t * str_byteset_skip(const str_byteset_t * set, const char_t * start, const char_t * end)
+{
+    const char_t * pos = start;
+#ifdef __SSSE3__
+    __m128i lo = _mm_loadu_si128((const __m128i *)set->lo);
+    __m128i hi = _mm_loadu_si128((const __m128i *)set->hi);
+    uint32_t miss = 0;
+
+    for (; end - pos >= 16; pos += 16) {
+        miss = misses(set, lo, hi, pos);
+        if (miss) return pos + __builtin_ctz(miss);
+    } // for
+#endif
+
+    for (; pos < end; ++pos) {
+        if (! set->member[*pos]) return pos;
+    } // for
+    return NULL;
+} // str_byteset_skip
+
+const char_t * str_byteset_rskip(const str_byteset_t * set, const char_t * start, const char_t * end)
+{
+    const char_t * pos = end;
+#ifdef __SSSE3__
+    __m128i lo = _mm_loadu_si128((const __m128i *)set->lo);
+    __m128i hi = _mm_loadu_si128((const __m128i *)set->hi);
+    uint32_t miss = 0;
+
+    for (; pos - start >= 16; pos -= 16) {
+        miss = misses(set, lo, hi, pos - 16);
+        if (miss) return pos - 16 + (32 - __builtin_clz(miss));
+    } // for
+#endif
+
+    while (pos > start && set->member[pos[-1]]) --pos;
+    return pos;
+} // str_byteset_rskip
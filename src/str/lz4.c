@@ -0,0 +1,159 @@
+#include <string.h>
+
+#include "str/lz4.h"
+
+#define LZ4_MIN_MATCH 4         // 最短匹配字节数
+#define LZ4_LAST_LITERALS 5     // 结尾字面量字节数
+#define LZ4_MF_LIMIT 12         // 最后一个匹配距离结尾的最小字节数
+#define LZ4_MAX_OFFSET 65535    // 最大回溯距离
+#define LZ4_HASH_BITS 12
+
+inline static uint32_t read32(const char_t * pos)
+{
+    uint32_t val = 0;
+    memcpy(&val, pos, sizeof(val)); // 允许非对齐地址
+    return val;
+} // read32
+
+inline static uint32_t hash4(uint32_t val)
+{
+    return (val * 2654435761U) >> (32 - LZ4_HASH_BITS);
+} // hash4
+
+// 写入追加长度字节，缓冲区不足时返回 NULL
+static char_t * put_length(char_t * op, const char_t * oend, str_size_t len)
+{
+    for (; len >= 255; len -= 255) {
+        if (op >= oend) return NULL;
+        *op++ = 255;
+    } // for
+    if (op >= oend) return NULL;
+    *op++ = len;
+    return op;
+} // put_length
+
+// 写入一个序列，match 为 0 表示只有字面量的最后序列，缓冲区不足时返回 NULL
+static char_t * put_sequence(char_t * op, const char_t * oend, const char_t * lit, str_size_t lit_len, str_size_t match, str_size_t offset)
+{
+    char_t * token = op;
+
+    if (op >= oend) return NULL;
+    op += 1;
+
+    if (lit_len >= 15) {
+        *token = 15 << 4;
+        if (! (op = put_length(op, oend, lit_len - 15))) return NULL;
+    } else {
+        *token = lit_len << 4;
+    } // if
+
+    if ((str_size_t)(oend - op) < lit_len) return NULL;
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (match == 0) return op;
+
+    if (oend - op < 2) return NULL;
+    *op++ = offset & 0xFF;
+    *op++ = offset >> 8;
+
+    match -= LZ4_MIN_MATCH;
+    if (match >= 15) {
+        *token |= 15;
+        return put_length(op, oend, match - 15);
+    } // if
+    *token |= match;
+    return op;
+} // put_sequence
+
+str_size_t lz4_compress(const char_t * src, str_size_t bytes, char_t * dst, str_size_t cap)
+{
+    str_size_t table[1 << LZ4_HASH_BITS] = {0}; // 4 字节序列最近出现的位置
+    const char_t * ip = src;
+    const char_t * anchor = src; // 尚未输出的字面量起点
+    const char_t * iend = src + bytes;
+    const char_t * ref = NULL;
+    char_t * op = dst;
+    const char_t * oend = dst + cap;
+    str_size_t len = 0;
+    uint32_t h = 0;
+
+    if (bytes > LZ4_MF_LIMIT) {
+        while (ip < iend - LZ4_MF_LIMIT) {
+            h = hash4(read32(ip));
+            ref = src + table[h];
+            table[h] = ip - src;
+
+            if (ref >= ip || ip - ref > LZ4_MAX_OFFSET || read32(ref) != read32(ip)) {
+                ip += 1;
+                continue;
+            } // if
+
+            // 向后扩展匹配，保留结尾字面量
+            for (len = LZ4_MIN_MATCH; ip + len < iend - LZ4_LAST_LITERALS && ref[len] == ip[len]; ++len) ;
+
+            op = put_sequence(op, oend, anchor, ip - anchor, len, ip - ref);
+            if (! op) return 0;
+
+            ip += len;
+            anchor = ip;
+        } // while
+    } // if
+
+    op = put_sequence(op, oend, anchor, iend - anchor, 0, 0);
+    return op ? op - dst : 0;
+} // lz4_compress
+
+// 读取追加长度字节，数据不足时返回 false
+inline static bool get_length(const char_t ** ip, const char_t * iend, str_size_t * len)
+{
+    char_t b = 0;
+
+    do {
+        if (*ip >= iend) return false;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return true;
+} // get_length
+
+bool lz4_decompress(const char_t * src, str_size_t bytes, char_t * dst, str_size_t * cap)
+{
+    const char_t * ip = src;
+    const char_t * iend = src + bytes;
+    char_t * op = dst;
+    const char_t * oend = dst + *cap;
+    const char_t * match = NULL;
+    str_size_t len = 0;
+    str_size_t offset = 0;
+    char_t token = 0;
+
+    while (ip < iend) {
+        token = *ip++;
+
+        // 字面量
+        len = token >> 4;
+        if (len == 15 && ! get_length(&ip, iend, &len)) return false;
+        if ((str_size_t)(iend - ip) < len || (str_size_t)(oend - op) < len) return false;
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+        if (ip == iend) break; // 最后序列没有匹配
+
+        // 匹配
+        if (iend - ip < 2) return false;
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (str_size_t)(op - dst)) return false;
+
+        len = token & 0xF;
+        if (len == 15 && ! get_length(&ip, iend, &len)) return false;
+        len += LZ4_MIN_MATCH;
+        if ((str_size_t)(oend - op) < len) return false;
+
+        // 匹配可能与输出重叠，逐字节复制
+        for (match = op - offset; len > 0; --len) *op++ = *match++;
+    } // while
+
+    *cap = op - dst;
+    return true;
+} // lz4_decompress
@@ -1 +1,38 @@
+#include <string.h>
+
 #include "str/misc.h"
+
+#define HASH_PRIME1 0x9E3779B97F4A7C15ULL
+#define HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+
+inline static uint64_t hash_mix(uint64_t h, uint64_t v)
+{
+    h ^= v * HASH_PRIME2;
+    h = (h << 31) | (h >> 33);
+    return h * HASH_PRIME1;
+} // hash_mix
+
+uint64_t str_hash(const char_t * start, str_size_t bytes)
+{
+    uint64_t h = HASH_PRIME1 ^ bytes;
+    uint64_t v = 0;
+    str_size_t i = 0;
+
+    // 每次混入 8 个字节，不要求地址对齐
+    for (i = 0; i + 8 <= bytes; i += 8) {
+        memcpy(&v, start + i, 8);
+        h = hash_mix(h, v);
+    } // for
+
+    if (i < bytes) {
+        v = 0;
+        memcpy(&v, start + i, bytes - i);
+        h = hash_mix(h, v);
+    } // if
+
+    // 最终扰动，使低位也受全部输入影响
+    h ^= h >> 33;
+    h *= HASH_PRIME2;
+    h ^= h >> 29;
+    return h;
+} // str_hash
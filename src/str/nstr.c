@@ -1,42 +1,131 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "str/ascii.h"
 #include "str/utf8.h"
+#include "str/misc.h"
+#include "str/lz4.h"
+#include "str/search.h"
+#include "str/acm.h"
+#include "str/regex.h"
+#include "str/byteset.h"
+#include "str/ucd.h"
 #include "str/nstr.h"
 
 #define container_of(type, member, addr) ((type *)((void *)(addr) - (void *)(&(((type *)0)->member))))
 
+#define CHARS_UNKNOWN NSTR_CHARS_UNKNOWN    // 字符数未知，首次需要时计算
+
 typedef uint32_t (*measure_t)(const char_t * pos);
-typedef bool (*count_t)(const char_t * start, uint32_t * bytes, uint32_t * chars);
+typedef bool (*count_t)(const char_t * start, str_size_t * bytes, str_size_t * chars);
+typedef bool (*validate_t)(const char_t * start, str_size_t * bytes);
+typedef str_size_t (*tally_t)(const char_t * start, str_size_t bytes);
+typedef str_size_t (*rseek_t)(const char_t * start, str_size_t bytes, str_size_t * chars);
 
 typedef struct VTABLE {
     measure_t   measure;        // 度量单个字符的字节数
-    count_t     count;          // 计算字节范围包含的字符数
+    count_t     count;          // 计算字节范围包含的字符数（限定字符数上限，同时校验）
+    validate_t  validate;       // 校验字节范围，不计算字符数
+    tally_t     tally;          // 计算字节范围包含的字符数，不校验
+    rseek_t     rseek;          // 从结尾向前计算至多若干个字符占用的字节数，不校验
 } vtable_t, *vtable_p;
 
+enum {
+    ENT_KIND_HEAP = 0,              // 字符存储于 data 区
+    ENT_KIND_MMAP = 1,              // 字符存储于文件映射区
+    ENT_KIND_EXTERN = 2,            // 字符存储于调用方提供的缓冲区
+    ENT_KIND_ANON = 3,              // 字符存储于匿名映射区，长期未访问时可压缩
+};
+
+typedef struct CKPT_INDEX {
+    uint32_t        step;           // 检查点间隔字符数
+    str_size_t      cnt;            // 检查点个数
+    str_size_t      offs[1];        // 第 k 个检查点是第 k * step 个字符的字节偏移量
+} ckpt_index_t, *ckpt_index_p;
+
 typedef struct ENTITY {
-    uint32_t        bytes;          // 串内容占用字节数
+    str_size_t      bytes;          // 串内容占用字节数
 
     uint32_t        need_free:1;    // 是否释放内存
-    uint32_t        unused:31;
+    uint32_t        kind:3;         // 实体类型
+    uint32_t        tracked:1;      // 是否已登记，用于查询浪费情况
+    uint32_t        verified:1;     // 全部内容是否已按 encoding 校验
+    uint32_t        encoding:6;     // 已校验的编码方案
+    uint32_t        ascii:1;        // 全部字节是否都小于 0x80
+    uint32_t        deduped:1;      // 是否已加入去重存储
+    uint32_t        unused:18;
 
     uint32_t        slcs;           // （仅用于字符串）切片计数，减到 0 则销毁字符串并释放内存
+    str_size_t      refd;           // 全部切片引用的字节数之和，重叠部分重复计算
+    ckpt_index_p    index;          // 字符下标索引，首次按下标定位时建立
+    struct COLL_KEY * keys;         // 排序键缓存，首次按排序规则比较时建立
     char_t          data[1];        // 字符存储区，包含结尾的 NUL 字符
 } entity_t, *entity_p;
 
-typedef struct NSTR {
-    uint32_t        bytes;          // 串内容占用字节数
-    uint32_t        chars;          // 编码后的字符个数
-
-    uint32_t        need_free:1;    // 是否释放内存
-    uint32_t        unused:25;
-    uint32_t        encoding:6;     // 编码方案，支持最多 64 种
-
-    entity_p        ent;            // 数据实体指针
-
+typedef struct COLL_KEY {
+    struct COLL_KEY * next;         // 较早生成的排序键
+    const char_t *  start;          // 切片起始地址
+    str_size_t      bytes;          // 切片字节数
+    str_locale_t    locale;         // 排序规则
+    str_size_t      len;            // 排序键字节数
+    char_t          data[1];        // 排序键
+} coll_key_t, *coll_key_p;
+
+typedef struct MMAP_ENTITY {
+    void *          addr;           // 映射区起始地址（页对齐）
+    size_t          len;            // 映射区长度
     const char_t *  start;          // 字符数据起始地址
-} nstr_t;
+    entity_t        ent;            // 实体头部，data 区不使用
+} mmap_entity_t, *mmap_entity_p;
+
+typedef struct EXTERN_ENTITY {
+    str_release_t   release;        // 释放回调函数
+    void *          ctx;            // 回调上下文
+    const char_t *  buf;            // 外部缓冲区起始地址
+    entity_t        ent;            // 实体头部，data 区不使用
+} extern_entity_t, *extern_entity_p;
+
+typedef struct ANON_ENTITY {
+    struct ANON_ENTITY * prev;      // 冷存储候选链表
+    struct ANON_ENTITY * next;
+    char_t *        buf;            // 映射区起始地址，即字符数据起始地址，压缩后地址不变
+    size_t          len;            // 映射区长度（页对齐），包含结尾的 NUL 字符
+    char_t *        packed;         // 压缩数据，NULL 表示未压缩
+    str_size_t      packed_bytes;   // 压缩数据字节数
+    uint32_t        epoch;          // 最近访问时的清扫轮次
+    bool            pinned;         // 字符数据地址已借出（指针或视图），不再压缩
+    entity_t        ent;            // 实体头部，data 区不使用
+} anon_entity_t, *anon_entity_p;
+
+typedef struct NSTR_SEARCHER {
+    nstr_p          pattern;        // 模式串切片，持有实体引用，保证查找器引用的字节范围存活
+    str_searcher_t  sr;             // 预编译的查找器
+} nstr_searcher_t;
+
+typedef struct NSTR_KEYWORDS {
+    str_acm_p       acm;            // 多模式匹配自动机
+    str_size_t      chars[1];       // 各模式串的字符数，用于由匹配结尾推算字符下标
+} nstr_keywords_t;
+
+typedef struct NSTR_REPLACER {
+    str_acm_p       acm;            // from 串的自动机，用于求最长匹配
+    str_byteset_t   firsts;         // from 串的首字节集合
+    int             n;              // 替换对数量
+    nstr_p          to[1];          // 各 to 串的切片，持有实体引用
+} nstr_replacer_t;
+
+typedef struct NSTR_REGEX {
+    str_regex_p     re;             // 编译后的正则表达式
+    const char_t ** caps;           // 各分组的起止地址
+} nstr_regex_t;
+
+#define INDEX_DEFAULT_STEP 256
+#define COLL_KEY_MAX 4  // 每个实体缓存的排序键个数上限
 
 // ---- 静态变量 ---- //
 
@@ -44,86 +133,641 @@ vtable_t vtable[STR_ENC_COUNT] = {
     {
         &ascii_measure,
         &ascii_count,
+        &ascii_validate,
+        &ascii_chars,
+        &ascii_rseek,
     },
     {
         &utf8_measure,
         &utf8_count,
+        &utf8_validate,
+        &utf8_chars,
+        &utf8_rseek,
     },
 };
 
 entity_t ref_ent = {0};
-entity_t blank_ent = {0};
+entity_t blank_ent = {.ascii = true};
+entity_t nstr_literal_entity = {0};
+entity_t nstr_fixed_entity = {0};
+
+// 共享的空串常量，用作删除操作的替换内容
+static nstr_t blank_str = {.start = blank_ent.data, .ent = &blank_ent, .ascii = true, .encoding = STR_ENC_ASCII};
+
+// 实体登记表，仅在开启跟踪后使用（开放定址，NULL 表示空位，&ref_ent 表示已删除）
+static struct {
+    entity_p *  slots;
+    uint32_t    cap;
+    uint32_t    used;               // 已占用位置数，包含已删除位置
+    bool        enabled;
+} tracker = {0};
+
+typedef struct DEDUP_SLOT {
+    uint64_t        hash;           // 内容散列值
+    entity_p        ent;            // NULL 表示空位，&ref_ent 表示已删除
+} dedup_slot_t, *dedup_slot_p;
+
+// 去重存储，max_bytes 为 0 表示关闭（开放定址）
+static struct {
+    dedup_slot_p        slots;
+    uint32_t            cap;
+    uint32_t            used;       // 已占用位置数，包含已删除位置
+    str_size_t          max_bytes;  // 参与去重的实体字节数上限
+    str_dedup_stats_t   stats;
+} dedup = {0};
+
+// 自动压缩策略，min_held 为 0 表示关闭
+static struct {
+    str_size_t  min_held;           // 实体持有字节数下限
+    uint32_t    max_waste;          // 浪费比例上限（百分比）
+} compact_policy = {0};
+
+// 字符下标索引策略，min_bytes 为 0 表示关闭
+static struct {
+    str_size_t  min_bytes;          // 实体字节数下限
+    uint32_t    step;               // 检查点间隔字符数
+} index_policy = {1024 * 1024, INDEX_DEFAULT_STEP};
+
+// 裁剪排序规则，下标为 locale - STR_LOC_USER
+static struct {
+    ucd_tailor_p *  tailors;
+    int             cnt;
+    int             cap;
+} locales = {0};
+
+// 冷存储策略，min_bytes 为 0 表示关闭
+static struct {
+    anon_entity_p   head;           // 全部匿名映射实体
+    str_size_t      min_bytes;      // 新实体使用匿名映射区的字节数下限
+    uint32_t        idle;           // 压缩前未访问的清扫轮次下限
+    uint32_t        epoch;          // 当前清扫轮次
+} cold_policy = {0};
 
 inline static entity_p get_entity(nstr_p s)
 {
     return s->ent;
 } // get_entity
 
-inline static void add_ref(entity_p ent)
+inline static uint32_t hash_pointer(const void * ptr, uint32_t cap)
+{
+    return ((uint64_t)ptr >> 4) * 0x9E3779B1U & (cap - 1);
+} // hash_pointer
+
+static bool track_entity(entity_p ent)
+{
+    entity_p * slots = NULL;
+    uint32_t cap = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    if ((tracker.used + 1) * 4 >= tracker.cap * 3) {
+        // 重建登记表，同时清除已删除位置
+        cap = tracker.cap ? tracker.cap * 2 : 64;
+        slots = calloc(cap, sizeof(slots[0]));
+        if (! slots) return false;
+
+        tracker.used = 0;
+        for (i = 0; i < tracker.cap; ++i) {
+            if (! tracker.slots[i] || tracker.slots[i] == &ref_ent) continue;
+            for (j = hash_pointer(tracker.slots[i], cap); slots[j]; j = (j + 1) & (cap - 1)) ;
+            slots[j] = tracker.slots[i];
+            tracker.used += 1;
+        } // for
+
+        free(tracker.slots);
+        tracker.slots = slots;
+        tracker.cap = cap;
+    } // if
+
+    for (j = hash_pointer(ent, tracker.cap); tracker.slots[j]; j = (j + 1) & (tracker.cap - 1)) ;
+    tracker.slots[j] = ent;
+    tracker.used += 1;
+    return true;
+} // track_entity
+
+static void untrack_entity(entity_p ent)
+{
+    uint32_t j = 0;
+
+    for (j = hash_pointer(ent, tracker.cap); tracker.slots[j]; j = (j + 1) & (tracker.cap - 1)) {
+        if (tracker.slots[j] == ent) {
+            tracker.slots[j] = &ref_ent;
+            return;
+        } // if
+    } // for
+} // untrack_entity
+
+// 查找内容相同的实体，散列值相同时逐字节比较
+static entity_p find_duplicate(const char_t * start, str_size_t bytes, uint64_t hash)
+{
+    uint32_t j = 0;
+
+    dedup.stats.lookups += 1;
+    if (dedup.cap == 0) return NULL;
+
+    for (j = hash & (dedup.cap - 1); dedup.slots[j].ent; j = (j + 1) & (dedup.cap - 1)) {
+        if (dedup.slots[j].ent == &ref_ent || dedup.slots[j].hash != hash) continue;
+        if (dedup.slots[j].ent->bytes == bytes && memcmp(dedup.slots[j].ent->data, start, bytes) == 0) {
+            dedup.stats.hits += 1;
+            dedup.stats.saved += bytes;
+            return dedup.slots[j].ent;
+        } // if
+        dedup.stats.collisions += 1;
+    } // for
+    return NULL;
+} // find_duplicate
+
+static void add_duplicate(entity_p ent, uint64_t hash)
+{
+    dedup_slot_p slots = NULL;
+    uint32_t cap = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    if ((dedup.used + 1) * 4 >= dedup.cap * 3) {
+        // 重建存储，同时清除已删除位置
+        cap = dedup.cap ? dedup.cap * 2 : 64;
+        slots = calloc(cap, sizeof(slots[0]));
+        if (! slots) return; // 无法去重不影响正确性
+
+        dedup.used = 0;
+        for (i = 0; i < dedup.cap; ++i) {
+            if (! dedup.slots[i].ent || dedup.slots[i].ent == &ref_ent) continue;
+            for (j = dedup.slots[i].hash & (cap - 1); slots[j].ent; j = (j + 1) & (cap - 1)) ;
+            slots[j] = dedup.slots[i];
+            dedup.used += 1;
+        } // for
+
+        free(dedup.slots);
+        dedup.slots = slots;
+        dedup.cap = cap;
+    } // if
+
+    for (j = hash & (dedup.cap - 1); dedup.slots[j].ent; j = (j + 1) & (dedup.cap - 1)) ;
+    dedup.slots[j].hash = hash;
+    dedup.slots[j].ent = ent;
+    dedup.used += 1;
+    dedup.stats.entries += 1;
+    ent->deduped = true;
+} // add_duplicate
+
+static void remove_duplicate(entity_p ent)
+{
+    uint64_t hash = str_hash(ent->data, ent->bytes);
+    uint32_t j = 0;
+
+    for (j = hash & (dedup.cap - 1); dedup.slots[j].ent; j = (j + 1) & (dedup.cap - 1)) {
+        if (dedup.slots[j].ent == ent) {
+            dedup.slots[j].ent = &ref_ent;
+            dedup.stats.entries -= 1;
+            return;
+        } // if
+    } // for
+} // remove_duplicate
+
+inline static entity_p init_entity(entity_p ent, uint32_t kind, str_size_t bytes)
+{
+    ent->bytes = bytes;
+    ent->need_free = true;
+    ent->kind = kind;
+    ent->tracked = tracker.enabled && track_entity(ent);
+    ent->verified = false;
+    ent->encoding = STR_ENC_ASCII;
+    ent->ascii = false;
+    ent->deduped = false;
+    ent->slcs = 0;
+    ent->refd = 0;
+    ent->index = NULL;
+    ent->keys = NULL;
+    return ent;
+} // init_entity
+
+inline static void add_ref(nstr_p s)
 {
-    ent->slcs += 1;
+    s->ent->slcs += 1;
+    s->ent->refd += s->bytes;
 } // add_ref
 
-inline static void del_ref(entity_p ent)
+static void free_entity(entity_p ent)
+{
+    mmap_entity_p mm = NULL;
+    extern_entity_p ex = NULL;
+    anon_entity_p an = NULL;
+    coll_key_p key = NULL;
+    coll_key_p next = NULL;
+
+    if (ent->tracked) untrack_entity(ent);
+    if (ent->deduped) remove_duplicate(ent);
+    free(ent->index);
+    for (key = ent->keys; key; key = next) {
+        next = key->next;
+        free(key);
+    } // for
+
+    switch (ent->kind) {
+        case ENT_KIND_MMAP:
+            mm = container_of(mmap_entity_t, ent, ent);
+            munmap(mm->addr, mm->len);
+            free(mm);
+            break;
+
+        case ENT_KIND_EXTERN:
+            ex = container_of(extern_entity_t, ent, ent);
+            if (ex->release) ex->release(ex->ctx, ex->buf, ex->ent.bytes);
+            free(ex);
+            break;
+
+        case ENT_KIND_ANON:
+            an = container_of(anon_entity_t, ent, ent);
+            if (an->prev) {
+                an->prev->next = an->next;
+            } else {
+                cold_policy.head = an->next;
+            } // if
+            if (an->next) an->next->prev = an->prev;
+
+            munmap(an->buf, an->len);
+            free(an->packed);
+            free(an);
+            break;
+
+        default:
+            free(ent);
+            break;
+    } // switch
+} // free_entity
+
+inline static void del_ref(nstr_p s)
 {
-    if (--ent->slcs == 0 && ent->need_free) free(ent);
+    entity_p ent = s->ent;
+
+    ent->refd -= s->bytes;
+    if (--ent->slcs == 0 && ent->need_free) free_entity(ent);
 } // del_ref
 
-static entity_p new_entity(uint32_t bytes)
+// 调整切片长度，同步实体的引用字节数
+inline static void set_bytes(nstr_p s, str_size_t bytes)
 {
-    entity_p new = malloc(sizeof(entity_t) + bytes);
-    if (new) {
-        new->need_free = true;
-        new->bytes = bytes;
-        new->slcs = 0;
+    s->ent->refd += bytes - s->bytes;
+    s->bytes = bytes;
+} // set_bytes
+
+static entity_p new_anon_entity(str_size_t bytes)
+{
+    anon_entity_p an = NULL;
+
+    an = malloc(sizeof(anon_entity_t));
+    if (! an) return NULL;
+
+    an->len = str_round_up((uint64_t)bytes + 1, sysconf(_SC_PAGESIZE));
+    an->buf = mmap(NULL, an->len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (an->buf == MAP_FAILED) {
+        free(an);
+        return NULL;
     } // if
+
+    an->packed = NULL;
+    an->packed_bytes = 0;
+    an->epoch = cold_policy.epoch;
+    an->pinned = false;
+
+    // 加入冷存储候选链表
+    an->prev = NULL;
+    an->next = cold_policy.head;
+    if (an->next) an->next->prev = an;
+    cold_policy.head = an;
+
+    return init_entity(&an->ent, ENT_KIND_ANON, bytes);
+} // new_anon_entity
+
+static entity_p new_entity(str_size_t bytes)
+{
+    entity_p new = NULL;
+
+    // 大实体使用独立的匿名映射区，压缩后可归还物理内存，同时保持切片地址不变
+    if (cold_policy.min_bytes > 0 && bytes >= cold_policy.min_bytes) return new_anon_entity(bytes);
+
+    new = malloc(sizeof(entity_t) + bytes);
+    if (new) init_entity(new, ENT_KIND_HEAP, bytes);
     return new;
 } // new_entity
 
-inline static nstr_p init_slice(nstr_p s, bool need_free, const char_t * start, entity_p ent, uint32_t bytes, uint32_t chars, str_encoding_t encoding)
+// 新实体的可写字符存储区
+inline static char_t * entity_data(entity_p ent)
+{
+    if (ent->kind == ENT_KIND_ANON) return container_of(anon_entity_t, ent, ent)->buf;
+    return ent->data;
+} // entity_data
+
+// 将字节范围复制到新实体，开启去重时优先返回内容相同的已有实体
+static entity_p copy_to_entity(const char_t * src, str_size_t bytes)
+{
+    entity_p ent = NULL;
+    uint64_t hash = 0;
+    bool shared = (dedup.max_bytes > 0 && bytes <= dedup.max_bytes);
+
+    if (shared) {
+        hash = str_hash(src, bytes);
+        if ((ent = find_duplicate(src, bytes, hash))) return ent;
+    } // if
+
+    ent = new_entity(bytes);
+    if (! ent) return NULL;
+
+    memcpy(entity_data(ent), src, bytes);
+    entity_data(ent)[bytes] = 0;
+
+    if (shared && ent->kind == ENT_KIND_HEAP) add_duplicate(ent, hash);
+    return ent;
+} // copy_to_entity
+
+// 对已生成内容的新实体去重，命中时释放新实体并返回已有实体
+static entity_p share_entity(entity_p ent)
+{
+    entity_p dup = NULL;
+    uint64_t hash = 0;
+
+    if (dedup.max_bytes == 0 || ent->bytes > dedup.max_bytes || ent->kind != ENT_KIND_HEAP || ! ent->need_free) return ent;
+
+    hash = str_hash(ent->data, ent->bytes);
+    if ((dup = find_duplicate(ent->data, ent->bytes, hash))) {
+        free_entity(ent);
+        return dup;
+    } // if
+
+    add_duplicate(ent, hash);
+    return ent;
+} // share_entity
+
+// 标记实体内容已按给定编码校验（内容复制自已校验的切片）
+inline static entity_p mark_verified(entity_p ent, str_encoding_t encoding)
+{
+    ent->verified = true;
+    ent->encoding = encoding;
+    return ent;
+} // mark_verified
+
+inline static const char_t * entity_start(entity_p ent)
+{
+    switch (ent->kind) {
+        case ENT_KIND_MMAP: return container_of(mmap_entity_t, ent, ent)->start;
+        case ENT_KIND_EXTERN: return container_of(extern_entity_t, ent, ent)->buf;
+        case ENT_KIND_ANON: return container_of(anon_entity_t, ent, ent)->buf;
+        default: break;
+    } // switch
+    return ent->data;
+} // entity_start
+
+// 切片是否落在字符边界上（首字节及切片后的字节都不是跟随字节）
+inline static bool on_char_boundary(nstr_p s)
+{
+    const char_t * end = s->start + s->bytes;
+
+    if (s->encoding != STR_ENC_UTF8 || s->bytes == 0) return true;
+    if ((s->start[0] & 0xC0) == 0x80) return false;
+    return end == entity_start(get_entity(s)) + get_entity(s)->bytes || (end[0] & 0xC0) != 0x80;
+} // on_char_boundary
+
+// 切片内容是否已按给定编码校验（所在实体已整体校验且切片落在字符边界上），空串总是有效
+inline static bool verified_as(nstr_p s, str_encoding_t encoding)
+{
+    entity_p ent = get_entity(s);
+
+    if (s->bytes == 0) return true;
+    return ent->verified && ent->encoding == encoding && s->encoding == encoding && on_char_boundary(s);
+} // verified_as
+
+static void thaw(anon_entity_p an)
+{
+    str_size_t bytes = an->ent.bytes;
+    bool ok = false;
+
+    // 压缩数据在冻结时已试解压校验，映射区始终可写，原地解压不会失败
+    ok = lz4_decompress(an->packed, an->packed_bytes, an->buf, &bytes);
+    assert(ok && bytes == an->ent.bytes);
+    (void)ok;
+
+    free(an->packed);
+    an->packed = NULL;
+    an->packed_bytes = 0;
+} // thaw
+
+// 访问字符数据前调用：记录访问轮次，必要时解压冷存储的内容
+inline static nstr_p touch(nstr_p s)
+{
+    anon_entity_p an = NULL;
+
+    if (s->ent->kind != ENT_KIND_ANON) return s;
+
+    an = container_of(anon_entity_t, ent, s->ent);
+    an->epoch = cold_policy.epoch;
+    if (an->packed) thaw(an);
+    return s;
+} // touch
+
+// 借出字符数据地址前调用：冷存储实体从此不再压缩，保证借出的指针和视图始终可读
+inline static nstr_p pin(nstr_p s)
+{
+    if (s->ent->kind == ENT_KIND_ANON) container_of(anon_entity_t, ent, s->ent)->pinned = true;
+    return touch(s);
+} // pin
+
+// 压缩实体内容，归还映射区的物理内存，返回归还的字节数
+static uint64_t freeze(anon_entity_p an)
+{
+    str_size_t bytes = an->ent.bytes;
+    str_size_t cap = lz4_bound(bytes);
+    str_size_t packed_bytes = 0;
+    str_size_t check_bytes = bytes;
+    char_t * packed = NULL;
+    char_t * check = NULL;
+    uint64_t released = 0;
+
+    packed = malloc(cap);
+    if (! packed) return 0;
+
+    packed_bytes = lz4_compress(an->buf, bytes, packed, cap);
+    if (packed_bytes == 0 || packed_bytes > bytes - bytes / 8) goto FREEZE_END; // 压缩率过低，不值得
+
+    // 先试解压一次，确认解冻时一定能还原内容，否则保持未压缩状态
+    check = malloc(bytes);
+    if (! check) goto FREEZE_END;
+    if (! lz4_decompress(packed, packed_bytes, check, &check_bytes) || check_bytes != bytes || memcmp(check, an->buf, bytes) != 0) goto FREEZE_END;
+
+    an->packed = packed;
+    if ((packed = realloc(packed, packed_bytes))) an->packed = packed; // 收缩失败时保留原缓冲区
+    an->packed_bytes = packed_bytes;
+    packed = NULL;
+
+    // 映射区保持可读写，解冻时无需再调整访问权限
+    madvise(an->buf, an->len, MADV_DONTNEED);
+    released = an->len - packed_bytes;
+
+FREEZE_END:
+    free(check);
+    free(packed);
+    return released;
+} // freeze
+
+inline static str_size_t get_chars(nstr_p s)
+{
+    if (s->chars != CHARS_UNKNOWN) return s->chars;
+
+    s->chars = s->ascii ? s->bytes : vtable[s->encoding].tally(touch(s)->start, s->bytes);
+    if (s->encoding == STR_ENC_UTF8 && s->chars == s->bytes) s->ascii = true; // 顺便识别纯 ASCII 内容
+    return s->chars;
+} // get_chars
+
+// 从给定位置开始，计算至多 *chars 个字符占用的字节数，纯 ASCII 切片直接换算
+inline static void seek_chars(nstr_p s, const char_t * start, str_size_t * bytes, str_size_t * chars)
+{
+    if (! s->ascii) {
+        vtable[s->encoding].count(start, bytes, chars);
+        return;
+    } // if
+
+    if (*chars < *bytes) {
+        *bytes = *chars;
+    } else {
+        *chars = *bytes;
+    } // if
+} // seek_chars
+
+// 从给定位置向前，计算至多 *chars 个字符占用的字节数，纯 ASCII 切片直接换算
+inline static str_size_t rseek_chars(nstr_p s, const char_t * end, str_size_t * chars)
+{
+    if (! s->ascii) return vtable[s->encoding].rseek(s->start, end - s->start, chars);
+    return ascii_rseek(s->start, end - s->start, chars);
+} // rseek_chars
+
+// 拼接结果的字符数，任一部分未知则结果未知
+inline static str_size_t sum_chars(str_size_t c1, str_size_t c2)
+{
+    return (c1 == CHARS_UNKNOWN || c2 == CHARS_UNKNOWN) ? CHARS_UNKNOWN : c1 + c2;
+} // sum_chars
+
+// 未知字符数的新切片，ASCII 编码的字符数等于字节数
+inline static str_size_t lazy_chars(str_size_t bytes, str_encoding_t encoding)
+{
+    return (encoding == STR_ENC_ASCII) ? bytes : CHARS_UNKNOWN;
+} // lazy_chars
+
+inline static nstr_p init_slice(nstr_p s, bool need_free, const char_t * start, entity_p ent, str_size_t bytes, str_size_t chars, str_encoding_t encoding)
 {
     s->need_free = need_free;
+    s->fixed = false;
+    s->ascii = ent->ascii;
     s->encoding = encoding;
     s->bytes = bytes;
     s->chars = chars;
     s->ent = ent;
     s->start = start;
 
-    add_ref(get_entity(s));
+    add_ref(s);
     return s;
 } // init_slice
 
-static nstr_p new_slice(const char_t * start, entity_p ent, uint32_t bytes, uint32_t chars, str_encoding_t encoding)
+static nstr_p new_slice(const char_t * start, entity_p ent, str_size_t bytes, str_size_t chars, str_encoding_t encoding)
 {
     nstr_p new = malloc(sizeof(nstr_t));
     if (new) init_slice(new, true, start, ent, bytes, chars, encoding);
     return new;
 } // new_slice
 
-inline static nstr_p refer_to_other(nstr_p r, const char_t * start, entity_p ent, uint32_t bytes, uint32_t chars, str_encoding_t encoding)
+// 定长串的缓冲区，紧随 nstr_fixed_t 头部
+inline static char_t * fixed_buffer(nstr_p s)
+{
+    return (char_t *)((nstr_fixed_p)s + 1);
+} // fixed_buffer
+
+inline static str_size_t fixed_capacity(nstr_p s)
+{
+    return ((nstr_fixed_p)s)->cap;
+} // fixed_capacity
+
+// 结果已写入定长串缓冲区，设置终止 NUL 字符和头部
+inline static nstr_p settle_fixed(nstr_p r, str_size_t bytes, str_size_t chars, str_encoding_t encoding, bool ascii)
 {
-    del_ref(get_entity(r));
+    fixed_buffer(r)[bytes] = 0;
+    r->start = fixed_buffer(r);
+    r->bytes = bytes;
+    r->chars = chars;
+    r->ascii = ascii;
+    r->encoding = encoding;
+    return r;
+} // settle_fixed
+
+// 将字节范围复制到定长串，可与缓冲区重叠，超出容量时返回 NULL
+static nstr_p copy_to_fixed(nstr_p r, const char_t * start, str_size_t bytes, str_size_t chars, str_encoding_t encoding, bool ascii)
+{
+    if (bytes > fixed_capacity(r)) return NULL;
+    memmove(fixed_buffer(r), start, bytes);
+    return settle_fixed(r, bytes, chars, encoding, ascii);
+} // copy_to_fixed
+
+// 源串是否位于定长串缓冲区内，是则不能边读边写
+inline static bool fixed_overlaps(nstr_p r, nstr_p s)
+{
+    return s->start <= fixed_buffer(r) + fixed_capacity(r) && fixed_buffer(r) < s->start + s->bytes;
+} // fixed_overlaps
+
+inline static nstr_p refer_to_other(nstr_p r, const char_t * start, entity_p ent, str_size_t bytes, str_size_t chars, str_encoding_t encoding)
+{
+    nstr_t old = *r; // 先增加新引用，避免新旧实体相同时被提前释放
+
+    if (r->fixed) return copy_to_fixed(r, start, bytes, chars, encoding, ent->ascii); // 定长串只复制内容，不引用实体
+
     r->bytes = bytes;
     r->chars = chars;
     r->ent = ent;
     r->start = start;
+    r->ascii = ent->ascii;
     r->encoding = encoding;
-    add_ref(get_entity(r));
+    add_ref(r);
+    del_ref(&old);
     return r;
 } // refer_to_other
 
-inline static nstr_p refer_to_or_new_slice(nstr_p r, const char_t * start, entity_p ent, uint32_t bytes, uint32_t chars, str_encoding_t encoding)
+inline static nstr_p refer_to_or_new_slice(nstr_p r, const char_t * start, entity_p ent, str_size_t bytes, str_size_t chars, str_encoding_t encoding)
 {
     if (r) return refer_to_other(r, start, ent, bytes, chars, encoding);
     return new_slice(start, ent, bytes, chars, encoding);
 } // refer_to_or_new_slice
 
+// 切片继承源串的纯 ASCII 标志（源串可能与结果是同一个切片，须事先保存）
+inline static nstr_p inherit_ascii(nstr_p r, bool ascii)
+{
+    if (r) r->ascii |= ascii;
+    return r;
+} // inherit_ascii
+
 inline static nstr_p refer_to_whole(nstr_p r, nstr_p s)
 {
-    return refer_to_or_new_slice(r, s->start, s->ent, s->bytes, s->chars, s->encoding);
+    bool ascii = s->ascii;
+    return inherit_ascii(refer_to_or_new_slice(r, s->start, s->ent, s->bytes, s->chars, s->encoding), ascii);
 } // refer_to_whole
 
-inline static void copy3(char_t * dst, const char_t * s1, int32_t b1, const char_t * s2, int32_t b2, const char_t * s3, int32_t b3)
+inline static uint64_t waste_of(entity_p ent)
+{
+    return ent->bytes - (ent->refd < ent->bytes ? ent->refd : ent->bytes);
+} // waste_of
+
+// 按自动压缩策略检查新切片，复制占比过小的切片
+inline static nstr_p apply_compact_policy(nstr_p s)
+{
+    entity_p ent = NULL;
+
+    if (! s || compact_policy.min_held == 0) return s;
+
+    ent = get_entity(s);
+    if (ent->bytes < compact_policy.min_held) return s;
+    if ((uint64_t)(ent->bytes - s->bytes) * 100 <= (uint64_t)ent->bytes * compact_policy.max_waste) return s;
+
+    nstr_compact(s); // 失败时保留原引用
+    return s;
+} // apply_compact_policy
+
+inline static void copy3(char_t * dst, const char_t * s1, str_size_t b1, const char_t * s2, str_size_t b2, const char_t * s3, str_size_t b3)
 {
     memcpy(dst, s1, b1);
     memcpy(dst + b1, s2, b2);
@@ -131,7 +775,7 @@ inline static void copy3(char_t * dst, const char_t * s1, int32_t b1, const char
     dst[b1 + b2 + b3] = 0;
 } // copy3
 
-nstr_p nstr_new(const char_t * src, uint32_t bytes, bool copy)
+nstr_p nstr_new(const char_t * src, str_size_t bytes, bool copy)
 {
     const char_t * start = blank_ent.data;
     entity_p ent = &blank_ent;
@@ -142,16 +786,13 @@ nstr_p nstr_new(const char_t * src, uint32_t bytes, bool copy)
 
     if (src && bytes > 0) {
         if (copy) {
-            ent = new_entity(bytes);
+            ent = copy_to_entity(src, bytes);
             if (! ent) {
                 free(new);
                 return NULL;
             } // if
 
-            memcpy(ent->data, src, bytes);
-            ent->data[bytes] = 0;
-
-            start = ent->data;
+            start = entity_data(ent);
         } else {
             ent = &ref_ent;
             start = src;
@@ -161,33 +802,301 @@ nstr_p nstr_new(const char_t * src, uint32_t bytes, bool copy)
     return init_slice(new, true, start, ent, bytes, bytes, STR_ENC_ASCII);
 } // nstr_new
 
+static void advise_range(const char_t * start, str_size_t bytes, int advice)
+{
+    char_t * begin = NULL;
+    size_t len = 0;
+    long page = sysconf(_SC_PAGESIZE);
+
+    begin = (char_t *)((uint64_t)start & ~(uint64_t)(page - 1));
+    len = str_round_up((uint64_t)start + bytes, page) - (uint64_t)begin;
+
+    // 提示仅影响性能，失败时忽略
+    if (advice & STR_MAP_SEQUENTIAL) madvise(begin, len, MADV_SEQUENTIAL);
+    if (advice & STR_MAP_RANDOM) madvise(begin, len, MADV_RANDOM);
+    if (advice & STR_MAP_WILLNEED) madvise(begin, len, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    if (advice & STR_MAP_HUGEPAGE) madvise(begin, len, MADV_HUGEPAGE);
+#endif
+} // advise_range
+
+nstr_p nstr_new_mmap_fd(int fd, uint64_t offset, str_size_t bytes, int advice)
+{
+    struct stat st;
+    mmap_entity_p mm = NULL;
+    nstr_p new = NULL;
+    uint64_t base = 0;
+    long page = sysconf(_SC_PAGESIZE);
+
+    if (fstat(fd, &st) < 0) return NULL;
+    if ((uint64_t)st.st_size < offset) {
+        errno = EINVAL;
+        return NULL;
+    } // if
+
+    if (bytes == 0) {
+        // 映射到文件末尾
+        if ((uint64_t)st.st_size - offset > STR_SIZE_MAX) {
+            errno = EOVERFLOW;
+            return NULL;
+        } // if
+        bytes = st.st_size - offset;
+    } else if (bytes > (uint64_t)st.st_size - offset) {
+        // 超出文件末尾的部分访问时会触发 SIGBUS
+        errno = EINVAL;
+        return NULL;
+    } // if
+    if (bytes == 0) return nstr_new_blank(STR_ENC_ASCII); // CASE: 空文件或偏移量位于文件末尾
+
+    new = malloc(sizeof(nstr_t));
+    if (! new) return NULL;
+
+    mm = malloc(sizeof(mmap_entity_t));
+    if (! mm) goto NSTR_NEW_MMAP_FD_ERROR;
+
+    base = offset & ~(uint64_t)(page - 1); // 映射起点必须页对齐
+    mm->len = offset - base + bytes;
+    mm->addr = mmap(NULL, mm->len, PROT_READ, MAP_PRIVATE, fd, base);
+    if (mm->addr == MAP_FAILED) goto NSTR_NEW_MMAP_FD_ERROR;
+
+    init_entity(&mm->ent, ENT_KIND_MMAP, bytes);
+
+    mm->start = (const char_t *)mm->addr + (offset - base);
+    init_slice(new, true, mm->start, &mm->ent, bytes, bytes, STR_ENC_ASCII);
+    if (advice != STR_MAP_NORMAL) advise_range(new->start, bytes, advice);
+    return new;
+
+NSTR_NEW_MMAP_FD_ERROR:
+    free(mm);
+    free(new);
+    return NULL;
+} // nstr_new_mmap_fd
+
+nstr_p nstr_new_mmap(const char * path, uint64_t offset, str_size_t bytes, int advice)
+{
+    nstr_p new = NULL;
+    int fd = -1;
+    int err = 0;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    new = nstr_new_mmap_fd(fd, offset, bytes, advice);
+    err = errno;
+    close(fd); // 映射区不依赖文件描述符
+    errno = err;
+    return new;
+} // nstr_new_mmap
+
+nstr_p nstr_new_external(const char_t * src, str_size_t bytes, str_release_t release, void * ctx)
+{
+    extern_entity_p ex = NULL;
+    nstr_p new = NULL;
+
+    assert(src != NULL || bytes == 0);
+
+    new = malloc(sizeof(nstr_t));
+    if (! new) return NULL;
+
+    ex = malloc(sizeof(extern_entity_t));
+    if (! ex) {
+        free(new);
+        return NULL;
+    } // if
+
+    ex->release = release;
+    ex->ctx = ctx;
+    ex->buf = src;
+    init_entity(&ex->ent, ENT_KIND_EXTERN, bytes);
+
+    return init_slice(new, true, (src ? src : blank_ent.data), &ex->ent, bytes, bytes, STR_ENC_ASCII);
+} // nstr_new_external
+
+bool nstr_advise(nstr_p s, int advice)
+{
+    if (get_entity(s)->kind != ENT_KIND_MMAP || s->bytes == 0) return false;
+    advise_range(s->start, s->bytes, advice);
+    return true;
+} // nstr_advise
+
 nstr_p nstr_new_blank(str_encoding_t encoding)
 {
     return new_slice(blank_ent.data, &blank_ent, 0, 0, encoding);
 } // nstr_new_blank
 
+nstr_p nstr_init_fixed(nstr_fixed_p fx, str_size_t cap)
+{
+    fx->cap = cap;
+    fx->str.need_free = false;
+    fx->str.fixed = true;
+    fx->str.unused = 0;
+    fx->str.ent = &nstr_fixed_entity;
+    return settle_fixed(&fx->str, 0, 0, STR_ENC_ASCII, true);
+} // nstr_init_fixed
+
 nstr_p nstr_clone(nstr_p s)
 {
+    bool verified = verified_as(touch(s), s->encoding);
     nstr_p new = nstr_new(s->start, s->bytes, true);
-    if (new) nstr_set_encoding(new, s->encoding);
+    entity_p ent = NULL;
+
+    if (new) {
+        new->encoding = s->encoding;
+        new->chars = s->chars;
+        new->ascii = s->ascii;
+
+        // 源串已校验时无需再次校验，去重命中的已有实体不改动其校验结果
+        ent = get_entity(new);
+        if (verified && ent->need_free && ent->slcs == 1) mark_verified(ent, s->encoding)->ascii |= s->ascii;
+    } // if
     return new;
 } // nstr_clone
 
 nstr_p nstr_duplicate(nstr_p s)
 {
-    return new_slice(s->start, s->ent, s->bytes, s->chars, s->encoding);
+    return apply_compact_policy(inherit_ascii(new_slice(s->start, s->ent, s->bytes, s->chars, s->encoding), s->ascii));
 } // nstr_duplicate
 
-void nstr_delete(nstr_p s)
+// 将切片内容复制到以 NUL 结尾的新实体，并改为引用新实体
+static bool refer_to_copy(nstr_p s)
+{
+    entity_p new = NULL;
+
+    if (s->bytes == 0) {
+        refer_to_other(s, blank_ent.data, &blank_ent, 0, 0, s->encoding);
+        return true;
+    } // if
+
+    new = copy_to_entity(touch(s)->start, s->bytes);
+    if (! new) return false;
+
+    new->ascii |= s->ascii;
+
+    refer_to_other(s, entity_data(new), new, s->bytes, s->chars, s->encoding);
+    return true;
+} // refer_to_copy
+
+bool nstr_compact(nstr_p s)
+{
+    entity_p ent = get_entity(s);
+
+    if (! ent->need_free || s->bytes == ent->bytes) return false; // CASE: 静态实体或切片覆盖整个实体
+    return refer_to_copy(s);
+} // nstr_compact
+
+// 切片之后的字节是否可以读取且为 NUL 字符
+inline static bool followed_by_nul(nstr_p s)
+{
+    entity_p ent = get_entity(s);
+    const char_t * end = s->start + s->bytes;
+
+    if (ent == &ref_ent) return false; // 外部字节范围的边界未知
+    if (ent == &nstr_literal_entity || ent->kind == ENT_KIND_HEAP || ent->kind == ENT_KIND_ANON) return end[0] == 0; // 字面量、data 区和匿名映射区均以 NUL 结尾
+
+    // 映射区和外部缓冲区不保证以 NUL 结尾，只能检查范围内的字节
+    return end < entity_start(ent) + ent->bytes && end[0] == 0;
+} // followed_by_nul
+
+const char_t * nstr_cstr(nstr_p s)
+{
+    if (s->fixed) return copy_to_fixed(s, s->start, s->bytes, s->chars, s->encoding, s->ascii) ? s->start : NULL; // 定长串在缓冲区内原地整理
+    if (followed_by_nul(pin(s))) return s->start; // CASE: 切片之后就是 NUL 字符，无需复制
+    if (! refer_to_copy(s)) return NULL;
+    return pin(s)->start;
+} // nstr_cstr
+
+void nstr_set_compact_policy(str_size_t min_held, uint32_t max_waste)
+{
+    compact_policy.min_held = min_held;
+    compact_policy.max_waste = (max_waste < 100) ? max_waste : 100;
+} // nstr_set_compact_policy
+
+void nstr_usage(nstr_p s, str_usage_p usage)
+{
+    entity_p ent = get_entity(s);
+
+    usage->entity = ent;
+    usage->held = ent->bytes;
+    usage->referenced = ent->refd;
+    usage->slices = ent->slcs;
+    usage->waste = waste_of(ent);
+    usage->packed = (ent->kind == ENT_KIND_ANON) ? container_of(anon_entity_t, ent, ent)->packed_bytes : 0;
+} // nstr_usage
+
+void nstr_set_dedup_policy(str_size_t max_bytes)
+{
+    dedup.max_bytes = max_bytes;
+} // nstr_set_dedup_policy
+
+void nstr_dedup_stats(str_dedup_stats_p stats, bool reset)
+{
+    uint32_t entries = dedup.stats.entries;
+
+    *stats = dedup.stats;
+    if (! reset) return;
+
+    memset(&dedup.stats, 0, sizeof(dedup.stats));
+    dedup.stats.entries = entries; // 存储中的实体数不随统计清零
+} // nstr_dedup_stats
+
+void nstr_set_cold_policy(str_size_t min_bytes, uint32_t idle_sweeps)
+{
+    cold_policy.min_bytes = min_bytes;
+    cold_policy.idle = (idle_sweeps > 0) ? idle_sweeps : 1;
+} // nstr_set_cold_policy
+
+uint64_t nstr_sweep_cold(void)
+{
+    anon_entity_p an = NULL;
+    uint64_t released = 0;
+
+    cold_policy.epoch += 1;
+    for (an = cold_policy.head; an; an = an->next) {
+        if (an->packed || an->pinned || cold_policy.epoch - an->epoch < cold_policy.idle) continue;
+        released += freeze(an);
+    } // for
+    return released;
+} // nstr_sweep_cold
+
+void nstr_track_entities(bool enabled)
+{
+    tracker.enabled = enabled;
+} // nstr_track_entities
+
+int nstr_worst_wastes(str_usage_p list, int n)
 {
     entity_p ent = NULL;
+    uint64_t waste = 0;
+    uint32_t i = 0;
+    int cnt = 0;
+    int j = 0;
+
+    for (i = 0; i < tracker.cap && n > 0; ++i) {
+        ent = tracker.slots[i];
+        if (! ent || ent == &ref_ent) continue;
+
+        waste = waste_of(ent);
+        if (waste == 0 || (cnt == n && list[cnt - 1].waste >= waste)) continue;
+
+        // 插入排序，按浪费字节数降序排列
+        j = (cnt < n) ? cnt++ : cnt - 1;
+        for (; j > 0 && list[j - 1].waste < waste; --j) list[j] = list[j - 1];
+
+        list[j].entity = ent;
+        list[j].held = ent->bytes;
+        list[j].referenced = ent->refd;
+        list[j].slices = ent->slcs;
+        list[j].waste = waste;
+    } // for
+    return cnt;
+} // nstr_worst_wastes
 
+void nstr_delete(nstr_p s)
+{
     if (! s) return; // NULL 指针
 
-    ent = get_entity(s);
+    del_ref(s);
     if (s->need_free) free(s);
-
-    del_ref(ent);
 } // nstr_delete
 
 void nstr_delete_array(nstr_array_p * as, int n)
@@ -204,192 +1113,1274 @@ str_encoding_t nstr_encoding(nstr_p s)
     return s->encoding;
 } // nstr_encoding
 
-uint32_t nstr_bytes(nstr_p s)
+str_size_t nstr_bytes(nstr_p s)
 {
     return s->bytes;
 } // nstr_bytes
 
-uint32_t nstr_chars(nstr_p s)
+str_size_t nstr_chars(nstr_p s)
 {
-    return s->chars;
+    return get_chars(s);
 } // nstr_chars
 
+str_size_t nstr_graphemes(nstr_p s)
+{
+    const char_t * pos = NULL;
+    const char_t * end = NULL;
+    str_size_t cnt = 0;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    touch(s);
+    if (s->encoding == STR_ENC_UTF8) return ucd_graphemes(s->start, s->bytes);
+
+    // 单字节字符，只有 CR LF 同簇
+    end = s->start + s->bytes;
+    cnt = s->bytes;
+    for (pos = memchr(s->start, '\r', s->bytes); pos && pos + 1 < end; pos = memchr(pos + 1, '\r', end - pos - 1)) {
+        if (pos[1] == '\n') --cnt;
+    } // for
+    return cnt;
+} // nstr_graphemes
+
 void nstr_byte_range(nstr_p s, const char_t ** start, const char_t ** end)
 {
-    *start = s->start;
+    *start = pin(s)->start;
     *end = s->start + s->bytes;
 } // nstr_byte_range
 
-uint32_t nstr_next_char(nstr_p s, const char_t ** start, uint32_t * index, nstr_p ch)
+inline static str_size_t next_char(const char_t * s_start, str_size_t s_bytes, str_encoding_t encoding, bool ascii, const char_t ** start, str_size_t * index, str_size_t * ch_bytes)
 {
-    assert(s != NULL);
-    assert(start != NULL);
-    assert(index != NULL);
-    assert(ch != NULL);
-
     if (! *start) {
-        *start = s->start;
+        *start = s_start;
         *index = 0;
-        refer_to_other(ch, s->start, 0, 0, 1, s->encoding);
     } else {
-        *start += ch->bytes;
-        *index += 1;
+        *start += *ch_bytes;
+        *index += 1;
+    } // if
+
+    if (*start >= s_start + s_bytes) {
+        *start = NULL;
+        return (*ch_bytes = 0);
+    } // if
+
+    if (ascii) return (*ch_bytes = 1); // 纯 ASCII 内容每个字节都是一个字符
+    return (*ch_bytes = vtable[encoding].measure(*start));
+} // next_char
+
+str_size_t nstr_next_char(nstr_p s, const char_t ** start, str_size_t * index, nstr_p ch)
+{
+    str_size_t bytes = 0;
+
+    assert(s != NULL);
+    assert(start != NULL);
+    assert(index != NULL);
+    assert(ch != NULL);
+    assert(! ch->fixed); // 字符切片借用源串字节范围，不能是定长串
+
+    touch(s);
+    if (! *start) refer_to_other(ch, s->start, s->ent, 0, 1, s->encoding);
+
+    bytes = ch->bytes;
+    if (next_char(s->start, s->bytes, s->encoding, s->ascii, start, index, &bytes) == 0) return 0;
+
+    ch->start = *start;
+    set_bytes(ch, bytes);
+    return bytes;
+} // nstr_next_char
+
+str_size_t nstr_prev_char(nstr_p s, const char_t ** start, str_size_t * index, nstr_p ch)
+{
+    str_size_t chars = 1;
+    str_size_t bytes = 0;
+
+    assert(s != NULL);
+    assert(start != NULL);
+    assert(index != NULL);
+    assert(ch != NULL);
+    assert(! ch->fixed); // 字符切片借用源串字节范围，不能是定长串
+
+    touch(s);
+    if (! *start) {
+        refer_to_other(ch, s->start, s->ent, 0, 1, s->encoding);
+        *start = s->start + s->bytes;
+        *index = 0;
+    } // if
+
+    if (*start <= s->start) {
+        *start = NULL; // 停止遍历
+        return 0;
+    } // if
+
+    bytes = rseek_chars(s, *start, &chars);
+    *start -= bytes;
+    *index -= 1;
+
+    ch->start = *start;
+    set_bytes(ch, bytes);
+    return bytes;
+} // nstr_prev_char
+
+str_size_t nstr_next_token(nstr_p s, const char_t ** start, str_size_t * index, nstr_p tok)
+{
+    const char_t * end = NULL;
+    const char_t * pos = NULL;
+    const char_t * stop = NULL;
+
+    assert(s != NULL);
+    assert(s->encoding != STR_ENC_UTF16);
+    assert(start != NULL);
+    assert(index != NULL);
+    assert(tok != NULL);
+    assert(! tok->fixed); // 单词切片借用源串字节范围，不能是定长串
+
+    touch(s);
+    end = s->start + s->bytes;
+    if (! *start) {
+        refer_to_other(tok, s->start, s->ent, 0, 0, s->encoding);
+        pos = s->start;
+        *index = 0;
+    } else {
+        pos = *start + tok->bytes;
+        *index += get_chars(tok);
+    } // if
+
+    // 空白字符都是单字节字符
+    stop = str_byteset_skip(&str_byteset_space, pos, end);
+    if (! stop) {
+        *start = NULL; // 停止遍历
+        *index += end - pos;
+        return 0;
+    } // if
+    *index += stop - pos;
+
+    pos = str_byteset_find(&str_byteset_space, stop, end);
+    if (! pos) pos = end;
+
+    *start = stop;
+    tok->start = stop;
+    tok->ascii = s->ascii; // get_chars() 可能按上个单词设置了纯 ASCII 标志
+    tok->chars = (s->ascii) ? pos - stop : lazy_chars(pos - stop, s->encoding);
+    set_bytes(tok, pos - stop);
+    return tok->bytes;
+} // nstr_next_token
+
+str_size_t nstr_next_grapheme(nstr_p s, const char_t ** start, str_size_t * index, nstr_p g)
+{
+    const char_t * end = NULL;
+    const char_t * pos = NULL;
+    str_size_t bytes = 0;
+    str_size_t chars = 0;
+
+    assert(s != NULL);
+    assert(s->encoding != STR_ENC_UTF16);
+    assert(start != NULL);
+    assert(index != NULL);
+    assert(g != NULL);
+    assert(! g->fixed); // 字素簇切片借用源串字节范围，不能是定长串
+
+    touch(s);
+    end = s->start + s->bytes;
+    if (! *start) {
+        refer_to_other(g, s->start, s->ent, 0, 0, s->encoding);
+        pos = s->start;
+        *index = 0;
+    } else {
+        pos = *start + g->bytes;
+        *index += g->chars;
+    } // if
+
+    if (pos >= end) {
+        *start = NULL; // 停止遍历
+        return 0;
+    } // if
+
+    if (s->encoding == STR_ENC_UTF8 && ! s->ascii) {
+        bytes = ucd_grapheme(pos, end - pos, &chars);
+    } else {
+        // 单字节字符，只有 CR LF 同簇
+        bytes = (pos[0] == '\r' && end - pos > 1 && pos[1] == '\n') ? 2 : 1;
+        chars = bytes;
+    } // if
+
+    *start = pos;
+    g->start = pos;
+    g->ascii = s->ascii;
+    g->chars = chars;
+    set_bytes(g, bytes);
+    return bytes;
+} // nstr_next_grapheme
+
+static str_size_t next_sub(const char_t * s_start, str_size_t s_bytes, str_size_t s_chars, str_encoding_t encoding, bool ascii, str_searcher_p sr, str_size_t sub_chars, const char_t ** start, str_size_t * index)
+{
+    const char_t * loc = NULL;  // 下个子串位置
+    size_t size = 0;    // 搜索范围长度
+    str_size_t bytes = 0;  // 距离上个子串位置的字节数
+
+    if (! *start) {
+        *start = s_start;
+        size = s_bytes;
+        *index = 0;
+    } else {
+        *start += sr->bytes;
+        size = s_bytes - (*start - s_start);
+        *index += sub_chars;
+    } // if
+
+    loc = str_searcher_find(sr, *start, size);
+    if (! loc) {
+        *start = NULL; // 停止查找
+        if (s_chars != CHARS_UNKNOWN) {
+            *index = s_chars;
+        } else {
+            *index = ascii ? s_bytes : vtable[encoding].tally(s_start, s_bytes);
+        } // if
+        return STR_NOT_FOUND; // 找不到子串
+    } // if
+
+    bytes = loc - *start;
+    *index += ascii ? bytes : vtable[encoding].tally(*start, bytes); // 源串已校验，只需计数
+
+    *start = loc; // 指向子串位置，下次从子串之后继续查找
+    return bytes;
+} // next_sub
+
+str_size_t nstr_next_sub(nstr_p s, nstr_p sub, const char_t ** start, str_size_t * index)
+{
+    str_searcher_t sr;
+    str_size_t ret = 0;
+
+    assert(s != NULL);
+    assert(! nstr_is_blank(s));
+
+    assert(sub != NULL);
+    assert(! nstr_is_blank(sub));
+
+    assert(start != NULL);
+    assert(index != NULL);
+
+    touch(s);
+    str_searcher_init(&sr, touch(sub)->start, sub->bytes);
+    ret = next_sub(s->start, s->bytes, s->chars, s->encoding, s->ascii, &sr, (*start ? get_chars(sub) : 0), start, index);
+    if (ret == STR_NOT_FOUND) s->chars = *index; // 顺便缓存字符数
+    return ret;
+} // nstr_next_sub
+
+str_size_t nstr_prev_sub(nstr_p s, nstr_p sub, const char_t ** start, str_size_t * index)
+{
+    str_searcher_t sr;
+    const char_t * end = NULL;  // 搜索范围结尾
+    const char_t * loc = NULL;  // 上个子串位置
+
+    assert(s != NULL);
+    assert(! nstr_is_blank(s));
+
+    assert(sub != NULL);
+    assert(! nstr_is_blank(sub));
+
+    assert(start != NULL);
+    assert(index != NULL);
+
+    touch(s);
+    if (! *start) {
+        end = s->start + s->bytes;
+        *index = 0;
+    } else {
+        end = *start; // 只在本次找到的子串之前查找
+    } // if
+
+    str_searcher_init(&sr, touch(sub)->start, sub->bytes);
+    loc = str_searcher_rfind(&sr, s->start, end - s->start);
+    if (! loc) {
+        *start = NULL; // 停止查找
+        return STR_NOT_FOUND;
+    } // if
+
+    *index -= s->ascii ? end - loc : vtable[s->encoding].tally(loc, end - loc); // 只计算经过部分的字符数
+    *start = loc;
+    return end - loc - sub->bytes;
+} // nstr_prev_sub
+
+nstr_searcher_p nstr_new_searcher(nstr_p pattern)
+{
+    nstr_searcher_p new = NULL;
+
+    assert(pattern != NULL);
+    assert(! nstr_is_blank(pattern));
+
+    new = malloc(sizeof(nstr_searcher_t));
+    if (! new) return NULL;
+
+    // 持有模式串的引用，保证字节范围存活；定长串的缓冲区不能借用，需要复制
+    new->pattern = pattern->fixed ? nstr_clone(pattern) : nstr_duplicate(pattern);
+    if (! new->pattern) {
+        free(new);
+        return NULL;
+    } // if
+
+    str_searcher_init(&new->sr, touch(new->pattern)->start, new->pattern->bytes);
+    return new;
+} // nstr_new_searcher
+
+void nstr_delete_searcher(nstr_searcher_p sr)
+{
+    if (! sr) return; // NULL 指针
+
+    nstr_delete(sr->pattern);
+    free(sr);
+} // nstr_delete_searcher
+
+// 访问查找器前调用，模式串可能已被冷存储压缩
+inline static str_searcher_p use_searcher(nstr_searcher_p sr)
+{
+    touch(sr->pattern);
+    return &sr->sr;
+} // use_searcher
+
+str_size_t nstr_next_match(nstr_p s, nstr_searcher_p sr, const char_t ** start, str_size_t * index)
+{
+    str_size_t ret = 0;
+
+    assert(s != NULL);
+    assert(! nstr_is_blank(s));
+
+    assert(sr != NULL);
+    assert(start != NULL);
+    assert(index != NULL);
+
+    ret = next_sub(touch(s)->start, s->bytes, s->chars, s->encoding, s->ascii, use_searcher(sr), (*start ? get_chars(sr->pattern) : 0), start, index);
+    if (ret == STR_NOT_FOUND) s->chars = *index; // 顺便缓存字符数
+    return ret;
+} // nstr_next_match
+
+bool nstr_contain_by(nstr_p s, nstr_searcher_p sr)
+{
+    return str_searcher_find(use_searcher(sr), touch(s)->start, s->bytes) != NULL;
+} // nstr_contain_by
+
+nstr_keywords_p nstr_new_keywords(nstr_p * needles, int n)
+{
+    nstr_keywords_p new = NULL;
+    const char_t ** starts = NULL;
+    str_size_t * bytes = NULL;
+    int i = 0;
+
+    assert(n >= 0);
+
+    new = malloc(sizeof(nstr_keywords_t) + sizeof(new->chars[0]) * n);
+    starts = malloc(sizeof(starts[0]) * (n + 1));
+    bytes = malloc(sizeof(bytes[0]) * (n + 1));
+    if (! new || ! starts || ! bytes) goto NSTR_NEW_KEYWORDS_ERROR;
+
+    for (i = 0; i < n; ++i) {
+        assert(needles[i] && ! nstr_is_blank(needles[i]));
+        starts[i] = touch(needles[i])->start;
+        bytes[i] = needles[i]->bytes;
+        new->chars[i] = get_chars(needles[i]);
+    } // for
+
+    // 自动机不引用模式串，编译后即可释放
+    new->acm = str_acm_new(starts, bytes, n);
+    if (! new->acm) goto NSTR_NEW_KEYWORDS_ERROR;
+
+    free(bytes);
+    free(starts);
+    return new;
+
+NSTR_NEW_KEYWORDS_ERROR:
+    free(bytes);
+    free(starts);
+    free(new);
+    return NULL;
+} // nstr_new_keywords
+
+void nstr_delete_keywords(nstr_keywords_p kw)
+{
+    if (! kw) return; // NULL 指针
+
+    str_acm_delete(kw->acm);
+    free(kw);
+} // nstr_delete_keywords
+
+int32_t nstr_next_keyword(nstr_p s, nstr_keywords_p kw, nstr_keyword_cursor_p cur)
+{
+    str_acm_p ac = kw->acm;
+    const char_t * end = NULL;
+    str_size_t offset = 0;
+    int32_t id = 0;
+
+    assert(s != NULL);
+    assert(cur != NULL);
+
+    touch(s);
+    if (! cur->start) {
+        // 从头开始
+        cur->pos = s->start;
+        cur->counted = 0;
+        cur->chars = 0;
+        cur->state = 0;
+        cur->pending = 0;
+    } // if
+
+    if (! cur->pending) {
+        end = str_acm_scan(ac, cur->pos, s->start + s->bytes, &cur->state);
+        if (! end) {
+            cur->start = NULL; // 停止查找
+            return STR_NOT_FOUND;
+        } // if
+
+        cur->pos = end;
+        cur->pending = ac->emit[cur->state];
+    } // if
+
+    // 同一结尾处的匹配沿输出链依次报告，较长的模式在前
+    id = ac->out[cur->pending];
+    cur->pending = ac->dict[cur->pending];
+
+    // 匹配结尾单调不减，字符数只需从上次计数处继续累加
+    offset = cur->pos - s->start;
+    cur->chars += s->ascii ? (offset - cur->counted) : vtable[s->encoding].tally(s->start + cur->counted, offset - cur->counted);
+    cur->counted = offset;
+
+    cur->bytes = ac->lens[id];
+    cur->offset = offset - cur->bytes;
+    cur->index = cur->chars - kw->chars[id];
+    cur->start = s->start + cur->offset;
+    return id;
+} // nstr_next_keyword
+
+nstr_regex_p nstr_new_regex(nstr_p pattern, int32_t * err)
+{
+    nstr_regex_p new = NULL;
+    int32_t ret = 0;
+
+    assert(pattern != NULL);
+    assert(pattern->encoding == STR_ENC_ASCII || pattern->encoding == STR_ENC_UTF8);
+
+    new = calloc(1, sizeof(nstr_regex_t));
+    if (! new) {
+        ret = STR_OUT_OF_MEMORY;
+        goto NSTR_NEW_REGEX_ERROR;
+    } // if
+
+    new->re = str_regex_new(touch(pattern)->start, pattern->bytes, &ret, NULL);
+    if (! new->re) {
+        if (ret != STR_OUT_OF_MEMORY) ret = STR_BAD_PATTERN;
+        goto NSTR_NEW_REGEX_ERROR;
+    } // if
+
+    new->caps = malloc(sizeof(new->caps[0]) * str_regex_groups(new->re) * 2);
+    if (! new->caps) {
+        ret = STR_OUT_OF_MEMORY;
+        goto NSTR_NEW_REGEX_ERROR;
+    } // if
+
+    if (err) *err = 0;
+    return new;
+
+NSTR_NEW_REGEX_ERROR:
+    nstr_delete_regex(new);
+    if (err) *err = ret;
+    return NULL;
+} // nstr_new_regex
+
+void nstr_delete_regex(nstr_regex_p re)
+{
+    if (! re) return; // NULL 指针
+
+    str_regex_delete(re->re);
+    free(re->caps);
+    free(re);
+} // nstr_delete_regex
+
+int nstr_regex_groups(nstr_regex_p re)
+{
+    return str_regex_groups(re->re);
+} // nstr_regex_groups
+
+bool nstr_regex_test(nstr_p s, nstr_regex_p re)
+{
+    assert(s != NULL);
+    assert(s->encoding == STR_ENC_ASCII || s->encoding == STR_ENC_UTF8);
+
+    touch(s);
+    return str_regex_find(re->re, s->start, s->start + s->bytes, s->start, NULL, 0);
+} // nstr_regex_test
+
+int32_t nstr_next_regex(nstr_p s, nstr_regex_p re, nstr_regex_cursor_p cur, nstr_p * caps, int n)
+{
+    const char_t * end = NULL;
+    nstr_p r = NULL;
+    str_size_t offset = 0;
+    int m = 0;
+    int i = 0;
+
+    assert(s != NULL);
+    assert(s->encoding == STR_ENC_ASCII || s->encoding == STR_ENC_UTF8);
+    assert(cur != NULL);
+    assert(n >= 0);
+
+    touch(s);
+    end = s->start + s->bytes;
+    if (! cur->start) {
+        // 从头开始
+        cur->pos = s->start;
+        cur->counted = 0;
+        cur->chars = 0;
+    } // if
+
+    if (! cur->pos || ! str_regex_find(re->re, s->start, end, cur->pos, re->caps, str_regex_groups(re->re))) {
+        cur->start = NULL; // 停止查找
+        return STR_NOT_FOUND;
+    } // if
+
+    // 匹配起始位置单调不减，字符数只需从上次计数处继续累加
+    offset = re->caps[0] - s->start;
+    cur->chars += s->ascii ? (offset - cur->counted) : vtable[s->encoding].tally(s->start + cur->counted, offset - cur->counted);
+    cur->counted = offset;
+
+    cur->start = re->caps[0];
+    cur->offset = offset;
+    cur->index = cur->chars;
+    cur->bytes = re->caps[1] - re->caps[0];
+
+    // 空匹配之后先前进一个字符，避免原地重复
+    cur->pos = re->caps[1];
+    if (cur->bytes == 0) cur->pos = (cur->pos < end) ? cur->pos + vtable[s->encoding].measure(cur->pos) : NULL;
+
+    m = (n < nstr_regex_groups(re)) ? n : nstr_regex_groups(re);
+    for (i = 0; i < m; ++i) {
+        if (re->caps[i * 2]) {
+            r = refer_to_or_new_slice(caps[i], re->caps[i * 2], get_entity(s), re->caps[i * 2 + 1] - re->caps[i * 2], lazy_chars(re->caps[i * 2 + 1] - re->caps[i * 2], s->encoding), s->encoding);
+            r = apply_compact_policy(inherit_ascii(r, s->ascii));
+        } else {
+            r = refer_to_or_new_slice(caps[i], blank_ent.data, &blank_ent, 0, 0, s->encoding); // 未参与匹配的分组
+        } // if
+        if (! r) return STR_OUT_OF_MEMORY;
+        caps[i] = r;
+    } // for
+    return m;
+} // nstr_next_regex
+
+str_size_t nstr_span(nstr_p s, nstr_p set)
+{
+    str_byteset_t bs;
+    const char_t * pos = NULL;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    str_byteset_init(&bs, touch(set)->start, set->bytes);
+    pos = str_byteset_skip(&bs, touch(s)->start, s->start + s->bytes);
+    return (pos ? pos : s->start + s->bytes) - s->start; // 集合成员都是单字节字符
+} // nstr_span
+
+str_size_t nstr_find_any_of(nstr_p s, nstr_p set)
+{
+    str_byteset_t bs;
+    const char_t * pos = NULL;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    str_byteset_init(&bs, touch(set)->start, set->bytes);
+    pos = str_byteset_find(&bs, touch(s)->start, s->start + s->bytes);
+    if (! pos) return STR_NOT_FOUND;
+    return s->ascii ? pos - s->start : vtable[s->encoding].tally(s->start, pos - s->start);
+} // nstr_find_any_of
+
+inline static int compare_bytes(const char_t * p1, str_size_t b1, const char_t * p2, str_size_t b2)
+{
+    int ret = memcmp(p1, p2, (b1 < b2 ? b1 : b2));
+    if (ret != 0) return ret;
+    return (b1 > b2) - (b1 < b2); // 公共前缀相同，较短者在前
+} // compare_bytes
+
+bool nstr_contain(nstr_p s, nstr_p sub)
+{
+    str_searcher_t sr;
+
+    if (sub->bytes == 0) return true;
+    if (sub->bytes > s->bytes) return false;
+
+    // 与 nstr_next_sub() 共用按模式串长度选择的查找算法
+    str_searcher_init(&sr, touch(sub)->start, sub->bytes);
+    return str_searcher_find(&sr, touch(s)->start, s->bytes) != NULL;
+} // nstr_contain
+
+bool nstr_contain_char(nstr_p s, char_t ch)
+{
+    return memchr(touch(s)->start, ch, s->bytes) != NULL;
+} // nstr_contain_char
+
+bool nstr_start_with(nstr_p s, nstr_p sub)
+{
+    return sub->bytes <= s->bytes && memcmp(touch(s)->start, touch(sub)->start, sub->bytes) == 0;
+} // nstr_start_with
+
+bool nstr_start_with_char(nstr_p s, char_t ch)
+{
+    return s->bytes > 0 && touch(s)->start[0] == ch;
+} // nstr_start_with_char
+
+bool nstr_end_with(nstr_p s, nstr_p sub)
+{
+    return sub->bytes <= s->bytes && memcmp(touch(s)->start + s->bytes - sub->bytes, touch(sub)->start, sub->bytes) == 0;
+} // nstr_end_with
+
+bool nstr_end_with_char(nstr_p s, char_t ch)
+{
+    return s->bytes > 0 && touch(s)->start[s->bytes - 1] == ch;
+} // nstr_end_with_char
+
+// 未注册的排序规则代号按根排序规则处理，避免越界访问裁剪表
+inline static str_locale_t known_locale(str_locale_t locale)
+{
+    if ((int)locale < STR_LOC_C || (int)locale >= STR_LOC_USER + locales.cnt) return STR_LOC_ROOT;
+    return locale;
+} // known_locale
+
+inline static const ucd_tailor_t * tailor_of(str_locale_t locale)
+{
+    assert(locale >= STR_LOC_ROOT && locale < STR_LOC_USER + locales.cnt);
+    return (locale == STR_LOC_ROOT) ? NULL : locales.tailors[locale - STR_LOC_USER];
+} // tailor_of
+
+// 功能：取得切片的排序键
+// 参数：
+//     s        IN  入参：源串或切片
+//     locale   IN  入参：排序规则，不能是 STR_LOC_C
+//     tmp      IO  入参：临时缓冲区，不能缓存时存放排序键，由调用方释放
+//     len      OUT 出参：排序键字节数
+// 返回值：
+//     non-NULL     排序键
+//     NULL         内存不足
+// 说明：
+//     动态分配的实体上缓存最近生成的 COLL_KEY_MAX 个排序键，按切片范围和排序规则查找；
+//     静态实体（字面量、定长串等）被多个无关的串共用，不缓存。
+static const char_t * sort_key(nstr_p s, str_locale_t locale, ucd_buffer_p tmp, str_size_t * len)
+{
+    entity_p ent = get_entity(touch(s));
+    coll_key_p key = NULL;
+    coll_key_p * link = NULL;
+    uint32_t cnt = 0;
+
+    for (key = ent->keys; key; key = key->next) {
+        if (key->start == s->start && key->bytes == s->bytes && key->locale == locale) {
+            *len = key->len;
+            return key->data;
+        } // if
+    } // for
+
+    if (! ucd_coll_key(s->start, s->bytes, tailor_of(locale), tmp)) return NULL;
+    *len = tmp->used;
+    if (! ent->need_free) return tmp->data;
+
+    key = malloc(sizeof(coll_key_t) + tmp->used);
+    if (! key) return tmp->data; // 只是不缓存
+
+    key->start = s->start;
+    key->bytes = s->bytes;
+    key->locale = locale;
+    key->len = tmp->used;
+    memcpy(key->data, tmp->data, tmp->used);
+    key->next = ent->keys;
+    ent->keys = key;
+
+    // 超出上限时丢弃最早生成的排序键
+    for (link = &ent->keys; *link && cnt < COLL_KEY_MAX; link = &(*link)->next) ++cnt;
+    if (*link) {
+        free(*link);
+        *link = NULL;
+    } // if
+    return key->data;
+} // sort_key
+
+int nstr_compare(nstr_p s1, nstr_p s2, str_locale_t locale)
+{
+    ucd_buffer_t t1 = {0};
+    ucd_buffer_t t2 = {0};
+    const char_t * k1 = NULL;
+    const char_t * k2 = NULL;
+    str_size_t b1 = 0;
+    str_size_t b2 = 0;
+    int ret = 0;
+
+    locale = known_locale(locale);
+    if (locale == STR_LOC_C) return compare_bytes(touch(s1)->start, s1->bytes, touch(s2)->start, s2->bytes);
+
+    assert(s1->encoding != STR_ENC_UTF16 && s2->encoding != STR_ENC_UTF16);
+
+    k1 = sort_key(s1, locale, &t1, &b1);
+    k2 = sort_key(s2, locale, &t2, &b2);
+    if (k1 && k2) {
+        ret = compare_bytes(k1, b1, k2, b2);
+    } else {
+        ret = compare_bytes(touch(s1)->start, s1->bytes, touch(s2)->start, s2->bytes); // 内存不足
+    } // if
+
+    free(t1.data);
+    free(t2.data);
+    return ret;
+} // nstr_compare
+
+int nstr_add_locale(const str_collation_rule_t * rules, int n)
+{
+    ucd_tailor_p * more = NULL;
+    ucd_tailor_p t = NULL;
+    int err = 0;
+
+    if (locales.cnt == locales.cap) {
+        more = realloc(locales.tailors, sizeof(locales.tailors[0]) * (locales.cap ? locales.cap * 2 : 4));
+        if (! more) return STR_OUT_OF_MEMORY;
+        locales.tailors = more;
+        locales.cap = locales.cap ? locales.cap * 2 : 4;
+    } // if
+
+    t = ucd_tailor_new((const ucd_coll_rule_t *)rules, n, &err);
+    if (! t) return (err == UCD_OUT_OF_MEMORY) ? STR_OUT_OF_MEMORY : STR_BAD_PATTERN;
+
+    locales.tailors[locales.cnt] = t;
+    return STR_LOC_USER + locales.cnt++;
+} // nstr_add_locale
+
+// 判断能否按字节进行 ASCII 折叠：非 UTF-8 编码，或内容不含非 ASCII 字节
+inline static bool fold_by_bytes(nstr_p s)
+{
+    if (s->ascii || s->encoding != STR_ENC_UTF8) return true;
+    if (ascii_span(touch(s)->start, s->bytes) < s->bytes) return false;
+    s->ascii = true; // 顺便识别纯 ASCII 内容
+    return true;
+} // fold_by_bytes
+
+// 判断在 s 中查找 sub 时能否只按 ASCII 折叠：sub 只含 ASCII 字节，且 s 也是如此或 sub 不含与非 ASCII 字符折叠相同的字母
+inline static bool fold_as_ascii(nstr_p s, nstr_p sub)
+{
+    if (! fold_by_bytes(sub)) return false;
+    return fold_by_bytes(s) || ! ucd_fold_aliased_in(sub->start, sub->bytes);
+} // fold_as_ascii
+
+// 功能：按大小写折叠比较两个字节范围
+// 参数：
+//     unicode  IN  是否按 UTF-8 编码处理非 ASCII 字符
+//     m1/m2    OUT 两个范围中折叠后相同部分的字节数
+// 说明：
+//     先按 ASCII 折叠成块比较，在非 ASCII 字节处不同时，再从该字符的首字节起按 Unicode 折叠逐个字符比较。
+//     相同部分的非 ASCII 字节原样相等，因此两边的字符边界一致。
+static int fold_compare(const char_t * p1, str_size_t b1, const char_t * p2, str_size_t b2, bool unicode, str_size_t * m1, str_size_t * m2)
+{
+    str_size_t n = (b1 < b2) ? b1 : b2;
+    str_size_t i = 0;
+    int ret = 0;
+
+    i = ascii_fold_prefix(p1, p2, n);
+    if (i < n && unicode && (p1[i] >= 0x80 || p2[i] >= 0x80)) {
+        while (i > 0 && ((p1[i] & 0xC0) == 0x80 || (p2[i] & 0xC0) == 0x80)) --i;
+        ret = ucd_fold_compare(p1 + i, b1 - i, p2 + i, b2 - i, m1, m2);
+        *m1 += i;
+        *m2 += i;
+        return ret;
+    } // if
+
+    *m1 = i;
+    *m2 = i;
+    if (i < n) return (int)ascii_fold(p1[i]) - (int)ascii_fold(p2[i]);
+    return (b1 > b2) - (b1 < b2); // 公共前缀相同，较短者在前
+} // fold_compare
+
+// 从 pos 开始忽略大小写查找子串，*bytes 返回匹配部分的字节数
+static const char_t * find_nocase(nstr_p s, nstr_p sub, const char_t * pos, str_size_t * bytes)
+{
+    str_searcher_t sr;
+    const char_t * end = s->start + s->bytes;
+    const char_t * loc = NULL;
+    str_size_t m2 = 0;
+    uint32_t skip = 0;
+
+    if (fold_as_ascii(s, sub)) {
+        str_searcher_init_nocase(&sr, sub->start, sub->bytes);
+        *bytes = sub->bytes;
+        return str_searcher_find(&sr, pos, end - pos);
+    } // if
+
+    // 含有非 ASCII 字符，逐个字符位置尝试按 Unicode 折叠匹配
+    for (loc = pos; loc < end; loc += (skip > 0) ? skip : 1) {
+        fold_compare(loc, end - loc, sub->start, sub->bytes, true, bytes, &m2);
+        if (m2 == sub->bytes) return loc;
+        skip = vtable[s->encoding].measure(loc);
+    } // for
+    return NULL;
+} // find_nocase
+
+str_size_t nstr_next_sub_nocase(nstr_p s, nstr_p sub, const char_t ** start, str_size_t * index, str_size_t * bytes)
+{
+    const char_t * pos = NULL;  // 查找起始地址
+    const char_t * loc = NULL;  // 下个子串位置
+    str_size_t m1 = 0;
+
+    assert(s != NULL);
+    assert(! nstr_is_blank(s));
+
+    assert(sub != NULL);
+    assert(! nstr_is_blank(sub));
+
+    assert(start != NULL);
+    assert(index != NULL);
+    assert(bytes != NULL);
+
+    touch(s);
+    touch(sub);
+    if (! *start) {
+        pos = s->start;
+        *index = 0;
+    } else {
+        pos = *start + *bytes; // 从上个子串之后继续查找
+        *index += s->ascii ? *bytes : vtable[s->encoding].tally(*start, *bytes);
+    } // if
+
+    loc = find_nocase(s, sub, pos, &m1);
+    if (! loc) {
+        *start = NULL; // 停止查找
+        *index = get_chars(s);
+        return STR_NOT_FOUND;
+    } // if
+
+    *index += s->ascii ? loc - pos : vtable[s->encoding].tally(pos, loc - pos);
+    *start = loc;
+    *bytes = m1;
+    return loc - pos;
+} // nstr_next_sub_nocase
+
+bool nstr_contain_nocase(nstr_p s, nstr_p sub)
+{
+    str_size_t bytes = 0;
+
+    if (sub->bytes == 0) return true;
+    if (s->bytes == 0) return false;
+    return find_nocase(touch(s), touch(sub), s->start, &bytes) != NULL;
+} // nstr_contain_nocase
+
+bool nstr_start_with_nocase(nstr_p s, nstr_p sub)
+{
+    str_size_t m1 = 0;
+    str_size_t m2 = 0;
+
+    fold_compare(touch(s)->start, s->bytes, touch(sub)->start, sub->bytes, ! fold_as_ascii(s, sub), &m1, &m2);
+    return m2 == sub->bytes;
+} // nstr_start_with_nocase
+
+bool nstr_end_with_nocase(nstr_p s, nstr_p sub)
+{
+    touch(s);
+    touch(sub);
+    if (sub->bytes <= s->bytes && ascii_fold_prefix(s->start + s->bytes - sub->bytes, sub->start, sub->bytes) == sub->bytes) return true;
+    if (fold_as_ascii(s, sub)) return false;
+    return ucd_fold_suffix(s->start, s->bytes, sub->start, sub->bytes); // 折叠前后的字符可能占用不同字节数，从结尾向前逐个字符比较
+} // nstr_end_with_nocase
+
+int nstr_compare_nocase(nstr_p s1, nstr_p s2)
+{
+    str_size_t m1 = 0;
+    str_size_t m2 = 0;
+    bool unicode = (s1->encoding == STR_ENC_UTF8 || s2->encoding == STR_ENC_UTF8);
+
+    return fold_compare(touch(s1)->start, s1->bytes, touch(s2)->start, s2->bytes, unicode, &m1, &m2);
+} // nstr_compare_nocase
+
+// ---- 视图函数 ---- //
+
+inline static str_size_t view_chars(nstr_view_p v)
+{
+    str_size_t chars = 0;
+
+    if (v->chars != STR_VIEW_CHARS_UNKNOWN) return v->chars;
+
+    chars = vtable[v->encoding].tally(v->start, v->bytes);
+    if (chars < STR_VIEW_CHARS_UNKNOWN) v->chars = chars; // 超出位域上限时不缓存，每次按需计算
+    return chars;
+} // view_chars
+
+nstr_view_t nstr_view(nstr_p s)
+{
+    nstr_view_t v = {.start = pin(s)->start, .bytes = s->bytes, .encoding = s->encoding};
+    v.chars = (s->chars < STR_VIEW_CHARS_UNKNOWN) ? s->chars : STR_VIEW_CHARS_UNKNOWN;
+    return v;
+} // nstr_view
+
+nstr_view_t nstr_view_of(const char_t * src, str_size_t bytes, str_encoding_t encoding)
+{
+    nstr_view_t v = {.start = src, .bytes = bytes, .encoding = encoding, .chars = STR_VIEW_CHARS_UNKNOWN};
+    if (encoding == STR_ENC_ASCII && bytes < STR_VIEW_CHARS_UNKNOWN) v.chars = bytes;
+    return v;
+} // nstr_view_of
+
+nstr_p nstr_from_view(nstr_p owner, nstr_view_p v, nstr_p r)
+{
+    str_size_t chars = (v->chars != STR_VIEW_CHARS_UNKNOWN) ? v->chars : CHARS_UNKNOWN;
+
+    // 视图必须借自 owner 的字节范围
+    assert(owner->start <= v->start && v->start + v->bytes <= owner->start + owner->bytes);
+    touch(owner);
+    return apply_compact_policy(refer_to_or_new_slice(r, v->start, owner->ent, v->bytes, chars, v->encoding));
+} // nstr_from_view
+
+str_size_t nstr_view_chars(nstr_view_p v)
+{
+    return view_chars(v);
+} // nstr_view_chars
+
+str_size_t nstr_view_next_char(nstr_view_p v, const char_t ** start, str_size_t * index, nstr_view_p ch)
+{
+    str_size_t bytes = 0;
+
+    assert(v != NULL);
+    assert(start != NULL);
+    assert(index != NULL);
+    assert(ch != NULL);
+
+    if (! *start) *ch = (nstr_view_t){.start = v->start, .bytes = 0, .chars = 1, .encoding = v->encoding};
+
+    bytes = ch->bytes;
+    if (next_char(v->start, v->bytes, v->encoding, false, start, index, &bytes) == 0) return 0;
+
+    ch->start = *start;
+    return (ch->bytes = bytes);
+} // nstr_view_next_char
+
+str_size_t nstr_view_next_sub(nstr_view_p v, nstr_view_p sub, const char_t ** start, str_size_t * index)
+{
+    str_searcher_t sr;
+
+    assert(v != NULL && v->bytes > 0);
+    assert(sub != NULL && sub->bytes > 0);
+    assert(start != NULL);
+    assert(index != NULL);
+
+    str_searcher_init(&sr, sub->start, sub->bytes);
+    return next_sub(v->start, v->bytes, (v->chars != STR_VIEW_CHARS_UNKNOWN ? v->chars : CHARS_UNKNOWN), v->encoding, false, &sr, (*start ? view_chars(sub) : 0), start, index);
+} // nstr_view_next_sub
+
+bool nstr_view_contain(nstr_view_p v, nstr_view_p sub)
+{
+    str_searcher_t sr;
+
+    if (sub->bytes == 0) return true;
+    if (sub->bytes > v->bytes) return false;
+
+    // 与 nstr_contain() 使用相同的查找算法
+    str_searcher_init(&sr, sub->start, sub->bytes);
+    return str_searcher_find(&sr, v->start, v->bytes) != NULL;
+} // nstr_view_contain
+
+bool nstr_view_start_with(nstr_view_p v, nstr_view_p sub)
+{
+    return sub->bytes <= v->bytes && memcmp(v->start, sub->start, sub->bytes) == 0;
+} // nstr_view_start_with
+
+bool nstr_view_end_with(nstr_view_p v, nstr_view_p sub)
+{
+    return sub->bytes <= v->bytes && memcmp(v->start + v->bytes - sub->bytes, sub->start, sub->bytes) == 0;
+} // nstr_view_end_with
+
+int nstr_view_compare(nstr_view_p v1, nstr_view_p v2, str_locale_t locale)
+{
+    ucd_buffer_t k1 = {0};
+    ucd_buffer_t k2 = {0};
+    int ret = 0;
+
+    locale = known_locale(locale);
+    if (locale == STR_LOC_C) return compare_bytes(v1->start, v1->bytes, v2->start, v2->bytes);
+
+    // 视图不持有实体，每次生成排序键
+    if (ucd_coll_key(v1->start, v1->bytes, tailor_of(locale), &k1) && ucd_coll_key(v2->start, v2->bytes, tailor_of(locale), &k2)) {
+        ret = compare_bytes(k1.data, k1.used, k2.data, k2.used);
+    } else {
+        ret = compare_bytes(v1->start, v1->bytes, v2->start, v2->bytes); // 内存不足
     } // if
 
-    if (*start >= s->start + s->bytes) {
-        *start = NULL;
-        return 0;
+    free(k1.data);
+    free(k2.data);
+    return ret;
+} // nstr_view_compare
+
+bool nstr_set_encoding(nstr_p s, str_encoding_t encoding)
+{
+    entity_p ent = get_entity(s);
+    str_encoding_t prev = s->encoding;
+    str_size_t span = 0;
+    str_size_t r_bytes = 0;
+
+    touch(s);
+    s->encoding = encoding;
+    if (! (ent->verified && ent->encoding == encoding && on_char_boundary(s))) {
+        // 先跳过开头的 7 位字节，同时识别纯 ASCII 内容，剩余部分再按编码校验
+        if (encoding == STR_ENC_UTF8) span = s->ascii ? s->bytes : ascii_span(s->start, s->bytes);
+        r_bytes = s->bytes - span;
+        if (! vtable[encoding].validate(s->start + span, &r_bytes)) {
+            // 编码错误
+            s->encoding = prev;
+            return false;
+        } // if
+
+        // ASCII 编码校验通过即说明全部字节都小于 0x80
+        s->ascii |= (encoding == STR_ENC_ASCII || span == s->bytes);
+
+        // 切片覆盖整个实体时记录校验结果，其它切片无需重复校验
+        if (s->bytes == ent->bytes && ent->need_free) mark_verified(ent, encoding)->ascii = s->ascii;
     } // if
 
-    ch->start = *start;
-    return (ch->bytes = vtable[s->encoding].measure(*start));
-} // nstr_next_char
+    s->chars = (s->ascii) ? s->bytes : lazy_chars(s->bytes, encoding); // 首次需要时再计算字符数
+    return true;
+} // nstr_set_encoding
 
-uint32_t nstr_next_sub(nstr_p s, nstr_p sub, const char_t ** start, uint32_t * index)
+bool nstr_validate(nstr_p s, str_encoding_t encoding)
 {
-    const char_t * loc = NULL;  // 下个子串位置
-    size_t size = 0;    // 搜索范围长度
-    uint32_t chars = 0;  // 距离上个子串位置的字符数
-    uint32_t bytes = 0;  // 距离上个子串位置的字节数
-
-    assert(s != NULL);
-    assert(! nstr_is_blank(s));
+    entity_p ent = get_entity(s);
+    str_size_t r_bytes = s->bytes;
 
-    assert(sub != NULL);
-    assert(! nstr_is_blank(sub));
+    if (ent->verified && ent->encoding == encoding && s->encoding == encoding) return true;
+    return vtable[encoding].validate(touch(s)->start, &r_bytes);
+} // nstr_validate
 
-    assert(start != NULL);
-    assert(index != NULL);
+str_size_t nstr_count_chars(nstr_p s)
+{
+    s->chars = CHARS_UNKNOWN;
+    return get_chars(s);
+} // nstr_count_chars
 
-    if (! *start) {
-        *start = s->start;
-        size = s->bytes;
-        *index = 0;
-    } else {
-        *start += sub->bytes;
-        size = s->bytes - (*start - s->start);
-        *index += sub->chars;
-    } // if
+void nstr_set_index_policy(str_size_t min_bytes, uint32_t step)
+{
+    index_policy.min_bytes = min_bytes;
+    index_policy.step = (step > 0) ? step : INDEX_DEFAULT_STEP;
+} // nstr_set_index_policy
 
-    if (sub->bytes == 1) {
-        // 子串只包含单个字节
-        loc = memchr(*start, ((char_t *)sub->start)[0], size);
-    } else {
-        loc = memmem(*start, size, sub->start, sub->bytes);
-    } // if
-    if (! loc) {
-        *start = NULL; // 停止查找
-        *index = s->chars;
-        return STR_NOT_FOUND; // 找不到子串
+// 取得切片所引用实体的字符下标索引，必要时建立，不适用或内存不足时返回 NULL
+static ckpt_index_p get_index(nstr_p s)
+{
+    entity_p ent = get_entity(s);
+    ckpt_index_p idx = ent->index;
+    str_size_t chars = 0;
+    str_size_t cnt = 0;
+
+    if (idx) return idx;
+
+    // 只为已整体校验的多字节 UTF-8 大实体建立索引
+    if (index_policy.min_bytes == 0 || ent->bytes < index_policy.min_bytes) return NULL;
+    if (! (ent->verified && ent->encoding == STR_ENC_UTF8) || ent->ascii || s->encoding != STR_ENC_UTF8) return NULL;
+
+    chars = utf8_chars(entity_start(ent), ent->bytes);
+    cnt = (chars + index_policy.step - 1) / index_policy.step;
+    idx = malloc(sizeof(ckpt_index_t) + sizeof(idx->offs[0]) * cnt);
+    if (! idx) return NULL;
+
+    idx->step = index_policy.step;
+    idx->cnt = utf8_checkpoints(entity_start(ent), ent->bytes, idx->step, idx->offs, cnt);
+    return (ent->index = idx);
+} // get_index
+
+// 功能：借助字符下标索引定位字符下标对应的字节偏移量
+// 参数：
+//     s        IN  入参：源串或切片，起点必须落在字符边界上
+//     idx      IN  入参：字符下标索引
+//     index    IN  入参：字符下标
+//     offset   OUT 出参：字节偏移量，下标超出范围时为源串字节数
+// 返回值：
+//     true         下标在范围内（含串尾）
+//     false        下标超出范围
+static bool seek_by_index(nstr_p s, ckpt_index_p idx, str_size_t index, str_size_t * offset)
+{
+    const char_t * base = entity_start(get_entity(s));
+    str_size_t s_off = s->start - base;
+    str_size_t lo = 0;
+    str_size_t hi = idx->cnt;
+    str_size_t mid = 0;
+    uint64_t target = 0;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
+    str_size_t need = 0;
+
+    // 二分查找切片起点之前最近的检查点，得到起点在实体中的字符序号
+    while (hi - lo > 1) {
+        mid = lo + (hi - lo) / 2;
+        if (idx->offs[mid] <= s_off) {
+            lo = mid;
+        } else {
+            hi = mid;
+        } // if
+    } // while
+    target = (uint64_t)lo * idx->step + utf8_chars(base + idx->offs[lo], s_off - idx->offs[lo]) + index;
+
+    // 从目标字符之前最近的检查点开始计数
+    lo = (target / idx->step < idx->cnt) ? target / idx->step : idx->cnt - 1;
+    target -= (uint64_t)lo * idx->step;
+    need = (target < STR_SIZE_MAX) ? target : STR_SIZE_MAX; // 超出范围的下标，计数必然不足
+    r_bytes = get_entity(s)->bytes - idx->offs[lo];
+    r_chars = need;
+    utf8_count(base + idx->offs[lo], &r_bytes, &r_chars);
+
+    if (r_chars != need || idx->offs[lo] + r_bytes > s_off + s->bytes) {
+        *offset = s->bytes;
+        return false;
     } // if
 
-    bytes = loc - *start;
-    chars = s->chars; // 最大跳过字符数小于源串字符数
-    vtable[s->encoding].count(*start, &bytes, &chars);
-
-    *index += chars;
-    return bytes;
-} // nstr_next_sub
+    *offset = idx->offs[lo] + r_bytes - s_off;
+    return true;
+} // seek_by_index
 
-bool nstr_set_encoding(nstr_p s, str_encoding_t encoding)
+// 功能：定位倒数第 chars 个字符的字节偏移量，不足 chars 个字符时定位到串头
+// 返回值：
+//     >= 0         实际倒数的字符数
+inline static str_size_t locate_tail(nstr_p s, str_size_t chars, str_size_t * offset)
 {
-    uint32_t r_bytes = 0;
-    uint32_t r_chars = 0;
-    bool ret = false;
+    *offset = s->bytes - rseek_chars(s, s->start + s->bytes, &chars);
+    return chars;
+} // locate_tail
+
+// 功能：定位字符下标对应的字节偏移量
+// 参数：
+//     s        IN  入参：源串或切片
+//     index    IN  入参：字符下标，转为 str_ssize_t 后为负数时从串尾倒数
+//     offset   OUT 出参：字节偏移量，下标超出范围时为源串字节数，负下标超出串头时为 0
+// 返回值：
+//     true         下标在范围内（含串尾），或是负下标
+//     false        下标超出范围
+inline static bool locate(nstr_p s, str_size_t index, str_size_t * offset)
+{
+    ckpt_index_p idx = NULL;
+    str_size_t r_bytes = s->bytes;
+    str_size_t r_chars = index;
 
-    r_bytes = s->bytes;
-    r_chars = s->bytes; // 字符数上限为字节数
-    if ((ret = vtable[encoding].count(s->start, &r_bytes, &r_chars))) {
-        // 编码正确
-        s->chars = r_chars;
-        s->encoding = encoding;
+    if (index == 0) {
+        *offset = 0;
+        return true;
+    } // if
+    if ((str_ssize_t)index < 0) {
+        locate_tail(s, 0 - index, offset);
+        return true;
+    } // if
+    if (s->bytes < index || (s->chars != CHARS_UNKNOWN && s->chars < index)) {
+        // 字符数不会超过字节数，无需计数即可判定
+        *offset = s->bytes;
+        return false;
+    } // if
+    if (! s->ascii && (idx = get_index(s))) return seek_by_index(s, idx, index, offset);
+    if (! s->ascii && s->chars != CHARS_UNKNOWN && s->chars - index < index) {
+        // 目标字符靠近串尾，从串尾向前计数
+        locate_tail(s, s->chars - index, offset);
+        return true;
     } // if
-    return ret;
-} // nstr_set_encoding
 
-void nstr_narrow_down(nstr_p s, uint32_t index, uint32_t chars)
+    seek_chars(s, s->start, &r_bytes, &r_chars);
+    *offset = r_bytes;
+    return r_chars == index;
+} // locate
+
+void nstr_narrow_down(nstr_p s, str_size_t index, str_size_t chars)
 {
     const char_t * start = NULL;
-    uint32_t r_bytes = 0;
-    uint32_t r_chars = 0;
-
-    // TODO: Support negtive index and chars.
+    str_size_t offset = 0;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
+    str_size_t tail = 0;
+
+    touch(s);
+
+    if (chars == 0 || s->bytes == 0) {
+        offset = s->bytes;
+    } else if ((str_ssize_t)index < 0) {
+        // 负下标从串尾向前计数，倒数经过的字符数即为剩余部分的准确字符数
+        r_chars = locate_tail(s, 0 - index, &offset);
+    } else {
+        locate(s, index, &offset); // 下标超出范围时定位到串尾
+        if (s->ascii) {
+            r_chars = s->bytes - offset;
+        } else {
+            r_chars = (s->chars != CHARS_UNKNOWN) ? s->chars - index : CHARS_UNKNOWN;
+        } // if
+    } // if
 
     // CASE-1: 切片起点超出范围
     // CASE-2: 源串是空串
     // CASE-3: 切片长度是零
-    if (s->chars <= index || chars == 0 || s->chars == 0) {
-        s->bytes = 0;
+    if (offset == s->bytes) {
+        set_bytes(s, 0);
         s->chars = 0;
         return;
     } // if
 
     // CASE-4: 源字符串不是空串
-    start = s->start;
-    if (0 < index) {
-        // 跳过前导部分
-        r_bytes = s->bytes;
-        r_chars = index;
-        vtable[s->encoding].count(start, &r_bytes, &r_chars);
-        start += r_bytes;
-    } // if
+    start = s->start + offset;
 
     // 最大切片范围是剩余部分
-    r_bytes = s->bytes - r_bytes;
-    r_chars = s->chars - r_chars;
-    if (chars < r_chars) {
+    r_bytes = s->bytes - offset;
+    if (chars < r_chars && r_chars != CHARS_UNKNOWN && r_chars - chars < chars) {
+        // 切片结尾靠近串尾，从串尾向前去掉多余的字符
+        tail = r_chars - chars;
+        r_bytes -= rseek_chars(s, s->start + s->bytes, &tail);
+        r_chars = chars;
+    } else if (chars < r_chars) {
+        // 计数在 chars 个字符或剩余部分结尾处停止，结果即为切片的准确字符数
         r_chars = chars;
-        vtable[s->encoding].count(start, &r_bytes, &r_chars);
+        seek_chars(s, start, &r_bytes, &r_chars);
     } // if
 
     s->start = start;
-    s->bytes = r_bytes;
+    set_bytes(s, r_bytes);
     s->chars = r_chars;
 } // nstr_narrow_down
 
-nstr_p nstr_slice(nstr_p s, uint32_t index, uint32_t chars, nstr_p r)
+nstr_p nstr_slice(nstr_p s, str_size_t index, str_size_t chars, nstr_p r)
 {
+    nstr_t tmp;
+    bool ascii = s->ascii;
+
+    if (r && r->fixed) {
+        // 先在临时切片上定位，只把结果部分复制到定长串
+        init_slice(&tmp, false, s->start, s->ent, s->bytes, s->chars, s->encoding);
+        nstr_narrow_down(inherit_ascii(&tmp, ascii), index, chars);
+        r = copy_to_fixed(r, tmp.start, tmp.bytes, tmp.chars, tmp.encoding, tmp.ascii);
+        del_ref(&tmp);
+        return r;
+    } // if
+
     if (r) {
         refer_to_other(r, s->start, s->ent, s->bytes, s->chars, s->encoding);
     } else {
         r = new_slice(s->start, s->ent, s->bytes, s->chars, s->encoding);
     } // if
-    if (r) nstr_narrow_down(r, index, chars);
-    return r;
+    if (r) nstr_narrow_down(inherit_ascii(r, ascii), index, chars);
+    return apply_compact_policy(r);
 } // nstr_slice
 
 inline static int32_t augment_array(nstr_p ** as, int * cap, int delta)
 {
     nstr_array_p an = realloc(*as, sizeof((*as)[0]) * (*cap + delta)); // 数组扩容
-    if (! an) return 0;
+    if (! an) return STR_OUT_OF_MEMORY;
     *cap += delta;
     *as = an;
-    return STR_OUT_OF_MEMORY;
+    return 0;
 } // augment_array
 
-int nstr_split(nstr_p s, nstr_p deli, int max, nstr_array_p * as)
+static int split(nstr_p s, str_searcher_p sr, int max, nstr_array_p * as)
 {
     nstr_p new = NULL; // 新子串
-    const char_t * start = NULL; // 本次搜索起始地址
-    uint32_t index = 0; // 本次搜索起始下标
-    uint32_t last = 0; // 上次搜索起始下标
-    int32_t ret = 0; // 返回值 & 跳过字节数
+    const char_t * loc = NULL; // 本次查找结果地址
+    const char_t * begin = NULL; // 本段起始地址
+    const char_t * end = NULL; // 源串结尾地址
+    int32_t ret = 0; // 返回值
     int rmd = 0; // 剩余切分次数，零表示停止，负数表示无限次
     int cnt = 0; // 子串数量，用于下标时始终指向下一个可用元素
     int cap = 0; // 数组容量
     int delta = 0; // 减量
 
-    if (s->chars == 0) {
+    if (s->bytes == 0) {
         // CASE-1: 源串是空串
-        *as = malloc(sizeof(as[0]) * 2);
+        *as = malloc(sizeof((*as)[0]) * 2);
         if (! *as) return STR_OUT_OF_MEMORY;
         (*as)[0] = nstr_new_blank(s->encoding);
         (*as)[1] = NULL;
         return 1;
     } // if
 
-    assert(deli && ! nstr_is_blank(deli));
-
+    touch(s);
     rmd = (max > 0) ? max : -1;
     delta = (rmd > 0) ? 1 : 0;
 
@@ -400,24 +2391,31 @@ int nstr_split(nstr_p s, nstr_p deli, int max, nstr_array_p * as)
     *as = malloc(sizeof((*as)[0]) * cap);
     if (! *as) return STR_OUT_OF_MEMORY;
 
-    last = 0 - deli->chars;
-    while (rmd != 0) {
+    // 只按字节查找，子串的字符数在首次需要时计算
+    begin = s->start;
+    end = s->start + s->bytes;
+    while (rmd != 0 && (loc = str_searcher_find(sr, begin, end - begin))) {
         if (cnt >= cap - 2 && (ret = augment_array(as, &cap, 16)) < 0) goto NSTR_SPLIT_ERROR;
 
-        ret = nstr_next_sub(s, deli, &start, &index);
-        if (ret == STR_NOT_FOUND) rmd = delta; // 退出查找
-
-        new = new_slice(start, &ref_ent, ret, index - (last + deli->chars), s->encoding);
+        new = apply_compact_policy(inherit_ascii(new_slice(begin, get_entity(s), loc - begin, lazy_chars(loc - begin, s->encoding), s->encoding), s->ascii));
         if (! new) {
             ret = STR_OUT_OF_MEMORY;
             goto NSTR_SPLIT_ERROR;
         } // if
 
         (*as)[cnt++] = new;
-        last = index;
+        begin = loc + sr->bytes;
         rmd -= delta;
     } // while
 
+    // 最后的子串
+    new = apply_compact_policy(inherit_ascii(new_slice(begin, get_entity(s), end - begin, lazy_chars(end - begin, s->encoding), s->encoding), s->ascii));
+    if (! new) {
+        ret = STR_OUT_OF_MEMORY;
+        goto NSTR_SPLIT_ERROR;
+    } // if
+
+    (*as)[cnt++] = new;
     (*as)[cnt] = NULL; // 设置终止标志
     ret = cnt;
     return ret;
@@ -425,11 +2423,27 @@ int nstr_split(nstr_p s, nstr_p deli, int max, nstr_array_p * as)
 NSTR_SPLIT_ERROR:
     nstr_delete_array(as, cnt);
     return ret;
+} // split
+
+int nstr_split(nstr_p s, nstr_p deli, int max, nstr_array_p * as)
+{
+    str_searcher_t sr;
+
+    if (s->bytes > 0) {
+        assert(deli && ! nstr_is_blank(deli));
+        str_searcher_init(&sr, touch(deli)->start, deli->bytes);
+    } // if
+    return split(s, &sr, max, as);
 } // nstr_split
 
-typedef char_t * (*copy_strings_t)(char_t * pos, nstr_p * as, int n, const char_t * dbuf, int32_t dbytes);
+int nstr_split_by(nstr_p s, nstr_searcher_p sr, int max, nstr_array_p * as)
+{
+    return split(s, use_searcher(sr), max, as);
+} // nstr_split_by
+
+typedef char_t * (*copy_strings_t)(char_t * pos, nstr_p * as, int n, const char_t * dbuf, str_size_t dbytes);
 
-static char_t * copy_strings(char_t * pos, nstr_p * as, int n, const char_t * dbuf, int32_t dbytes)
+static char_t * copy_strings(char_t * pos, nstr_p * as, int n, const char_t * dbuf, str_size_t dbytes)
 {
     int i = 0;
     int b = n / 4;
@@ -455,7 +2469,7 @@ static char_t * copy_strings(char_t * pos, nstr_p * as, int n, const char_t * db
     return pos;
 } // copy_strings
 
-static char_t * copy_strings_with_short_deli(char_t * pos, nstr_p * as, int n, const char_t * dbuf, int32_t dbytes)
+static char_t * copy_strings_with_short_deli(char_t * pos, nstr_p * as, int n, const char_t * dbuf, str_size_t dbytes)
 {
     int i = 0;
     int b = n / 4;
@@ -485,7 +2499,7 @@ static char_t * copy_strings_with_short_deli(char_t * pos, nstr_p * as, int n, c
     return pos;
 } // copy_strings_with_short_deli
 
-static char_t * copy_strings_with_long_deli(char_t * pos, nstr_p * as, int n, const char_t * dbuf, int32_t dbytes)
+static char_t * copy_strings_with_long_deli(char_t * pos, nstr_p * as, int n, const char_t * dbuf, str_size_t dbytes)
 {
     int i = 0;
     int b = n / 4;
@@ -519,7 +2533,8 @@ static char_t * copy_strings_with_long_deli(char_t * pos, nstr_p * as, int n, co
     return pos;
 } // copy_strings_with_long_deli
 
-static entity_p join_strings(nstr_p deli, nstr_p * as, int n, va_list * ap, uint32_t * chars)
+// verified 传入间隔符是否已校验，传出结果是否已按第一部分的编码校验
+static entity_p join_strings(nstr_p deli, nstr_p * as, int n, va_list * ap, str_size_t * chars, bool * ascii, bool * verified)
 {
     va_list cp;
     copy_strings_t copy = &copy_strings;
@@ -527,17 +2542,21 @@ static entity_p join_strings(nstr_p deli, nstr_p * as, int n, va_list * ap, uint
     nstr_p * as2 = NULL;
     char_t * pos = NULL;
     const char_t * dbuf = NULL;
-    uint32_t bytes = 0;
-    int32_t dbytes = 0;
+    str_size_t bytes = 0;
+    str_size_t dbytes = 0;
     int i = 0;
     int n2 = 0;
     int cnt = 0;
 
-    // 第一遍：计算总字节数
+    // 第一遍：计算总字节数，字符数只在各部分均已知时累加，各部分均为纯 ASCII 或均已按第一部分的编码校验时结果也是
+    *ascii = (! deli || deli->ascii);
     cnt += n;
     for (i = 0; i < n; ++i) {
+        touch(as[i]);
         bytes += as[i]->bytes;
-        *chars += as[i]->chars;
+        *chars = sum_chars(*chars, as[i]->chars);
+        *ascii = *ascii && as[i]->ascii;
+        *verified = *verified && verified_as(as[i], as[0]->encoding);
     } // for
 
     va_copy(cp, *ap);
@@ -545,8 +2564,11 @@ static entity_p join_strings(nstr_p deli, nstr_p * as, int n, va_list * ap, uint
         n2 = va_arg(cp, int);
         cnt += n2;
         for (i = 0; i < n2; ++i) {
+            touch(as2[i]);
             bytes += (as2[i])->bytes;
-            *chars += (as2[i])->chars;
+            *chars = sum_chars(*chars, (as2[i])->chars);
+            *ascii = *ascii && (as2[i])->ascii;
+            *verified = *verified && verified_as(as2[i], as[0]->encoding);
         } // for
     } // while
     va_end(cp);
@@ -554,11 +2576,15 @@ static entity_p join_strings(nstr_p deli, nstr_p * as, int n, va_list * ap, uint
     if (cnt == 0) return &blank_ent;
 
     if (deli && deli->bytes > 0) {
-        dbuf = deli->start;
+        dbuf = touch(deli)->start;
         dbytes = deli->bytes;
 
         bytes += dbytes * cnt; // 字节总数包含尾部间隔符，简化拷贝逻辑
-        *chars += deli->chars * (cnt - 1); // 字符总数不包含尾部间隔符
+        if (deli->chars != CHARS_UNKNOWN) {
+            *chars = sum_chars(*chars, deli->chars * (cnt - 1)); // 字符总数不包含尾部间隔符
+        } else {
+            *chars = CHARS_UNKNOWN;
+        } // if
 
         copy = (deli->bytes == 1) ? &copy_strings_with_short_deli : &copy_strings_with_long_deli;
     } // if
@@ -567,7 +2593,7 @@ static entity_p join_strings(nstr_p deli, nstr_p * as, int n, va_list * ap, uint
     if (! ent) return NULL;
 
     // 第二遍：拷贝字节数据
-    pos = copy(ent->data, as, n, dbuf, dbytes);
+    pos = copy(entity_data(ent), as, n, dbuf, dbytes);
 
     va_copy(cp, *ap);
     while ((as2 = va_arg(cp, nstr_p *))) {
@@ -576,10 +2602,25 @@ static entity_p join_strings(nstr_p deli, nstr_p * as, int n, va_list * ap, uint
     va_end(cp);
 
     ent->bytes -= dbytes; // 去掉多余的尾部间隔符
-    ent->data[ent->bytes] = 0; // 设置终止 NUL 字符
+    entity_data(ent)[ent->bytes] = 0; // 设置终止 NUL 字符
     return ent;
 } // join_strings
 
+// 生成引用新实体的结果切片，失败时释放实体
+// verified 表示各组成部分均已按 encoding 校验，此时新实体无需再次校验
+inline static nstr_p refer_to_new_entity(nstr_p r, entity_p ent, str_size_t chars, str_encoding_t encoding, bool ascii, bool verified)
+{
+    nstr_p new = NULL;
+
+    // 去重前标记，命中已有实体时不改动其校验结果
+    if (ent->need_free) ent->ascii |= ascii;
+    if (ent->need_free && verified) mark_verified(ent, encoding);
+    ent = share_entity(ent);
+    new = refer_to_or_new_slice(r, entity_data(ent), ent, ent->bytes, chars, encoding);
+    if (ent->slcs == 0 && ent->need_free) free_entity(ent); // 生成失败，或结果已复制到定长串
+    return new;
+} // refer_to_new_entity
+
 nstr_p nstr_repeat(nstr_p s, int n, nstr_p r)
 {
     nstr_p as[16] = {
@@ -590,7 +2631,6 @@ nstr_p nstr_repeat(nstr_p s, int n, nstr_p r)
     };
     char_t * pos = NULL;
     entity_p ent = NULL;
-    nstr_p new = NULL;
     int32_t b = 0;
 
     if (s->bytes == 0 || n <= 1) return refer_to_whole(r, s); // CASE-1: s 是空串
@@ -598,201 +2638,762 @@ nstr_p nstr_repeat(nstr_p s, int n, nstr_p r)
     ent = new_entity(s->bytes * n);
     if (! ent) return NULL;
 
-    pos = copy_strings(ent->data, as, n % (sizeof(as) / sizeof(as[0])), NULL, 0);
+    touch(s);
+
+    pos = copy_strings(entity_data(ent), as, n % (sizeof(as) / sizeof(as[0])), NULL, 0);
 
     b = n / (sizeof(as) / sizeof(as[0]));
     while (b-- > 0) pos = copy_strings(pos, as, (sizeof(as) / sizeof(as[0])), NULL, 0);
+    *pos = 0; // 设置终止 NUL 字符
 
-    new = new_slice(ent->data, 0, ent->bytes, s->bytes * n, s->encoding);
-    if (! new) free(ent);
-    return new;
+    return refer_to_new_entity(r, ent, (s->chars != CHARS_UNKNOWN ? s->chars * n : CHARS_UNKNOWN), s->encoding, s->ascii, verified_as(s, s->encoding));
 } // repeat
 
 nstr_p nstr_concat(nstr_p * as, int n, nstr_p r, ...)
 {
     va_list ap;
     entity_p ent = NULL;
-    nstr_p new = NULL;
-    uint32_t chars = 0;
+    str_size_t chars = 0;
+    bool ascii = false;
+    bool verified = true;
 
     va_start(ap, r);
-    ent = join_strings(NULL, as, n, &ap, &chars);
+    ent = join_strings(NULL, as, n, &ap, &chars, &ascii, &verified);
     va_end(ap);
     if (! ent) return NULL;
 
-    new = new_slice(ent->data, 0, ent->bytes, chars, as[0]->encoding);
-    if (! new) free(ent);
-    return new;
+    return refer_to_new_entity(r, ent, chars, as[0]->encoding, ascii, verified);
 } // nstr_concat
 
 nstr_p nstr_concat2(nstr_p s1, nstr_p s2, nstr_p r)
 {
     entity_p ent = NULL;
-    nstr_p new = NULL;
-    uint32_t bytes = 0;
+    str_size_t bytes = 0;
 
     bytes = s1->bytes + s2->bytes;
-    if (bytes == 0) return refer_to_or_new_slice(r, blank_ent.data, 0, 0, 0, s1->encoding);
+    if (bytes == 0) return refer_to_or_new_slice(r, blank_ent.data, &blank_ent, 0, 0, s1->encoding);
+
+    if (r && r->fixed && ! fixed_overlaps(r, s1) && ! fixed_overlaps(r, s2)) {
+        // 直接写入定长串缓冲区，无需临时实体
+        if (bytes > fixed_capacity(r)) return NULL;
+        memcpy(fixed_buffer(r), touch(s1)->start, s1->bytes);
+        memcpy(fixed_buffer(r) + s1->bytes, touch(s2)->start, s2->bytes);
+        return settle_fixed(r, bytes, sum_chars(s1->chars, s2->chars), s1->encoding, s1->ascii && s2->ascii);
+    } // if
 
     ent = new_entity(bytes);
     if (! ent) return NULL;
 
-    memcpy(ent->data, s1->start, s1->bytes);
-    memcpy(ent->data + s1->bytes, s2->start, s2->bytes);
-    ent->data[bytes] = 0;
+    memcpy(entity_data(ent), touch(s1)->start, s1->bytes);
+    memcpy(entity_data(ent) + s1->bytes, touch(s2)->start, s2->bytes);
+    entity_data(ent)[bytes] = 0;
 
-    new = new_slice(ent->data, 0, ent->bytes, s1->chars + s2->chars, s1->encoding);
-    if (! new) free(ent);
-    return new;
+    return refer_to_new_entity(r, ent, sum_chars(s1->chars, s2->chars), s1->encoding, s1->ascii && s2->ascii, verified_as(s1, s1->encoding) && verified_as(s2, s1->encoding));
 } // nstr_concat2
 
 nstr_p nstr_concat3(nstr_p s1, nstr_p s2, nstr_p s3, nstr_p r)
 {
     entity_p ent = NULL;
-    nstr_p new = NULL;
-    uint32_t bytes = 0;
+    str_size_t bytes = 0;
 
     bytes = s1->bytes + s2->bytes + s3->bytes;
-    if (bytes == 0) return refer_to_or_new_slice(r, blank_ent.data, 0, 0, 0, s1->encoding);
+    if (bytes == 0) return refer_to_or_new_slice(r, blank_ent.data, &blank_ent, 0, 0, s1->encoding);
+
+    if (r && r->fixed && ! fixed_overlaps(r, s1) && ! fixed_overlaps(r, s2) && ! fixed_overlaps(r, s3)) {
+        // 直接写入定长串缓冲区，无需临时实体
+        if (bytes > fixed_capacity(r)) return NULL;
+        copy3(fixed_buffer(r), touch(s1)->start, s1->bytes, touch(s2)->start, s2->bytes, touch(s3)->start, s3->bytes);
+        return settle_fixed(r, bytes, sum_chars(sum_chars(s1->chars, s2->chars), s3->chars), s1->encoding, s1->ascii && s2->ascii && s3->ascii);
+    } // if
 
     ent = new_entity(bytes);
     if (! ent) return NULL;
 
-    copy3(ent->data, s1->start, s1->bytes, s2->start, s2->bytes, s3->start, s3->bytes);
+    copy3(entity_data(ent), touch(s1)->start, s1->bytes, touch(s2)->start, s2->bytes, touch(s3)->start, s3->bytes);
 
-    new = new_slice(ent->data, 0, ent->bytes, s1->chars + s2->chars + s3->chars, s1->encoding);
-    if (! new) free(ent);
-    return new;
+    return refer_to_new_entity(r, ent, sum_chars(sum_chars(s1->chars, s2->chars), s3->chars), s1->encoding, s1->ascii && s2->ascii && s3->ascii, verified_as(s1, s1->encoding) && verified_as(s2, s1->encoding) && verified_as(s3, s1->encoding));
 } // nstr_concat3
 
 nstr_p nstr_join(nstr_p deli, nstr_p * as, int n, nstr_p r, ...)
 {
     va_list ap;
     entity_p ent = NULL;
-    nstr_p new = NULL;
-    uint32_t chars = 0;
+    str_size_t chars = 0;
+    bool ascii = false;
+    bool verified = deli ? verified_as(deli, as[0]->encoding) : true;
 
     va_start(ap, r);
-    ent = join_strings(deli, as, n, &ap, &chars);
+    ent = join_strings(deli, as, n, &ap, &chars, &ascii, &verified);
     va_end(ap);
     if (! ent) return NULL;
 
-    new = new_slice(ent->data, 0, ent->bytes, chars, as[0]->encoding);
-    if (! new) free(ent);
-    return new;
+    return refer_to_new_entity(r, ent, chars, as[0]->encoding, ascii, verified);
 } // nstr_join
 
 nstr_p nstr_join_by_char(char_t deli, nstr_p * as, int n, nstr_p r, ...)
 {
     va_list ap;
-    nstr_t d = {0};
+    nstr_t d = {.start = &deli, .ent = &nstr_literal_entity, .bytes = 1, .chars = 1, .ascii = (deli < 0x80), .encoding = STR_ENC_ASCII};
     entity_p ent = NULL;
-    nstr_p new = NULL;
-    uint32_t chars = 0;
+    str_size_t chars = 0;
+    bool ascii = false;
+    bool verified = (deli < 0x80); // ASCII 间隔符按任何编码都有效
 
-    init_slice(&d, false, &deli, &ref_ent, 1, 1, STR_ENC_ASCII);
+    // 临时间隔符不持有实体引用，无需设置和撤销
     va_start(ap, r);
-    ent = join_strings(&d, as, n, &ap, &chars);
+    ent = join_strings(&d, as, n, &ap, &chars, &ascii, &verified);
     va_end(ap);
-    del_ref(get_entity(&d));
     if (! ent) return NULL;
 
-    new = new_slice(ent->data, 0, ent->bytes, chars, as[0]->encoding);
-    if (! new) free(ent);
-    return new;
+    return refer_to_new_entity(r, ent, chars, as[0]->encoding, ascii, verified);
 } // nstr_join_by_char
 
-nstr_p nstr_replace(nstr_p s, uint32_t index, uint32_t chars, nstr_p to, nstr_p r)
+// 功能：将给定字节范围替换成新串
+// 参数：
+//     s        IN  入参：源串或切片
+//     p1_bytes IN  入参：跳过部分的字节数
+//     p2_bytes IN  入参：待替换部分的字节数
+//     to       IN  入参：新串
+//     chars    IN  入参：结果的字符数，CHARS_UNKNOWN 表示未知
+//     r        IO  入参：NULL 表示生成新切片，否则重设该切片
+static nstr_p replace_bytes(nstr_p s, str_size_t p1_bytes, str_size_t p2_bytes, nstr_p to, str_size_t chars, nstr_p r)
 {
     entity_p ent = NULL;
-    nstr_p new = NULL;
-    uint32_t p1_bytes = 0;
-    uint32_t p2_bytes = 0;
-    uint32_t p3_bytes = 0;
-    uint32_t bytes = 0;
-    uint32_t p1_chars = 0;
-    uint32_t p2_chars = 0;
-    uint32_t p3_chars = 0;
-
-    p1_chars = index; // 跳过部分
-    p2_chars = s->chars - p1_chars; // 待替换部分
-    if (chars < p2_chars) p2_chars = chars;
-    p3_chars = s->chars - p1_chars - p2_chars;
+    str_size_t p3_bytes = 0;
+    str_size_t bytes = 0;
 
-    if (to->chars == 0) return refer_to_whole(r, s); // CASE: 替换部分零长度
-
-    if (p1_chars > 0) {
-        p1_bytes = s->bytes;
-        vtable[s->encoding].count(s->start, &p1_bytes, &p1_chars);
-    } // if
-    if (p2_chars > 0) {
-        p2_bytes = s->bytes - p1_bytes;
-        vtable[s->encoding].count(s->start + p1_bytes, &p2_bytes, &p2_chars);
-    } // if
+    if (p2_bytes == 0 && to->bytes == 0) return refer_to_whole(r, s); // CASE: 内容不变
 
     p3_bytes = s->bytes - p1_bytes - p2_bytes;
     bytes = p1_bytes + to->bytes + p3_bytes;
+    if (bytes == 0) return refer_to_or_new_slice(r, blank_ent.data, &blank_ent, 0, 0, s->encoding);
+
+    if (r && r->fixed && ! fixed_overlaps(r, s) && ! fixed_overlaps(r, to)) {
+        // 直接写入定长串缓冲区，无需临时实体
+        if (bytes > fixed_capacity(r)) return NULL;
+        copy3(fixed_buffer(r), touch(s)->start, p1_bytes, touch(to)->start, to->bytes, s->start + p1_bytes + p2_bytes, p3_bytes);
+        return settle_fixed(r, bytes, chars, s->encoding, s->ascii && to->ascii);
+    } // if
 
     ent = new_entity(bytes);
     if (! ent) return NULL;
 
-    copy3(ent->data, s->start, p1_bytes, to->start, to->bytes, s->start + p1_bytes + p2_bytes, p3_bytes);
+    copy3(entity_data(ent), touch(s)->start, p1_bytes, touch(to)->start, to->bytes, s->start + p1_bytes + p2_bytes, p3_bytes);
+    return refer_to_new_entity(r, ent, chars, s->encoding, s->ascii && to->ascii, verified_as(s, s->encoding) && verified_as(to, s->encoding));
+} // replace_bytes
 
-    new = refer_to_or_new_slice(r, ent->data, 0, bytes, p1_chars + to->chars + p3_chars, s->encoding);
-    if (! new) free(ent);
-    return new;
+nstr_p nstr_replace(nstr_p s, str_size_t index, str_size_t chars, nstr_p to, nstr_p r)
+{
+    str_size_t p1_bytes = 0;
+    str_size_t p2_bytes = 0;
+    str_size_t p2_chars = 0;
+    str_size_t r_chars = CHARS_UNKNOWN;
+
+    // 跳过部分，下标超出范围时追加到串尾，负下标从串尾倒数
+    locate(touch(s), index, &p1_bytes);
+
+    // 待替换部分
+    p2_bytes = s->bytes - p1_bytes;
+    p2_chars = chars;
+    if (chars > 0) {
+        seek_chars(s, s->start + p1_bytes, &p2_bytes, &p2_chars);
+    } else {
+        p2_bytes = 0;
+    } // if
+
+    if (s->chars != CHARS_UNKNOWN) r_chars = sum_chars(s->chars - p2_chars, to->chars);
+    return replace_bytes(s, p1_bytes, p2_bytes, to, r_chars, r);
 } // nstr_replace
 
-nstr_p nstr_replace_with_char(nstr_p s, uint32_t index, uint32_t chars, char_t ch, nstr_p r)
+nstr_p nstr_replace_with_char(nstr_p s, str_size_t index, str_size_t chars, char_t ch, nstr_p r)
 {
-    nstr_t to = {0};
-    nstr_p new = NULL;
-
-    init_slice(&to, false, &ch, &ref_ent, 1, 1, STR_ENC_ASCII);
-    new = nstr_replace(s, index, chars, &to, r);
-    del_ref(get_entity(&to));
-    return new;
+    nstr_t to = {.start = &ch, .ent = &nstr_literal_entity, .bytes = 1, .chars = 1, .ascii = (ch < 0x80), .encoding = STR_ENC_ASCII};
+    return nstr_replace(s, index, chars, &to, r);
 } // nstr_replace_with_char
 
-nstr_p nstr_remove(nstr_p s, uint32_t index, uint32_t chars, nstr_p r)
+nstr_p nstr_remove(nstr_p s, str_size_t index, str_size_t chars, nstr_p r)
 {
-    nstr_t b = {.start = blank_ent.data, .encoding = s->encoding };
-    return nstr_replace(s, index, chars, &b, r);
+    return nstr_replace(s, index, chars, &blank_str, r);
 } // nstr_remove
 
-nstr_p nstr_cut_head(nstr_p s, uint32_t chars, nstr_p r)
+nstr_p nstr_cut_head(nstr_p s, str_size_t chars, nstr_p r)
 {
-    nstr_t b = {.start = blank_ent.data, .encoding = s->encoding };
-    // CASE-1: 删除长度大于字符串长度
-    if (s->chars < chars) return refer_to_or_new_slice(r, blank_ent.data, 0, 0, 0, s->encoding);
-    return nstr_replace(s, 0, chars, &b, r);
+    return nstr_replace(s, 0, chars, &blank_str, r);
 } // nstr_cut_head
 
-nstr_p nstr_cut_tail(nstr_p s, uint32_t chars, nstr_p r)
+nstr_p nstr_cut_tail(nstr_p s, str_size_t chars, nstr_p r)
 {
-    nstr_t b = {.start = blank_ent.data, .encoding = s->encoding };
-    // CASE-1: 删除长度大于字符串长度
-    if (s->chars < chars) return refer_to_or_new_slice(r, blank_ent.data, 0, 0, 0, s->encoding);
-    return nstr_replace(s, s->chars - chars, chars, &b, r);
+    // CASE-1: 删除长度大于字符串长度（字符数不会超过字节数，无需计数即可判定）
+    if (s->bytes < chars) return refer_to_or_new_slice(r, blank_ent.data, &blank_ent, 0, 0, s->encoding);
+
+    // CASE-2: 从串尾倒数定位删除部分，不经过串头部分；不足 chars 个字符时全部删除
+    return nstr_replace(s, 0 - chars, chars, &blank_str, r);
 } // nstr_cut_tail
 
-nstr_p nstr_substitute(nstr_p s, bool all, nstr_p from, nstr_p to, nstr_p r)
+// 收窄到字节范围 [begin, end) ，去掉的部分都是单字节字符
+static nstr_p narrow_bytes(nstr_p s, const char_t * begin, const char_t * end, nstr_p r)
+{
+    str_size_t chars = (s->chars == CHARS_UNKNOWN) ? CHARS_UNKNOWN : s->chars - (s->bytes - (end - begin));
+    bool ascii = s->ascii;
+
+    return apply_compact_policy(inherit_ascii(refer_to_or_new_slice(r, begin, get_entity(s), end - begin, chars, s->encoding), ascii));
+} // narrow_bytes
+
+nstr_p nstr_chomp(nstr_p s, nstr_p r)
+{
+    const char_t * end = NULL;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    end = touch(s)->start + s->bytes;
+    if (end > s->start && end[-1] == '\n') {
+        --end;
+        if (end > s->start && end[-1] == '\r') --end; // 只有紧接换行符之前的回车符才一并删除
+    } // if
+    return narrow_bytes(s, s->start, end, r);
+} // nstr_chomp
+
+nstr_p nstr_trim(nstr_p s, nstr_p r)
+{
+    const char_t * begin = NULL;
+    const char_t * end = NULL;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    end = touch(s)->start + s->bytes;
+    begin = str_byteset_skip(&str_byteset_space, s->start, end);
+    if (! begin) return narrow_bytes(s, end, end, r); // 全部是空白字符
+    return narrow_bytes(s, begin, str_byteset_rskip(&str_byteset_space, begin, end), r);
+} // nstr_trim
+
+nstr_p nstr_ltrim(nstr_p s, nstr_p r)
+{
+    const char_t * begin = NULL;
+    const char_t * end = NULL;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    end = touch(s)->start + s->bytes;
+    begin = str_byteset_skip(&str_byteset_space, s->start, end);
+    return narrow_bytes(s, (begin ? begin : end), end, r);
+} // nstr_ltrim
+
+nstr_p nstr_rtrim(nstr_p s, nstr_p r)
+{
+    assert(s->encoding != STR_ENC_UTF16);
+
+    touch(s);
+    return narrow_bytes(s, s->start, str_byteset_rskip(&str_byteset_space, s->start, s->start + s->bytes), r);
+} // nstr_rtrim
+
+#define SUBST_STACK_LOCS 64 // 栈上记录的匹配位置数，超出时改用堆缓冲区
+
+// 功能：替换全部子串，一次查找记录全部匹配位置，按准确长度一次复制到新实体
+// 参数：
+//     s            IN  入参：源串或切片，不能是空串
+//     sr           IN  入参：待替换子串的查找器
+//     from_chars   IN  入参：待替换子串的字符数，CHARS_UNKNOWN 表示未知
+//     to           IN  入参：新串
+//     r            IO  入参：NULL 表示生成新切片，否则重设该切片
+// 说明：
+//     没有匹配时直接引用源串，不分配内存。
+static nstr_p substitute_all(nstr_p s, str_searcher_p sr, str_size_t from_chars, nstr_p to, nstr_p r)
+{
+    str_size_t stack[SUBST_STACK_LOCS]; // 匹配位置（字节偏移量）
+    str_size_t * locs = stack;
+    str_size_t * more = NULL;
+    str_size_t cap = SUBST_STACK_LOCS;
+    str_size_t cnt = 0; // 匹配次数
+    const char_t * loc = NULL;
+    const char_t * begin = NULL;
+    const char_t * end = NULL;
+    char_t * pos = NULL;
+    entity_p ent = NULL;
+    nstr_p new = NULL;
+    str_size_t bytes = 0;
+    str_size_t chars = 0;
+    str_size_t i = 0;
+
+    begin = touch(s)->start;
+    end = s->start + s->bytes;
+    while ((loc = str_searcher_find(sr, begin, end - begin))) {
+        if (cnt == cap) {
+            // 缓冲区扩容，首次扩容时从栈上复制
+            more = realloc((locs == stack) ? NULL : locs, sizeof(locs[0]) * cap * 2);
+            if (! more) goto NSTR_SUBSTITUTE_ALL_ERROR;
+            if (locs == stack) memcpy(more, stack, sizeof(stack));
+            locs = more;
+            cap *= 2;
+        } // if
+
+        locs[cnt++] = loc - s->start;
+        begin = loc + sr->bytes;
+    } // while
+
+    if (cnt == 0) return refer_to_whole(r, s); // CASE-1: 没有匹配
+
+    bytes = s->bytes - cnt * sr->bytes + cnt * to->bytes;
+    if (bytes == 0) {
+        // CASE-2: 全部内容被替换为空串
+        new = refer_to_or_new_slice(r, blank_ent.data, &blank_ent, 0, 0, s->encoding);
+        goto NSTR_SUBSTITUTE_ALL_END;
+    } // if
+
+    ent = new_entity(bytes);
+    if (! ent) goto NSTR_SUBSTITUTE_ALL_ERROR;
+
+    // CASE-3: 按记录的位置交替复制原有部分和新串
+    touch(to);
+    pos = entity_data(ent);
+    begin = s->start;
+    for (i = 0; i < cnt; ++i) {
+        memcpy(pos, begin, s->start + locs[i] - begin);
+        pos += s->start + locs[i] - begin;
+        memcpy(pos, to->start, to->bytes);
+        pos += to->bytes;
+        begin = s->start + locs[i] + sr->bytes;
+    } // for
+    memcpy(pos, begin, end - begin);
+    pos[end - begin] = 0; // 设置终止 NUL 字符
+
+    if (s->chars != CHARS_UNKNOWN && from_chars != CHARS_UNKNOWN && to->chars != CHARS_UNKNOWN) {
+        chars = s->chars - cnt * from_chars + cnt * to->chars;
+    } else {
+        chars = lazy_chars(bytes, s->encoding);
+    } // if
+    new = refer_to_new_entity(r, ent, chars, s->encoding, s->ascii && to->ascii, verified_as(s, s->encoding) && verified_as(to, s->encoding));
+
+NSTR_SUBSTITUTE_ALL_END:
+    if (locs != stack) free(locs);
+    return new;
+
+NSTR_SUBSTITUTE_ALL_ERROR:
+    if (locs != stack) free(locs);
+    return NULL;
+} // substitute_all
+
+// 功能：替换子串
+// 参数：
+//     s            IN  入参：源串或切片
+//     all          IN  入参：是否替换全部子串
+//     sr           IN  入参：待替换子串的查找器
+//     from_chars   IN  入参：待替换子串的字符数，CHARS_UNKNOWN 表示未知
+//     to           IN  入参：新串
+//     r            IO  入参：NULL 表示生成新切片，否则重设该切片
+static nstr_p substitute(nstr_p s, bool all, str_searcher_p sr, str_size_t from_chars, nstr_p to, nstr_p r)
 {
-    nstr_array_p as = NULL; // 子串数组
-    const char_t * start = NULL; // 遍历变量
-    uint32_t p1_bytes = 0; // 跳过字节数
-    uint32_t index = 0; // 待替换串下标
-    int cnt = 0; // 子串数
+    const char_t * loc = NULL; // 待替换串地址
+    str_size_t chars = 0; // 结果字符数
+
+    if (all) return substitute_all(s, sr, from_chars, to, r);
 
-    if (all) {
-        cnt = nstr_split(s, from, -1, &as);
-        if (cnt < 0) return NULL;
-        return nstr_join(to, as, cnt, r, NULL);
+    if (s->bytes == 0 || ! (loc = str_searcher_find(sr, touch(s)->start, s->bytes))) return refer_to_whole(r, s);
+    if (s->chars != CHARS_UNKNOWN && from_chars != CHARS_UNKNOWN) {
+        chars = sum_chars(s->chars - from_chars, to->chars);
+    } else {
+        chars = lazy_chars(s->bytes - sr->bytes + to->bytes, s->encoding);
     } // if
+    return replace_bytes(s, loc - s->start, sr->bytes, to, chars, r);
+} // substitute
+
+nstr_p nstr_substitute(nstr_p s, bool all, nstr_p from, nstr_p to, nstr_p r)
+{
+    str_searcher_t sr;
 
-    p1_bytes = nstr_next_sub(s, from, &start, &index);
-    if (p1_bytes == STR_UNKNOWN_BYTE) return NULL;
-    if (p1_bytes == STR_NOT_FOUND) return refer_to_whole(r, s);
+    if (s->bytes == 0) return refer_to_whole(r, s); // CASE: 源串是空串，无可替换
 
-    return nstr_replace(s, index, from->chars, to, r);
+    assert(from && ! nstr_is_blank(from));
+    str_searcher_init(&sr, touch(from)->start, from->bytes);
+    return substitute(s, all, &sr, from->chars, to, r);
 } // nstr_substitute
+
+nstr_p nstr_substitute_by(nstr_p s, bool all, nstr_searcher_p sr, nstr_p to, nstr_p r)
+{
+    if (s->bytes == 0) return refer_to_whole(r, s); // CASE: 源串是空串，无可替换
+    return substitute(s, all, use_searcher(sr), sr->pattern->chars, to, r);
+} // nstr_substitute_by
+
+#define PAIRS_STACK_HITS 64 // 栈上记录的匹配数，超出时改用堆缓冲区
+
+typedef struct PAIRS_HIT {
+    str_size_t      offset;         // 匹配的字节偏移量
+    int32_t         id;             // 替换对编号
+} pairs_hit_t;
+
+// 功能：编译 from 串的自动机和首字节集合
+static str_acm_p compile_pairs(nstr_p * pairs, int n, str_byteset_p firsts)
+{
+    const char_t ** starts = NULL;
+    str_size_t * bytes = NULL;
+    char_t * heads = NULL;
+    str_acm_p ac = NULL;
+    int i = 0;
+
+    starts = malloc(sizeof(starts[0]) * (n + 1));
+    bytes = malloc(sizeof(bytes[0]) * (n + 1));
+    heads = malloc(n + 1);
+    if (! starts || ! bytes || ! heads) goto NSTR_COMPILE_PAIRS_END;
+
+    for (i = 0; i < n; ++i) {
+        assert(pairs[i * 2] && ! nstr_is_blank(pairs[i * 2]));
+        assert(pairs[i * 2 + 1] != NULL);
+        starts[i] = touch(pairs[i * 2])->start;
+        bytes[i] = pairs[i * 2]->bytes;
+        heads[i] = starts[i][0];
+    } // for
+
+    str_byteset_init(firsts, heads, n);
+    ac = str_acm_new(starts, bytes, n);
+
+NSTR_COMPILE_PAIRS_END:
+    free(heads);
+    free(bytes);
+    free(starts);
+    return ac;
+} // compile_pairs
+
+// 功能：按最左最长规则替换多对子串
+// 参数：
+//     s        IN  入参：源串或切片
+//     ac       IN  入参：from 串的自动机
+//     firsts   IN  入参：from 串的首字节集合
+//     to       IN  入参：to 串数组，第 i 对的 to 串是 to[i * stride]
+//     stride   IN  入参：to 串数组的步长
+//     r        IO  入参：NULL 表示生成新切片，否则重设该切片
+static nstr_p substitute_pairs(nstr_p s, str_acm_p ac, const str_byteset_t * firsts, nstr_p * to, int stride, nstr_p r)
+{
+    pairs_hit_t stack[PAIRS_STACK_HITS];
+    pairs_hit_t * hits = stack;
+    pairs_hit_t * more = NULL;
+    str_size_t cap = PAIRS_STACK_HITS;
+    str_size_t cnt = 0; // 匹配次数
+    const char_t * pos = NULL;
+    const char_t * begin = NULL;
+    const char_t * end = NULL;
+    char_t * dst = NULL;
+    entity_p ent = NULL;
+    nstr_p new = NULL;
+    nstr_p t = NULL;
+    str_size_t removed = 0; // 被替换部分的字节数
+    str_size_t added = 0; // 新串的字节数
+    str_size_t bytes = 0;
+    str_size_t i = 0;
+    int32_t id = 0;
+    bool ascii = s->ascii;
+    bool verified = verified_as(s, s->encoding);
+
+    pos = touch(s)->start;
+    end = s->start + s->bytes;
+    while (pos < end && (pos = str_byteset_find(firsts, pos, end))) {
+        id = str_acm_longest(ac, pos, end);
+        if (id == STR_ACM_NO_OUTPUT) {
+            ++pos; // 首字节相同但不匹配
+            continue;
+        } // if
+
+        if (cnt == cap) {
+            // 缓冲区扩容，首次扩容时从栈上复制
+            more = realloc((hits == stack) ? NULL : hits, sizeof(hits[0]) * cap * 2);
+            if (! more) goto NSTR_SUBSTITUTE_PAIRS_ERROR;
+            if (hits == stack) memcpy(more, stack, sizeof(stack));
+            hits = more;
+            cap *= 2;
+        } // if
+
+        t = to[id * stride];
+        hits[cnt].offset = pos - s->start;
+        hits[cnt++].id = id;
+        removed += ac->lens[id];
+        added += t->bytes;
+        ascii = ascii && t->ascii;
+        verified = verified && verified_as(t, s->encoding);
+        pos += ac->lens[id]; // 替换部分不再参与匹配
+    } // while
+
+    if (cnt == 0) return refer_to_whole(r, s); // CASE-1: 没有匹配
+
+    bytes = s->bytes - removed + added;
+    if (bytes == 0) {
+        // CASE-2: 全部内容被替换为空串
+        new = refer_to_or_new_slice(r, blank_ent.data, &blank_ent, 0, 0, s->encoding);
+        goto NSTR_SUBSTITUTE_PAIRS_END;
+    } // if
+
+    ent = new_entity(bytes);
+    if (! ent) goto NSTR_SUBSTITUTE_PAIRS_ERROR;
+
+    // CASE-3: 按记录的位置交替复制原有部分和新串
+    dst = entity_data(ent);
+    begin = s->start;
+    for (i = 0; i < cnt; ++i) {
+        t = touch(to[hits[i].id * stride]);
+        memcpy(dst, begin, s->start + hits[i].offset - begin);
+        dst += s->start + hits[i].offset - begin;
+        memcpy(dst, t->start, t->bytes);
+        dst += t->bytes;
+        begin = s->start + hits[i].offset + ac->lens[hits[i].id];
+    } // for
+    memcpy(dst, begin, end - begin);
+    dst[end - begin] = 0; // 设置终止 NUL 字符
+
+    new = refer_to_new_entity(r, ent, (ascii ? bytes : lazy_chars(bytes, s->encoding)), s->encoding, ascii, verified);
+
+NSTR_SUBSTITUTE_PAIRS_END:
+    if (hits != stack) free(hits);
+    return new;
+
+NSTR_SUBSTITUTE_PAIRS_ERROR:
+    if (hits != stack) free(hits);
+    return NULL;
+} // substitute_pairs
+
+nstr_replacer_p nstr_new_replacer(nstr_p * pairs, int n)
+{
+    nstr_replacer_p new = NULL;
+    int i = 0;
+
+    assert(n >= 0);
+
+    new = calloc(1, sizeof(nstr_replacer_t) + sizeof(new->to[0]) * n);
+    if (! new) return NULL;
+
+    new->acm = compile_pairs(pairs, n, &new->firsts);
+    if (! new->acm) goto NSTR_NEW_REPLACER_ERROR;
+
+    // 持有 to 串的引用；定长串的缓冲区不能借用，需要复制
+    for (i = 0; i < n; ++i) {
+        new->to[i] = pairs[i * 2 + 1]->fixed ? nstr_clone(pairs[i * 2 + 1]) : nstr_duplicate(pairs[i * 2 + 1]);
+        if (! new->to[i]) goto NSTR_NEW_REPLACER_ERROR;
+        new->n = i + 1;
+    } // for
+    return new;
+
+NSTR_NEW_REPLACER_ERROR:
+    nstr_delete_replacer(new);
+    return NULL;
+} // nstr_new_replacer
+
+void nstr_delete_replacer(nstr_replacer_p rp)
+{
+    int i = 0;
+
+    if (! rp) return; // NULL 指针
+
+    for (i = 0; i < rp->n; ++i) nstr_delete(rp->to[i]);
+    str_acm_delete(rp->acm);
+    free(rp);
+} // nstr_delete_replacer
+
+nstr_p nstr_substitute_pairs(nstr_p s, nstr_p * pairs, int n, nstr_p r)
+{
+    str_byteset_t firsts;
+    str_acm_p ac = NULL;
+    nstr_p new = NULL;
+
+    if (s->bytes == 0 || n <= 0) return refer_to_whole(r, s); // CASE: 源串是空串或没有替换对，无可替换
+
+    // 临时自动机只在本次调用中使用，to 串无需持有引用
+    ac = compile_pairs(pairs, n, &firsts);
+    if (! ac) return NULL;
+
+    new = substitute_pairs(s, ac, &firsts, pairs + 1, 2, r);
+    str_acm_delete(ac);
+    return new;
+} // nstr_substitute_pairs
+
+nstr_p nstr_substitute_with(nstr_p s, nstr_replacer_p rp, nstr_p r)
+{
+    if (s->bytes == 0 || rp->n == 0) return refer_to_whole(r, s); // CASE: 源串是空串或没有替换对，无可替换
+    return substitute_pairs(s, rp->acm, &rp->firsts, rp->to, 1, r);
+} // nstr_substitute_with
+
+// 功能：转换大小写
+// 参数：
+//     kind     IN  映射类型（UCD_CASE_LOWER/UCD_CASE_UPPER/UCD_CASE_FOLD）
+// 说明：
+//     纯 ASCII 内容按字节转换，字节数不变；UTF-8 内容先计算结果的确切字节数，再一次写入新实体。
+static nstr_p convert_case(nstr_p s, uint32_t kind, nstr_p r)
+{
+    char_t lo = (kind == UCD_CASE_UPPER) ? 'a' : 'A';
+    char_t * pos = NULL;
+    entity_p ent = NULL;
+    str_size_t first = 0;   // 第一个发生变化的字节的偏移量
+    str_size_t extra = 0;   // 增加的字符数
+    str_size_t bytes = 0;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    touch(s);
+    if (s->ascii || s->encoding != STR_ENC_UTF8) {
+        first = ascii_case_span(s->start, s->bytes, lo);
+        bytes = s->bytes;
+    } else {
+        bytes = ucd_case_measure(s->start, s->bytes, kind, &first, &extra);
+    } // if
+    if (first == s->bytes) return refer_to_whole(r, s); // CASE-1: 已是目标大小写，只增加引用
+
+    ent = new_entity(bytes);
+    if (! ent) return NULL;
+
+    // CASE-2: 复制没有变化的开头部分，转换其余部分
+    pos = entity_data(ent);
+    memcpy(pos, s->start, first);
+    if (s->ascii || s->encoding != STR_ENC_UTF8) {
+        ascii_case_convert(pos + first, s->start + first, s->bytes - first, lo);
+    } else {
+        ucd_case_convert(pos + first, s->start + first, s->bytes - first, kind);
+    } // if
+    pos[bytes] = 0; // 设置终止 NUL 字符
+
+    return refer_to_new_entity(r, ent, (s->chars != CHARS_UNKNOWN) ? s->chars + extra : CHARS_UNKNOWN, s->encoding, s->ascii, verified_as(s, s->encoding));
+} // convert_case
+
+nstr_p nstr_to_lower(nstr_p s, nstr_p r)
+{
+    return convert_case(s, UCD_CASE_LOWER, r);
+} // nstr_to_lower
+
+nstr_p nstr_to_upper(nstr_p s, nstr_p r)
+{
+    return convert_case(s, UCD_CASE_UPPER, r);
+} // nstr_to_upper
+
+nstr_p nstr_case_fold(nstr_p s, nstr_p r)
+{
+    return convert_case(s, UCD_CASE_FOLD, r);
+} // nstr_case_fold
+
+#define NORM_STACK_SPANS 16 // 栈上记录的规范化片段数，超出时改用堆缓冲区
+
+// 需要改写的片段：源串中的字节范围及规范化结果在缓冲区中的字节数
+typedef struct NORM_SPAN {
+    str_size_t      begin;
+    str_size_t      end;
+    str_size_t      bytes;
+} norm_span_t;
+
+// 功能：逐段规范化快速检查不通过的片段，记录结果与源内容不同者
+// 参数：
+//     s        IN  入参：UTF-8 源串或切片
+//     form     IN  入参：规范化形式
+//     out      IO  入参：结果缓冲区，依次存放各片段的规范化结果
+//     spans    IO  入参：片段记录，初始指向栈上缓冲区，容量不足时改用堆缓冲区
+//     cap      IO  入参：片段记录容量
+//     stack    IN  入参：栈上的片段记录缓冲区
+// 返回值：
+//     >= 0         需要改写的片段数
+//     < 0          内存不足
+static int64_t normalize_spans(nstr_p s, str_norm_form_t form, ucd_buffer_p out, norm_span_t ** spans, str_size_t * cap, norm_span_t * stack)
+{
+    norm_span_t * more = NULL;
+    str_size_t begin = 0;
+    str_size_t end = 0;
+    str_size_t used = 0;
+    str_size_t off = 0;
+    int64_t cnt = 0;
+
+    while (off < s->bytes) {
+        begin = off + ucd_norm_span(s->start + off, s->bytes - off, form, &end);
+        if (begin == s->bytes) break;
+        end += off;
+        off = end;
+
+        used = out->used;
+        if (! ucd_normalize(s->start + begin, end - begin, form, out)) return -1;
+        if (out->used - used == end - begin && memcmp(out->data + used, s->start + begin, end - begin) == 0) {
+            out->used = used; // 检查结果为 MAYBE 的片段规范化后不变，丢弃
+            continue;
+        } // if
+
+        if ((str_size_t)cnt == *cap) {
+            // 缓冲区扩容，首次扩容时从栈上复制
+            more = realloc((*spans == stack) ? NULL : *spans, sizeof(more[0]) * (*cap) * 2);
+            if (! more) return -1;
+            if (*spans == stack) memcpy(more, stack, sizeof(stack[0]) * (*cap));
+            *spans = more;
+            *cap *= 2;
+        } // if
+
+        (*spans)[cnt].begin = begin;
+        (*spans)[cnt].end = end;
+        (*spans)[cnt].bytes = out->used - used;
+        ++cnt;
+    } // while
+    return cnt;
+} // normalize_spans
+
+nstr_p nstr_normalize(nstr_p s, str_norm_form_t form, nstr_p r)
+{
+    norm_span_t stack[NORM_STACK_SPANS];
+    norm_span_t * spans = stack;
+    ucd_buffer_t out = {0};
+    str_size_t cap = NORM_STACK_SPANS;
+    const char_t * norm = NULL;
+    const char_t * begin = NULL;
+    char_t * pos = NULL;
+    entity_p ent = NULL;
+    nstr_p new = NULL;
+    str_size_t bytes = 0;
+    int64_t cnt = 0;
+    int64_t i = 0;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    touch(s);
+    if (s->ascii || s->encoding != STR_ENC_UTF8) return refer_to_whole(r, s); // CASE-1: ASCII 字符不受规范化影响
+
+    cnt = normalize_spans(s, form, &out, &spans, &cap, stack);
+    if (cnt < 0) goto NSTR_NORMALIZE_END;
+    if (cnt == 0) {
+        // CASE-2: 已是规范化形式，只增加引用
+        new = refer_to_whole(r, s);
+        goto NSTR_NORMALIZE_END;
+    } // if
+
+    bytes = s->bytes;
+    for (i = 0; i < cnt; ++i) bytes = bytes - (spans[i].end - spans[i].begin) + spans[i].bytes;
+
+    ent = new_entity(bytes);
+    if (! ent) goto NSTR_NORMALIZE_END;
+
+    // CASE-3: 交替复制原有部分和规范化结果
+    pos = entity_data(ent);
+    begin = s->start;
+    norm = out.data;
+    for (i = 0; i < cnt; ++i) {
+        memcpy(pos, begin, s->start + spans[i].begin - begin);
+        pos += s->start + spans[i].begin - begin;
+        memcpy(pos, norm, spans[i].bytes);
+        pos += spans[i].bytes;
+        norm += spans[i].bytes;
+        begin = s->start + spans[i].end;
+    } // for
+    memcpy(pos, begin, s->start + s->bytes - begin);
+    pos[s->start + s->bytes - begin] = 0; // 设置终止 NUL 字符
+
+    new = refer_to_new_entity(r, ent, lazy_chars(bytes, STR_ENC_UTF8), STR_ENC_UTF8, false, verified_as(s, STR_ENC_UTF8));
+
+NSTR_NORMALIZE_END:
+    if (spans != stack) free(spans);
+    free(out.data);
+    return new;
+} // nstr_normalize
+
+bool nstr_is_normalized(nstr_p s, str_norm_form_t form)
+{
+    norm_span_t stack[NORM_STACK_SPANS];
+    norm_span_t * spans = stack;
+    ucd_buffer_t out = {0};
+    str_size_t cap = NORM_STACK_SPANS;
+    int64_t cnt = 0;
+
+    assert(s->encoding != STR_ENC_UTF16);
+
+    touch(s);
+    if (s->ascii || s->encoding != STR_ENC_UTF8) return true;
+
+    cnt = normalize_spans(s, form, &out, &spans, &cap, stack);
+    if (spans != stack) free(spans);
+    free(out.data);
+    return cnt == 0;
+} // nstr_is_normalized
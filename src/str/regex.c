@@ -0,0 +1,1339 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "str/utf8.h"
+#include "str/search.h"
+#include "str/regex.h"
+
+// 引用: Russ Cox. Regular Expression Matching: the Virtual Machine Approach. 2009.
+// 引用: Russ Cox. Regular Expression Matching in the Wild. 2010.（惰性 DFA 与 Pike VM 的配合）
+
+#define RE_MAX_INSTS    (1 << 16)   // 程序指令数上限
+#define RE_MAX_REPEAT   1000        // 计数重复上限
+#define RE_MAX_DEPTH    200         // 分组嵌套深度上限
+#define RE_MAX_PREFIX   64          // 字面量前缀字节数上限
+#define RE_NONE         UINT32_MAX  // 空链接、尚未计算的转移
+#define RE_DEAD         0           // 死状态编号
+#define RE_DFA_FULL     (RE_NONE - 1)  // 缓存已满
+#define RE_SEEDS(re)    ((re)->cnt * 3 + 1)     // 栈中暂存种子的起始位置，之前的部分用于闭包计算
+
+enum {
+    OP_BYTE = 0,    // 字节在 [lo, hi] 范围内时前进到 x
+    OP_SPLIT,       // 优先尝试 x ，其次尝试 y
+    OP_JMP,         // 跳转到 x
+    OP_SAVE,        // 记录当前位置到 y 号槽，继续 x
+    OP_BOL,         // 源串开头
+    OP_EOL,         // 源串结尾
+    OP_MATCH,       // 匹配成功
+};
+
+enum {
+    NODE_EMPTY = 0,
+    NODE_SET,       // 码点集合
+    NODE_CAT,       // 连接
+    NODE_ALT,       // 选择
+    NODE_REPEAT,    // 重复
+    NODE_GROUP,     // 分组
+    NODE_BOL,
+    NODE_EOL,
+};
+
+enum {
+    STATE_MATCH = 1,    // 到达此状态即匹配成功
+    STATE_EOL_MATCH = 2,// 在源串结尾处停在此状态时匹配成功
+};
+
+typedef struct RE_INST {
+    uint8_t         op;
+    uint8_t         lo;
+    uint8_t         hi;
+    uint32_t        x;
+    uint32_t        y;
+} re_inst_t;
+
+typedef struct RE_RANGE {
+    uchar_t         lo;
+    uchar_t         hi;
+} re_range_t;
+
+typedef struct RE_RANGES {
+    re_range_t *    v;
+    uint32_t        cnt;
+    uint32_t        cap;
+} re_ranges_t;
+
+typedef struct RE_NODE {
+    uint32_t        type;
+    int32_t         min;        // 重复次数下限
+    int32_t         max;        // 重复次数上限，-1 表示无上限
+    bool            greedy;
+    int32_t         group;      // 捕获分组编号，-1 表示不捕获
+    struct RE_NODE * left;
+    struct RE_NODE * right;
+    re_ranges_t     set;        // 有序、不重叠的码点区间
+    struct RE_NODE * chain;     // 全部节点串成链表，便于释放
+} re_node_t, *re_node_p;
+
+typedef struct RE_PARSER {
+    const char_t *  start;
+    const char_t *  pos;
+    const char_t *  end;
+    re_node_p       all;
+    uint32_t        groups;
+    uint32_t        depth;
+    int32_t         err;
+} re_parser_t, *re_parser_p;
+
+typedef struct RE_PROG {
+    re_inst_t *     insts;
+    uint32_t        cnt;
+    uint32_t        cap;
+    int32_t         err;
+} re_prog_t, *re_prog_p;
+
+// UTF-8 字节区间序列，用于把码点区间编译成字节指令
+typedef struct RE_SEQ {
+    uint8_t         lo[4];
+    uint8_t         hi[4];
+    uint32_t        len;
+} re_seq_t;
+
+typedef struct RE_SEQS {
+    re_seq_t *      v;
+    uint32_t        cnt;
+    uint32_t        cap;
+} re_seqs_t;
+
+typedef struct RE_DFA {
+    uint32_t *      trans;      // 转移表，states × 256
+    uint8_t *       flags;      // 各状态的标志
+    uint32_t *      offs;       // 各状态的指令集合在 pool 中的偏移量
+    uint32_t *      lens;       // 各状态的指令集合大小
+    uint32_t        states;
+    uint32_t        cap;
+    uint32_t *      pool;       // 指令集合
+    uint32_t        pool_used;
+    uint32_t        pool_cap;
+    uint32_t *      table;      // 散列表，存放状态编号 + 1
+    uint32_t        table_cap;
+    uint32_t        start[2];   // 不在 / 在源串开头时的起始状态
+    size_t          used;       // 已使用的字节数
+    bool            anchored;   // 锚定 DFA 只从起始位置尝试匹配
+} re_dfa_t, *re_dfa_p;
+
+// Pike VM 的线程列表
+typedef struct RE_LIST {
+    uint32_t *      sparse;     // 稀疏集合，记录已加入的指令
+    uint32_t *      dense;
+    uint32_t        n;
+    uint32_t *      pcs;        // 线程的指令，按优先级排列
+    const char_t ** caps;       // 线程的分组位置，threads × slots
+    uint32_t        threads;
+} re_list_t, *re_list_p;
+
+typedef struct RE_JOB {
+    uint32_t        pc;
+    uint32_t        slot;       // RE_NONE 表示执行指令，否则表示恢复分组位置
+    const char_t *  old;
+} re_job_t;
+
+struct STR_REGEX {
+    re_inst_t *     insts;
+    uint32_t        cnt;
+    uint32_t        groups;
+    uint32_t        slots;
+    re_dfa_t        dfa[2];     // 非锚定、锚定 DFA
+    str_searcher_t  prefix;     // 字面量前缀查找器
+    char_t          literal[RE_MAX_PREFIX];
+    uint32_t *      sparse;     // DFA 计算闭包用的稀疏集合
+    uint32_t *      dense;
+    uint32_t *      kept;       // 闭包中保留的指令
+    uint32_t *      stack;
+    re_list_t       list[2];
+    re_job_t *      jobs;
+    const char_t ** work;       // 加入线程时的工作分组位置
+    const char_t ** found;      // 匹配线程的分组位置
+};
+
+// ---- 解析 ----
+
+static re_node_p new_node(re_parser_p p, uint32_t type, re_node_p left, re_node_p right)
+{
+    re_node_p nd = calloc(1, sizeof(re_node_t));
+    if (! nd) {
+        p->err = STR_REGEX_OUT_OF_MEMORY;
+        return NULL;
+    } // if
+
+    nd->type = type;
+    nd->group = -1;
+    nd->greedy = true;
+    nd->left = left;
+    nd->right = right;
+    nd->chain = p->all;
+    p->all = nd;
+    return nd;
+} // new_node
+
+static bool add_range(re_ranges_t * rs, uchar_t lo, uchar_t hi)
+{
+    re_range_t * v = NULL;
+
+    if (rs->cnt == rs->cap) {
+        v = realloc(rs->v, sizeof(rs->v[0]) * (rs->cap ? rs->cap * 2 : 4));
+        if (! v) return false;
+        rs->v = v;
+        rs->cap = rs->cap ? rs->cap * 2 : 4;
+    } // if
+    rs->v[rs->cnt].lo = lo;
+    rs->v[rs->cnt].hi = hi;
+    rs->cnt += 1;
+    return true;
+} // add_range
+
+static int compare_range(const void * a, const void * b)
+{
+    const re_range_t * x = a;
+    const re_range_t * y = b;
+    return (x->lo > y->lo) - (x->lo < y->lo);
+} // compare_range
+
+// 排序并合并相交、相邻的区间
+static void normalize(re_ranges_t * rs)
+{
+    uint32_t i = 0;
+    uint32_t k = 0;
+
+    if (rs->cnt == 0) return;
+    qsort(rs->v, rs->cnt, sizeof(rs->v[0]), compare_range);
+    for (i = 1; i < rs->cnt; ++i) {
+        if (rs->v[i].lo <= rs->v[k].hi + 1) {
+            if (rs->v[i].hi > rs->v[k].hi) rs->v[k].hi = rs->v[i].hi;
+        } else {
+            rs->v[++k] = rs->v[i];
+        } // if
+    } // for
+    rs->cnt = k + 1;
+} // normalize
+
+// 对规范化后的区间取补集
+static bool negate(re_ranges_t * rs)
+{
+    re_ranges_t out = {0};
+    uchar_t lo = 0;
+    uint32_t i = 0;
+
+    for (i = 0; i < rs->cnt; ++i) {
+        if (rs->v[i].lo > lo && ! add_range(&out, lo, rs->v[i].lo - 1)) goto RE_NEGATE_ERROR;
+        lo = rs->v[i].hi + 1;
+    } // for
+    if (lo <= 0x10FFFF && ! add_range(&out, lo, 0x10FFFF)) goto RE_NEGATE_ERROR;
+
+    free(rs->v);
+    *rs = out;
+    return true;
+
+RE_NEGATE_ERROR:
+    free(out.v);
+    return false;
+} // negate
+
+// 把 \d \w \s 及其大写形式代表的集合加入 rs
+static bool add_class(re_ranges_t * rs, char_t name)
+{
+    re_ranges_t tmp = {0};
+    bool ok = true;
+    uint32_t i = 0;
+
+    switch (name | 0x20) {
+        case 'd':
+            ok = add_range(&tmp, '0', '9');
+            break;
+        case 'w':
+            ok = add_range(&tmp, '0', '9') && add_range(&tmp, 'A', 'Z') && add_range(&tmp, '_', '_') && add_range(&tmp, 'a', 'z');
+            break;
+        default:
+            ok = add_range(&tmp, '\t', '\r') && add_range(&tmp, ' ', ' ');
+            break;
+    } // switch
+
+    if (ok && name < 'a') ok = negate(&tmp);
+    for (i = 0; ok && i < tmp.cnt; ++i) ok = add_range(rs, tmp.v[i].lo, tmp.v[i].hi);
+    free(tmp.v);
+    return ok;
+} // add_class
+
+// 解码模式串中的一个字符，模式串可能在多字节字符中间结束
+static bool next_char(re_parser_p p, uchar_t * ch)
+{
+    char_t seq[4] = {0};
+    int32_t bytes = 0;
+
+    if (p->pos >= p->end) return false;
+    memcpy(seq, p->pos, (p->end - p->pos < 4) ? p->end - p->pos : 4);
+    bytes = utf8_decode(seq, ch);
+    if (bytes < 0 || bytes > p->end - p->pos) return false;
+    p->pos += bytes;
+    return true;
+} // next_char
+
+// 解析 \ 之后的转义字符，*cls 返回类别名（0 表示单个字符）
+static bool parse_escape(re_parser_p p, uchar_t * ch, char_t * cls)
+{
+    char_t c = 0;
+
+    *cls = 0;
+    if (p->pos >= p->end) return false;
+    c = *p->pos;
+    if (c >= 0x80) return next_char(p, ch);
+
+    p->pos += 1;
+    switch (c) {
+        case 'd': case 'D': case 'w': case 'W': case 's': case 'S':
+            *cls = c;
+            return true;
+        case 'n': *ch = '\n'; return true;
+        case 't': *ch = '\t'; return true;
+        case 'r': *ch = '\r'; return true;
+        case 'f': *ch = '\f'; return true;
+        case 'v': *ch = '\v'; return true;
+        case '0': *ch = '\0'; return true;
+        default: break;
+    } // switch
+
+    // 未定义的字母、数字转义留作将来扩展
+    if ((c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) return false;
+    *ch = c;
+    return true;
+} // parse_escape
+
+static re_node_p parse_class(re_parser_p p)
+{
+    re_node_p nd = NULL;
+    bool neg = false;
+    bool first = true;
+    uchar_t lo = 0;
+    uchar_t hi = 0;
+    char_t cls = 0;
+
+    nd = new_node(p, NODE_SET, NULL, NULL);
+    if (! nd) return NULL;
+
+    if (p->pos < p->end && *p->pos == '^') {
+        neg = true;
+        p->pos += 1;
+    } // if
+
+    for (;; first = false) {
+        if (p->pos >= p->end) goto RE_PARSE_CLASS_ERROR;
+        if (*p->pos == ']' && ! first) break;
+
+        if (*p->pos == '\\') {
+            p->pos += 1;
+            if (! parse_escape(p, &lo, &cls)) goto RE_PARSE_CLASS_ERROR;
+            if (cls) {
+                if (! add_class(&nd->set, cls)) goto RE_PARSE_CLASS_NOMEM;
+                continue;
+            } // if
+        } else if (! next_char(p, &lo)) {
+            goto RE_PARSE_CLASS_ERROR;
+        } // if
+
+        hi = lo;
+        if (p->end - p->pos >= 2 && p->pos[0] == '-' && p->pos[1] != ']') {
+            p->pos += 1;
+            if (*p->pos == '\\') {
+                p->pos += 1;
+                if (! parse_escape(p, &hi, &cls) || cls) goto RE_PARSE_CLASS_ERROR;
+            } else if (! next_char(p, &hi)) {
+                goto RE_PARSE_CLASS_ERROR;
+            } // if
+            if (lo > hi) goto RE_PARSE_CLASS_ERROR;
+        } // if
+        if (! add_range(&nd->set, lo, hi)) goto RE_PARSE_CLASS_NOMEM;
+    } // for
+
+    p->pos += 1; // ]
+    normalize(&nd->set);
+    if (neg && ! negate(&nd->set)) goto RE_PARSE_CLASS_NOMEM;
+    return nd;
+
+RE_PARSE_CLASS_NOMEM:
+    p->err = STR_REGEX_OUT_OF_MEMORY;
+    return NULL;
+
+RE_PARSE_CLASS_ERROR:
+    p->err = STR_REGEX_BAD_SYNTAX;
+    return NULL;
+} // parse_class
+
+static re_node_p parse_alt(re_parser_p p);
+
+static re_node_p parse_atom(re_parser_p p)
+{
+    re_node_p nd = NULL;
+    re_node_p inner = NULL;
+    int32_t group = -1;
+    uchar_t ch = 0;
+    char_t cls = 0;
+
+    switch (*p->pos) {
+        case '(':
+            p->pos += 1;
+            if (++p->depth > RE_MAX_DEPTH) goto RE_PARSE_ATOM_ERROR;
+            if (p->end - p->pos >= 2 && p->pos[0] == '?' && p->pos[1] == ':') {
+                p->pos += 2;
+            } else {
+                group = ++p->groups;
+            } // if
+
+            inner = parse_alt(p);
+            if (! inner) return NULL;
+            if (p->pos >= p->end || *p->pos != ')') goto RE_PARSE_ATOM_ERROR;
+            p->pos += 1;
+            p->depth -= 1;
+
+            nd = new_node(p, NODE_GROUP, inner, NULL);
+            if (nd) nd->group = group;
+            return nd;
+
+        case '[':
+            p->pos += 1;
+            return parse_class(p);
+
+        case '.':
+            p->pos += 1;
+            nd = new_node(p, NODE_SET, NULL, NULL);
+            if (nd && (! add_range(&nd->set, 0, '\n' - 1) || ! add_range(&nd->set, '\n' + 1, 0x10FFFF))) goto RE_PARSE_ATOM_NOMEM;
+            return nd;
+
+        case '^':
+            p->pos += 1;
+            return new_node(p, NODE_BOL, NULL, NULL);
+
+        case '$':
+            p->pos += 1;
+            return new_node(p, NODE_EOL, NULL, NULL);
+
+        case '*': case '+': case '?':
+            goto RE_PARSE_ATOM_ERROR; // 没有可重复的内容
+
+        case '\\':
+            p->pos += 1;
+            if (! parse_escape(p, &ch, &cls)) goto RE_PARSE_ATOM_ERROR;
+            break;
+
+        default:
+            if (! next_char(p, &ch)) goto RE_PARSE_ATOM_ERROR;
+            break;
+    } // switch
+
+    nd = new_node(p, NODE_SET, NULL, NULL);
+    if (! nd) return NULL;
+    if (cls ? ! add_class(&nd->set, cls) : ! add_range(&nd->set, ch, ch)) goto RE_PARSE_ATOM_NOMEM;
+    normalize(&nd->set);
+    return nd;
+
+RE_PARSE_ATOM_NOMEM:
+    p->err = STR_REGEX_OUT_OF_MEMORY;
+    return NULL;
+
+RE_PARSE_ATOM_ERROR:
+    p->err = STR_REGEX_BAD_SYNTAX;
+    return NULL;
+} // parse_atom
+
+static bool parse_number(re_parser_p p, int32_t * num)
+{
+    if (p->pos >= p->end || *p->pos < '0' || *p->pos > '9') return false;
+    for (*num = 0; p->pos < p->end && *p->pos >= '0' && *p->pos <= '9'; ++p->pos) {
+        *num = *num * 10 + (*p->pos - '0');
+        if (*num > RE_MAX_REPEAT) *num = RE_MAX_REPEAT + 1; // 防止溢出，稍后报错
+    } // for
+    return true;
+} // parse_number
+
+// 解析 {n} {n,} {n,m} ，不符合格式时恢复位置，'{' 按普通字符处理
+static int parse_count(re_parser_p p, int32_t * min, int32_t * max)
+{
+    const char_t * saved = p->pos;
+
+    p->pos += 1; // {
+    if (! parse_number(p, min)) goto RE_PARSE_COUNT_LITERAL;
+    *max = *min;
+    if (p->pos < p->end && *p->pos == ',') {
+        p->pos += 1;
+        if (! parse_number(p, max)) *max = -1;
+    } // if
+    if (p->pos >= p->end || *p->pos != '}') goto RE_PARSE_COUNT_LITERAL;
+    p->pos += 1;
+
+    if (*min > RE_MAX_REPEAT || *max > RE_MAX_REPEAT || (*max >= 0 && *min > *max)) return -1;
+    return 1;
+
+RE_PARSE_COUNT_LITERAL:
+    p->pos = saved;
+    return 0;
+} // parse_count
+
+static re_node_p parse_repeat(re_parser_p p)
+{
+    re_node_p nd = NULL;
+    int32_t min = 0;
+    int32_t max = 0;
+    int r = 0;
+
+    nd = parse_atom(p);
+    while (nd && p->pos < p->end) {
+        switch (*p->pos) {
+            case '*': min = 0; max = -1; p->pos += 1; break;
+            case '+': min = 1; max = -1; p->pos += 1; break;
+            case '?': min = 0; max = 1; p->pos += 1; break;
+            case '{':
+                r = parse_count(p, &min, &max);
+                if (r < 0) {
+                    p->err = STR_REGEX_BAD_SYNTAX;
+                    return NULL;
+                } // if
+                if (r == 0) return nd;
+                break;
+            default:
+                return nd;
+        } // switch
+
+        nd = new_node(p, NODE_REPEAT, nd, NULL);
+        if (! nd) return NULL;
+        nd->min = min;
+        nd->max = max;
+        if (p->pos < p->end && *p->pos == '?') {
+            nd->greedy = false;
+            p->pos += 1;
+        } // if
+    } // while
+    return nd;
+} // parse_repeat
+
+static re_node_p parse_cat(re_parser_p p)
+{
+    re_node_p nd = NULL;
+    re_node_p item = NULL;
+
+    nd = new_node(p, NODE_EMPTY, NULL, NULL);
+    while (nd && p->pos < p->end && *p->pos != '|' && *p->pos != ')') {
+        item = parse_repeat(p);
+        if (! item) return NULL;
+        nd = (nd->type == NODE_EMPTY) ? item : new_node(p, NODE_CAT, nd, item);
+    } // while
+    return nd;
+} // parse_cat
+
+static re_node_p parse_alt(re_parser_p p)
+{
+    re_node_p nd = NULL;
+    re_node_p right = NULL;
+
+    nd = parse_cat(p);
+    while (nd && p->pos < p->end && *p->pos == '|') {
+        p->pos += 1;
+        right = parse_cat(p);
+        if (! right) return NULL;
+        nd = new_node(p, NODE_ALT, nd, right);
+    } // while
+    return nd;
+} // parse_alt
+
+// ---- 编译 ----
+
+static uint32_t emit(re_prog_p pg, uint8_t op, uint32_t x, uint32_t y)
+{
+    re_inst_t * insts = NULL;
+
+    if (pg->err) return 0;
+    if (pg->cnt == RE_MAX_INSTS) {
+        pg->err = STR_REGEX_TOO_LARGE;
+        return 0;
+    } // if
+    if (pg->cnt == pg->cap) {
+        insts = realloc(pg->insts, sizeof(pg->insts[0]) * (pg->cap ? pg->cap * 2 : 64));
+        if (! insts) {
+            pg->err = STR_REGEX_OUT_OF_MEMORY;
+            return 0;
+        } // if
+        pg->insts = insts;
+        pg->cap = pg->cap ? pg->cap * 2 : 64;
+    } // if
+
+    pg->insts[pg->cnt].op = op;
+    pg->insts[pg->cnt].lo = 0;
+    pg->insts[pg->cnt].hi = 0;
+    pg->insts[pg->cnt].x = (x == RE_NONE) ? pg->cnt + 1 : x;
+    pg->insts[pg->cnt].y = y;
+    return pg->cnt++;
+} // emit
+
+// 设置跳转目标，出错后指令数组可能无效，不再修改
+inline static void patch(re_prog_p pg, uint32_t pc, bool first, uint32_t target)
+{
+    if (pg->err) return;
+    if (first) {
+        pg->insts[pc].x = target;
+    } else {
+        pg->insts[pc].y = target;
+    } // if
+} // patch
+
+// 非贪婪重复：交换 split 指令的分支优先级
+inline static void prefer_skip(re_prog_p pg, uint32_t pc)
+{
+    uint32_t x = 0;
+
+    if (pg->err) return;
+    x = pg->insts[pc].x;
+    pg->insts[pc].x = pg->insts[pc].y;
+    pg->insts[pc].y = x;
+} // prefer_skip
+
+static bool push_seq(re_seqs_t * ss, uchar_t lo, uchar_t hi)
+{
+    re_seq_t * v = NULL;
+    char_t a[4] = {0};
+    char_t b[4] = {0};
+    uint32_t i = 0;
+
+    if (ss->cnt == ss->cap) {
+        v = realloc(ss->v, sizeof(ss->v[0]) * (ss->cap ? ss->cap * 2 : 8));
+        if (! v) return false;
+        ss->v = v;
+        ss->cap = ss->cap ? ss->cap * 2 : 8;
+    } // if
+
+    ss->v[ss->cnt].len = utf8_encode(lo, a);
+    utf8_encode(hi, b);
+    for (i = 0; i < ss->v[ss->cnt].len; ++i) {
+        ss->v[ss->cnt].lo[i] = a[i];
+        ss->v[ss->cnt].hi[i] = b[i];
+    } // for
+    ss->cnt += 1;
+    return true;
+} // push_seq
+
+// 把码点区间拆分成若干段，每段的 UTF-8 编码可以表示为逐字节区间的序列
+static bool split_range(re_seqs_t * ss, uchar_t lo, uchar_t hi)
+{
+    static const uchar_t limits[3] = {0x7F, 0x7FF, 0xFFFF};
+    uchar_t m = 0;
+    int32_t n = 0;
+    int32_t i = 0;
+
+    if (lo > hi) return true;
+
+    // 代理码点不会出现在合法的 UTF-8 文本中
+    if (lo <= 0xDFFF && hi >= 0xD800) {
+        return (lo >= 0xD800 || split_range(ss, lo, 0xD7FF)) && (hi <= 0xDFFF || split_range(ss, 0xE000, hi));
+    } // if
+
+    // 编码长度不同的部分分开处理
+    for (i = 0; i < 3; ++i) {
+        if (lo <= limits[i] && hi > limits[i]) return split_range(ss, lo, limits[i]) && split_range(ss, limits[i] + 1, hi);
+    } // for
+
+    n = (lo <= 0x7F) ? 1 : (lo <= 0x7FF) ? 2 : (lo <= 0xFFFF) ? 3 : 4;
+    for (i = 1; i < n; ++i) {
+        // 低 6i 位不能同时覆盖完整范围时，在边界处拆开
+        m = (1u << (6 * i)) - 1;
+        if ((lo & ~m) != (hi & ~m)) {
+            if ((lo & m) != 0) return split_range(ss, lo, lo | m) && split_range(ss, (lo | m) + 1, hi);
+            if ((hi & m) != m) return split_range(ss, lo, (hi & ~m) - 1) && split_range(ss, hi & ~m, hi);
+        } // if
+    } // for
+    return push_seq(ss, lo, hi);
+} // split_range
+
+static void compile_set(re_prog_p pg, re_node_p nd)
+{
+    re_seqs_t ss = {0};
+    uint32_t jumps = RE_NONE;   // 待回填的跳转指令链表，通过 y 链接
+    uint32_t split = 0;
+    uint32_t next = 0;
+    uint32_t pc = 0;
+    uint32_t i = 0;
+    uint32_t k = 0;
+
+    for (i = 0; i < nd->set.cnt; ++i) {
+        if (! split_range(&ss, nd->set.v[i].lo, nd->set.v[i].hi)) {
+            pg->err = STR_REGEX_OUT_OF_MEMORY;
+            goto RE_COMPILE_SET_END;
+        } // if
+    } // for
+
+    if (ss.cnt == 0) {
+        // 空集合永远不能匹配
+        emit(pg, OP_BYTE, RE_NONE, 0);
+        if (! pg->err) {
+            pg->insts[pg->cnt - 1].lo = 1;
+            pg->insts[pg->cnt - 1].hi = 0;
+        } // if
+        goto RE_COMPILE_SET_END;
+    } // if
+
+    for (i = 0; i < ss.cnt; ++i) {
+        if (i + 1 < ss.cnt) split = emit(pg, OP_SPLIT, RE_NONE, 0);
+        for (k = 0; k < ss.v[i].len; ++k) {
+            pc = emit(pg, OP_BYTE, RE_NONE, 0);
+            if (pg->err) goto RE_COMPILE_SET_END;
+            pg->insts[pc].lo = ss.v[i].lo[k];
+            pg->insts[pc].hi = ss.v[i].hi[k];
+        } // for
+        if (i + 1 < ss.cnt) {
+            pc = emit(pg, OP_JMP, 0, jumps);
+            jumps = pc;
+            patch(pg, split, false, pg->cnt);
+        } // if
+    } // for
+
+    while (! pg->err && jumps != RE_NONE) {
+        next = pg->insts[jumps].y;
+        pg->insts[jumps].x = pg->cnt;
+        jumps = next;
+    } // while
+
+RE_COMPILE_SET_END:
+    free(ss.v);
+} // compile_set
+
+static void compile(re_prog_p pg, re_node_p nd)
+{
+    uint32_t chain = RE_NONE;   // 待回填的可选重复链表，通过 y 链接
+    uint32_t next = 0;
+    uint32_t pc = 0;
+    uint32_t jmp = 0;
+    int32_t i = 0;
+
+    if (pg->err) return;
+
+    switch (nd->type) {
+        case NODE_SET:
+            compile_set(pg, nd);
+            break;
+
+        case NODE_CAT:
+            compile(pg, nd->left);
+            compile(pg, nd->right);
+            break;
+
+        case NODE_ALT:
+            pc = emit(pg, OP_SPLIT, RE_NONE, 0);
+            compile(pg, nd->left);
+            jmp = emit(pg, OP_JMP, 0, 0);
+            patch(pg, pc, false, pg->cnt);
+            compile(pg, nd->right);
+            patch(pg, jmp, true, pg->cnt);
+            break;
+
+        case NODE_REPEAT:
+            for (i = 0; i < nd->min; ++i) compile(pg, nd->left);
+
+            if (nd->max < 0) {
+                // e* ：L1: split L2, L3; L2: e; jmp L1; L3:
+                pc = emit(pg, OP_SPLIT, RE_NONE, 0);
+                compile(pg, nd->left);
+                emit(pg, OP_JMP, pc, 0);
+                patch(pg, pc, false, pg->cnt);
+                if (! nd->greedy) prefer_skip(pg, pc);
+                break;
+            } // if
+
+            // e{0,k} 编译成嵌套的 (e(e(e)?)?)? ，所有跳过分支都指向末尾
+            for (i = nd->min; i < nd->max; ++i) {
+                pc = emit(pg, OP_SPLIT, RE_NONE, chain);
+                chain = pc;
+                compile(pg, nd->left);
+            } // for
+            while (! pg->err && chain != RE_NONE) {
+                next = pg->insts[chain].y;
+                pg->insts[chain].y = pg->cnt;
+                if (! nd->greedy) prefer_skip(pg, chain);
+                chain = next;
+            } // while
+            break;
+
+        case NODE_GROUP:
+            if (nd->group >= 0) emit(pg, OP_SAVE, RE_NONE, nd->group * 2);
+            compile(pg, nd->left);
+            if (nd->group >= 0) emit(pg, OP_SAVE, RE_NONE, nd->group * 2 + 1);
+            break;
+
+        case NODE_BOL:
+            emit(pg, OP_BOL, RE_NONE, 0);
+            break;
+
+        case NODE_EOL:
+            emit(pg, OP_EOL, RE_NONE, 0);
+            break;
+
+        default:
+            break;
+    } // switch
+} // compile
+
+// 提取所有匹配都必须具有的字面量前缀，返回节点是否完全由字面量组成
+static bool extract_prefix(str_regex_p re, re_node_p nd, str_size_t * len)
+{
+    char_t seq[4] = {0};
+    int32_t bytes = 0;
+
+    switch (nd->type) {
+        case NODE_EMPTY:
+            return true;
+        case NODE_CAT:
+            return extract_prefix(re, nd->left, len) && extract_prefix(re, nd->right, len);
+        case NODE_GROUP:
+            return extract_prefix(re, nd->left, len);
+        case NODE_SET:
+            if (nd->set.cnt != 1 || nd->set.v[0].lo != nd->set.v[0].hi) return false;
+            bytes = utf8_encode(nd->set.v[0].lo, seq);
+            if (*len + bytes > RE_MAX_PREFIX) return false;
+            memcpy(re->literal + *len, seq, bytes);
+            *len += bytes;
+            return true;
+        default:
+            break;
+    } // switch
+    return false;
+} // extract_prefix
+
+// ---- 惰性 DFA ----
+
+// 从种子指令出发计算 ε 闭包，保留字节、匹配指令及尚未满足的行尾断言，返回保留的指令数
+static uint32_t closure(str_regex_p re, const uint32_t * seeds, uint32_t n, bool at_begin, bool at_end)
+{
+    re_inst_t * in = NULL;
+    uint32_t visited = 0;
+    uint32_t kept = 0;
+    uint32_t top = 0;
+    uint32_t pc = 0;
+    uint32_t i = 0;
+
+    for (i = n; i > 0; --i) re->stack[top++] = seeds[i - 1];
+    while (top > 0) {
+        pc = re->stack[--top];
+        if (re->sparse[pc] < visited && re->dense[re->sparse[pc]] == pc) continue;
+        re->sparse[pc] = visited;
+        re->dense[visited++] = pc;
+
+        in = &re->insts[pc];
+        switch (in->op) {
+            case OP_SPLIT:
+                re->stack[top++] = in->y;
+                re->stack[top++] = in->x;
+                break;
+            case OP_JMP:
+            case OP_SAVE:
+                re->stack[top++] = in->x;
+                break;
+            case OP_BOL:
+                if (at_begin) re->stack[top++] = in->x;
+                break;
+            case OP_EOL:
+                if (at_end) {
+                    re->stack[top++] = in->x;
+                } else {
+                    re->kept[kept++] = pc;
+                } // if
+                break;
+            default:
+                re->kept[kept++] = pc;
+                break;
+        } // switch
+    } // while
+    return kept;
+} // closure
+
+static int compare_pc(const void * a, const void * b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+} // compare_pc
+
+inline static uint32_t hash_pcs(const uint32_t * pcs, uint32_t n)
+{
+    uint32_t h = 2166136261u;
+    uint32_t i = 0;
+
+    for (i = 0; i < n; ++i) h = (h ^ pcs[i]) * 16777619u;
+    return h;
+} // hash_pcs
+
+// 状态占用的字节数：转移表、指令集合及索引
+inline static size_t state_cost(uint32_t n)
+{
+    return (256 + n + 4) * sizeof(uint32_t) + 1;
+} // state_cost
+
+static bool grow_table(re_dfa_p d)
+{
+    uint32_t * table = NULL;
+    uint32_t cap = d->table_cap ? d->table_cap * 2 : 64;
+    uint32_t h = 0;
+    uint32_t i = 0;
+
+    table = calloc(cap, sizeof(table[0]));
+    if (! table) return false;
+    for (i = 0; i < d->states; ++i) {
+        h = hash_pcs(d->pool + d->offs[i], d->lens[i]) & (cap - 1);
+        while (table[h]) h = (h + 1) & (cap - 1);
+        table[h] = i + 1;
+    } // for
+
+    free(d->table);
+    d->table = table;
+    d->table_cap = cap;
+    return true;
+} // grow_table
+
+// 新增状态，超出预算或内存不足时返回 RE_DFA_FULL
+static uint32_t add_state(re_dfa_p d, const uint32_t * pcs, uint32_t n, uint8_t flags)
+{
+    uint32_t * trans = NULL;
+    uint32_t * pool = NULL;
+    void * p = NULL;
+    uint32_t cap = 0;
+    uint32_t st = d->states;
+    uint32_t h = 0;
+
+    if (d->used + state_cost(n) > STR_REGEX_DFA_BUDGET) return RE_DFA_FULL;
+
+    if (d->states == d->cap) {
+        cap = d->cap ? d->cap * 2 : 16;
+        trans = realloc(d->trans, sizeof(d->trans[0]) * 256 * cap);
+        if (! trans) return RE_DFA_FULL;
+        d->trans = trans;
+        if (! (p = realloc(d->flags, sizeof(d->flags[0]) * cap))) return RE_DFA_FULL;
+        d->flags = p;
+        if (! (p = realloc(d->offs, sizeof(d->offs[0]) * cap))) return RE_DFA_FULL;
+        d->offs = p;
+        if (! (p = realloc(d->lens, sizeof(d->lens[0]) * cap))) return RE_DFA_FULL;
+        d->lens = p;
+        d->cap = cap;
+    } // if
+
+    if (d->pool_used + n > d->pool_cap) {
+        cap = d->pool_cap ? d->pool_cap * 2 : 256;
+        while (cap < d->pool_used + n) cap *= 2;
+        pool = realloc(d->pool, sizeof(d->pool[0]) * cap);
+        if (! pool) return RE_DFA_FULL;
+        d->pool = pool;
+        d->pool_cap = cap;
+    } // if
+
+    if ((d->states + 1) * 2 > d->table_cap && ! grow_table(d)) return RE_DFA_FULL;
+
+    if (n > 0) memcpy(d->pool + d->pool_used, pcs, sizeof(pcs[0]) * n);
+    memset(d->trans + st * 256, (st == RE_DEAD) ? 0 : 0xFF, sizeof(d->trans[0]) * 256); // 死状态转移到自身
+    d->offs[st] = d->pool_used;
+    d->lens[st] = n;
+    d->flags[st] = flags;
+    d->pool_used += n;
+    d->states += 1;
+    d->used += state_cost(n);
+
+    h = hash_pcs(pcs, n) & (d->table_cap - 1);
+    while (d->table[h]) h = (h + 1) & (d->table_cap - 1);
+    d->table[h] = st + 1;
+    return st;
+} // add_state
+
+// 清空缓存，只保留死状态
+static bool reset_dfa(re_dfa_p d)
+{
+    d->states = 0;
+    d->pool_used = 0;
+    d->used = 0;
+    d->start[0] = RE_NONE;
+    d->start[1] = RE_NONE;
+    if (d->table) memset(d->table, 0, sizeof(d->table[0]) * d->table_cap);
+    return add_state(d, NULL, 0, 0) == RE_DEAD;
+} // reset_dfa
+
+// 查找或新增 re->kept 中前 n 条指令构成的状态
+static uint32_t find_state(str_regex_p re, re_dfa_p d, uint32_t n)
+{
+    uint32_t * pcs = re->kept;
+    uint32_t h = 0;
+    uint32_t st = 0;
+    uint32_t i = 0;
+    uint32_t k = 0;
+    uint8_t flags = 0;
+
+    qsort(pcs, n, sizeof(pcs[0]), compare_pc);
+    for (h = hash_pcs(pcs, n) & (d->table_cap - 1); d->table[h]; h = (h + 1) & (d->table_cap - 1)) {
+        st = d->table[h] - 1;
+        if (d->lens[st] == n && (n == 0 || memcmp(d->pool + d->offs[st], pcs, sizeof(pcs[0]) * n) == 0)) return st;
+    } // for
+
+    // 行尾断言在源串结尾处可以通过，预先计算此时能否匹配
+    for (i = 0; i < n; ++i) {
+        if (re->insts[pcs[i]].op == OP_MATCH) flags |= STATE_MATCH | STATE_EOL_MATCH;
+        if (re->insts[pcs[i]].op == OP_EOL) re->stack[RE_SEEDS(re) + k++] = re->insts[pcs[i]].x;
+    } // for
+
+    st = add_state(d, pcs, n, flags);
+    if (st == RE_DFA_FULL || k == 0 || (flags & STATE_EOL_MATCH)) return st;
+
+    memcpy(re->kept, re->stack + RE_SEEDS(re), sizeof(re->kept[0]) * k);
+    n = closure(re, re->kept, k, false, true);
+    for (i = 0; i < n; ++i) {
+        if (re->insts[re->kept[i]].op == OP_MATCH) d->flags[st] |= STATE_EOL_MATCH;
+    } // for
+    return st;
+} // find_state
+
+// 计算起始状态
+static uint32_t start_state(str_regex_p re, re_dfa_p d, bool at_begin)
+{
+    uint32_t seed = 0;
+    uint32_t st = d->start[at_begin];
+
+    if (st != RE_NONE) return st;
+    st = find_state(re, d, closure(re, &seed, 1, at_begin, false));
+    if (st == RE_DFA_FULL) {
+        if (! reset_dfa(d)) return RE_DFA_FULL;
+        st = find_state(re, d, closure(re, &seed, 1, at_begin, false));
+        if (st == RE_DFA_FULL) return RE_DFA_FULL;
+    } // if
+    d->start[at_begin] = st;
+    return st;
+} // start_state
+
+// 计算状态 st 读入字节 b 后的状态，缓存已满时清空后重建
+static uint32_t step(str_regex_p re, re_dfa_p d, uint32_t st, char_t b)
+{
+    re_inst_t * in = NULL;
+    uint32_t * pcs = d->pool + d->offs[st];
+    uint32_t n = 0;
+    uint32_t nx = 0;
+    uint32_t i = 0;
+
+    // 种子暂存在栈的末尾，不与闭包计算冲突
+    for (i = 0; i < d->lens[st]; ++i) {
+        in = &re->insts[pcs[i]];
+        if (in->op == OP_BYTE && in->lo <= b && b <= in->hi) re->stack[RE_SEEDS(re) + n++] = in->x;
+    } // for
+    if (! d->anchored) re->stack[RE_SEEDS(re) + n++] = 0; // 非锚定：每个位置都可以开始匹配
+
+    memcpy(re->kept, re->stack + RE_SEEDS(re), sizeof(re->kept[0]) * n);
+    nx = find_state(re, d, closure(re, re->kept, n, false, false));
+    if (nx != RE_DFA_FULL) {
+        d->trans[st * 256 + b] = nx;
+        return nx;
+    } // if
+
+    // 重新计算闭包（kept 已被覆盖），缓存清空后 st 失效，不再记录转移
+    for (i = 0, n = 0; i < d->lens[st]; ++i) {
+        in = &re->insts[pcs[i]];
+        if (in->op == OP_BYTE && in->lo <= b && b <= in->hi) re->stack[RE_SEEDS(re) + n++] = in->x;
+    } // for
+    if (! d->anchored) re->stack[RE_SEEDS(re) + n++] = 0;
+    memcpy(re->kept, re->stack + RE_SEEDS(re), sizeof(re->kept[0]) * n);
+    if (! reset_dfa(d)) return RE_DFA_FULL;
+    return find_state(re, d, closure(re, re->kept, n, false, false));
+} // step
+
+// 功能：用 DFA 查找最早结束的匹配
+// 返回值：
+//     1            找到，*hit 是匹配结尾
+//     0            找不到
+//     -1           缓存预算不足以运行 DFA ，需要改用 Pike VM
+static int dfa_scan(str_regex_p re, re_dfa_p d, const char_t * begin, const char_t * from, const char_t * end, const char_t ** hit)
+{
+    const char_t * pos = from;
+    uint32_t st = 0;
+    uint32_t nx = 0;
+
+    // 空范围可能同时位于开头和结尾（如 $^），状态标志未考虑这种情况，交给 Pike VM
+    if (from == end) return -1;
+
+    st = start_state(re, d, from == begin);
+    if (st == RE_DFA_FULL) return -1;
+    if (d->flags[st] & STATE_MATCH) {
+        *hit = pos;
+        return 1;
+    } // if
+
+    while (pos < end) {
+        nx = d->trans[st * 256 + *pos];
+        if (nx == RE_NONE) {
+            nx = step(re, d, st, *pos);
+            if (nx == RE_DFA_FULL) return -1;
+        } // if
+
+        st = nx;
+        pos += 1;
+        if (st == RE_DEAD) return 0;
+        if (d->flags[st] & STATE_MATCH) {
+            *hit = pos;
+            return 1;
+        } // if
+    } // while
+
+    if (d->flags[st] & STATE_EOL_MATCH) {
+        *hit = end;
+        return 1;
+    } // if
+    return 0;
+} // dfa_scan
+
+// ---- Pike VM ----
+
+// 加入线程：沿 ε 边展开，优先级高的分支先加入；re->work 是当前的分组位置，返回前恢复原值
+static void add_thread(str_regex_p re, re_list_p ls, uint32_t pc0, const char_t * begin, const char_t * end, const char_t * pos)
+{
+    re_inst_t * in = NULL;
+    re_job_t job = {0};
+    uint32_t top = 0;
+    uint32_t pc = 0;
+    uint32_t t = 0;
+
+    re->jobs[top].pc = pc0;
+    re->jobs[top++].slot = RE_NONE;
+    while (top > 0) {
+        job = re->jobs[--top];
+        if (job.slot != RE_NONE) {
+            re->work[job.slot] = job.old;
+            continue;
+        } // if
+
+        for (pc = job.pc; ! (ls->sparse[pc] < ls->n && ls->dense[ls->sparse[pc]] == pc);) {
+            ls->sparse[pc] = ls->n;
+            ls->dense[ls->n++] = pc;
+
+            in = &re->insts[pc];
+            if (in->op == OP_JMP) {
+                pc = in->x;
+            } else if (in->op == OP_SPLIT) {
+                re->jobs[top].pc = in->y;
+                re->jobs[top++].slot = RE_NONE;
+                pc = in->x;
+            } else if (in->op == OP_SAVE) {
+                re->jobs[top].slot = in->y;
+                re->jobs[top++].old = re->work[in->y];
+                re->work[in->y] = pos;
+                pc = in->x;
+            } else if ((in->op == OP_BOL && pos == begin) || (in->op == OP_EOL && pos == end)) {
+                pc = in->x;
+            } else {
+                if (in->op == OP_BYTE || in->op == OP_MATCH) {
+                    t = ls->threads++;
+                    ls->pcs[t] = pc;
+                    memcpy(ls->caps + t * re->slots, re->work, sizeof(re->work[0]) * re->slots);
+                } // if
+                break;
+            } // if
+        } // for
+    } // while
+} // add_thread
+
+// 功能：从 from 开始、在不晚于 limit 的位置开始的线程中找最左优先的匹配，结果存入 re->found
+static bool pike(str_regex_p re, const char_t * begin, const char_t * end, const char_t * from, const char_t * limit)
+{
+    re_list_p cur = &re->list[0];
+    re_list_p nxt = &re->list[1];
+    re_list_p tmp = NULL;
+    re_inst_t * in = NULL;
+    const char_t * pos = from;
+    bool matched = false;
+    uint32_t i = 0;
+
+    cur->n = 0;
+    cur->threads = 0;
+    for (;; ++pos) {
+        if (! matched && pos <= limit) {
+            // 新线程优先级最低，排在已有线程之后
+            memset(re->work, 0, sizeof(re->work[0]) * re->slots);
+            add_thread(re, cur, 0, begin, end, pos);
+        } // if
+        if (cur->threads == 0 && (matched || pos >= limit)) break;
+
+        nxt->n = 0;
+        nxt->threads = 0;
+        for (i = 0; i < cur->threads; ++i) {
+            in = &re->insts[cur->pcs[i]];
+            if (in->op == OP_MATCH) {
+                // 更低优先级的线程不再需要
+                memcpy(re->found, cur->caps + i * re->slots, sizeof(re->found[0]) * re->slots);
+                matched = true;
+                break;
+            } // if
+            if (pos < end && in->lo <= *pos && *pos <= in->hi) {
+                memcpy(re->work, cur->caps + i * re->slots, sizeof(re->work[0]) * re->slots);
+                add_thread(re, nxt, in->x, begin, end, pos + 1);
+            } // if
+        } // for
+
+        tmp = cur;
+        cur = nxt;
+        nxt = tmp;
+        if (pos == end) break;
+    } // for
+    return matched;
+} // pike
+
+// ---- 接口 ----
+
+static bool prepare(str_regex_p re)
+{
+    uint32_t n = re->cnt;
+    uint32_t i = 0;
+
+    re->slots = re->groups * 2;
+    re->sparse = malloc(sizeof(re->sparse[0]) * n);
+    re->dense = malloc(sizeof(re->dense[0]) * n);
+    re->kept = malloc(sizeof(re->kept[0]) * n);
+    re->stack = malloc(sizeof(re->stack[0]) * (n * 4 + 2));
+    re->jobs = malloc(sizeof(re->jobs[0]) * (n * 2 + 1));
+    re->work = malloc(sizeof(re->work[0]) * re->slots);
+    re->found = malloc(sizeof(re->found[0]) * re->slots);
+    if (! re->sparse || ! re->dense || ! re->kept || ! re->stack || ! re->jobs || ! re->work || ! re->found) return false;
+
+    for (i = 0; i < 2; ++i) {
+        re->list[i].sparse = malloc(sizeof(re->list[i].sparse[0]) * n);
+        re->list[i].dense = malloc(sizeof(re->list[i].dense[0]) * n);
+        re->list[i].pcs = malloc(sizeof(re->list[i].pcs[0]) * n);
+        re->list[i].caps = malloc(sizeof(re->list[i].caps[0]) * n * re->slots);
+        if (! re->list[i].sparse || ! re->list[i].dense || ! re->list[i].pcs || ! re->list[i].caps) return false;
+    } // for
+
+    re->dfa[1].anchored = true;
+    return reset_dfa(&re->dfa[0]) && reset_dfa(&re->dfa[1]);
+} // prepare
+
+str_regex_p str_regex_new(const char_t * pattern, str_size_t bytes, int32_t * err, str_size_t * err_pos)
+{
+    re_parser_t p = {0};
+    re_prog_t pg = {0};
+    re_node_p root = NULL;
+    re_node_p nd = NULL;
+    str_regex_p re = NULL;
+    str_size_t len = 0;
+
+    p.start = pattern;
+    p.pos = pattern;
+    p.end = pattern + bytes;
+
+    root = parse_alt(&p);
+    if (root && p.pos < p.end) p.err = STR_REGEX_BAD_SYNTAX; // 多余的 )
+    if (p.err) {
+        pg.err = p.err;
+        goto STR_REGEX_NEW_END;
+    } // if
+
+    // 程序：save 0; 模式; save 1; match
+    emit(&pg, OP_SAVE, RE_NONE, 0);
+    compile(&pg, root);
+    emit(&pg, OP_SAVE, RE_NONE, 1);
+    emit(&pg, OP_MATCH, 0, 0);
+    if (pg.err) goto STR_REGEX_NEW_END;
+
+    re = calloc(1, sizeof(str_regex_t));
+    if (! re) {
+        pg.err = STR_REGEX_OUT_OF_MEMORY;
+        goto STR_REGEX_NEW_END;
+    } // if
+
+    re->insts = pg.insts;
+    re->cnt = pg.cnt;
+    re->groups = p.groups + 1;
+    pg.insts = NULL;
+    if (! prepare(re)) {
+        pg.err = STR_REGEX_OUT_OF_MEMORY;
+        str_regex_delete(re);
+        re = NULL;
+        goto STR_REGEX_NEW_END;
+    } // if
+
+    extract_prefix(re, root, &len);
+    if (len > 0) str_searcher_init(&re->prefix, re->literal, len);
+
+STR_REGEX_NEW_END:
+    while (p.all) {
+        nd = p.all;
+        p.all = nd->chain;
+        free(nd->set.v);
+        free(nd);
+    } // while
+    free(pg.insts);
+
+    if (err) *err = pg.err;
+    if (err_pos) *err_pos = p.pos - pattern;
+    return re;
+} // str_regex_new
+
+void str_regex_delete(str_regex_p re)
+{
+    uint32_t i = 0;
+
+    if (! re) return; // NULL 指针
+
+    for (i = 0; i < 2; ++i) {
+        free(re->dfa[i].table);
+        free(re->dfa[i].pool);
+        free(re->dfa[i].lens);
+        free(re->dfa[i].offs);
+        free(re->dfa[i].flags);
+        free(re->dfa[i].trans);
+        free(re->list[i].caps);
+        free(re->list[i].pcs);
+        free(re->list[i].dense);
+        free(re->list[i].sparse);
+    } // for
+    free(re->found);
+    free(re->work);
+    free(re->jobs);
+    free(re->stack);
+    free(re->kept);
+    free(re->dense);
+    free(re->sparse);
+    free(re->insts);
+    free(re);
+} // str_regex_delete
+
+uint32_t str_regex_groups(str_regex_p re)
+{
+    return re->groups;
+} // str_regex_groups
+
+bool str_regex_find(str_regex_p re, const char_t * begin, const char_t * end, const char_t * from, const char_t ** caps, uint32_t n)
+{
+    const char_t * pos = from;
+    const char_t * start = from;
+    const char_t * limit = end;
+    const char_t * hit = NULL;
+    int r = 0;
+
+    if (re->prefix.bytes > 0) {
+        // 每个匹配都以前缀开头：逐个候选位置做锚定匹配，第一个成功的就是最左匹配
+        for (;; pos = start + 1) {
+            start = str_searcher_find(&re->prefix, pos, end - pos);
+            if (! start) return false;
+            r = dfa_scan(re, &re->dfa[1], begin, start, end, &hit);
+            if (r > 0 || (r < 0 && pike(re, begin, end, start, start))) break;
+        } // for
+        limit = start;
+    } else {
+        r = dfa_scan(re, &re->dfa[0], begin, from, end, &hit);
+        if (r == 0) return false;
+        if (r > 0) limit = hit; // 最早结束的匹配不可能早于最左匹配开始
+    } // if
+
+    if (n == 0 && r > 0) return true;
+    if ((r > 0 || re->prefix.bytes == 0) && ! pike(re, begin, end, start, limit)) return false;
+    if (n == 0) return true;
+
+    if (n > re->groups) {
+        memset(caps + re->slots, 0, sizeof(caps[0]) * (n - re->groups) * 2);
+        n = re->groups;
+    } // if
+    memcpy(caps, re->found, sizeof(caps[0]) * n * 2);
+    return true;
+} // str_regex_find
@@ -0,0 +1,176 @@
+#include <assert.h>
+#include <string.h>
+
+#include "str/ascii.h"
+#include "str/search.h"
+
+#define SEARCH_ONES 0x0101010101010101ULL
+#define SEARCH_LOWS 0x7F7F7F7F7F7F7F7FULL
+
+// 逐字节标记零字节（该字节最高位置 1），无跨字节借位，结果精确
+inline static uint64_t zero_bytes(uint64_t word)
+{
+    return ~(((word & SEARCH_LOWS) + SEARCH_LOWS) | word | SEARCH_LOWS);
+} // zero_bytes
+
+inline static bool match_at(str_searcher_p sr, const char_t * pos)
+{
+    // 首尾字节已比较，只需比较中间部分
+    return pos[0] == sr->needle[0] && pos[sr->bytes - 1] == sr->needle[sr->bytes - 1] && memcmp(pos + 1, sr->needle + 1, sr->bytes - 2) == 0;
+} // match_at
+
+static const char_t * find_pair(str_searcher_p sr, const char_t * start, str_size_t bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes - sr->bytes + 1; // 候选位置上界（不含）
+    uint64_t first = sr->needle[0] * SEARCH_ONES;
+    uint64_t last = sr->needle[sr->bytes - 1] * SEARCH_ONES;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    int k = 0;
+
+    // 每次检查 8 个候选位置：首字节和末字节同时相等才是候选
+    for (; end - pos >= 8; pos += 8) {
+        memcpy(&head, pos, sizeof(head));
+        memcpy(&tail, pos + sr->bytes - 1, sizeof(tail));
+        if (! (zero_bytes(head ^ first) & zero_bytes(tail ^ last))) continue;
+
+        for (k = 0; k < 8; ++k) {
+            if (match_at(sr, pos + k)) return pos + k;
+        } // for
+    } // for
+
+    for (; pos < end; ++pos) {
+        if (match_at(sr, pos)) return pos;
+    } // for
+    return NULL;
+} // find_pair
+
+inline static bool match_nocase_at(str_searcher_p sr, const char_t * pos)
+{
+    str_size_t i = 0;
+
+    for (i = 0; i < sr->bytes && ascii_fold(pos[i]) == ascii_fold(sr->needle[i]); ++i) ;
+    return i == sr->bytes;
+} // match_nocase_at
+
+static const char_t * find_nocase(str_searcher_p sr, const char_t * start, str_size_t bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes - sr->bytes + 1; // 候选位置上界（不含）
+    uint64_t first = ascii_fold(sr->needle[0]) * SEARCH_ONES;
+    uint64_t last = ascii_fold(sr->needle[sr->bytes - 1]) * SEARCH_ONES;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    int k = 0;
+
+    // 同 find_pair() ，比较前先将整块折叠为小写
+    for (; end - pos >= 8; pos += 8) {
+        memcpy(&head, pos, sizeof(head));
+        memcpy(&tail, pos + sr->bytes - 1, sizeof(tail));
+        if (! (zero_bytes(ascii_fold_word(head) ^ first) & zero_bytes(ascii_fold_word(tail) ^ last))) continue;
+
+        for (k = 0; k < 8; ++k) {
+            if (match_nocase_at(sr, pos + k)) return pos + k;
+        } // for
+    } // for
+
+    for (; pos < end; ++pos) {
+        if (match_nocase_at(sr, pos)) return pos;
+    } // for
+    return NULL;
+} // find_nocase
+
+static const char_t * find_horspool(str_searcher_p sr, const char_t * start, str_size_t bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes - sr->bytes + 1; // 候选位置上界（不含）
+    char_t last = sr->needle[sr->bytes - 1];
+    char_t ch = 0;
+
+    while (pos < end) {
+        ch = pos[sr->bytes - 1];
+        if (ch == last && memcmp(pos, sr->needle, sr->bytes - 1) == 0) return pos;
+        pos += sr->shift[ch];
+    } // while
+    return NULL;
+} // find_horspool
+
+static const char_t * rfind_pair(str_searcher_p sr, const char_t * start, str_size_t bytes)
+{
+    const char_t * pos = start + bytes - sr->bytes + 1; // 已检查候选位置的下界
+    uint64_t first = sr->needle[0] * SEARCH_ONES;
+    uint64_t last = sr->needle[sr->bytes - 1] * SEARCH_ONES;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    int k = 0;
+
+    // 从结尾向前每次检查 8 个候选位置，块内从高到低比较
+    for (; pos - start >= 8; pos -= 8) {
+        memcpy(&head, pos - 8, sizeof(head));
+        memcpy(&tail, pos - 8 + sr->bytes - 1, sizeof(tail));
+        if (! (zero_bytes(head ^ first) & zero_bytes(tail ^ last))) continue;
+
+        for (k = 1; k <= 8; ++k) {
+            if (match_at(sr, pos - k)) return pos - k;
+        } // for
+    } // for
+
+    while (pos > start) {
+        if (match_at(sr, --pos)) return pos;
+    } // while
+    return NULL;
+} // rfind_pair
+
+void str_searcher_init(str_searcher_p sr, const char_t * needle, str_size_t bytes)
+{
+    str_size_t i = 0;
+    str_size_t dist = 0;
+
+    sr->needle = needle;
+    sr->bytes = bytes;
+
+    if (bytes == 1) {
+        sr->algo = STR_SEARCH_BYTE;
+    } else if (bytes < STR_SEARCH_LONG) {
+        sr->algo = STR_SEARCH_PAIR;
+    } else {
+        sr->algo = STR_SEARCH_HORSPOOL;
+
+        // 未出现在模式串（末字节除外）中的字节可跳过整个模式串
+        memset(sr->shift, (bytes < 255) ? bytes : 255, sizeof(sr->shift));
+        for (i = 0; i < bytes - 1; ++i) {
+            dist = bytes - 1 - i;
+            sr->shift[needle[i]] = (dist < 255) ? dist : 255;
+        } // for
+    } // if
+} // str_searcher_init
+
+void str_searcher_init_nocase(str_searcher_p sr, const char_t * needle, str_size_t bytes)
+{
+    sr->needle = needle;
+    sr->bytes = bytes;
+    sr->algo = STR_SEARCH_NOCASE;
+} // str_searcher_init_nocase
+
+const char_t * str_searcher_find(str_searcher_p sr, const char_t * start, str_size_t bytes)
+{
+    if (bytes < sr->bytes) return NULL;
+
+    switch (sr->algo) {
+        case STR_SEARCH_BYTE: return memchr(start, sr->needle[0], bytes);
+        case STR_SEARCH_PAIR: return find_pair(sr, start, bytes);
+        case STR_SEARCH_NOCASE: return find_nocase(sr, start, bytes);
+        default: break;
+    } // switch
+    return find_horspool(sr, start, bytes);
+} // str_searcher_find
+
+const char_t * str_searcher_rfind(str_searcher_p sr, const char_t * start, str_size_t bytes)
+{
+    assert(sr->algo != STR_SEARCH_NOCASE);
+
+    if (bytes < sr->bytes) return NULL;
+    if (sr->algo == STR_SEARCH_BYTE) return memrchr(start, sr->needle[0], bytes);
+    return rfind_pair(sr, start, bytes);
+} // str_searcher_rfind
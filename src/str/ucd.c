@@ -0,0 +1,988 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "str/ascii.h"
+#include "str/utf8.h"
+#include "str/ucd.h"
+#include "ucd_table.h"  // 由 ucd.py 生成，随源码提交
+
+#define UCD_BAD_BYTE 0x110000  // 异常字节的码点基数，加上字节值后不与任何码点相同
+
+// 韩文音节按算法分解和组合（参见 Unicode 标准第 3.12 节）
+#define HANGUL_SBASE 0xAC00
+#define HANGUL_LBASE 0x1100
+#define HANGUL_VBASE 0x1161
+#define HANGUL_TBASE 0x11A7
+#define HANGUL_LCOUNT 19
+#define HANGUL_VCOUNT 21
+#define HANGUL_TCOUNT 28
+#define HANGUL_NCOUNT (HANGUL_VCOUNT * HANGUL_TCOUNT)
+#define HANGUL_SCOUNT (HANGUL_LCOUNT * HANGUL_NCOUNT)
+
+#define UCD_NORM_STACK 256  // 规范化时栈上码点缓冲区的容量，超出时改用堆内存
+
+static const char_t quick_limits[4] = {UCD_NFC_QUICK, UCD_NFD_QUICK, UCD_NFKC_QUICK, UCD_NFKD_QUICK};
+
+// 解码一个字符，异常字节按单字节字符处理
+inline static int32_t decode(const char_t * pos, const char_t * end, uchar_t * ch)
+{
+    char_t buf[4] = {0};
+    int32_t n = 0;
+
+    if (end - pos < 4) {
+        // 结尾不足 4 字节时复制出来解码，避免越界读取
+        memcpy(buf, pos, end - pos);
+        pos = buf;
+    } // if
+
+    n = utf8_decode(pos, ch);
+    if (n > 0) return n;
+
+    *ch = UCD_BAD_BYTE | pos[0];
+    return 1;
+} // decode
+
+// 解码 end 之前的一个字符，异常字节按单字节字符处理
+inline static int32_t decode_prev(const char_t * start, const char_t * end, uchar_t * ch)
+{
+    const char_t * pos = end - 1;
+
+    // 向前跳过至多 3 个跟随字节
+    while (pos > start && end - pos < 4 && (pos[0] & 0xC0) == 0x80) --pos;
+    if (decode(pos, end, ch) == end - pos) return end - pos;
+
+    *ch = UCD_BAD_BYTE | end[-1];
+    return 1;
+} // decode_prev
+
+uchar_t ucd_fold(uchar_t ch)
+{
+    if (ch < 0x80) return ascii_fold(ch);
+    return ch + ucd_fold_delta[ucd_fold_value(ch)];
+} // ucd_fold
+
+bool ucd_fold_aliased_in(const char_t * start, str_size_t bytes)
+{
+    str_size_t i = 0;
+
+    for (i = 0; i < bytes; ++i) {
+        if (start[i] < 0x80 && ucd_fold_aliased[start[i]]) return true;
+    } // for
+    return false;
+} // ucd_fold_aliased_in
+
+int ucd_fold_compare(const char_t * p1, str_size_t b1, const char_t * p2, str_size_t b2, str_size_t * m1, str_size_t * m2)
+{
+    const char_t * e1 = p1 + b1;
+    const char_t * e2 = p2 + b2;
+    const char_t * q1 = p1;
+    const char_t * q2 = p2;
+    uchar_t c1 = 0;
+    uchar_t c2 = 0;
+    int32_t n1 = 0;
+    int32_t n2 = 0;
+    int ret = 0;
+
+    while (q1 < e1 && q2 < e2) {
+        n1 = decode(q1, e1, &c1);
+        n2 = decode(q2, e2, &c2);
+        c1 = ucd_fold(c1);
+        c2 = ucd_fold(c2);
+        if (c1 != c2) {
+            ret = (c1 < c2) ? -1 : 1;
+            break;
+        } // if
+        q1 += n1;
+        q2 += n2;
+    } // while
+
+    if (m1) *m1 = q1 - p1;
+    if (m2) *m2 = q2 - p2;
+    if (ret == 0) ret = (q1 < e1) - (q2 < e2); // 公共部分相同，较短者在前
+    return ret;
+} // ucd_fold_compare
+
+bool ucd_fold_suffix(const char_t * p1, str_size_t b1, const char_t * p2, str_size_t b2)
+{
+    const char_t * q1 = p1 + b1;
+    const char_t * q2 = p2 + b2;
+    uchar_t c1 = 0;
+    uchar_t c2 = 0;
+
+    while (q2 > p2) {
+        if (q1 <= p1) return false;
+
+        q1 -= decode_prev(p1, q1, &c1);
+        q2 -= decode_prev(p2, q2, &c2);
+        if (ucd_fold(c1) != ucd_fold(c2)) return false;
+    } // while
+    return true;
+} // ucd_fold_suffix
+
+int32_t ucd_case(uchar_t ch, uint32_t kind, uchar_t out[UCD_CASE_MAX])
+{
+    const int32_t * delta = NULL;
+    const uchar_t (* special)[UCD_CASE_MAX] = NULL;
+    uint32_t v = 0;
+    uint32_t deltas = 0;
+    int32_t n = 0;
+
+    if (ch < 0x80) {
+        out[0] = ch ^ (((uint32_t)(ch - (kind == UCD_CASE_UPPER ? 'a' : 'A')) < 26) << 5);
+        return 1;
+    } // if
+
+    switch (kind) {
+        case UCD_CASE_LOWER:
+            v = ucd_lower_value(ch);
+            delta = ucd_lower_delta;
+            special = ucd_lower_special;
+            deltas = UCD_LOWER_DELTAS;
+            break;
+        case UCD_CASE_UPPER:
+            v = ucd_upper_value(ch);
+            delta = ucd_upper_delta;
+            special = ucd_upper_special;
+            deltas = UCD_UPPER_DELTAS;
+            break;
+        default:
+            v = ucd_casefold_value(ch);
+            delta = ucd_casefold_delta;
+            special = ucd_casefold_special;
+            deltas = UCD_CASEFOLD_DELTAS;
+            break;
+    } // switch
+
+    if (v < deltas) {
+        out[0] = ch + delta[v];
+        return 1;
+    } // if
+
+    // 映射为多个字符，字符序列以 0 结尾（不足 UCD_CASE_MAX 个时）
+    for (n = 0; n < UCD_CASE_MAX && special[v - deltas][n]; ++n) out[n] = special[v - deltas][n];
+    return n;
+} // ucd_case
+
+str_size_t ucd_case_measure(const char_t * start, str_size_t bytes, uint32_t kind, str_size_t * first, str_size_t * extra)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    char_t lo = (kind == UCD_CASE_UPPER) ? 'a' : 'A';
+    char_t seq[4] = {0};
+    uchar_t out[UCD_CASE_MAX] = {0};
+    uchar_t ch = 0;
+    str_size_t ret = bytes;
+    str_size_t run = 0;
+    str_size_t same = 0;
+    int32_t n = 0;
+    int32_t m = 0;
+    int32_t i = 0;
+    int32_t len = 0;
+
+    *first = bytes;
+    *extra = 0;
+    while (pos < end) {
+        // ASCII 字符转换前后字节数不变，找到第一处变化后只需成段跳过
+        run = ascii_span(pos, end - pos);
+        if (*first == bytes) {
+            same = ascii_case_span(pos, run, lo);
+            if (same < run) *first = pos - start + same;
+        } // if
+        pos += run;
+        if (pos >= end) break;
+
+        n = decode(pos, end, &ch);
+        if (ch < UCD_BAD_BYTE) {
+            m = ucd_case(ch, kind, out);
+            if (m > 1 || out[0] != ch) {
+                if (*first == bytes) *first = pos - start;
+                for (i = 0, len = 0; i < m; ++i) len += utf8_encode(out[i], seq);
+                ret += len - n;
+                *extra += m - 1;
+            } // if
+        } // if
+        pos += n;
+    } // while
+    return ret;
+} // ucd_case_measure
+
+char_t * ucd_case_convert(char_t * dst, const char_t * start, str_size_t bytes, uint32_t kind)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    char_t lo = (kind == UCD_CASE_UPPER) ? 'a' : 'A';
+    uchar_t out[UCD_CASE_MAX] = {0};
+    uchar_t ch = 0;
+    str_size_t run = 0;
+    int32_t n = 0;
+    int32_t m = 0;
+    int32_t i = 0;
+
+    while (pos < end) {
+        run = ascii_span(pos, end - pos);
+        ascii_case_convert(dst, pos, run, lo);
+        dst += run;
+        pos += run;
+        if (pos >= end) break;
+
+        n = decode(pos, end, &ch);
+        if (ch < UCD_BAD_BYTE) {
+            m = ucd_case(ch, kind, out);
+            for (i = 0; i < m; ++i) dst += utf8_encode(out[i], dst);
+        } else {
+            *dst++ = *pos; // 异常字节原样复制
+        } // if
+        pos += n;
+    } // while
+    return dst;
+} // ucd_case_convert
+
+uint32_t ucd_ccc(uchar_t ch)
+{
+    return ucd_norm_props[ucd_norm_value(ch)] & 0xFF;
+} // ucd_ccc
+
+// 稳定字符：ccc 为 0 且快速检查结果为 YES ，规范化不会越过它相互影响
+inline static bool is_stable(uint32_t props, uint32_t form)
+{
+    return (props & ((0x3 << (8 + 2 * form)) | 0xFF)) == 0;
+} // is_stable
+
+str_size_t ucd_norm_span(const char_t * start, str_size_t bytes, uint32_t form, str_size_t * end)
+{
+    const char_t * pos = start;
+    const char_t * stop = start + bytes;
+    const char_t * stable = start;  // 最后一个稳定字符的起始地址
+    char_t quick = quick_limits[form];
+    uchar_t ch = 0;
+    uint32_t props = 0;
+    uint32_t ccc = 0;
+    uint32_t last = 0;  // 上个字符的 ccc
+    str_size_t run = 0;
+    int32_t n = 0;
+
+    while (pos < stop) {
+        run = ascii_span_below(pos, stop - pos, quick);
+        if (run > 0) {
+            // 成块跳过稳定字符，stable 指向其中最后一个字符
+            pos += run;
+            for (stable = pos - 1; stable > start && (stable[0] & 0xC0) == 0x80; --stable) ;
+            last = 0;
+            if (pos >= stop) break;
+        } // if
+
+        n = decode(pos, stop, &ch);
+        props = ucd_norm_props[ucd_norm_value(ch)];
+        ccc = props & 0xFF;
+        if (((props >> (8 + 2 * form)) & 0x3) || (ccc != 0 && last > ccc)) {
+            // 需要规范化，向后找到下一个稳定字符为止
+            for (pos += n; pos < stop && pos[0] >= quick; pos += n) {
+                n = decode(pos, stop, &ch);
+                if (is_stable(ucd_norm_props[ucd_norm_value(ch)], form)) break;
+            } // for
+            *end = pos - start;
+            return stable - start;
+        } // if
+
+        if (ccc == 0) stable = pos;
+        last = ccc;
+        pos += n;
+    } // while
+
+    *end = bytes;
+    return bytes;
+} // ucd_norm_span
+
+// 完全分解单个字符，返回结果包含的字符数（至多 UCD_DECOMP_MAX 个）
+inline static int32_t decompose(uchar_t ch, bool compat, uchar_t * out)
+{
+    const char_t * pos = NULL;
+    const char_t * end = NULL;
+    uint32_t s = ch - HANGUL_SBASE;
+    uint32_t e = 0;
+    int32_t n = 0;
+
+    if (s < HANGUL_SCOUNT) {
+        out[0] = HANGUL_LBASE + s / HANGUL_NCOUNT;
+        out[1] = HANGUL_VBASE + (s % HANGUL_NCOUNT) / HANGUL_TCOUNT;
+        out[2] = HANGUL_TBASE + s % HANGUL_TCOUNT;
+        return (out[2] == HANGUL_TBASE) ? 2 : 3;
+    } // if
+
+    e = ucd_decomp[compat ? ucd_compat_value(ch) : ucd_canon_value(ch)];
+    if (e == 0) {
+        out[0] = ch;
+        return 1;
+    } // if
+
+    // 分解结果按 UTF-8 编码存储
+    pos = ucd_decomp_pool + (e >> 8);
+    end = pos + (e & 0xFF);
+    while (pos < end) pos += decode(pos, end, &out[n++]);
+    return n;
+} // decompose
+
+// 规范排序：ccc 非 0 的连续字符按 ccc 稳定排序
+static void reorder(uchar_t * cps, str_size_t n)
+{
+    str_size_t i = 0;
+    str_size_t j = 0;
+    uint32_t ccc = 0;
+    uchar_t ch = 0;
+
+    for (i = 1; i < n; ++i) {
+        ccc = ucd_ccc(cps[i]);
+        if (ccc == 0) continue;
+
+        ch = cps[i];
+        for (j = i; j > 0 && ucd_ccc(cps[j - 1]) > ccc; --j) cps[j] = cps[j - 1];
+        cps[j] = ch;
+    } // for
+} // reorder
+
+// 查找两个字符的主合成字符，返回 0 表示不能组合
+static uchar_t compose_pair(uchar_t a, uchar_t b)
+{
+    uint32_t l = a - HANGUL_LBASE;
+    uint32_t v = b - HANGUL_VBASE;
+    uint32_t s = a - HANGUL_SBASE;
+    uint32_t t = b - HANGUL_TBASE;
+    uint32_t k = 0;
+    uint32_t lo = 0;
+    uint32_t hi = 0;
+    uint32_t mid = 0;
+
+    if (l < HANGUL_LCOUNT && v < HANGUL_VCOUNT) return HANGUL_SBASE + (l * HANGUL_VCOUNT + v) * HANGUL_TCOUNT;
+    if (s < HANGUL_SCOUNT && s % HANGUL_TCOUNT == 0 && t - 1 < HANGUL_TCOUNT - 1) return a + t;
+
+    k = ucd_comp_value(b);
+    if (k == 0) return 0;
+
+    // 组合对按第一个字符排序，二分查找
+    lo = ucd_comp_index[k - 1];
+    hi = ucd_comp_index[k];
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (ucd_comp_pairs[mid][0] == a) return ucd_comp_pairs[mid][1];
+        if (ucd_comp_pairs[mid][0] < a) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        } // if
+    } // while
+    return 0;
+} // compose_pair
+
+// 规范组合，返回组合后的字符数
+static str_size_t compose(uchar_t * cps, str_size_t n)
+{
+    str_size_t starter = 0; // 最近的起始字符的位置
+    str_size_t cnt = 1;     // 组合后的字符数
+    str_size_t i = 0;
+    uint32_t last = 0;      // 上个未被组合的字符的 ccc
+    uint32_t ccc = 0;
+    uchar_t comp = 0;
+
+    if (n == 0) return 0;
+
+    last = ucd_ccc(cps[0]) ? 256 : 0; // 以非起始字符开头时不能组合
+    for (i = 1; i < n; ++i) {
+        ccc = ucd_ccc(cps[i]);
+        comp = compose_pair(cps[starter], cps[i]);
+        if (comp && (last < ccc || last == 0)) {
+            cps[starter] = comp; // 未被阻隔，组合到起始字符上
+            continue;
+        } // if
+
+        if (ccc == 0) starter = cnt;
+        last = ccc;
+        cps[cnt++] = cps[i];
+    } // for
+    return cnt;
+} // compose
+
+// 确保缓冲区还能容纳 more 字节
+static bool reserve(ucd_buffer_p out, str_size_t more)
+{
+    char_t * data = NULL;
+    str_size_t cap = out->cap ? out->cap : 64;
+
+    if (out->cap - out->used >= more) return true;
+
+    while (cap - out->used < more) cap *= 2;
+    data = realloc(out->data, cap);
+    if (! data) return false;
+
+    out->data = data;
+    out->cap = cap;
+    return true;
+} // reserve
+
+// 功能：完全分解 UTF-8 字节范围并规范排序
+// 参数：
+//     stack    IN  栈上缓冲区，容量为 UCD_NORM_STACK ，不足时改用堆缓冲区
+//     compat   IN  是否兼容分解
+//     n        OUT 码点数
+// 返回值：
+//     non-NULL     码点缓冲区，不是 stack 时由调用方释放
+//     NULL         内存不足
+static uchar_t * decompose_all(const char_t * start, str_size_t bytes, bool compat, uchar_t * stack, str_size_t * n)
+{
+    uchar_t * cps = stack;
+    uchar_t * more = NULL;
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    str_size_t cap = UCD_NORM_STACK;
+    str_size_t cnt = 0;
+    uchar_t ch = 0;
+
+    while (pos < end) {
+        if (cap - cnt < UCD_DECOMP_MAX) {
+            // 缓冲区扩容，首次扩容时从栈上复制
+            more = realloc((cps == stack) ? NULL : cps, sizeof(cps[0]) * cap * 2);
+            if (! more) goto UCD_DECOMPOSE_ALL_ERROR;
+            if (cps == stack) memcpy(more, stack, sizeof(cps[0]) * UCD_NORM_STACK);
+            cps = more;
+            cap *= 2;
+        } // if
+
+        pos += decode(pos, end, &ch);
+        cnt += decompose(ch, compat, cps + cnt);
+    } // while
+
+    reorder(cps, cnt);
+    *n = cnt;
+    return cps;
+
+UCD_DECOMPOSE_ALL_ERROR:
+    if (cps != stack) free(cps);
+    return NULL;
+} // decompose_all
+
+bool ucd_normalize(const char_t * start, str_size_t bytes, uint32_t form, ucd_buffer_p out)
+{
+    uchar_t stack[UCD_NORM_STACK];
+    uchar_t * cps = NULL;
+    str_size_t n = 0;
+    str_size_t i = 0;
+    bool ret = false;
+
+    cps = decompose_all(start, bytes, form >= UCD_NFKC, stack, &n);
+    if (! cps) return false;
+    if (form == UCD_NFC || form == UCD_NFKC) n = compose(cps, n);
+
+    if (! reserve(out, n * 4)) goto UCD_NORMALIZE_END;
+    for (i = 0; i < n; ++i) {
+        if (cps[i] >= UCD_BAD_BYTE) {
+            out->data[out->used++] = cps[i] & 0xFF; // 异常字节原样保留
+        } else {
+            out->used += utf8_encode(cps[i], out->data + out->used);
+        } // if
+    } // for
+    ret = true;
+
+UCD_NORMALIZE_END:
+    if (cps != stack) free(cps);
+    return ret;
+} // ucd_normalize
+
+// 异常字节按控制字符处理
+inline static uint32_t gcb_of(uchar_t ch)
+{
+    return (ch >= UCD_BAD_BYTE) ? UCD_GCB_CONTROL : ucd_gcb_value(ch);
+} // gcb_of
+
+uint32_t ucd_gcb(uchar_t ch)
+{
+    return gcb_of(ch);
+} // ucd_gcb
+
+str_size_t ucd_grapheme(const char_t * start, str_size_t bytes, str_size_t * chars)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    uchar_t ch = 0;
+    uint32_t prev = 0;
+    uint32_t cur = 0;
+    uint32_t ri = 0;        // 连续的 RI 字符数
+    uint32_t emoji = 0;     // 1: 已有 ExtPict Extend* ，2: 其后紧跟 ZWJ
+    str_size_t cnt = 1;
+    int32_t n = 0;
+    bool join = false;
+
+    // ASCII 字符之后紧跟 ASCII 字符时必有分界（CR LF 除外）
+    if (bytes == 1 || (start[0] < 0x80 && start[1] < 0x80 && ! (start[0] == '\r' && start[1] == '\n'))) {
+        if (chars) *chars = 1;
+        return 1;
+    } // if
+
+    pos += decode(pos, end, &ch);
+    prev = gcb_of(ch);
+    ri = (prev == UCD_GCB_RI);
+    emoji = (prev == UCD_GCB_EXT_PICT);
+
+    while (pos < end) {
+        n = decode(pos, end, &ch);
+        cur = gcb_of(ch);
+
+        if (prev == UCD_GCB_CR) {
+            join = (cur == UCD_GCB_LF);                                             // GB3/GB4
+        } else if (prev == UCD_GCB_LF || prev == UCD_GCB_CONTROL || cur == UCD_GCB_CR || cur == UCD_GCB_LF || cur == UCD_GCB_CONTROL) {
+            join = false;                                                           // GB4/GB5
+        } else if (prev == UCD_GCB_L) {
+            join = (cur == UCD_GCB_L || cur == UCD_GCB_V || cur == UCD_GCB_LV || cur == UCD_GCB_LVT || cur == UCD_GCB_EXTEND || cur == UCD_GCB_ZWJ || cur == UCD_GCB_SPACING_MARK); // GB6
+        } else if ((prev == UCD_GCB_LV || prev == UCD_GCB_V) && (cur == UCD_GCB_V || cur == UCD_GCB_T)) {
+            join = true;                                                            // GB7
+        } else if ((prev == UCD_GCB_LVT || prev == UCD_GCB_T) && cur == UCD_GCB_T) {
+            join = true;                                                            // GB8
+        } else if (cur == UCD_GCB_EXTEND || cur == UCD_GCB_ZWJ || cur == UCD_GCB_SPACING_MARK || prev == UCD_GCB_PREPEND) {
+            join = true;                                                            // GB9/GB9a/GB9b
+        } else if (cur == UCD_GCB_EXT_PICT) {
+            join = (emoji == 2);                                                    // GB11
+        } else if (cur == UCD_GCB_RI) {
+            join = (ri % 2 == 1);                                                   // GB12/GB13
+        } else {
+            join = false;                                                           // GB999
+        } // if
+        if (! join) break;
+
+        // 更新 GB11 和 GB12/GB13 的状态
+        if (cur == UCD_GCB_EXT_PICT) {
+            emoji = 1;
+        } else if (cur == UCD_GCB_ZWJ && emoji == 1) {
+            emoji = 2;
+        } else if (cur != UCD_GCB_EXTEND || emoji == 2) {
+            emoji = 0; // ZWJ 之后只能紧跟 ExtPict
+        } // if
+        ri = (cur == UCD_GCB_RI) ? ri + 1 : 0;
+
+        prev = cur;
+        pos += n;
+        ++cnt;
+    } // while
+
+    if (chars) *chars = cnt;
+    return pos - start;
+} // ucd_grapheme
+
+str_size_t ucd_graphemes(const char_t * start, str_size_t bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    const char_t * cr = NULL;
+    str_size_t run = 0;
+    str_size_t cnt = 0;
+
+    while (pos < end) {
+        run = ascii_span(pos, end - pos);
+        if (run > 1) {
+            // 除最后一个字节外，每个 ASCII 字节自成一簇；最后一个字节可能与后续组合字符同簇，留给逐簇判断
+            run -= 1;
+            if (pos[run - 1] == '\r' && pos[run] == '\n') run -= 1;
+            cnt += run;
+            for (cr = memchr(pos, '\r', run); cr; cr = memchr(cr + 1, '\r', pos + run - cr - 1)) {
+                if (cr + 1 < pos + run && cr[1] == '\n') --cnt;
+            } // for
+            pos += run;
+            if (pos >= end) break;
+        } // if
+
+        pos += ucd_grapheme(pos, end - pos, NULL);
+        ++cnt;
+    } // while
+    return cnt;
+} // ucd_graphemes
+
+#define UCD_TAILOR_SEQ 4    // 裁剪字符规范分解后至多包含的码点数
+#define UCD_TAILOR_CES 4    // 参照字符至多包含的排序元素数
+#define UCD_TAILOR_MAX 250  // 裁剪规则条数上限，紧随同一参照字符的次序不超过附加字节的取值范围
+#define UCD_COLL_SEQ 3      // DUCET 收缩至多包含的码点数
+
+// 排序元素（collation element），各级权重为 0 表示该级没有权重
+typedef struct COLL_ELEMENT {
+    uint32_t        primary;
+    uint32_t        secondary;
+    uint32_t        tertiary;
+    uint32_t        level;          // 裁剪后差异所在的级别，0 表示未裁剪
+    uint32_t        rank;           // 裁剪后紧随参照字符的次序
+} coll_element_t;
+
+typedef struct UCD_TAILOR_ENTRY {
+    uchar_t         seq[UCD_TAILOR_SEQ];  // 规范分解序列
+    uint32_t        len;
+    int32_t         cnt;                  // 排序元素个数
+    coll_element_t  ces[UCD_TAILOR_CES];
+} ucd_tailor_entry_t;
+
+struct UCD_TAILOR {
+    int                 n;
+    ucd_tailor_entry_t  entries[1];     // 按首码点升序、长度降序排列，优先匹配较长的序列
+};
+
+// 展开 DUCET 条目的值（单个排序元素或元素池中的一段），返回元素个数
+inline static int32_t unpack_elements(uint32_t v, coll_element_t * ces)
+{
+    const uint32_t * packed = NULL;
+    int32_t n = 1;
+    int32_t i = 0;
+
+    v &= ~UCD_COLL_STARTER;
+    if (v & UCD_COLL_SINGLE) {
+        v &= ~UCD_COLL_SINGLE;
+        packed = &v;
+    } else {
+        packed = ucd_coll_ces + (v >> 5);
+        n = v & 0x1F;
+    } // if
+
+    memset(ces, 0, sizeof(ces[0]) * n);
+    for (i = 0; i < n; ++i) {
+        ces[i].primary = packed[i] >> 14;
+        ces[i].secondary = (packed[i] >> 5) & 0x1FF;
+        ces[i].tertiary = packed[i] & 0x1F;
+    } // for
+    return n;
+} // unpack_elements
+
+// 隐式权重（UTS #10 10.1）：不在 DUCET 中的码点按码点生成两个排序元素，异常字节排在全部码点之后
+inline static int32_t implicit_elements(uchar_t ch, coll_element_t * ces)
+{
+    uint32_t base = 0xFBC0;
+    uint32_t origin = 0;
+    int i = 0;
+
+    for (i = 0; i < UCD_COLL_IMPLICITS; ++i) {
+        if (ucd_coll_implicits[i * 4] <= ch && ch <= ucd_coll_implicits[i * 4 + 1]) {
+            base = ucd_coll_implicits[i * 4 + 2];
+            origin = ucd_coll_implicits[i * 4 + 3];
+            break;
+        } // if
+    } // for
+
+    memset(ces, 0, sizeof(ces[0]) * 2);
+    ces[0].primary = (origin) ? base : base + (ch >> 15);
+    ces[0].secondary = 0x20;
+    ces[0].tertiary = 0x02;
+    ces[1].primary = ((origin) ? ch - origin : (ch & 0x7FFF)) | 0x8000;
+    return 2;
+} // implicit_elements
+
+// 在 DUCET 收缩表中查找码点序列，返回条目的值，0 表示没有
+static uint32_t find_contraction(const uchar_t * seq, int32_t len)
+{
+    uchar_t key[UCD_COLL_SEQ] = {0};
+    const uint32_t * e = NULL;
+    int lo = 0;
+    int hi = UCD_COLL_CONTRACTIONS;
+    int mid = 0;
+    int i = 0;
+
+    memcpy(key, seq, sizeof(seq[0]) * len);
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        e = ucd_coll_contractions + mid * 4;
+        for (i = 0; i < UCD_COLL_SEQ && e[i] == key[i]; ++i) ;
+        if (i == UCD_COLL_SEQ) return e[UCD_COLL_SEQ];
+
+        if (e[i] < key[i]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        } // if
+    } // while
+    return 0;
+} // find_contraction
+
+// 功能：在 DUCET 中查找从 cps[i] 开始的最长条目（UTS #10 S2.1）
+// 参数：
+//     cps      IO  规范分解并排序后的码点
+//     n        IO  码点数
+//     i        IN  起始下标
+//     ces      OUT 排序元素，容量为 UCD_COLL_CES_MAX
+//     m        OUT 排序元素个数
+// 返回值：
+//     从 i 开始消耗的码点数
+// 说明：
+//     先找最长的连续收缩，再依次尝试其后未被阻断的非起始字符（S2.1.1 ~ S2.1.3），
+//     能与已匹配部分组成收缩的非起始字符从 cps 中移除，n 随之减小。
+static int32_t coll_lookup(uchar_t * cps, str_size_t * n, str_size_t i, coll_element_t * ces, int32_t * m)
+{
+    uchar_t seq[UCD_COLL_SEQ] = {0};
+    uint32_t v = ucd_coll_value(cps[i]);
+    uint32_t w = 0;
+    uint32_t ccc = 0;
+    uint32_t last = 0;  // 最近跳过的非起始字符的组合类，不小于后续字符的组合类时阻断
+    str_size_t j = 0;
+    int32_t len = 1;
+    int32_t k = 0;
+
+    if (v == 0) {
+        *m = implicit_elements(cps[i], ces);
+        return 1;
+    } // if
+
+    if (v & UCD_COLL_STARTER) {
+        for (k = (*n - i < UCD_COLL_SEQ) ? *n - i : UCD_COLL_SEQ; k > 1; --k) {
+            w = find_contraction(cps + i, k);
+            if (w) {
+                v = w;
+                len = k;
+                break;
+            } // if
+        } // for
+
+        memcpy(seq, cps + i, sizeof(seq[0]) * len);
+        k = len;
+        for (j = i + len; j < *n && k < UCD_COLL_SEQ && (ccc = ucd_ccc(cps[j])) != 0;) {
+            seq[k] = cps[j];
+            w = (last < ccc) ? find_contraction(seq, k + 1) : 0;
+            if (w) {
+                v = w;
+                k += 1;
+                memmove(cps + j, cps + j + 1, sizeof(cps[0]) * (*n - j - 1));
+                *n -= 1;
+            } else {
+                last = ccc;
+                j += 1;
+            } // if
+        } // for
+    } // if
+
+    *m = unpack_elements(v, ces);
+    return len;
+} // coll_lookup
+
+// 单个字符规范分解后的排序元素，超过 max 个时返回 -1
+static int32_t char_elements(uchar_t ch, coll_element_t * ces, int32_t max)
+{
+    uchar_t seq[UCD_DECOMP_MAX] = {0};
+    coll_element_t tmp[UCD_COLL_CES_MAX];
+    str_size_t n = 0;
+    str_size_t i = 0;
+    int32_t cnt = 0;
+    int32_t m = 0;
+    int32_t k = 0;
+
+    n = decompose(ch, false, seq);
+    reorder(seq, n);
+    for (i = 0; i < n; i += k) {
+        k = coll_lookup(seq, &n, i, tmp, &m);
+        if (cnt + m > max) return -1;
+        memcpy(ces + cnt, tmp, sizeof(tmp[0]) * m);
+        cnt += m;
+    } // for
+    return cnt;
+} // char_elements
+
+// 排序元素在给定级别上的权重
+inline static uint32_t weight_of(const coll_element_t * ce, uint32_t level)
+{
+    if (level == UCD_LEVEL_PRIMARY) return ce->primary;
+    return (level == UCD_LEVEL_SECONDARY) ? ce->secondary : ce->tertiary;
+} // weight_of
+
+static int compare_entries(const void * a, const void * b)
+{
+    const ucd_tailor_entry_t * e1 = a;
+    const ucd_tailor_entry_t * e2 = b;
+
+    if (e1->seq[0] != e2->seq[0]) return (e1->seq[0] < e2->seq[0]) ? -1 : 1;
+    return (int)e2->len - (int)e1->len;
+} // compare_entries
+
+// 按规则添加一个裁剪字符，返回 false 表示规则无效
+// 排序元素取自参照字符，最后一个在规则级别上有权重的元素记下次序；
+// 级别低于第三级时参照字符先转换为与 ch 相同的大小写，使大小写形式仍按 DUCET 的第三级权重区分
+static bool add_entry(ucd_tailor_p t, uchar_t ch, const ucd_coll_rule_t * rule, uint32_t rank)
+{
+    ucd_tailor_entry_t * e = &t->entries[t->n];
+    uchar_t seq[UCD_DECOMP_MAX] = {0};
+    uchar_t anchor[UCD_CASE_MAX] = {0};
+    uint32_t kind = ucd_lower_value(ch) ? UCD_CASE_UPPER : UCD_CASE_LOWER;  // 有小写映射的是大写字母
+    int32_t n = 0;
+    int32_t i = 0;
+
+    n = decompose(ch, false, seq);
+    if (n > UCD_TAILOR_SEQ) return false;
+
+    if (rule->level == UCD_LEVEL_TERTIARY || ucd_case(rule->anchor, kind, anchor) != 1) anchor[0] = rule->anchor;
+    e->cnt = char_elements(anchor[0], e->ces, UCD_TAILOR_CES);
+    for (i = 0; i < e->cnt && e->ces[i].primary == 0; ++i) ;
+    if (e->cnt < 0 || i == e->cnt) return false;    // 排序元素过多或参照字符没有主权重
+
+    for (i = e->cnt - 1; weight_of(&e->ces[i], rule->level) == 0; --i) ;
+    e->ces[i].level = rule->level;
+    e->ces[i].rank = rank;
+
+    reorder(seq, n);
+    memcpy(e->seq, seq, sizeof(seq[0]) * n);
+    e->len = n;
+    t->n += 1;
+    return true;
+} // add_entry
+
+ucd_tailor_p ucd_tailor_new(const ucd_coll_rule_t * rules, int n, int * err)
+{
+    ucd_tailor_p t = NULL;
+    uchar_t variant[UCD_CASE_MAX] = {0};
+    uint32_t kinds[2] = {UCD_CASE_LOWER, UCD_CASE_UPPER};
+    uint32_t rank = 0;
+    int i = 0;
+    int j = 0;
+    int k = 0;
+
+    if (n < 0 || n > UCD_TAILOR_MAX) goto UCD_TAILOR_NEW_BAD_RULE;
+
+    // 每条规则至多添加字符本身及其小写、大写形式
+    t = calloc(1, sizeof(ucd_tailor_t) + sizeof(t->entries[0]) * n * 3);
+    if (! t) {
+        *err = UCD_OUT_OF_MEMORY;
+        return NULL;
+    } // if
+
+    for (i = 0; i < n; ++i) {
+        if (rules[i].level < UCD_LEVEL_PRIMARY || rules[i].level > UCD_LEVEL_TERTIARY) goto UCD_TAILOR_NEW_BAD_RULE;
+
+        rank = 1;
+        for (j = 0; j < i; ++j) {
+            if (rules[j].anchor == rules[i].anchor && rules[j].level == rules[i].level) rank += 1;
+        } // for
+        if (! add_entry(t, rules[i].ch, &rules[i], rank)) goto UCD_TAILOR_NEW_BAD_RULE;
+
+        // 大小写形式同时调整
+        for (k = 0; k < 2; ++k) {
+            if (ucd_case(rules[i].ch, kinds[k], variant) != 1 || variant[0] == rules[i].ch) continue;
+            if (! add_entry(t, variant[0], &rules[i], rank)) goto UCD_TAILOR_NEW_BAD_RULE;
+        } // for
+    } // for
+
+    qsort(t->entries, t->n, sizeof(t->entries[0]), &compare_entries);
+    return t;
+
+UCD_TAILOR_NEW_BAD_RULE:
+    free(t);
+    *err = UCD_BAD_RULE;
+    return NULL;
+} // ucd_tailor_new
+
+// 在裁剪表中查找从 cps 开始的最长序列，返回匹配的码点数，0 表示没有
+static int32_t match_tailor(const ucd_tailor_t * t, const uchar_t * cps, str_size_t n, coll_element_t * ces, int32_t * m)
+{
+    int lo = 0;
+    int hi = t->n;
+    int mid = 0;
+    uint32_t i = 0;
+
+    // 二分查找首码点相同的第一项
+    while (lo < hi) {
+        mid = (lo + hi) / 2;
+        if (t->entries[mid].seq[0] < cps[0]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        } // if
+    } // while
+
+    for (; lo < t->n && t->entries[lo].seq[0] == cps[0]; ++lo) {
+        if (t->entries[lo].len > n) continue;
+        for (i = 1; i < t->entries[lo].len && t->entries[lo].seq[i] == cps[i]; ++i) ;
+        if (i == t->entries[lo].len) {
+            memcpy(ces, t->entries[lo].ces, sizeof(ces[0]) * t->entries[lo].cnt);
+            *m = t->entries[lo].cnt;
+            return i;
+        } // if
+    } // for
+    return 0;
+} // match_tailor
+
+// 主权重：固定 2 字节，高位在前；DUCET 的主权重不小于 0x0200 ，首字节不与级间分隔符 0x01 混淆
+inline static char_t * put_primary(char_t * pos, uint32_t w)
+{
+    pos[0] = w >> 8;
+    pos[1] = w & 0xFF;
+    return pos + 2;
+} // put_primary
+
+// 次要权重：DUCET 的次要权重在 0x20 ~ 0x11C 之间，减去 0x1E 后是 1 字节（2 ~ 254）
+inline static char_t * put_secondary(char_t * pos, uint32_t w)
+{
+    pos[0] = w - 0x1E;
+    return pos + 1;
+} // put_secondary
+
+// 裁剪表的附加字节：紧随参照字符的次序，未裁剪的权重为 2
+inline static char_t * put_tail(char_t * pos, const coll_element_t * ce, uint32_t level)
+{
+    pos[0] = 2 + ((ce->level == level) ? ce->rank : 0);
+    return pos + 1;
+} // put_tail
+
+bool ucd_coll_key(const char_t * start, str_size_t bytes, const ucd_tailor_t * tailor, ucd_buffer_p out)
+{
+    uchar_t stack[UCD_NORM_STACK];
+    uchar_t * cps = NULL;
+    ucd_buffer_t lv[2] = {{0}};     // 次要和第三级权重的临时缓冲区
+    char_t * pos = NULL;
+    char_t * sec = NULL;
+    char_t * ter = NULL;
+    coll_element_t ces[UCD_COLL_CES_MAX];
+    str_size_t used = out->used;
+    str_size_t n = 0;
+    str_size_t i = 0;
+    int32_t m = 0;
+    int32_t k = 0;
+    int32_t j = 0;
+    bool ret = false;
+
+    cps = decompose_all(start, bytes, false, stack, &n);
+    if (! cps) return false;
+
+    for (i = 0; i < n; i += k) {
+        k = (tailor) ? match_tailor(tailor, cps + i, n - i, ces, &m) : 0;
+        if (k == 0) k = coll_lookup(cps, &n, i, ces, &m);
+
+        // 每个排序元素至多 2 字节主权重、1 字节次要权重、1 字节第三级权重，裁剪时每个权重另加 1 字节
+        if (! reserve(out, m * 3) || ! reserve(&lv[0], m * 2) || ! reserve(&lv[1], m * 2)) goto UCD_COLL_KEY_END;
+
+        pos = out->data + out->used;
+        sec = lv[0].data + lv[0].used;
+        ter = lv[1].data + lv[1].used;
+        for (j = 0; j < m; ++j) {
+            if (ces[j].primary) {
+                pos = put_primary(pos, ces[j].primary);
+                if (tailor) pos = put_tail(pos, &ces[j], UCD_LEVEL_PRIMARY);
+            } // if
+            if (ces[j].secondary) {
+                sec = put_secondary(sec, ces[j].secondary);
+                if (tailor) sec = put_tail(sec, &ces[j], UCD_LEVEL_SECONDARY);
+            } // if
+            if (ces[j].tertiary) {
+                (*ter++) = ces[j].tertiary;
+                if (tailor) ter = put_tail(ter, &ces[j], UCD_LEVEL_TERTIARY);
+            } // if
+        } // for
+        out->used = pos - out->data;
+        lv[0].used = sec - lv[0].data;
+        lv[1].used = ter - lv[1].data;
+    } // for
+
+    // 依次连接各级权重，级间以 0x01 分隔
+    if (! reserve(out, lv[0].used + lv[1].used + 2)) goto UCD_COLL_KEY_END;
+    pos = out->data + out->used;
+    (*pos++) = 0x01;
+    if (lv[0].used) memcpy(pos, lv[0].data, lv[0].used);
+    pos += lv[0].used;
+    (*pos++) = 0x01;
+    if (lv[1].used) memcpy(pos, lv[1].data, lv[1].used);
+    pos += lv[1].used;
+
+    out->used = pos - out->data;
+    ret = true;
+
+UCD_COLL_KEY_END:
+    if (! ret) out->used = used;
+    free(lv[0].data);
+    free(lv[1].data);
+    if (cps != stack) free(cps);
+    return ret;
+} // ucd_coll_key
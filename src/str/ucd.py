@@ -0,0 +1,478 @@
+#!/usr/bin/env python3
+# 由 Python 的 unicodedata 模块和同目录下的 allkeys.txt（DUCET）生成 Unicode 数据表（C 头文件）src/str/ucd_table.h ，
+# 生成结果随源码提交。
+#
+# 用法：ucd.py <输出文件>，或 cmake --build <构建目录> --target ucd_table
+#
+# 数据表须由 unicodedata 版本与 GCB_UNIDATA_VERSION 相同的 Python 生成，构建库本身不需要 Python 。
+#
+# 每种属性生成一组两级表：一级表按码点高位给出块号，二级表按码点低位给出属性值（或属性值的下标），
+# 内容相同的块只保存一份。超出属性最大码点的部分不生成，查表前先与 LIMIT 比较。
+
+import os
+import re
+import sys
+import unicodedata
+
+MAX_CP = 0x110000
+
+
+def is_surrogate(cp):
+    return 0xD800 <= cp <= 0xDFFF
+
+
+def ctype(values):
+    top = max(values) if values else 0
+    low = min(values) if values else 0
+    if low >= 0:
+        if top < 0x100:
+            return 'uint8_t'
+        if top < 0x10000:
+            return 'uint16_t'
+        return 'uint32_t'
+    if -0x80 <= low and top < 0x80:
+        return 'int8_t'
+    if -0x8000 <= low and top < 0x8000:
+        return 'int16_t'
+    return 'int32_t'
+
+
+def emit_array(out, name, values, per_line=16):
+    out.append('static const %s %s[%d] = {' % (ctype(values), name, len(values)))
+    for i in range(0, len(values), per_line):
+        out.append('    ' + ', '.join(str(v) for v in values[i:i + per_line]) + ',')
+    out.append('};')
+    out.append('')
+
+
+def emit_two_stage(out, prefix, values, default, shift=7, packed=False):
+    # values: 码点到属性值的映射（dict），未列出的码点取 default
+    # packed: 属性值都小于 16 时，二级表每字节存放两个值（低半字节在前）
+    limit = (max(values) + 1) if values else 1
+    block = 1 << shift
+    limit = (limit + block - 1) // block * block
+    stage1 = []
+    stage2 = []
+    seen = {}
+    for base in range(0, limit, block):
+        chunk = tuple(values.get(cp, default) for cp in range(base, base + block))
+        if chunk not in seen:
+            seen[chunk] = len(stage2) // block
+            stage2.extend(chunk)
+        stage1.append(seen[chunk])
+
+    out.append('#define %s_SHIFT %d' % (prefix.upper(), shift))
+    out.append('#define %s_LIMIT 0x%X' % (prefix.upper(), limit))
+    out.append('')
+    emit_array(out, prefix + '_stage1', stage1)
+    if packed:
+        assert max(stage2) < 16
+        stage2 = [stage2[i] | (stage2[i + 1] << 4) for i in range(0, len(stage2), 2)]
+    emit_array(out, prefix + '_stage2', stage2)
+
+    # 查表函数：超出 LIMIT 的码点取默认值
+    out.append('inline static uint32_t %s_value(uchar_t ch)' % prefix)
+    out.append('{')
+    if packed:
+        out.append('    uint32_t i = 0;')
+        out.append('')
+    out.append('    if (ch >= %s_LIMIT) return %d;' % (prefix.upper(), default))
+    if packed:
+        out.append('    i = (%s_stage1[ch >> %s_SHIFT] << %s_SHIFT) | (ch & ((1 << %s_SHIFT) - 1));' % ((prefix,) + (prefix.upper(),) * 3))
+        out.append('    return (%s_stage2[i >> 1] >> ((i & 1) << 2)) & 0xF;' % prefix)
+    else:
+        out.append('    return %s_stage2[(%s_stage1[ch >> %s_SHIFT] << %s_SHIFT) | (ch & ((1 << %s_SHIFT) - 1))];' % ((prefix,) * 2 + (prefix.upper(),) * 3))
+    out.append('} // %s_value' % prefix)
+    out.append('')
+
+
+def simple_fold(cp):
+    # 近似 CaseFolding.txt 的 C+S 项：完全折叠结果是单个字符时取该字符，否则取单个字符的小写形式
+    ch = chr(cp)
+    folded = ch.casefold()
+    if len(folded) == 1:
+        return ord(folded)
+    lower = ch.lower()
+    if len(lower) == 1:
+        return ord(lower)
+    return cp
+
+
+def gen_fold(out):
+    deltas = {}
+    for cp in range(MAX_CP):
+        if is_surrogate(cp):
+            continue
+        f = simple_fold(cp)
+        if f != cp:
+            deltas[cp] = f - cp
+
+    # 二级表只保存差值的下标，差值种类不多
+    kinds = [0] + sorted(set(deltas.values()))
+    index = {d: i for i, d in enumerate(kinds)}
+    out.append('// 简单大小写折叠：码点加上 ucd_fold_delta[下标] 即为折叠结果')
+    emit_two_stage(out, 'ucd_fold', {cp: index[d] for cp, d in deltas.items()}, 0)
+    emit_array(out, 'ucd_fold_delta', kinds, 8)
+
+    # 折叠结果与某个非 ASCII 字符相同的 ASCII 字符（如 k 与 KELVIN SIGN），按 ASCII 处理不完整
+    aliased = [0] * 128
+    for cp, d in deltas.items():
+        f = cp + d
+        if cp >= 0x80 and f < 0x80:
+            aliased[f] = 1
+            aliased[f ^ 0x20] = 1
+    out.append('// 折叠结果与非 ASCII 字符相同的 ASCII 字符')
+    emit_array(out, 'ucd_fold_aliased', aliased)
+
+
+def gen_case(out, name, convert):
+    # 完全大小写映射：结果是单个字符时保存差值，否则保存字符序列（至多 3 个字符）
+    deltas = {}
+    seqs = {}
+    for cp in range(MAX_CP):
+        if is_surrogate(cp):
+            continue
+        mapped = convert(chr(cp))
+        if mapped == chr(cp):
+            continue
+        if len(mapped) == 1:
+            deltas[cp] = ord(mapped) - cp
+        else:
+            seqs[cp] = mapped
+
+    # 二级表的值小于 DELTAS 时是差值的下标，否则减去 DELTAS 是字符序列的下标
+    kinds = [0] + sorted(set(deltas.values()))
+    specials = sorted(set(seqs.values()))
+    index = {d: i for i, d in enumerate(kinds)}
+    values = {cp: index[d] for cp, d in deltas.items()}
+    values.update({cp: len(kinds) + specials.index(m) for cp, m in seqs.items()})
+
+    prefix = 'ucd_' + name
+    out.append('// 完全大小写映射（%s）' % name)
+    out.append('#define %s_DELTAS %d' % (prefix.upper(), len(kinds)))
+    out.append('')
+    emit_two_stage(out, prefix, values, 0)
+    emit_array(out, prefix + '_delta', kinds, 8)
+    out.append('static const uchar_t %s_special[%d][3] = {' % (prefix, len(specials)))
+    for m in specials:
+        out.append('    {%s},' % ', '.join('0x%04X' % ord(c) for c in m))
+    out.append('};')
+    out.append('')
+
+
+HANGUL_S = (0xAC00, 0xD7A3)
+HANGUL_V = (0x1161, 0x1175)
+HANGUL_T = (0x11A8, 0x11C2)
+
+
+def gen_norm(out):
+    # 规范化数据：组合类（ccc）、快速检查属性、完全分解和组合对。韩文音节按算法处理，不放入表中。
+    forms = ['NFC', 'NFD', 'NFKC', 'NFKD']
+    norm = {}
+    canon = {}
+    compat = {}
+    for cp in range(MAX_CP):
+        if is_surrogate(cp):
+            continue
+        ch = chr(cp)
+        no = [unicodedata.normalize(f, ch) != ch for f in forms]
+        ccc = unicodedata.combining(ch)
+        if ccc or any(no):
+            # 低 8 位是 ccc ，其上每种形式 2 位：0 是 YES ，1 是 NO ，2 是 MAYBE
+            norm[cp] = ccc | sum(int(n) << (8 + 2 * i) for i, n in enumerate(no))
+        if HANGUL_S[0] <= cp <= HANGUL_S[1]:
+            continue
+        if no[1]:
+            canon[cp] = unicodedata.normalize('NFD', ch)
+        if no[3]:
+            compat[cp] = unicodedata.normalize('NFKD', ch)
+
+    # 主合成字符：规范分解为两个字符，且两者组合回该字符
+    pairs = {}
+    for cp in range(MAX_CP):
+        if is_surrogate(cp) or HANGUL_S[0] <= cp <= HANGUL_S[1]:
+            continue
+        d = unicodedata.decomposition(chr(cp))
+        if not d or d.startswith('<'):
+            continue
+        d = [int(x, 16) for x in d.split()]
+        if len(d) == 2 and unicodedata.normalize('NFC', ''.join(map(chr, d))) == chr(cp):
+            pairs[tuple(d)] = cp
+
+    # 可与前面的字符组合的字符，NFC/NFKC 的快速检查结果为 MAYBE
+    seconds = sorted(set(b for a, b in pairs) | set(range(HANGUL_V[0], HANGUL_V[1] + 1)) | set(range(HANGUL_T[0], HANGUL_T[1] + 1)))
+    for cp in seconds:
+        v = norm.get(cp, 0)
+        for i in (0, 2):
+            if not (v >> (8 + 2 * i)) & 3:
+                v |= 2 << (8 + 2 * i)
+        norm[cp] = v
+
+    # 各形式不需要检查的 UTF-8 首字节上限：小于该字节的字符 ccc 为 0 且快速检查结果为 YES
+    out.append('// 规范化：ccc 和快速检查属性')
+    for i, f in enumerate(forms):
+        low = min(cp for cp, v in norm.items() if (v & 0xFF) or (v >> (8 + 2 * i)) & 3)
+        lead = 0x80 if low < 0x80 else 0xC0 | (low >> 6) if low < 0x800 else 0xE0
+        out.append('#define UCD_%s_QUICK 0x%02X' % (f, lead))
+    out.append('')
+
+    kinds = [0] + sorted(set(norm.values()))
+    index = {v: i for i, v in enumerate(kinds)}
+    emit_two_stage(out, 'ucd_norm', {cp: index[v] for cp, v in norm.items()}, 0, 6)
+    emit_array(out, 'ucd_norm_props', kinds, 8)
+
+    # 完全分解：二级表的值是 ucd_decomp 的下标（0 表示不分解），元素高位是 UTF-8 序列在 ucd_decomp_pool 中的偏移量，低 8 位是字节数
+    seqs = sorted(set(canon.values()) | set(compat.values()))
+    pool = []
+    entries = [0]
+    where = {}
+    for sq in seqs:
+        b = sq.encode('utf-8')
+        where[sq] = len(entries)
+        entries.append((len(pool) << 8) | len(b))
+        pool.extend(b)
+    out.append('// 完全分解')
+    out.append('#define UCD_DECOMP_MAX %d' % max(len(sq) for sq in seqs))
+    out.append('')
+    emit_two_stage(out, 'ucd_canon', {cp: where[sq] for cp, sq in canon.items()}, 0, 6)
+    emit_two_stage(out, 'ucd_compat', {cp: where[sq] for cp, sq in compat.items()}, 0, 6)
+    emit_array(out, 'ucd_decomp', entries, 8)
+    emit_array(out, 'ucd_decomp_pool', pool, 16)
+
+    # 组合对：二级表给出第二个字符的编号，ucd_comp_index 给出该字符的组合对在 ucd_comp_pairs 中的范围（按第一个字符排序）
+    second = sorted(set(b for a, b in pairs))
+    sid = {b: i + 1 for i, b in enumerate(second)}
+    idx = [0]
+    flat = []
+    for b in second:
+        for a, c in sorted((a, c) for (a, b2), c in pairs.items() if b2 == b):
+            flat.append((a, c))
+        idx.append(len(flat))
+    out.append('// 组合对')
+    emit_two_stage(out, 'ucd_comp', sid, 0)
+    emit_array(out, 'ucd_comp_index', idx, 16)
+    out.append('static const uchar_t ucd_comp_pairs[%d][2] = {' % len(flat))
+    for i in range(0, len(flat), 4):
+        out.append('    ' + ' '.join('{0x%04X, 0x%04X},' % p for p in flat[i:i + 4]))
+    out.append('};')
+    out.append('')
+
+
+# 扩展字素簇分界属性（UAX #29 Grapheme_Cluster_Break），取值与 ucd.h 中的 UCD_GCB_XXX 一致
+GCB = ['Other', 'CR', 'LF', 'Control', 'Extend', 'ZWJ', 'Regional_Indicator', 'Prepend', 'SpacingMark',
+       'L', 'V', 'T', 'LV', 'LVT', 'Extended_Pictographic']
+
+# unicodedata 不提供以下属性，按 Unicode 14.0 的 PropList.txt/GraphemeBreakProperty.txt/emoji-data.txt 列出，
+# 与其余属性所依据的 unicodedata 版本必须一致，升级 Python 后需按新版本数据文件更新这些列表
+GCB_UNIDATA_VERSION = '14.0.0'
+OTHER_GRAPHEME_EXTEND = [(0x09BE, 0x09BE), (0x09D7, 0x09D7), (0x0B3E, 0x0B3E), (0x0B57, 0x0B57), (0x0BBE, 0x0BBE),
+                         (0x0BD7, 0x0BD7), (0x0CC2, 0x0CC2), (0x0CD5, 0x0CD6), (0x0D3E, 0x0D3E), (0x0D57, 0x0D57),
+                         (0x0DCF, 0x0DCF), (0x0DDF, 0x0DDF), (0x1B35, 0x1B35), (0x200C, 0x200C), (0x302E, 0x302F),
+                         (0xFF9E, 0xFF9F), (0x1133E, 0x1133E), (0x11357, 0x11357), (0x114B0, 0x114B0),
+                         (0x114BD, 0x114BD), (0x115AF, 0x115AF), (0x11930, 0x11930), (0x1D165, 0x1D165),
+                         (0x1D16E, 0x1D172), (0xE0020, 0xE007F), (0x1F3FB, 0x1F3FF)]
+PREPEND = [(0x0600, 0x0605), (0x06DD, 0x06DD), (0x070F, 0x070F), (0x0890, 0x0891), (0x08E2, 0x08E2), (0x0D4E, 0x0D4E),
+           (0x110BD, 0x110BD), (0x110CD, 0x110CD), (0x111C2, 0x111C3), (0x1193F, 0x1193F), (0x11941, 0x11941),
+           (0x11A3A, 0x11A3A), (0x11A84, 0x11A89), (0x11D46, 0x11D46)]
+# 属于 Mc 但不是 SpacingMark 的字符
+NOT_SPACING_MARK = [(0x102B, 0x102C), (0x1038, 0x1038), (0x1062, 0x1064), (0x1067, 0x106D), (0x1083, 0x1083),
+                    (0x1087, 0x108C), (0x108F, 0x108F), (0x109A, 0x109C), (0x1A61, 0x1A61), (0x1A63, 0x1A64),
+                    (0xAA7B, 0xAA7B), (0xAA7D, 0xAA7D), (0x11720, 0x11721)]
+EXTENDED_PICTOGRAPHIC = [(0x00A9, 0x00A9), (0x00AE, 0x00AE), (0x203C, 0x203C), (0x2049, 0x2049), (0x2122, 0x2122),
+                         (0x2139, 0x2139), (0x2194, 0x2199), (0x21A9, 0x21AA), (0x231A, 0x231B), (0x2328, 0x2328),
+                         (0x2388, 0x2388), (0x23CF, 0x23CF), (0x23E9, 0x23F3), (0x23F8, 0x23FA), (0x24C2, 0x24C2),
+                         (0x25AA, 0x25AB), (0x25B6, 0x25B6), (0x25C0, 0x25C0), (0x25FB, 0x25FE), (0x2600, 0x2605),
+                         (0x2607, 0x2612), (0x2614, 0x2685), (0x2690, 0x2705), (0x2708, 0x2712), (0x2714, 0x2714),
+                         (0x2716, 0x2716), (0x271D, 0x271D), (0x2721, 0x2721), (0x2728, 0x2728), (0x2733, 0x2734),
+                         (0x2744, 0x2744), (0x2747, 0x2747), (0x274C, 0x274C), (0x274E, 0x274E), (0x2753, 0x2755),
+                         (0x2757, 0x2757), (0x2763, 0x2767), (0x2795, 0x2797), (0x27A1, 0x27A1), (0x27B0, 0x27B0),
+                         (0x27BF, 0x27BF), (0x2934, 0x2935), (0x2B05, 0x2B07), (0x2B1B, 0x2B1C), (0x2B50, 0x2B50),
+                         (0x2B55, 0x2B55), (0x3030, 0x3030), (0x303D, 0x303D), (0x3297, 0x3297), (0x3299, 0x3299),
+                         (0x1F000, 0x1F0FF), (0x1F10D, 0x1F10F), (0x1F12F, 0x1F12F), (0x1F16C, 0x1F171),
+                         (0x1F17E, 0x1F17F), (0x1F18E, 0x1F18E), (0x1F191, 0x1F19A), (0x1F1AD, 0x1F1E5),
+                         (0x1F201, 0x1F20F), (0x1F21A, 0x1F21A), (0x1F22F, 0x1F22F), (0x1F232, 0x1F23A),
+                         (0x1F23C, 0x1F23F), (0x1F249, 0x1F3FA), (0x1F400, 0x1F53D), (0x1F546, 0x1F64F),
+                         (0x1F680, 0x1F6FF), (0x1F774, 0x1F77F), (0x1F7D5, 0x1F7FF), (0x1F80C, 0x1F80F),
+                         (0x1F848, 0x1F84F), (0x1F85A, 0x1F85F), (0x1F888, 0x1F88F), (0x1F8AE, 0x1F8FF),
+                         (0x1F90C, 0x1F93A), (0x1F93C, 0x1F945), (0x1F947, 0x1FAFF), (0x1FC00, 0x1FFFD)]
+HANGUL_L = [(0x1100, 0x115F), (0xA960, 0xA97C)]
+HANGUL_VS = [(0x1160, 0x11A7), (0xD7B0, 0xD7C6)]
+HANGUL_TS = [(0x11A8, 0x11FF), (0xD7CB, 0xD7FB)]
+
+
+def in_ranges(cp, ranges):
+    return any(lo <= cp <= hi for lo, hi in ranges)
+
+
+def gcb_of(cp):
+    ch = chr(cp)
+    cat = unicodedata.category(ch)
+    if cp == 0x0D:
+        return 'CR'
+    if cp == 0x0A:
+        return 'LF'
+    if cp == 0x200D:
+        return 'ZWJ'
+    if 0x1F1E6 <= cp <= 0x1F1FF:
+        return 'Regional_Indicator'
+    if in_ranges(cp, PREPEND):
+        return 'Prepend'
+    if cat in ('Mn', 'Me') or in_ranges(cp, OTHER_GRAPHEME_EXTEND):
+        return 'Extend'
+    if cat in ('Cc', 'Zl', 'Zp', 'Cf'):
+        return 'Control'
+    if cat == 'Cn' and (0xE0000 <= cp <= 0xE0FFF or 0xFFF0 <= cp <= 0xFFF8 or 0x2060 <= cp <= 0x206F):
+        return 'Control'    # 未分配的 Default_Ignorable_Code_Point
+    if (cat == 'Mc' and not in_ranges(cp, NOT_SPACING_MARK)) or cp in (0x0E33, 0x0EB3):
+        return 'SpacingMark'
+    if in_ranges(cp, HANGUL_L):
+        return 'L'
+    if in_ranges(cp, HANGUL_VS):
+        return 'V'
+    if in_ranges(cp, HANGUL_TS):
+        return 'T'
+    if HANGUL_S[0] <= cp <= HANGUL_S[1]:
+        return 'LV' if (cp - HANGUL_S[0]) % 28 == 0 else 'LVT'
+    if in_ranges(cp, EXTENDED_PICTOGRAPHIC):
+        return 'Extended_Pictographic'
+    return 'Other'
+
+
+def gen_gcb(out):
+    values = {}
+    assert unicodedata.unidata_version == GCB_UNIDATA_VERSION, \
+        'unicodedata 的 Unicode 版本为 %s ，内置的字素簇属性列表为 %s ，需先更新列表' % (
+            unicodedata.unidata_version, GCB_UNIDATA_VERSION)
+    for cp in range(MAX_CP):
+        if is_surrogate(cp):
+            continue
+        v = GCB.index(gcb_of(cp))
+        if v:
+            values[cp] = v
+    out.append('// 字素簇分界属性：取值不超过 4 位，二级表按半字节存放')
+    emit_two_stage(out, 'ucd_gcb', values, 0, 7, True)
+
+
+# 排序权重：由随源码提交的 DUCET（allkeys.txt）生成，与 unicodedata 无关。
+# 排序元素打包为 32 位：主权重 16 位、次要权重 9 位、第三级权重 5 位（低位），可变权重标记（*）不保留。
+# 二级表的值为 0 表示按码点计算隐式权重；UCD_COLL_SINGLE | 元素 是单个排序元素；
+# 否则是 下标 << 5 | 个数 ，指向排序元素池 ucd_coll_ces 。UCD_COLL_STARTER 标记收缩（多码点条目）的首码点。
+ALLKEYS = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'allkeys.txt')
+COLL_SINGLE = 0x80000000
+COLL_STARTER = 0x40000000
+
+# UCA 隐式权重的汉字范围（Unicode 13.0 的 Unified_Ideograph），须与 allkeys.txt 的版本一致
+CORE_HAN = [(0x4E00, 0x9FFC), (0xFA0E, 0xFA0F), (0xFA11, 0xFA11), (0xFA13, 0xFA14), (0xFA1F, 0xFA1F),
+            (0xFA21, 0xFA21), (0xFA23, 0xFA24), (0xFA27, 0xFA29)]
+OTHER_HAN = [(0x3400, 0x4DBF), (0x20000, 0x2A6DD), (0x2A700, 0x2B734), (0x2B740, 0x2B81D),
+             (0x2B820, 0x2CEA1), (0x2CEB0, 0x2EBE0), (0x30000, 0x3134A)]
+COLL_UNIDATA_VERSION = '13.0.0'
+
+
+def pack_ce(primary, secondary, tertiary):
+    assert primary < 0x10000 and secondary < 0x200 and tertiary < 0x20
+    return (primary << 14) | (secondary << 5) | tertiary
+
+
+def gen_coll(out):
+    version = None
+    implicit = []
+    entries = {}
+    with open(ALLKEYS) as f:
+        for line in f:
+            line = line.split('#')[0].strip()
+            if not line:
+                continue
+            if line.startswith('@version'):
+                version = line.split()[1]
+            elif line.startswith('@implicitweights'):
+                m = re.match(r'@implicitweights ([0-9A-F]+)\.\.([0-9A-F]+); ([0-9A-F]+)$', line)
+                implicit.append((int(m.group(1), 16), int(m.group(2), 16), int(m.group(3), 16)))
+            else:
+                key, ces = line.split(';')
+                seq = tuple(int(cp, 16) for cp in key.split())
+                ces = re.findall(r'\[[.*]([0-9A-F]+)\.([0-9A-F]+)\.([0-9A-F]+)\]', ces)
+                entries[seq] = [pack_ce(int(p, 16), int(s, 16), int(t, 16)) for p, s, t in ces]
+    assert version == COLL_UNIDATA_VERSION, \
+        'allkeys.txt 的版本为 %s ，内置的汉字范围为 %s ，需先更新范围' % (version, COLL_UNIDATA_VERSION)
+
+    # 多个元素的条目存入元素池，内容相同的只保存一份
+    pool = []
+    seen = {}
+
+    def ref_of(ces):
+        if len(ces) == 1:
+            return COLL_SINGLE | ces[0]
+        ces = tuple(ces)
+        if ces not in seen:
+            seen[ces] = len(pool)
+            pool.extend(ces)
+        assert len(ces) < 32
+        return (seen[ces] << 5) | len(ces)
+
+    values = {}
+    contractions = []
+    for seq, ces in sorted(entries.items()):
+        if len(seq) == 1:
+            values[seq[0]] = values.get(seq[0], 0) | ref_of(ces)
+        else:
+            assert len(seq) <= 3 and (seq[0],) in entries
+            values[seq[0]] = values.get(seq[0], 0) | COLL_STARTER
+            contractions.append(seq + (0,) * (3 - len(seq)) + (ref_of(ces),))
+    assert len(pool) < (1 << 25)
+
+    # 隐式权重范围：起点为 0 时按汉字计算（AAAA = 基数 + (cp >> 15)），否则 BBBB 是相对起点的偏移
+    ranges = [(lo, hi, 0xFB40, 0) for lo, hi in CORE_HAN] + [(lo, hi, 0xFB80, 0) for lo, hi in OTHER_HAN]
+    for lo, hi, base in implicit:
+        # 只有块中已分配的码点使用该基数
+        origin = min(r[0] for r in implicit if r[2] == base)
+        first = None
+        for cp in range(lo, hi + 2):
+            if cp <= hi and unicodedata.category(chr(cp)) != 'Cn':
+                first = cp if first is None else first
+            elif first is not None:
+                ranges.append((first, cp - 1, base, origin))
+                first = None
+
+    out.append('// 排序权重（DUCET %s）' % version)
+    out.append('#define UCD_COLL_VERSION "%s"' % version)
+    out.append('#define UCD_COLL_SINGLE 0x%08X   // 单个排序元素，直接存放在低 30 位' % COLL_SINGLE)
+    out.append('#define UCD_COLL_STARTER 0x%08X  // 收缩的首码点' % COLL_STARTER)
+    out.append('#define UCD_COLL_CES_MAX %d   // 单个条目至多包含的排序元素数' % max(len(ces) for ces in entries.values()))
+    out.append('#define UCD_COLL_CONTRACTIONS %d' % len(contractions))
+    out.append('#define UCD_COLL_IMPLICITS %d' % len(ranges))
+    out.append('')
+    emit_two_stage(out, 'ucd_coll', values, 0)
+    emit_array(out, 'ucd_coll_ces', pool)
+    out.append('// 收缩：每项依次是 3 个码点（不足补 0 ）和条目的值，按码点升序排列')
+    emit_array(out, 'ucd_coll_contractions', [v for c in contractions for v in c], 4)
+    out.append('// 隐式权重：每项依次是首末码点、主权重基数和偏移起点')
+    emit_array(out, 'ucd_coll_implicits', [v for r in ranges for v in r], 4)
+
+
+def main():
+    out = [
+        '// 本文件由 src/str/ucd.py 生成，请勿修改，重新生成：cmake --build <构建目录> --target ucd_table',
+        '// Unicode 版本：%s' % unicodedata.unidata_version,
+        '',
+        '#ifndef _AUX_STR_UCD_TABLE_H_',
+        '#define _AUX_STR_UCD_TABLE_H_ 1',
+        '',
+        '#define UCD_VERSION "%s"' % unicodedata.unidata_version,
+        '',
+    ]
+    gen_fold(out)
+    gen_case(out, 'lower', str.lower)
+    gen_case(out, 'upper', str.upper)
+    gen_case(out, 'casefold', str.casefold)
+    gen_norm(out)
+    gen_gcb(out)
+    gen_coll(out)
+    out.append('#endif // _AUX_STR_UCD_TABLE_H_')
+
+    with open(sys.argv[1], 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+
+if __name__ == '__main__':
+    main()
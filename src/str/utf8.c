@@ -1,5 +1,6 @@
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "str/utf8.h"
 #include "str/misc.h"
@@ -48,15 +49,15 @@ uint32_t utf8_measure_by_lookup(const char_t * pos)
     return chars[get_token(*pos)];
 } // utf8_measure_by_lookup
 
-bool utf8_count(const char_t * start, uint32_t * bytes, uint32_t * chars)
+bool utf8_count(const char_t * start, str_size_t * bytes, str_size_t * chars)
 {
     const char_t * pos = NULL;
     const char_t * end = NULL;
-    uint32_t i = 0;
+    str_size_t i = 0;
     uint32_t cnt = 0; // 跟随字节数
     uint32_t chk = 0; // 正确字节数
     uint32_t ena = 0; // 累加开关
-    uint32_t max = 0; // 检查字符数上限
+    str_size_t max = 0; // 检查字符数上限
 
     max = *bytes < *chars ? *bytes : *chars; // 字符数 <= 范围内字节数
     end = start + *bytes;
@@ -82,9 +83,134 @@ bool utf8_count(const char_t * start, uint32_t * bytes, uint32_t * chars)
     return i == max || pos == end;
 } // utf8_count
 
-bool utf8_verify_plain(const char_t * start, uint32_t * bytes, uint32_t * chars)
+#define UTF8_HIGH_BITS 0x8080808080808080ULL
+
+inline static uint64_t load_word(const char_t * pos)
+{
+    uint64_t word = 0;
+    memcpy(&word, pos, sizeof(word)); // 允许非对齐地址
+    return word;
+} // load_word
+
+bool utf8_validate(const char_t * start, str_size_t * bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + *bytes;
+    uint32_t cnt = 0; // 跟随字节数
+
+    while (pos < end) {
+        if (end - pos >= 8 && (load_word(pos) & UTF8_HIGH_BITS) == 0) {
+            pos += 8; // 整块都是 ASCII 字符
+            continue;
+        } // if
+
+        if (pos[0] < 0x80) {
+            pos += 1;
+            continue;
+        } // if
+
+        cnt = utf8_measure(pos);
+        if (cnt == 0 || end - pos < cnt) break; // 首字节异常或字符被截断
+        switch (cnt) {
+            case 4: if ((pos[3] & 0xC0) != 0x80) goto UTF8_VALIDATE_END;
+            case 3: if ((pos[2] & 0xC0) != 0x80) goto UTF8_VALIDATE_END;
+            case 2: if ((pos[1] & 0xC0) != 0x80) goto UTF8_VALIDATE_END;
+            default: break;
+        } // switch
+        pos += cnt;
+    } // while
+
+UTF8_VALIDATE_END:
+    *bytes = pos - start;
+    return pos == end;
+} // utf8_validate
+
+str_size_t utf8_chars(const char_t * start, str_size_t bytes)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    uint64_t word = 0;
+    str_size_t tails = 0; // 跟随字节数
+
+    for (; end - pos >= 8; pos += 8) {
+        word = load_word(pos);
+        // 跟随字节形如 0b10xxxxxx ：最高位为 1 且次高位为 0
+        tails += __builtin_popcountll(word & ~(word << 1) & UTF8_HIGH_BITS);
+    } // for
+    for (; pos < end; ++pos) tails += (pos[0] & 0xC0) == 0x80;
+    return bytes - tails;
+} // utf8_chars
+
+str_size_t utf8_rseek(const char_t * start, str_size_t bytes, str_size_t * chars)
+{
+    const char_t * pos = start + bytes;
+    uint64_t word = 0;
+    uint32_t heads = 0; // 整块中的非跟随字节数
+    str_size_t need = *chars;
+    str_size_t cnt = 0; // 已经过的字符数
+
+    while (pos > start && cnt < need) {
+        if (pos - start >= 8) {
+            word = load_word(pos - 8);
+            heads = 8 - __builtin_popcountll(word & ~(word << 1) & UTF8_HIGH_BITS);
+            if (cnt + heads < need) {
+                // 目标字符不在整块内
+                cnt += heads;
+                pos -= 8;
+                continue;
+            } // if
+        } // if
+
+        // 逐个字节向前检查，停在目标字符的首字节上
+        for (; pos > start && cnt < need; --pos) {
+            if ((pos[-1] & 0xC0) != 0x80) ++cnt;
+        } // for
+    } // while
+
+    *chars = cnt;
+    return start + bytes - pos;
+} // utf8_rseek
+
+str_size_t utf8_checkpoints(const char_t * start, str_size_t bytes, uint32_t step, str_size_t * offs, str_size_t max)
+{
+    const char_t * pos = start;
+    const char_t * end = start + bytes;
+    uint64_t word = 0;
+    uint32_t heads = 0; // 整块中的非跟随字节数
+    str_size_t chars = 0; // 已经过的字符数
+    str_size_t next = 0; // 下个检查点的字符序号
+    str_size_t cnt = 0; // 检查点个数
+    uint32_t i = 0;
+
+    assert(step > 0);
+
+    while (pos < end && cnt < max) {
+        if (end - pos >= 8) {
+            word = load_word(pos);
+            heads = 8 - __builtin_popcountll(word & ~(word << 1) & UTF8_HIGH_BITS);
+            if (chars + heads <= next) {
+                // 整块内没有检查点
+                chars += heads;
+                pos += 8;
+                continue;
+            } // if
+        } // if
+
+        // 逐个字节检查，直到整块结束
+        for (i = 0; i < 8 && pos < end && cnt < max; ++i, ++pos) {
+            if ((pos[0] & 0xC0) == 0x80) continue; // 跟随字节
+            if (chars++ == next) {
+                offs[cnt++] = pos - start;
+                next += step;
+            } // if
+        } // for
+    } // while
+    return cnt;
+} // utf8_checkpoints
+
+bool utf8_verify_plain(const char_t * start, str_size_t * bytes, str_size_t * chars)
 {
-    int i = 0;
+    str_size_t i = 0;
     *chars = 0;
     while (i < *bytes) {
         if (start[i] <= 0x7F) {
@@ -159,7 +285,7 @@ inline static uint8_t move_next(const uint8_t sts, const char_t ch)
     return next[sts][get_token(ch)];
 } // move_next
 
-uint8_t verify_part(uint8_t sts, const char_t * pos, const uint32_t bytes, uint32_t * ng_bytes, uint32_t * chars)
+uint8_t verify_part(uint8_t sts, const char_t * pos, const uint32_t bytes, str_size_t * ng_bytes, str_size_t * chars)
 {
     switch(bytes) {
         case 8: sts = move_next(sts, *pos++); *ng_bytes += sts == UTF8_VSS_ERROR; *chars += sts == UTF8_VSS_ASCII;
@@ -175,17 +301,17 @@ uint8_t verify_part(uint8_t sts, const char_t * pos, const uint32_t bytes, uint3
     return sts;
 } // verify_part
 
-uint8_t utf8_verify_by_lookup_in_stream(const uint8_t sts, const char_t * const start, uint32_t * const bytes, uint32_t * const chars)
+uint8_t utf8_verify_by_lookup_in_stream(const uint8_t sts, const char_t * const start, str_size_t * const bytes, str_size_t * const chars)
 {
     const char_t * pos = NULL;
     const char_t * begin = NULL;
     const char_t * end = NULL;
-    uint32_t ok_bytes = 0;
-    uint32_t ng_bytes = 0;
-    uint32_t ok_chars = 0;
+    str_size_t ok_bytes = 0;
+    str_size_t ng_bytes = 0;
+    str_size_t ok_chars = 0;
     uint32_t leads = 0;
     uint32_t tails = 0;
-    uint32_t chunks = 0;
+    str_size_t chunks = 0;
     uint8_t curr_sts = sts;
     uint8_t prev_sts = sts;
     const uint32_t chunk_size = 8;
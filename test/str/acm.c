@@ -0,0 +1,122 @@
+#include <criterion/criterion.h>
+
+#ifndef ACM_SOURCE
+#define ACM_SOURCE 1
+#include "str/acm.c"
+#endif
+
+// 扫描全部匹配，按结尾位置记录 (结尾偏移量, 模式编号)
+static int scan_all(str_acm_p ac, const char_t * start, str_size_t bytes, str_size_t * ends, int32_t * ids, int max)
+{
+    const char_t * pos = start;
+    uint32_t state = 0;
+    uint32_t e = 0;
+    int cnt = 0;
+
+    while ((pos = str_acm_scan(ac, pos, start + bytes, &state))) {
+        for (e = ac->emit[state]; e && cnt < max; e = ac->dict[e], ++cnt) {
+            ends[cnt] = pos - start;
+            ids[cnt] = ac->out[e];
+        } // for
+    } // while
+    return cnt;
+} // scan_all
+
+Test(Function, str_acm_classic)
+{
+    const char_t * needles[] = {(const char_t *)"he", (const char_t *)"she", (const char_t *)"his", (const char_t *)"hers"};
+    const str_size_t bytes[] = {2, 3, 3, 4};
+    const char_t text[] = {"ushers"};
+    const str_size_t r_ends[] = {4, 4, 6};
+    const int32_t r_ids[] = {1, 0, 3};
+    str_size_t ends[8] = {0};
+    int32_t ids[8] = {0};
+    str_acm_p ac = str_acm_new(needles, bytes, 4);
+    int cnt = 0;
+    int i = 0;
+
+    cr_assert(ac != NULL, "str_acm_new() fails");
+    cr_expect(ac->states == 10 && ac->classes == 6, "str_acm_new() builds wrong automaton: got %u states, %u classes", ac->states, ac->classes);
+
+    // 同一结尾处先报告较长的模式
+    cnt = scan_all(ac, text, sizeof(text) - 1, ends, ids, 8);
+    cr_expect(cnt == 3, "str_acm_scan() return incorrect count: expect %d, got %d", 3, cnt);
+    for (i = 0; i < cnt && i < 3; ++i) {
+        cr_expect(ends[i] == r_ends[i] && ids[i] == r_ids[i], "str_acm_scan() return incorrect match %d: expect %" STR_SIZE_FMT "/%d, got %" STR_SIZE_FMT "/%d", i, r_ends[i], r_ids[i], ends[i], ids[i]);
+    } // for
+
+    str_acm_delete(ac);
+} // str_acm_classic
+
+Test(Function, str_acm_random)
+{
+    char_t text[2000] = {0};
+    char_t pool[64][8] = {{0}};
+    const char_t * needles[64] = {NULL};
+    str_size_t bytes[64] = {0};
+    str_size_t ends[4096] = {0};
+    int32_t ids[4096] = {0};
+    str_acm_p ac = NULL;
+    uint32_t seed = 3;
+    str_size_t e = 0;
+    int expect = 0;
+    int cnt = 0;
+    int i = 0;
+    int j = 0;
+
+    for (i = 0; i < sizeof(text); ++i) {
+        seed = seed * 1103515245 + 12345;
+        text[i] = 'a' + (seed >> 16) % 4;
+    } // for
+
+    // 长短不一、互为前后缀的模式，编号按长度降序排列，方便与朴素结果对照
+    for (i = 0; i < 64; ++i) {
+        bytes[i] = 6 - i / 13;
+        do {
+            for (j = 0; j < bytes[i]; ++j) {
+                seed = seed * 1103515245 + 12345;
+                pool[i][j] = 'a' + (seed >> 16) % 4;
+            } // for
+            for (j = 0; j < i && ! (bytes[j] == bytes[i] && memcmp(pool[j], pool[i], bytes[i]) == 0); ++j) ;
+        } while (j < i); // 避免重复模式
+        needles[i] = pool[i];
+    } // for
+
+    ac = str_acm_new(needles, bytes, 64);
+    cr_assert(ac != NULL, "str_acm_new() fails");
+    cnt = scan_all(ac, text, sizeof(text), ends, ids, 4096);
+
+    // 朴素对照：逐个结尾位置，按长度降序检查全部模式
+    for (e = 1, j = 0; e <= sizeof(text); ++e) {
+        for (i = 0; i < 64; ++i) {
+            if (bytes[i] > e || memcmp(text + e - bytes[i], needles[i], bytes[i]) != 0) continue;
+            if (j < cnt) cr_expect(ends[j] == e && ids[j] == i, "str_acm_scan() return incorrect match %d: expect %" STR_SIZE_FMT "/%d, got %" STR_SIZE_FMT "/%d", j, e, i, ends[j], ids[j]);
+            ++j;
+        } // for
+    } // for
+    expect = j;
+    cr_expect(cnt == expect, "str_acm_scan() return incorrect count: expect %d, got %d", expect, cnt);
+
+    str_acm_delete(ac);
+} // str_acm_random
+
+Test(Function, str_acm_longest)
+{
+    const char_t * needles[] = {(const char_t *)"a", (const char_t *)"ab", (const char_t *)"abcd", (const char_t *)"bc", (const char_t *)"ab"};
+    const str_size_t bytes[] = {1, 2, 4, 2, 2};
+    const char * texts[] = {"abcd", "abc", "abx", "ax", "bcd", "cab", "", "abcdabcd"};
+    const int32_t r_ids[] = {2, 1, 1, 0, 3, STR_ACM_NO_OUTPUT, STR_ACM_NO_OUTPUT, 2};
+    str_acm_p ac = str_acm_new(needles, bytes, 5);
+    int32_t id = 0;
+    int i = 0;
+
+    cr_assert(ac != NULL, "str_acm_new() fails");
+
+    // 只考虑以起始位置开头的模式，重复的模式报告编号最小者
+    for (i = 0; i < sizeof(texts) / sizeof(texts[0]); ++i) {
+        id = str_acm_longest(ac, (const char_t *)texts[i], (const char_t *)texts[i] + strlen(texts[i]));
+        cr_expect(id == r_ids[i], "str_acm_longest(\"%s\") return incorrect id: expect %d, got %d", texts[i], r_ids[i], id);
+    } // for
+
+    str_acm_delete(ac);
+} // str_acm_longest
@@ -25,6 +25,11 @@ typedef struct UT {
 #define S3_STR "\x20\x40\x7F"
 #define S3_REPR "\\x20\\x40\\x7F"
 
+#define S4_STR "ABCD"
+#define S4_REPR "ABCD"
+#define S9_STR "ABCDEFGHI"
+#define S9_REPR "ABCDEFGHI"
+
 #define B1_STR "\0"
 #define B1_REPR "\\0"
 #define B2_STR "A\x80"
@@ -66,6 +71,8 @@ Test(Function, ascii_count)
         {.bytes = 1, .chars = 1, .i_bytes = 1, .i_chars = 1, .r_bytes = 1, .r_chars = 1, .result = true, .name = "s1", .str = {S1_STR}, .repr = {S1_REPR}},
         {.bytes = 2, .chars = 2, .i_bytes = 2, .i_chars = 2, .r_bytes = 2, .r_chars = 2, .result = true, .name = "s2", .str = {S2_STR}, .repr = {S2_REPR}},
         {.bytes = 3, .chars = 3, .i_bytes = 3, .i_chars = 3, .r_bytes = 3, .r_chars = 3, .result = true, .name = "s3", .str = {S3_STR}, .repr = {S3_REPR}},
+        {.bytes = 4, .chars = 4, .i_bytes = 4, .i_chars = 4, .r_bytes = 4, .r_chars = 4, .result = true, .name = "s4", .str = {S4_STR}, .repr = {S4_REPR}},
+        {.bytes = 9, .chars = 9, .i_bytes = 9, .i_chars = 8, .r_bytes = 8, .r_chars = 8, .result = true, .name = "s9_8", .str = {S9_STR}, .repr = {S9_REPR}},
 
         {.bytes = 3, .chars = 3, .i_bytes = 3, .i_chars = 1, .r_bytes = 1, .r_chars = 1, .result = true, .name = "s3_1", .str = {S3_STR}, .repr = {S3_REPR}},
         {.bytes = 3, .chars = 3, .i_bytes = 2, .i_chars = 3, .r_bytes = 2, .r_chars = 2, .result = true, .name = "s3_2", .str = {S3_STR}, .repr = {S3_REPR}},
@@ -80,16 +87,16 @@ Test(Function, ascii_count)
     };
 
     int i = 0;
-    uint32_t r_bytes = 0;
-    uint32_t r_chars = 0;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
     bool ret = false;
 
     for (i = 0; i < sizeof(sc) / sizeof(sc[0]); ++i) {
         r_bytes = sc[i].i_bytes;
         r_chars = sc[i].i_chars;
         ret = ascii_count(sc[i].str, &r_bytes, &r_chars);
-        cr_expect(r_bytes == sc[i].r_bytes, "ascii_count(%s) return incorrect bytes: expect %d, got %d", sc[i].name, sc[i].r_bytes, r_bytes);
-        cr_expect(r_chars == sc[i].r_chars, "ascii_count(%s) return incorrect chars: expect %d, got %d", sc[i].name, sc[i].r_chars, r_chars);
+        cr_expect(r_bytes == sc[i].r_bytes, "ascii_count(%s) return incorrect bytes: expect %d, got %" STR_SIZE_FMT, sc[i].name, sc[i].r_bytes, r_bytes);
+        cr_expect(r_chars == sc[i].r_chars, "ascii_count(%s) return incorrect chars: expect %d, got %" STR_SIZE_FMT, sc[i].name, sc[i].r_chars, r_chars);
         cr_expect(ret == sc[i].result, "ascii_count(%s) return incorrect result: expect %d, got %d", sc[i].name, sc[i].result, ret);
     } // for
 /*
@@ -150,3 +157,127 @@ Test(Function, ascii_count)
 */
 } // ascii_count
 
+
+Test(Function, ascii_validate)
+{
+    static ut_t sc[] = {
+        {.i_bytes = 3, .r_bytes = 3, .result = true, .name = "s3", .str = {S3_STR}, .repr = {S3_REPR}},
+        {.i_bytes = 9, .r_bytes = 9, .result = true, .name = "s9", .str = {S9_STR}, .repr = {S9_REPR}},
+        {.i_bytes = 2, .r_bytes = 1, .result = false, .name = "b2", .str = {B2_STR}, .repr = {B2_REPR}},
+        {.i_bytes = 3, .r_bytes = 1, .result = false, .name = "b5", .str = {B5_STR}, .repr = {B5_REPR}},
+        {.i_bytes = 11, .r_bytes = 10, .result = false, .name = "b9", .str = {S9_STR B2_STR}, .repr = {S9_REPR B2_REPR}},
+    };
+
+    int i = 0;
+    str_size_t r_bytes = 0;
+    bool ret = false;
+
+    for (i = 0; i < sizeof(sc) / sizeof(sc[0]); ++i) {
+        r_bytes = sc[i].i_bytes;
+        ret = ascii_validate(sc[i].str, &r_bytes);
+        cr_expect(r_bytes == sc[i].r_bytes, "ascii_validate(%s) return incorrect bytes: expect %d, got %" STR_SIZE_FMT, sc[i].name, sc[i].r_bytes, r_bytes);
+        cr_expect(ret == sc[i].result, "ascii_validate(%s) return incorrect result: expect %d, got %d", sc[i].name, sc[i].result, ret);
+    } // for
+} // ascii_validate
+
+Test(Function, ascii_span)
+{
+    static ut_t sc[] = {
+        {.i_bytes = 3, .r_bytes = 3, .name = "s3", .str = {S3_STR}, .repr = {S3_REPR}},
+        {.i_bytes = 9, .r_bytes = 9, .name = "s9", .str = {S9_STR}, .repr = {S9_REPR}},
+        {.i_bytes = 1, .r_bytes = 1, .name = "b1", .str = {B1_STR}, .repr = {B1_REPR}},
+        {.i_bytes = 2, .r_bytes = 1, .name = "b2", .str = {B2_STR}, .repr = {B2_REPR}},
+        {.i_bytes = 11, .r_bytes = 10, .name = "b9", .str = {S9_STR B2_STR}, .repr = {S9_REPR B2_REPR}},
+    };
+
+    int i = 0;
+    str_size_t r_bytes = 0;
+
+    for (i = 0; i < sizeof(sc) / sizeof(sc[0]); ++i) {
+        r_bytes = ascii_span(sc[i].str, sc[i].i_bytes);
+        cr_expect(r_bytes == sc[i].r_bytes, "ascii_span(%s) return incorrect bytes: expect %d, got %" STR_SIZE_FMT, sc[i].name, sc[i].r_bytes, r_bytes);
+    } // for
+} // ascii_span
+
+Test(Function, ascii_fold_prefix)
+{
+    char_t s1[90] = {0};
+    char_t s2[90] = {0};
+    str_size_t i = 0;
+    str_size_t k = 0;
+    str_size_t ret = 0;
+
+    // 覆盖 '@' '[' '`' '{' 等与字母相邻的字节，以及不小于 0x80 的字节
+    for (i = 0; i < sizeof(s1); ++i) {
+        s1[i] = (i % 2) ? 0x40 + i % 0x40 : 0xC0 + i % 0x40;
+        s2[i] = (s1[i] >= 'a' && s1[i] <= 'z') ? s1[i] - 0x20 : s1[i];
+    } // for
+
+    ret = ascii_fold_prefix(s1, s2, sizeof(s1));
+    cr_expect(ret == sizeof(s1), "ascii_fold_prefix() return incorrect bytes: expect %d, got %" STR_SIZE_FMT, (int)sizeof(s1), ret);
+
+    for (k = 0; k < sizeof(s1); ++k) {
+        s2[k] ^= (s1[k] == '@' || s1[k] >= 0x80) ? 0x01 : 0x10; // 折叠后仍不相同
+        ret = ascii_fold_prefix(s1, s2, sizeof(s1));
+        cr_expect(ret == k, "ascii_fold_prefix() return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, k, ret);
+        s2[k] ^= (s1[k] == '@' || s1[k] >= 0x80) ? 0x01 : 0x10;
+    } // for
+
+    cr_expect(ascii_fold_prefix((const char_t *)"[@`{", (const char_t *)"{`@[", 4) == 0, "ascii_fold_prefix() folds non-letters");
+    cr_expect(ascii_fold_prefix((const char_t *)"\xC3\x80", (const char_t *)"\xE3\xA0", 2) == 0, "ascii_fold_prefix() folds non-ASCII bytes");
+} // ascii_fold_prefix
+
+Test(Function, ascii_case_convert)
+{
+    char_t src[90] = {0};
+    char_t dst[90] = {0};
+    str_size_t i = 0;
+    str_size_t ret = 0;
+
+    // 覆盖字母前后相邻的字节，以及不小于 0x80 的字节
+    for (i = 0; i < sizeof(src); ++i) src[i] = (i % 3) ? 0x3F + i % 0x42 : 0xC1 + i;
+
+    ascii_case_convert(dst, src, sizeof(src), 'A');
+    for (i = 0; i < sizeof(src); ++i) {
+        cr_expect(dst[i] == ((src[i] >= 'A' && src[i] <= 'Z') ? src[i] + 0x20 : src[i]), "ascii_case_convert() return incorrect byte at %" STR_SIZE_FMT ": src 0x%02X, got 0x%02X", i, src[i], dst[i]);
+    } // for
+
+    ascii_case_convert(dst, src, sizeof(src), 'a');
+    for (i = 0; i < sizeof(src); ++i) {
+        cr_expect(dst[i] == ((src[i] >= 'a' && src[i] <= 'z') ? src[i] - 0x20 : src[i]), "ascii_case_convert() return incorrect byte at %" STR_SIZE_FMT ": src 0x%02X, got 0x%02X", i, src[i], dst[i]);
+    } // for
+
+    // 原地转换后不再有小写字母
+    ascii_case_convert(src, src, sizeof(src), 'a');
+    ret = ascii_case_span(src, sizeof(src), 'a');
+    cr_expect(ret == sizeof(src), "ascii_case_span() return incorrect bytes: expect %d, got %" STR_SIZE_FMT, (int)sizeof(src), ret);
+
+    for (i = 0; i < sizeof(src); ++i) {
+        if (src[i] >= 'A' && src[i] <= 'Z') break;
+    } // for
+    ret = ascii_case_span(src, sizeof(src), 'A');
+    cr_expect(ret == i, "ascii_case_span() return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, i, ret);
+    cr_expect(ascii_case_span((const char_t *)"@[`{\xC1\xDA", 6, 'A') == 6, "ascii_case_span() stops at non-letters");
+} // ascii_case_convert
+
+Test(Function, ascii_span_below)
+{
+    char_t buf[90] = {0};
+    str_size_t i = 0;
+    str_size_t ret = 0;
+
+    // 混合 ASCII 与首字节低于上限的双字节字符
+    for (i = 0; i < sizeof(buf); ++i) buf[i] = (i % 4 == 1) ? 0xC3 : (i % 4 == 2) ? 0xA9 : 'a' + i % 26;
+
+    ret = ascii_span_below(buf, sizeof(buf), 0xCC);
+    cr_expect(ret == sizeof(buf), "ascii_span_below() return incorrect bytes: expect %d, got %" STR_SIZE_FMT, (int)sizeof(buf), ret);
+    ret = ascii_span_below(buf, sizeof(buf), 0x80);
+    cr_expect(ret == 1, "ascii_span_below() return incorrect bytes: expect 1, got %" STR_SIZE_FMT, ret);
+
+    for (i = 0; i < sizeof(buf); ++i) {
+        buf[i] += 0x20; // 0xC3 变为 0xE3 ，超出上限
+        ret = ascii_span_below(buf, sizeof(buf), 0xCC);
+        cr_expect(ret == ((buf[i] >= 0xCC) ? i : sizeof(buf)), "ascii_span_below() return incorrect bytes at %" STR_SIZE_FMT ": got %" STR_SIZE_FMT, i, ret);
+        buf[i] -= 0x20;
+    } // for
+} // ascii_span_below
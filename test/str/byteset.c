@@ -0,0 +1,69 @@
+#include <criterion/criterion.h>
+
+#ifndef BYTESET_SOURCE
+#define BYTESET_SOURCE 1
+#include "str/byteset.c"
+#endif
+
+Test(Function, str_byteset_space)
+{
+    str_byteset_t set;
+    int i = 0;
+
+    // 静态定义的空白字符集合与编译结果一致
+    str_byteset_init(&set, (const char_t *)" \t\n\v\f\r", 6);
+    cr_expect(set.exact && memcmp(set.member, str_byteset_space.member, 256) == 0, "str_byteset_init() builds incorrect members");
+    for (i = 0; i < 256; ++i) {
+        cr_expect(((set.lo[i & 0xF] & set.hi[i >> 4]) != 0) == ((str_byteset_space.lo[i & 0xF] & str_byteset_space.hi[i >> 4]) != 0), "str_byteset_space has incorrect nibble tables for byte %d", i);
+        cr_expect(((set.lo[i & 0xF] & set.hi[i >> 4]) != 0) == set.member[i], "str_byteset_init() builds incorrect nibble tables for byte %d", i);
+    } // for
+} // str_byteset_space
+
+Test(Function, str_byteset_random)
+{
+    char_t text[300] = {0};
+    char_t bytes[64] = {0};
+    str_byteset_t set;
+    const char_t * end = NULL;
+    const char_t * r_pos = NULL;
+    const char_t * pos = NULL;
+    uint32_t seed = 5;
+    int n = 0;
+    int round = 0;
+    int from = 0;
+    int i = 0;
+
+    for (round = 0; round < 500; ++round) {
+        // 成员数从少到多，较大的集合会用完 8 个桶，查表结果不精确
+        n = round % 64;
+        for (i = 0; i < n; ++i) {
+            seed = seed * 1103515245 + 12345;
+            bytes[i] = seed >> 16;
+        } // for
+        str_byteset_init(&set, bytes, n);
+        for (i = 0; i < 256; ++i) {
+            cr_assert(set.member[i] == 0 || (set.lo[i & 0xF] & set.hi[i >> 4]) != 0, "str_byteset_init() misses byte %d", i);
+        } // for
+
+        // 文本大部分由成员组成，检验各函数在不同长度和对齐下的结果
+        for (i = 0; i < sizeof(text); ++i) {
+            seed = seed * 1103515245 + 12345;
+            text[i] = (n > 0 && (seed >> 16) % ((round % 2) ? 8 : 512) != 0) ? bytes[(seed >> 20) % n] : (seed >> 8);
+        } // for
+        seed = seed * 1103515245 + 12345;
+        from = (seed >> 16) % 40;
+        end = text + from + (seed >> 24) % (sizeof(text) - from);
+
+        for (r_pos = text + from; r_pos < end && ! set.member[*r_pos]; ++r_pos) ;
+        pos = str_byteset_find(&set, text + from, end);
+        cr_expect(pos == (r_pos < end ? r_pos : NULL), "str_byteset_find() return incorrect position in round %d", round);
+
+        for (r_pos = text + from; r_pos < end && set.member[*r_pos]; ++r_pos) ;
+        pos = str_byteset_skip(&set, text + from, end);
+        cr_expect(pos == (r_pos < end ? r_pos : NULL), "str_byteset_skip() return incorrect position in round %d", round);
+
+        for (r_pos = end; r_pos > text + from && set.member[r_pos[-1]]; --r_pos) ;
+        pos = str_byteset_rskip(&set, text + from, end);
+        cr_expect(pos == r_pos, "str_byteset_rskip() return incorrect position in round %d", round);
+    } // for
+} // str_byteset_random
@@ -0,0 +1,71 @@
+#include <criterion/criterion.h>
+
+#ifndef LZ4_SOURCE
+#define LZ4_SOURCE 1
+#include "str/lz4.c"
+#endif
+
+static void check_round_trip(const char * name, const char_t * src, str_size_t bytes)
+{
+    char_t * packed = malloc(lz4_bound(bytes));
+    char_t * plain = malloc(bytes + 1);
+    str_size_t packed_bytes = 0;
+    str_size_t plain_bytes = bytes;
+
+    packed_bytes = lz4_compress(src, bytes, packed, lz4_bound(bytes));
+    cr_expect(packed_bytes > 0, "%s: lz4_compress() fails", name);
+    cr_expect(lz4_decompress(packed, packed_bytes, plain, &plain_bytes), "%s: lz4_decompress() rejects own output", name);
+    cr_expect(plain_bytes == bytes && memcmp(plain, src, bytes) == 0, "%s: round trip return incorrect content", name);
+
+    free(plain);
+    free(packed);
+} // check_round_trip
+
+Test(Function, lz4_round_trip)
+{
+    char_t buf[70000] = {0};
+    uint32_t seed = 1;
+    str_size_t i = 0;
+
+    check_round_trip("blank", buf, 0);
+    check_round_trip("short", (const char_t *)"abcabcabcab", 11);
+    check_round_trip("zeros", buf, sizeof(buf));
+
+    for (i = 0; i < sizeof(buf); ++i) buf[i] = "lorem ipsum dolor sit amet, "[i % 28] + (i / 5000);
+    check_round_trip("text", buf, sizeof(buf));
+
+    for (i = 0; i < sizeof(buf); ++i) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = seed >> 16;
+    } // for
+    check_round_trip("random", buf, sizeof(buf));
+} // lz4_round_trip
+
+Test(Function, lz4_compress)
+{
+    char_t buf[1000] = {0};
+    char_t packed[64] = {0};
+
+    cr_expect(lz4_compress(buf, sizeof(buf), packed, sizeof(packed)) > 0, "lz4_compress() don't compress zeros");
+    cr_expect(lz4_compress((const char_t *)"0123456789abcdefghij", 20, packed, 8) == 0, "lz4_compress() overflows buffer");
+} // lz4_compress
+
+Test(Function, lz4_decompress)
+{
+    // 字面量 "ab" + 回溯 2 字节、匹配 6 字节，最后序列字面量 "c"
+    const char_t packed[] = {0x22, 'a', 'b', 0x02, 0x00, 0x10, 'c'};
+    const char_t bad_offset[] = {0x12, 'a', 0x02, 0x00, 0x10, 'c'};
+    const char_t truncated[] = {0xF0, 0xFF};
+    char_t plain[16] = {0};
+    str_size_t cap = sizeof(plain);
+
+    cr_expect(lz4_decompress(packed, sizeof(packed), plain, &cap), "lz4_decompress() rejects valid block");
+    cr_expect(cap == 9 && memcmp(plain, "abababab" "c", 9) == 0, "lz4_decompress() return incorrect content");
+
+    cap = sizeof(plain);
+    cr_expect(! lz4_decompress(bad_offset, sizeof(bad_offset), plain, &cap), "lz4_decompress() accepts offset beyond output");
+    cap = sizeof(plain);
+    cr_expect(! lz4_decompress(truncated, sizeof(truncated), plain, &cap), "lz4_decompress() accepts truncated block");
+    cap = 4;
+    cr_expect(! lz4_decompress(packed, sizeof(packed), plain, &cap), "lz4_decompress() overflows buffer");
+} // lz4_decompress
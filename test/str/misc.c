@@ -10,7 +10,7 @@ typedef struct UT_SPAN_CASE {
     uint32_t bytes;
     uint32_t alignment;
     uint32_t r_leads;
-    uint32_t r_chunks;
+    str_size_t r_chunks;
     uint32_t r_tails;
     const char_t name[80];
 } ut_span_t, *ut_span_p;
@@ -32,7 +32,7 @@ static ut_span_t sc[] = {
     {.name = {"cross2_full"},  .start = (const char_t *)0x0, .bytes = 24, .alignment = 8, .r_leads = 0, .r_chunks = 3, .r_tails = 0},
 };
 
-static void str_span_wrapper(const char_t * start, const uint32_t bytes, const uint32_t alignment, const char_t ** begin, uint32_t * leads, uint32_t * chunks, uint32_t * tails, const char_t ** end)
+static void str_span_wrapper(const char_t * start, const str_size_t bytes, const uint32_t alignment, const char_t ** begin, uint32_t * leads, str_size_t * chunks, uint32_t * tails, const char_t ** end)
 {
     str_span(start, bytes, alignment, begin, leads, chunks, tails, end);
 } // str_span_wrapper
@@ -43,7 +43,7 @@ Test(Function, str_span)
     const char_t * r_begin = NULL;
     const char_t * r_end = NULL;
     uint32_t r_leads = 0;
-    uint32_t r_chunks = 0;
+    str_size_t r_chunks = 0;
     uint32_t r_tails = 0;
     int i = 0;
 
@@ -52,7 +52,27 @@ Test(Function, str_span)
         c = &sc[i];
         str_span_wrapper(c->start, c->bytes, c->alignment, &r_begin, &r_leads, &r_chunks, &r_tails, &r_end);
         cr_expect(r_leads == c->r_leads, "%s: str_span(%p, %u, %u) returns incorrect leads: expect %u, got %u", c->name, c->start, c->bytes, c->alignment, c->r_leads, r_leads);
-        cr_expect(r_chunks == c->r_chunks, "%s: str_span(%p, %u, %u) returns incorrect chunks: expect %u, got %u", c->name, c->start, c->bytes, c->alignment, c->r_chunks, r_chunks);
+        cr_expect(r_chunks == c->r_chunks, "%s: str_span(%p, %u, %u) returns incorrect chunks: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->start, c->bytes, c->alignment, c->r_chunks, r_chunks);
         cr_expect(r_tails == c->r_tails, "%s: str_span(%p, %u, %u) returns incorrect tails: expect %u, got %u", c->name, c->start, c->bytes, c->alignment, c->r_tails, r_tails);
     } // for
 } // str_span
+
+Test(Function, str_hash)
+{
+    const char_t text[] = {"content addressed dedup store"};
+    char_t copy[sizeof(text)] = {0};
+    uint64_t h = str_hash(text, sizeof(text) - 1);
+    int i = 0;
+
+    memcpy(copy + 1, text, sizeof(text) - 2);
+    cr_expect(str_hash(copy + 1, sizeof(text) - 2) == str_hash(text, sizeof(text) - 2), "str_hash() depends on alignment");
+    cr_expect(str_hash(text, 0) != str_hash((const char_t *)"\0", 1), "str_hash() ignores length");
+
+    // 任一字节变化都应改变散列值
+    memcpy(copy, text, sizeof(text));
+    for (i = 0; i < sizeof(text) - 1; ++i) {
+        copy[i] ^= 1;
+        cr_expect(str_hash(copy, sizeof(text) - 1) != h, "str_hash() ignores byte %d", i);
+        copy[i] ^= 1;
+    } // for
+} // str_hash
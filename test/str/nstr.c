@@ -23,8 +23,8 @@ void check_slice(const char_t * func, nstr_p s, int32_t need_free, int32_t bytes
 {
     cr_expect(s != NULL, "%s() return pointer: expect non-NULL, got NULL", func);
     cr_expect(s->need_free == need_free, "%s() don't set .need_free right: expect %d, got %d", func, need_free, s->need_free);
-    cr_expect(s->bytes == bytes, "%s() don't set .bytes right: expect %d, got %d", func, bytes, s->bytes);
-    cr_expect(s->chars == chars, "%s() don't set .chars right: expect %d, got %d", func, chars, s->chars);
+    cr_expect(s->bytes == bytes, "%s() don't set .bytes right: expect %d, got %" STR_SIZE_FMT, func, bytes, s->bytes);
+    cr_expect(s->chars == chars, "%s() don't set .chars right: expect %d, got %" STR_SIZE_FMT, func, chars, s->chars);
     cr_expect(s->encoding == encoding, "%s() don't set .encoding right: expect %d, got %d", func, encoding, s->encoding);
     cr_expect(s->start == start, "%s() don't set .start right: expect %p, got %p", func, start, s->start);
     cr_expect(get_entity(s) == ent, "%s() ain't refering to %p", func, ent);
@@ -42,3 +42,1213 @@ Test(Creation, nstr_new_reference)
 
     nstr_delete(new);
 } // nstr_new
+
+Test(Creation, nstr_new_mmap)
+{
+    const char_t cstr[] = {"Hello mmapped world!"};
+    char path[] = {"/tmp/nstr_mmap_XXXXXX"};
+    int32_t size = sizeof(cstr) - 1;
+    nstr_p new = NULL;
+    nstr_p sub = NULL;
+    int fd = -1;
+
+    fd = mkstemp(path);
+    cr_assert(fd >= 0, "mkstemp() failed");
+    cr_assert(write(fd, cstr, size) == size, "write() failed");
+
+    new = nstr_new_mmap_fd(fd, 0, 0, STR_MAP_SEQUENTIAL);
+    close(fd);
+    cr_assert(new != NULL, "nstr_new_mmap_fd() return pointer: expect non-NULL, got NULL");
+    cr_expect(get_entity(new)->kind == ENT_KIND_MMAP, "nstr_new_mmap_fd() don't create mmap entity");
+    cr_expect(new->bytes == size, "nstr_new_mmap_fd() don't set .bytes right: expect %d, got %" STR_SIZE_FMT, size, new->bytes);
+    cr_expect(memcmp(new->start, cstr, size) == 0, "nstr_new_mmap_fd() maps wrong content");
+    nstr_delete(new);
+
+    new = nstr_new_mmap(path, 6, 7, STR_MAP_NORMAL);
+    cr_assert(new != NULL, "nstr_new_mmap() return pointer: expect non-NULL, got NULL");
+    cr_expect(new->bytes == 7, "nstr_new_mmap() don't set .bytes right: expect %d, got %" STR_SIZE_FMT, 7, new->bytes);
+    cr_expect(memcmp(new->start, "mmapped", 7) == 0, "nstr_new_mmap() maps wrong content");
+
+    sub = nstr_slice(new, 1, 3, NULL);
+    cr_expect(get_entity(sub)->slcs == 2, "nstr_slice() don't add references: expect %d, got %d", 2, get_entity(sub)->slcs);
+    cr_expect(memcmp(sub->start, "map", 3) == 0, "nstr_slice() refers to wrong content");
+    cr_expect(nstr_advise(sub, STR_MAP_WILLNEED), "nstr_advise() rejects mmapped slice");
+
+    nstr_delete(new);
+    nstr_delete(sub);
+
+    cr_expect(nstr_new_mmap(path, size + 1, 0, STR_MAP_NORMAL) == NULL, "nstr_new_mmap() accepts offset beyond EOF");
+    errno = 0;
+    cr_expect(nstr_new_mmap(path, 0, 10000, STR_MAP_NORMAL) == NULL && errno == EINVAL, "nstr_new_mmap() accepts range beyond EOF");
+    cr_expect(nstr_new_mmap(path, 6, size - 5, STR_MAP_NORMAL) == NULL, "nstr_new_mmap() accepts range beyond EOF");
+    cr_expect(nstr_new_mmap(path, 1, STR_SIZE_MAX, STR_MAP_NORMAL) == NULL, "nstr_new_mmap() accepts overflowing range");
+    new = nstr_new_mmap(path, 6, size - 6, STR_MAP_NORMAL);
+    cr_expect(new != NULL && new->bytes == size - 6, "nstr_new_mmap() rejects range ending at EOF");
+    nstr_delete(new);
+    unlink(path);
+} // nstr_new_mmap
+
+static void release_counter(void * ctx, const char_t * buf, str_size_t bytes)
+{
+    *(int *)ctx += 1;
+} // release_counter
+
+Test(Creation, nstr_new_external)
+{
+    const char_t cstr[] = {"Hello external world!"};
+    int32_t size = sizeof(cstr) - 1;
+    nstr_p new = NULL;
+    nstr_p sub = NULL;
+    int released = 0;
+
+    new = nstr_new_external(cstr, size, &release_counter, &released);
+    check_slice((const char_t *)"nstr_new_external", new, 1, size, size, STR_ENC_ASCII, cstr, get_entity(new), 1);
+    cr_expect(get_entity(new)->kind == ENT_KIND_EXTERN, "nstr_new_external() don't create external entity");
+
+    sub = nstr_slice(new, 6, 8, NULL);
+    nstr_delete(new);
+    cr_expect(released == 0, "nstr_new_external() releases buffer still in use");
+
+    nstr_delete(sub);
+    cr_expect(released == 1, "nstr_new_external() don't release buffer: expect %d call, got %d", 1, released);
+} // nstr_new_external
+
+Test(View, nstr_view)
+{
+    const char_t cstr[] = {"key=" "\xE4\xB8\xAD" "value"};
+    nstr_view_t v = {0};
+    nstr_view_t key = {0};
+    nstr_view_t val = {0};
+    nstr_view_t ch = {0};
+    nstr_view_t eq = nstr_view_of((const char_t *)"=", 1, STR_ENC_ASCII);
+    const char_t * start = NULL;
+    str_size_t index = 0;
+    uint32_t ret = 0;
+    nstr_p s = NULL;
+    nstr_p sub = NULL;
+
+    cr_expect(sizeof(nstr_view_t) == 8 + 2 * sizeof(str_size_t), "nstr_view_t isn't compact: got %d bytes", (int)sizeof(nstr_view_t));
+
+    s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8));
+
+    v = nstr_view(s);
+    cr_expect(v.bytes == s->bytes && nstr_view_chars(&v) == nstr_chars(s), "nstr_view() don't copy counts");
+    cr_expect(get_entity(s)->slcs == 1, "nstr_view() adds references: expect %d, got %d", 1, get_entity(s)->slcs);
+
+    ret = nstr_view_next_sub(&v, &eq, &start, &index);
+    cr_expect(ret == 3 && index == 3, "nstr_view_next_sub() return incorrect position: expect %d/%d, got %d/%" STR_SIZE_FMT, 3, 3, ret, index);
+
+    key = nstr_view_of((const char_t *)"key", 3, STR_ENC_ASCII);
+    val = nstr_view_of(start + 1, v.bytes - ret - 1, STR_ENC_UTF8);
+    cr_expect(nstr_view_chars(&val) == 6, "nstr_view_chars() counts chars wrong: expect %d, got %d", 6, val.chars);
+    cr_expect(nstr_view_start_with(&v, &key), "nstr_view_start_with() fails");
+    cr_expect(nstr_view_contain(&v, &key) && nstr_view_contain(&v, &eq) && ! nstr_view_contain(&key, &v), "nstr_view_contain() return incorrect result");
+    cr_expect(nstr_view_compare(&key, &v, STR_LOC_C) < 0, "nstr_view_compare() orders wrong");
+
+    start = NULL;
+    ret = nstr_view_next_char(&val, &start, &index, &ch);
+    cr_expect(ret == 3 && index == 0, "nstr_view_next_char() return incorrect result: expect %d/%d, got %d/%" STR_SIZE_FMT, 3, 0, ret, index);
+    ret = nstr_view_next_char(&val, &start, &index, &ch);
+    cr_expect(ret == 1 && index == 1 && ch.start[0] == 'v', "nstr_view_next_char() return incorrect result: expect %d/%d, got %d/%" STR_SIZE_FMT, 1, 1, ret, index);
+
+    sub = nstr_from_view(s, &val, NULL);
+    check_slice((const char_t *)"nstr_from_view", sub, 1, val.bytes, 6, STR_ENC_UTF8, val.start, get_entity(s), 2);
+
+    nstr_delete(sub);
+    nstr_delete(s);
+} // nstr_view
+
+Test(Function, nstr_split)
+{
+    const char_t cstr[] = {"a,bc,,d"};
+    nstr_array_p as = NULL;
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p deli = nstr_new_reference((const char_t *)",");
+    int cnt = 0;
+
+    cnt = nstr_split(s, deli, -1, &as);
+    cr_assert(cnt == 4, "nstr_split() return incorrect count: expect %d, got %d", 4, cnt);
+    check_slice((const char_t *)"nstr_split", as[0], 1, 1, 1, STR_ENC_ASCII, s->start + 0, get_entity(s), 5);
+    check_slice((const char_t *)"nstr_split", as[1], 1, 2, 2, STR_ENC_ASCII, s->start + 2, get_entity(s), 5);
+    check_slice((const char_t *)"nstr_split", as[2], 1, 0, 0, STR_ENC_ASCII, s->start + 5, get_entity(s), 5);
+    check_slice((const char_t *)"nstr_split", as[3], 1, 1, 1, STR_ENC_ASCII, s->start + 6, get_entity(s), 5);
+    cr_expect(as[4] == NULL, "nstr_split() don't terminate array");
+    nstr_delete_array(&as, cnt);
+
+    cnt = nstr_split(s, deli, 1, &as);
+    cr_assert(cnt == 2, "nstr_split() return incorrect count: expect %d, got %d", 2, cnt);
+    check_slice((const char_t *)"nstr_split", as[1], 1, 5, 5, STR_ENC_ASCII, s->start + 2, get_entity(s), 3);
+    nstr_delete_array(&as, cnt);
+
+    nstr_delete(deli);
+    nstr_delete(s);
+} // nstr_split
+
+Test(Memory, nstr_compact)
+{
+    char_t buf[4096] = {0};
+    str_usage_t list[2] = {0};
+    str_usage_t usage = {0};
+    nstr_p big = NULL;
+    nstr_p tkn = NULL;
+    nstr_p auto_tkn = NULL;
+    entity_p ent = NULL;
+    int cnt = 0;
+
+    memset(buf, 'x', sizeof(buf));
+    nstr_track_entities(true);
+    big = nstr_new(buf, sizeof(buf), true);
+    ent = get_entity(big);
+
+    tkn = nstr_slice(big, 100, 20, NULL);
+    nstr_usage(tkn, &usage);
+    cr_expect(usage.held == 4096 && usage.referenced == 4096 + 20 && usage.slices == 2, "nstr_usage() reports wrong usage: got %" STR_SIZE_FMT "/%" STR_SIZE_FMT "/%u", usage.held, usage.referenced, usage.slices);
+
+    nstr_delete(big);
+    nstr_usage(tkn, &usage);
+    cr_expect(usage.waste == 4096 - 20, "nstr_usage() reports wrong waste: expect %d, got %d", 4096 - 20, (int)usage.waste);
+
+    cnt = nstr_worst_wastes(list, 2);
+    cr_expect(cnt == 1 && list[0].entity == ent, "nstr_worst_wastes() don't list pinned entity: got %d", cnt);
+
+    cr_expect(nstr_compact(tkn), "nstr_compact() don't compact pinning slice");
+    check_slice((const char_t *)"nstr_compact", tkn, 1, 20, 20, STR_ENC_ASCII, get_entity(tkn)->data, get_entity(tkn), 1);
+    cr_expect(! nstr_compact(tkn), "nstr_compact() compacts right-sized slice");
+    cr_expect(nstr_worst_wastes(list, 2) == 0, "nstr_worst_wastes() lists released entity");
+
+    nstr_set_compact_policy(1024, 90);
+    auto_tkn = nstr_new(buf, sizeof(buf), true);
+    nstr_slice(auto_tkn, 0, 10, tkn);
+    cr_expect(get_entity(tkn) != get_entity(auto_tkn) && get_entity(tkn)->bytes == 10, "nstr_slice() ignores compact policy");
+    nstr_set_compact_policy(0, 0);
+    nstr_track_entities(false);
+
+    nstr_delete(auto_tkn);
+    nstr_delete(tkn);
+} // nstr_compact
+
+Test(Memory, cold_entities)
+{
+    char_t buf[64 * 1024] = {0};
+    str_usage_t usage = {0};
+    const char_t * start = NULL;
+    const char_t * end = NULL;
+    anon_entity_p an = NULL;
+    nstr_p big = NULL;
+    nstr_p hot = NULL;
+    nstr_p sub = NULL;
+    uint64_t released = 0;
+    int i = 0;
+
+    for (i = 0; i < sizeof(buf); ++i) buf[i] = 'a' + (i / 7) % 26;
+    nstr_set_cold_policy(16 * 1024, 2);
+    big = nstr_new(buf, sizeof(buf), true);
+    hot = nstr_new(buf, sizeof(buf), true);
+    sub = nstr_new((const char_t *)"xyz", 3, true);
+    cr_assert(get_entity(big)->kind == ENT_KIND_ANON && get_entity(sub)->kind == ENT_KIND_HEAP, "nstr_new() ignores cold policy");
+
+    an = container_of(anon_entity_t, ent, get_entity(big));
+    cr_expect(nstr_sweep_cold() == 0 && ! an->packed, "nstr_sweep_cold() packs entity before it is idle");
+
+    nstr_contain(hot, sub);
+    released = nstr_sweep_cold();
+    nstr_usage(big, &usage);
+    cr_expect(released > 0 && an->packed && usage.packed == an->packed_bytes, "nstr_sweep_cold() don't pack idle entity: released %d", (int)released);
+    nstr_usage(hot, &usage);
+    cr_expect(usage.packed == 0, "nstr_sweep_cold() packs recently touched entity");
+
+    cr_expect(! nstr_contain(big, sub) && ! an->packed, "nstr_contain() don't thaw packed entity");
+    cr_expect(nstr_compare(big, hot, STR_LOC_C) == 0, "thawed entity has incorrect content");
+
+    nstr_sweep_cold();
+    nstr_sweep_cold();
+    cr_expect(an->packed, "nstr_sweep_cold() don't pack entity again");
+    nstr_slice(big, 7, 7, sub);
+    cr_expect(sub->bytes == 7 && memcmp(sub->start, "bbbbbbb", 7) == 0, "nstr_slice() reads packed entity");
+
+    // 借出地址后不再压缩，借出的指针始终可读
+    nstr_byte_range(big, &start, &end);
+    nstr_sweep_cold();
+    nstr_sweep_cold();
+    cr_expect(! an->packed && an->pinned, "nstr_sweep_cold() packs entity with borrowed pointer");
+    cr_expect(end - start == sizeof(buf) && memcmp(start, buf, sizeof(buf)) == 0, "borrowed pointer reads incorrect content");
+    nstr_set_cold_policy(0, 0);
+
+    nstr_delete(sub);
+    nstr_delete(hot);
+    nstr_delete(big);
+} // cold_entities
+
+Test(Memory, dedup_store)
+{
+    const char_t cstr[] = {"payload"};
+    str_dedup_stats_t stats = {0};
+    nstr_p s1 = NULL;
+    nstr_p s2 = NULL;
+    nstr_p s3 = NULL;
+    nstr_p part = NULL;
+    nstr_p cat = NULL;
+    nstr_p other = NULL;
+    nstr_p u1 = NULL;
+    nstr_p u2 = NULL;
+    nstr_p ucat = NULL;
+
+    nstr_set_dedup_policy(1024);
+    s1 = nstr_new(cstr, sizeof(cstr) - 1, true);
+    s2 = nstr_new(cstr, sizeof(cstr) - 1, true);
+    cr_expect(get_entity(s1) == get_entity(s2) && get_entity(s1)->slcs == 2, "nstr_new() don't share identical content");
+
+    s3 = nstr_clone(s1);
+    cr_expect(get_entity(s3) == get_entity(s1), "nstr_clone() don't share identical content");
+
+    part = nstr_slice(s1, 3, 4, NULL);
+    cat = nstr_concat2(nstr_slice(s1, 0, 3, s3), part, NULL);
+    cr_expect(get_entity(cat) == get_entity(s1) && get_entity(s1)->slcs == 5, "nstr_concat2() don't share identical result");
+
+    other = nstr_new((const char_t *)"payloaD", 7, true);
+    cr_expect(get_entity(other) != get_entity(s1), "nstr_new() shares different content");
+
+    nstr_dedup_stats(&stats, true);
+    cr_expect(stats.lookups == 5 && stats.hits == 3 && stats.saved == 21 && stats.entries == 2, "nstr_dedup_stats() reports wrong stats: got %d/%d/%d/%d", (int)stats.lookups, (int)stats.hits, (int)stats.saved, stats.entries);
+    nstr_dedup_stats(&stats, false);
+    cr_expect(stats.lookups == 0 && stats.entries == 2, "nstr_dedup_stats() don't reset counters");
+
+    nstr_delete(other);
+    nstr_dedup_stats(&stats, false);
+    cr_expect(stats.entries == 1, "released entity stays in dedup store");
+
+    // 命中已有实体时不改写其校验结果
+    cr_assert(nstr_set_encoding(s1, STR_ENC_ASCII), "nstr_set_encoding() rejects valid ASCII");
+    u1 = nstr_new(cstr, 3, true);
+    u2 = nstr_new(cstr + 3, 4, true);
+    cr_assert(nstr_set_encoding(u1, STR_ENC_UTF8) && nstr_set_encoding(u2, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    ucat = nstr_concat2(u1, u2, NULL);
+    cr_expect(get_entity(ucat) == get_entity(s1), "nstr_concat2() don't share identical result");
+    cr_expect(get_entity(s1)->verified && get_entity(s1)->encoding == STR_ENC_ASCII, "nstr_concat2() rewrites verification of shared entity");
+    nstr_delete(ucat);
+    nstr_delete(u2);
+    nstr_delete(u1);
+
+    nstr_set_dedup_policy(0);
+    other = nstr_new(cstr, sizeof(cstr) - 1, true);
+    cr_expect(get_entity(other) != get_entity(s1), "nstr_new() shares content after dedup is disabled");
+
+    nstr_delete(other);
+    nstr_delete(cat);
+    nstr_delete(part);
+    nstr_delete(s3);
+    nstr_delete(s2);
+    nstr_delete(s1);
+} // dedup_store
+
+Test(Function, lazy_chars)
+{
+    const char_t cstr[] = {"\xE4\xB8\xAD\xE6\x96\x87 text"};
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p sub = NULL;
+    nstr_p cat = NULL;
+    nstr_p rep = NULL;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(s->chars == CHARS_UNKNOWN, "nstr_set_encoding() counts chars eagerly");
+    cr_expect(get_entity(s)->verified, "nstr_set_encoding() don't record verification");
+
+    cat = nstr_concat2(s, s, NULL);
+    cr_expect(cat->chars == CHARS_UNKNOWN, "nstr_concat2() counts chars eagerly");
+    cr_expect(nstr_chars(cat) == 14, "nstr_chars() return incorrect chars: expect %d, got %" STR_SIZE_FMT, 14, nstr_chars(cat));
+    cr_expect(nstr_chars(s) == 7 && s->chars == 7, "nstr_chars() don't cache chars");
+
+    sub = nstr_slice(s, 1, 3, NULL);
+    check_slice((const char_t *)"nstr_slice", sub, 1, 5, 3, STR_ENC_UTF8, s->start + 3, get_entity(s), 2);
+    cr_expect(nstr_set_encoding(sub, STR_ENC_UTF8), "nstr_set_encoding() rejects verified slice");
+
+    rep = nstr_replace(s, 1, 1, sub, NULL);
+    cr_expect(rep->bytes == 13 && nstr_chars(rep) == 9, "nstr_replace() return incorrect counts: got %" STR_SIZE_FMT "/%" STR_SIZE_FMT, rep->bytes, nstr_chars(rep));
+    cr_expect(memcmp(rep->start, "\xE4\xB8\xAD\xE6\x96\x87 t text", 13) == 0, "nstr_replace() return incorrect content");
+
+    nstr_delete(rep);
+    nstr_delete(sub);
+    nstr_delete(cat);
+    nstr_delete(s);
+} // lazy_chars
+
+Test(Function, unverified_parts)
+{
+    nstr_p u = nstr_new((const char_t *)"ab", 2, true);
+    nstr_p x = nstr_new((const char_t *)"x", 1, true);
+    nstr_p bad = nstr_new((const char_t *)"\xFF\xFE", 2, true);
+    nstr_p half = nstr_new((const char_t *)"\xE4\xB8", 2, true);
+    nstr_p cat = NULL;
+    nstr_p join = NULL;
+    nstr_p good = NULL;
+    nstr_p cl = NULL;
+
+    cr_assert(nstr_set_encoding(u, STR_ENC_UTF8) && nstr_set_encoding(x, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+
+    // 含未校验部分的结果不能视为已校验
+    cat = nstr_concat2(u, bad, NULL);
+    cr_expect(! get_entity(cat)->verified, "nstr_concat2() marks result with unverified part as verified");
+    cr_expect(! nstr_set_encoding(cat, STR_ENC_UTF8), "nstr_set_encoding() accepts invalid UTF-8 concatenation");
+
+    join = nstr_concat2(x, half, NULL);
+    cr_expect(! nstr_validate(join, STR_ENC_UTF8), "nstr_validate() accepts truncated UTF-8 concatenation");
+
+    cl = nstr_clone(bad);
+    cr_expect(! nstr_set_encoding(cl, STR_ENC_ASCII), "nstr_set_encoding() accepts invalid ASCII clone");
+
+    // 各部分均已校验时结果无需再次校验
+    good = nstr_concat2(u, x, NULL);
+    cr_expect(get_entity(good)->verified && get_entity(good)->encoding == STR_ENC_UTF8, "nstr_concat2() don't inherit verification");
+
+    // 间隔符可以为 NULL
+    nstr_join(NULL, (nstr_p[]){u, x}, 2, good, NULL);
+    cr_expect(good->bytes == 3 && memcmp(good->start, "abx", 3) == 0, "nstr_join() return incorrect result without delimiter");
+    cr_expect(get_entity(good)->verified, "nstr_join() don't inherit verification without delimiter");
+
+    nstr_delete(good);
+    nstr_delete(cl);
+    nstr_delete(join);
+    nstr_delete(cat);
+    nstr_delete(half);
+    nstr_delete(bad);
+    nstr_delete(x);
+    nstr_delete(u);
+} // unverified_parts
+
+Test(Function, pure_ascii)
+{
+    const char_t cstr[] = {"plain text"};
+    const char_t * start = NULL;
+    str_size_t index = 0;
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p u = nstr_new((const char_t *)"\xE4\xB8\xAD", 3, true);
+    nstr_p sub = NULL;
+    nstr_p cat = NULL;
+    nstr_p ch = nstr_new_blank(STR_ENC_UTF8);
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(s->ascii && get_entity(s)->ascii, "nstr_set_encoding() don't record pure ASCII content");
+    cr_expect(s->chars == 10, "nstr_set_encoding() don't derive chars from bytes");
+
+    sub = nstr_slice(s, 6, 3, NULL);
+    cr_expect(sub->ascii && sub->bytes == 3 && sub->chars == 3, "nstr_slice() return incorrect slice");
+    cr_expect(memcmp(sub->start, "tex", 3) == 0, "nstr_slice() return incorrect content");
+
+    cr_expect(nstr_next_sub(s, sub, &start, &index) == 6 && index == 6, "nstr_next_sub() return incorrect index: got %" STR_SIZE_FMT, index);
+
+    start = NULL;
+    while (nstr_next_char(s, &start, &index, ch) > 0) cr_expect(ch->bytes == 1, "nstr_next_char() return incorrect bytes");
+    cr_expect(index == 10, "nstr_next_char() return incorrect index: got %" STR_SIZE_FMT, index);
+
+    cr_assert(nstr_set_encoding(u, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(! u->ascii, "nstr_set_encoding() flags non-ASCII content");
+
+    cat = nstr_concat2(s, sub, NULL);
+    cr_expect(cat->ascii && nstr_chars(cat) == 13, "nstr_concat2() don't propagate flag");
+    nstr_concat2(s, u, cat);
+    cr_expect(! cat->ascii && nstr_chars(cat) == 11, "nstr_concat2() propagates flag incorrectly");
+    nstr_replace(s, 5, 10, sub, cat);
+    cr_expect(cat->ascii && cat->bytes == 8 && memcmp(cat->start, "plaintex", 8) == 0, "nstr_replace() return incorrect result");
+
+    nstr_delete(ch);
+    nstr_delete(cat);
+    nstr_delete(sub);
+    nstr_delete(u);
+    nstr_delete(s);
+} // pure_ascii
+
+Test(Function, char_index)
+{
+    char_t buf[3 * 40 + 40] = {0};
+    uint32_t bytes = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    nstr_p s = NULL;
+    nstr_p sub = NULL;
+    nstr_p exp = NULL;
+    nstr_p rep = nstr_new((const char_t *)"-", 1, false);
+
+    // 交替排列 3 字节字符和 ASCII 字符，共 80 个字符
+    for (i = 0; i < 40; ++i) {
+        memcpy(buf + bytes, "\xE4\xB8\xAD" "a", 4);
+        bytes += 4;
+    } // for
+
+    s = nstr_new(buf, bytes, true);
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    sub = nstr_new_blank(STR_ENC_UTF8);
+    exp = nstr_new_blank(STR_ENC_UTF8);
+
+    for (i = 0; i <= 82; i += 3) {
+        for (j = 0; j <= 82; j += 7) {
+            nstr_set_index_policy(0, 0);
+            nstr_slice(s, i, j, exp);
+            nstr_set_index_policy(1, 5);
+            nstr_slice(s, i, j, sub);
+            cr_expect(sub->start == exp->start && sub->bytes == exp->bytes && nstr_chars(sub) == nstr_chars(exp), "nstr_slice(%d, %d) return incorrect slice with index", i, j);
+
+            // 切片起点不在检查点上
+            nstr_narrow_down(sub, 2, 9);
+            nstr_narrow_down(exp, 2, 9);
+            cr_expect(sub->start == exp->start && sub->bytes == exp->bytes, "nstr_narrow_down(%d, %d) return incorrect slice with index", i, j);
+        } // for
+
+        nstr_replace(s, i, 2, rep, sub);
+        nstr_set_index_policy(0, 0);
+        nstr_replace(s, i, 2, rep, exp);
+        cr_expect(sub->bytes == exp->bytes && memcmp(sub->start, exp->start, sub->bytes) == 0, "nstr_replace(%d) return incorrect result with index", i);
+        nstr_set_index_policy(1, 5);
+    } // for
+
+    cr_expect(get_entity(s)->index != NULL && get_entity(s)->index->cnt == 16, "index isn't built or shared");
+    nstr_set_index_policy(1024 * 1024, 0);
+
+    nstr_delete(rep);
+    nstr_delete(exp);
+    nstr_delete(sub);
+    nstr_delete(s);
+} // char_index
+
+static nstr_t kw = NSTR_LITERAL_INIT("\xE4\xB8\xAD\xE6\x96\x87 kw", STR_ENC_UTF8);
+
+Test(Creation, nstr_literal)
+{
+    nstr_p s = nstr_new((const char_t *)"a,b,c", 5, true);
+    nstr_p lit = NSTR_LITERAL(",");
+    nstr_p r = NULL;
+    nstr_array_p as = NULL;
+    int cnt = 0;
+
+    cr_expect(lit->bytes == 1 && lit->chars == 1 && lit->encoding == STR_ENC_ASCII, "NSTR_LITERAL() return incorrect counts");
+    cr_expect(kw.bytes == 9 && kw.chars == 5 && ! kw.ascii && kw.encoding == STR_ENC_UTF8, "NSTR_LITERAL_INIT() return incorrect counts: got %" STR_SIZE_FMT "/%" STR_SIZE_FMT, kw.bytes, kw.chars);
+    cr_expect(NSTR_LITERAL_UTF8("plain")->ascii, "NSTR_LITERAL_UTF8() don't flag pure ASCII content");
+
+    cnt = nstr_split(s, lit, -1, &as);
+    cr_expect(cnt == 3, "nstr_split() return incorrect count: got %d", cnt);
+    r = nstr_join(NSTR_LITERAL("::"), as, cnt, NULL, NULL);
+    cr_expect(r->bytes == 7 && memcmp(r->start, "a::b::c", 7) == 0, "nstr_join() return incorrect result");
+    cr_expect(nstr_remove(s, 1, 3, r) == r && r->bytes == 2 && memcmp(r->start, "ac", 2) == 0, "nstr_remove() return incorrect result");
+    cr_expect(nstr_replace_with_char(s, 1, 1, ';', r) == r && memcmp(r->start, "a;b,c", 5) == 0, "nstr_replace_with_char() return incorrect result");
+
+    nstr_delete(r);
+    nstr_delete_array(&as, cnt);
+    nstr_delete(s);
+} // nstr_literal
+
+typedef struct UT_RECORD {
+    int id;
+    NSTR_FIXED_TYPE(8) name;
+} ut_record_t;
+
+Test(Creation, nstr_fixed)
+{
+    NSTR_FIXED(key, 16);
+    ut_record_t rec = {0};
+    nstr_p k = NSTR_FIXED_STR(key);
+    nstr_p name = NULL;
+    nstr_p s = nstr_new((const char_t *)"user:42", 7, true);
+    nstr_p sub = NULL;
+
+    cr_expect(k->bytes == 0 && k->fixed && k->start == key.buf && key.head.cap == 16, "NSTR_FIXED() don't initialize blank string");
+
+    cr_assert(nstr_concat2(s, NSTR_LITERAL("/profile"), k) == k, "nstr_concat2() don't write into fixed string");
+    cr_expect(k->bytes == 15 && k->start == key.buf && strcmp((const char *)key.buf, "user:42/profile") == 0, "nstr_concat2() writes incorrect content");
+    cr_expect(nstr_end_with(k, NSTR_LITERAL("profile")) && nstr_chars(k) == 15, "fixed string isn't readable");
+    cr_expect(nstr_concat3(s, s, s, k) == NULL && k->bytes == 15, "nstr_concat3() overflows fixed string");
+
+    cr_expect(nstr_replace(k, 0, 4, NSTR_LITERAL("group"), k) == k, "nstr_replace() don't write into aliased fixed string");
+    cr_expect(strcmp((const char *)key.buf, "group:42/profile") == 0, "nstr_replace() writes incorrect content: %s", key.buf);
+
+    nstr_fixed_init(rec.name);
+    name = NSTR_FIXED_STR(rec.name);
+    cr_expect(nstr_slice(k, 6, 2, name) == name && name->bytes == 2 && memcmp(name->start, "42", 3) == 0, "nstr_slice() don't copy into fixed string");
+    cr_expect(nstr_slice(k, 0, 100, name) == NULL && name->bytes == 2, "nstr_slice() overflows fixed string");
+
+    nstr_narrow_down(k, 6, 2);
+    cr_expect(nstr_cstr(k) == key.buf && strcmp((const char *)key.buf, "42") == 0, "nstr_cstr() don't settle fixed string");
+
+    sub = nstr_slice(k, 1, 1, NULL);
+    cr_expect(sub->start == key.buf + 1 && ! sub->fixed && get_entity(sub) == &nstr_fixed_entity, "nstr_slice() don't borrow fixed string");
+
+    nstr_delete(sub);
+    nstr_delete(s);
+} // nstr_fixed
+
+Test(Function, nstr_cstr)
+{
+    const char_t buf[] = {"abc,def"};
+    nstr_p s = nstr_new(buf, 7, true);
+    nstr_p sub = NULL;
+    nstr_p ref = nstr_new(buf, 3, false);
+    nstr_p ex = nstr_new_external(buf, 7, NULL, NULL);
+    const char_t * cstr = NULL;
+
+    cr_expect(nstr_cstr(s) == s->start, "nstr_cstr() copies whole string");
+
+    sub = nstr_slice(s, 4, 3, NULL);
+    cr_expect(nstr_cstr(sub) == sub->start && get_entity(sub) == get_entity(s), "nstr_cstr() copies tail slice");
+
+    nstr_slice(s, 0, 3, sub);
+    cstr = nstr_cstr(sub);
+    cr_expect(cstr != s->start && strcmp((const char *)cstr, "abc") == 0, "nstr_cstr() return incorrect C string");
+    cr_expect(get_entity(sub) != get_entity(s) && nstr_cstr(sub) == cstr, "nstr_cstr() don't cache copy");
+
+    cstr = nstr_cstr(ref);
+    cr_expect(cstr != buf && strcmp((const char *)cstr, "abc") == 0, "nstr_cstr() trusts unknown byte range");
+
+    cr_expect(nstr_cstr(ex) != buf && strcmp((const char *)nstr_cstr(ex), "abc,def") == 0, "nstr_cstr() reads past external buffer");
+    cr_expect(strcmp((const char *)nstr_cstr(NSTR_LITERAL("lit")), "lit") == 0, "nstr_cstr() copies literal");
+
+    nstr_delete(ex);
+    nstr_delete(ref);
+    nstr_delete(sub);
+    nstr_delete(s);
+} // nstr_cstr
+
+Test(Function, nstr_searcher)
+{
+    const char_t cstr[] = {"k1=\xE4\xB8\xAD, k2=v2, k3=v3"};
+    const char_t * start = NULL;
+    str_size_t index = 0;
+    str_size_t ret = 0;
+    nstr_array_p as = NULL;
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p rep = NULL;
+    nstr_searcher_p comma = NULL;
+    nstr_searcher_p missing = NULL;
+    int cnt = 0;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    comma = nstr_new_searcher(NSTR_LITERAL(", "));
+    missing = nstr_new_searcher(NSTR_LITERAL("a pattern longer than thirty-two bytes"));
+    cr_assert(comma && missing, "nstr_new_searcher() fails");
+
+    ret = nstr_next_match(s, comma, &start, &index);
+    cr_expect(ret == 6 && index == 4, "nstr_next_match() return incorrect position: expect %d/%d, got %d/%d", 6, 4, (int)ret, (int)index);
+    ret = nstr_next_match(s, comma, &start, &index);
+    cr_expect(ret == 5 && index == 11, "nstr_next_match() return incorrect position: expect %d/%d, got %d/%d", 5, 11, (int)ret, (int)index);
+    ret = nstr_next_match(s, comma, &start, &index);
+    cr_expect(ret == STR_NOT_FOUND && start == NULL && index == 18, "nstr_next_match() return incorrect end: got %d", (int)index);
+
+    cr_expect(nstr_contain_by(s, comma) && ! nstr_contain_by(s, missing), "nstr_contain_by() return incorrect result");
+    cr_expect(nstr_contain(s, NSTR_LITERAL("k3=v3")) && nstr_contain(s, NSTR_LITERAL("=")) && ! nstr_contain(s, NSTR_LITERAL("k4")), "nstr_contain() return incorrect result");
+    cr_expect(nstr_contain(s, s) && ! nstr_contain(s, NSTR_LITERAL("a pattern longer than thirty-two bytes")), "nstr_contain() return incorrect result for long pattern");
+
+    cnt = nstr_split_by(s, comma, -1, &as);
+    cr_expect(cnt == 3 && as[1]->bytes == 5 && memcmp(as[2]->start, "k3=v3", 5) == 0, "nstr_split_by() return incorrect parts: got %d", cnt);
+    nstr_delete_array(&as, cnt);
+
+    rep = nstr_substitute_by(s, true, comma, NSTR_LITERAL(";"), NULL);
+    cr_expect(rep->bytes == 18 && memcmp(rep->start, "k1=\xE4\xB8\xAD;k2=v2;k3=v3", 18) == 0, "nstr_substitute_by() return incorrect content");
+    nstr_substitute_by(s, false, comma, NSTR_LITERAL(";"), rep);
+    cr_expect(rep->bytes == 19 && nstr_chars(rep) == 17 && memcmp(rep->start, "k1=\xE4\xB8\xAD;k2=v2, k3=v3", 19) == 0, "nstr_substitute_by() return incorrect content");
+
+    nstr_delete(rep);
+    nstr_delete_searcher(missing);
+    nstr_delete_searcher(comma);
+    nstr_delete(s);
+} // nstr_searcher
+
+Test(Function, nstr_keywords)
+{
+    const char_t cstr[] = {"\xE4\xB8\xAD error: disk error"};
+    nstr_p needles[] = {NSTR_LITERAL("error"), NSTR_LITERAL("disk"), NSTR_LITERAL("or"), NSTR_LITERAL_UTF8("\xE4\xB8\xAD")};
+    const int32_t r_ids[] = {3, 0, 2, 1, 0, 2};
+    const str_size_t r_index[] = {0, 2, 5, 9, 14, 17};
+    nstr_keyword_cursor_t cur = {0};
+    nstr_keywords_p kw = NULL;
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    int32_t id = 0;
+    int cnt = 0;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    kw = nstr_new_keywords(needles, 4);
+    cr_assert(kw != NULL, "nstr_new_keywords() fails");
+
+    while ((id = nstr_next_keyword(s, kw, &cur)) >= 0) {
+        if (cnt < 6) {
+            cr_expect(id == r_ids[cnt] && cur.index == r_index[cnt], "nstr_next_keyword() return incorrect match %d: expect %d@%" STR_SIZE_FMT ", got %d@%" STR_SIZE_FMT, cnt, r_ids[cnt], r_index[cnt], id, cur.index);
+            cr_expect(cur.bytes == needles[id]->bytes && memcmp(cur.start, needles[id]->start, cur.bytes) == 0, "nstr_next_keyword() return incorrect range");
+        } // if
+        ++cnt;
+    } // while
+    cr_expect(cnt == 6 && cur.start == NULL, "nstr_next_keyword() return incorrect count: expect %d, got %d", 6, cnt);
+
+    nstr_delete_keywords(kw);
+    nstr_delete(s);
+} // nstr_keywords
+
+Test(Function, nstr_regex)
+{
+    const char_t cstr[] = {"\xE4\xB8\xAD=1, ab=22, c="};
+    const str_size_t r_index[] = {0, 5, 12};
+    const str_size_t r_chars[] = {1, 2, 1};
+    nstr_regex_cursor_t cur = {0};
+    nstr_p caps[3] = {NULL};
+    nstr_regex_p re = NULL;
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    int32_t err = 0;
+    int cnt = 0;
+    int i = 0;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(nstr_new_regex(NSTR_LITERAL("a(b"), &err) == NULL && err == STR_BAD_PATTERN, "nstr_new_regex() accepts bad pattern");
+
+    re = nstr_new_regex(NSTR_LITERAL("([^ ,=]+)=(\\d*)"), &err);
+    cr_assert(re != NULL, "nstr_new_regex() fails: err = %d", err);
+    cr_expect(nstr_regex_groups(re) == 3, "nstr_regex_groups() return incorrect count: expect %d, got %d", 3, nstr_regex_groups(re));
+    cr_expect(nstr_regex_test(s, re), "nstr_regex_test() fails");
+
+    // 分组切片与源串共享实体，字符下标按 UTF-8 计算
+    while (nstr_next_regex(s, re, &cur, caps, 3) >= 0) {
+        if (cnt < 3) {
+            cr_expect(cur.index == r_index[cnt], "nstr_next_regex() return incorrect index %d: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, cnt, r_index[cnt], cur.index);
+            cr_expect(caps[1]->ent == s->ent && nstr_chars(caps[1]) == r_chars[cnt], "nstr_next_regex() return incorrect group 1 on match %d", cnt);
+            cr_expect(cur.bytes == caps[0]->bytes && cur.start == caps[0]->start, "nstr_next_regex() return incorrect range on match %d", cnt);
+        } // if
+        ++cnt;
+    } // while
+    cr_expect(cnt == 3 && cur.start == NULL, "nstr_next_regex() return incorrect count: expect %d, got %d", 3, cnt);
+    cr_expect(nstr_is_blank(caps[2]), "nstr_next_regex() return non-blank for empty group");
+
+    for (i = 0; i < 3; ++i) nstr_delete(caps[i]);
+    nstr_delete_regex(re);
+
+    // 空匹配之后前进一个字符
+    re = nstr_new_regex(NSTR_LITERAL("x*"), &err);
+    cr_assert(re != NULL, "nstr_new_regex() fails: err = %d", err);
+    for (cnt = 0; nstr_next_regex(s, re, &cur, NULL, 0) >= 0; ++cnt) ;
+    cr_expect(cnt == nstr_chars(s) + 1, "nstr_next_regex() return incorrect count of empty matches: expect %" STR_SIZE_FMT ", got %d", nstr_chars(s) + 1, cnt);
+    cr_expect(nstr_regex_test(NSTR_LITERAL("abc"), re), "nstr_regex_test() fails on empty match");
+    nstr_delete_regex(re);
+
+    nstr_delete(s);
+} // nstr_regex
+
+Test(Function, nstr_trim)
+{
+    const char_t cstr[] = {" \t\xE4\xB8\xAD x \r\n"};
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p r = NULL;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(nstr_chars(s) == 8, "nstr_chars() return incorrect count");
+
+    // 结果与源串共享实体，字符数由源串推算
+    r = nstr_trim(s, NULL);
+    cr_expect(r->ent == s->ent && r->bytes == 5 && r->start == s->start + 2 && r->chars == 3, "nstr_trim() return incorrect slice");
+    nstr_ltrim(s, r);
+    cr_expect(r->bytes == 8 && r->start == s->start + 2 && r->chars == 6, "nstr_ltrim() return incorrect slice");
+    nstr_rtrim(s, r);
+    cr_expect(r->bytes == 7 && r->start == s->start && r->chars == 5, "nstr_rtrim() return incorrect slice");
+    nstr_chomp(s, r);
+    cr_expect(r->bytes == 8 && r->chars == 6, "nstr_chomp() return incorrect slice");
+    nstr_chomp(r, r);
+    cr_expect(r->bytes == 8, "nstr_chomp() removes non-newline byte");
+    nstr_chomp(NSTR_LITERAL("abc\r"), r);
+    cr_expect(r->bytes == 4, "nstr_chomp() removes lone carriage return");
+    nstr_chomp(NSTR_LITERAL("abc\n"), r);
+    cr_expect(r->bytes == 3, "nstr_chomp() keeps trailing newline");
+
+    nstr_trim(NSTR_LITERAL(" \t\n "), r);
+    cr_expect(nstr_is_blank(r), "nstr_trim() return non-blank for blank content");
+    nstr_rtrim(NSTR_LITERAL("x"), r);
+    cr_expect(r->bytes == 1, "nstr_rtrim() removes non-space byte");
+
+    nstr_delete(r);
+    nstr_delete(s);
+} // nstr_trim
+
+Test(Function, nstr_span)
+{
+    const char_t cstr[] = {"key\xE4\xB8\xAD=val;x"};
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(nstr_span(s, NSTR_LITERAL("abcdefghijklmnopqrstuvwxyz")) == 3, "nstr_span() return incorrect count");
+    cr_expect(nstr_span(s, NSTR_LITERAL("=")) == 0, "nstr_span() return incorrect count");
+    cr_expect(nstr_span(NSTR_LITERAL("aaa"), NSTR_LITERAL("a")) == 3, "nstr_span() return incorrect count");
+
+    // 下标按字符计算
+    cr_expect(nstr_find_any_of(s, NSTR_LITERAL(";=")) == 4, "nstr_find_any_of() return incorrect index");
+    cr_expect(nstr_find_any_of(s, NSTR_LITERAL("#")) == STR_NOT_FOUND, "nstr_find_any_of() finds absent byte");
+
+    nstr_delete(s);
+} // nstr_span
+
+Test(Function, nstr_next_token)
+{
+    const char_t cstr[] = {"  alpha\t\xE4\xB8\xAD\xE6\x96\x87 \n z  "};
+    const char * r_tokens[] = {"alpha", "\xE4\xB8\xAD\xE6\x96\x87", "z"};
+    const str_size_t r_index[] = {2, 8, 13};
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p tok = nstr_new_blank(STR_ENC_UTF8);
+    const char_t * start = NULL;
+    str_size_t index = 0;
+    str_size_t bytes = 0;
+    int cnt = 0;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    while ((bytes = nstr_next_token(s, &start, &index, tok)) > 0) {
+        if (cnt < 3) {
+            cr_expect(bytes == strlen(r_tokens[cnt]) && memcmp(tok->start, r_tokens[cnt], bytes) == 0, "nstr_next_token() return incorrect token %d", cnt);
+            cr_expect(index == r_index[cnt] && tok->ent == s->ent, "nstr_next_token() return incorrect index %d: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, cnt, r_index[cnt], index);
+        } // if
+        ++cnt;
+    } // while
+    cr_expect(cnt == 3 && start == NULL && index == nstr_chars(s), "nstr_next_token() return incorrect count: expect %d, got %d", 3, cnt);
+
+    nstr_delete(tok);
+    nstr_delete(s);
+} // nstr_next_token
+
+Test(Function, negative_index)
+{
+    char_t buf[4 * 20] = {0};
+    uint32_t bytes = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    nstr_p s = NULL;
+    nstr_p sub = NULL;
+    nstr_p exp = NULL;
+
+    // 交替排列 3 字节字符和 ASCII 字符，共 40 个字符
+    for (i = 0; i < 20; ++i) {
+        memcpy(buf + bytes, "\xE4\xB8\xAD" "a", 4);
+        bytes += 4;
+    } // for
+
+    s = nstr_new(buf, bytes, true);
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    sub = nstr_new_blank(STR_ENC_UTF8);
+    exp = nstr_new_blank(STR_ENC_UTF8);
+
+    for (i = 1; i <= 42; i += 3) {
+        for (j = 0; j <= 42; j += 5) {
+            nstr_slice(s, (i < 40) ? 40 - i : 0, j, exp);
+            s->chars = CHARS_UNKNOWN; // 字符数未知时只从串尾计数
+            nstr_slice(s, (str_size_t)0 - i, j, sub);
+            cr_expect(sub->start == exp->start && sub->bytes == exp->bytes && nstr_chars(sub) == nstr_chars(exp), "nstr_slice(-%d, %d) return incorrect slice", i, j);
+            cr_expect(s->chars == CHARS_UNKNOWN, "nstr_slice(-%d, %d) counts all chars", i, j);
+
+            // 字符数已知时，非负下标也从较近的一端计数
+            nstr_slice(s, 40 - i, j, sub);
+            cr_expect(nstr_chars(s) == 40, "nstr_chars() return incorrect count");
+            nstr_slice(s, 40 - i, j, exp);
+            cr_expect(sub->start == exp->start && sub->bytes == exp->bytes && nstr_chars(sub) == nstr_chars(exp), "nstr_slice(%d, %d) return incorrect slice", 40 - i, j);
+        } // for
+    } // for
+
+    // 删除和追加都不计算源串的字符数
+    s->chars = CHARS_UNKNOWN;
+    nstr_cut_tail(s, 3, sub);
+    cr_expect(sub->bytes == bytes - 5 && memcmp(sub->start, buf, sub->bytes) == 0 && s->chars == CHARS_UNKNOWN, "nstr_cut_tail() return incorrect result");
+    nstr_cut_tail(s, 41, sub);
+    cr_expect(nstr_is_blank(sub), "nstr_cut_tail() return non-blank when cutting all chars");
+    nstr_append_char(s, '!', sub);
+    cr_expect(sub->bytes == bytes + 1 && sub->start[bytes] == '!' && s->chars == CHARS_UNKNOWN, "nstr_append_char() return incorrect result");
+    nstr_replace(s, -2, 1, NSTR_LITERAL("--"), sub);
+    cr_expect(sub->bytes == bytes - 1 && memcmp(sub->start + bytes - 4, "--a", 3) == 0, "nstr_replace(-2) return incorrect result");
+
+    nstr_delete(exp);
+    nstr_delete(sub);
+    nstr_delete(s);
+} // negative_index
+
+Test(Function, nstr_prev_char)
+{
+    const char_t cstr[] = {"a\xE4\xB8\xAD" "b\xF0\x9F\x98\x80"};
+    const str_size_t r_bytes[] = {4, 1, 3, 1};
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p ch = nstr_new_blank(STR_ENC_UTF8);
+    nstr_p exp = nstr_new_blank(STR_ENC_UTF8);
+    const char_t * start = NULL;
+    str_size_t index = 0;
+    str_size_t bytes = 0;
+    int cnt = 0;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    while ((bytes = nstr_prev_char(s, &start, &index, ch)) > 0) {
+        cr_expect(cnt < 4 && bytes == r_bytes[cnt], "nstr_prev_char() return incorrect bytes on char %d", cnt);
+        cr_expect((str_ssize_t)index == -1 - cnt, "nstr_prev_char() return incorrect index on char %d", cnt);
+
+        // 负下标可直接用于切片
+        nstr_slice(s, index, 1, exp);
+        cr_expect(ch->start == start && exp->start == start && exp->bytes == bytes, "nstr_prev_char() return incorrect slice on char %d", cnt);
+        ++cnt;
+    } // while
+    cr_expect(cnt == 4 && start == NULL && s->chars == CHARS_UNKNOWN, "nstr_prev_char() return incorrect count: expect %d, got %d", 4, cnt);
+
+    nstr_delete(exp);
+    nstr_delete(ch);
+    nstr_delete(s);
+} // nstr_prev_char
+
+Test(Function, nstr_prev_sub)
+{
+    const char_t cstr[] = {"ab\xE4\xB8\xAD" "ab" "\xE4\xB8\xAD\xE4\xB8\xAD" "aba"};
+    const str_ssize_t r_index[] = {-3, -7, -10};
+    const str_size_t r_ret[] = {1, 6, 3};
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    const char_t * start = NULL;
+    str_size_t index = 0;
+    str_size_t ret = 0;
+    int cnt = 0;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    while ((ret = nstr_prev_sub(s, NSTR_LITERAL("ab"), &start, &index)) != STR_NOT_FOUND) {
+        cr_expect(cnt < 3 && ret == r_ret[cnt], "nstr_prev_sub() return incorrect bytes on match %d: got %" STR_SIZE_FMT, cnt, ret);
+        cr_expect(cnt < 3 && (str_ssize_t)index == r_index[cnt], "nstr_prev_sub() return incorrect index on match %d: got %" STR_SSIZE_FMT, cnt, (str_ssize_t)index);
+        cr_expect(start && memcmp(start, "ab", 2) == 0, "nstr_prev_sub() return incorrect position on match %d", cnt);
+        ++cnt;
+    } // while
+    cr_expect(cnt == 3 && start == NULL, "nstr_prev_sub() return incorrect count: expect %d, got %d", 3, cnt);
+
+    // 重叠的候选位置只取靠后的一个
+    cnt = 0;
+    while (nstr_prev_sub(NSTR_LITERAL("aaa"), NSTR_LITERAL("aa"), &start, &index) != STR_NOT_FOUND) ++cnt;
+    cr_expect(cnt == 1 && (str_ssize_t)index == -2, "nstr_prev_sub() return overlapping matches");
+
+    nstr_delete(s);
+} // nstr_prev_sub
+
+Test(Function, nstr_substitute)
+{
+    char_t buf[3 * 200] = {0};
+    char_t exp[4 * 200] = {0};
+    nstr_p s = NULL;
+    nstr_p r = NULL;
+    NSTR_FIXED(fx, 16);
+    uint32_t i = 0;
+
+    // 匹配次数超出栈上缓冲区，结果长度增加
+    for (i = 0; i < 200; ++i) {
+        memcpy(buf + i * 3, "a,b", 3);
+        memcpy(exp + i * 4, "a::b", 4);
+    } // for
+    s = nstr_new(buf, sizeof(buf), true);
+    cr_expect(nstr_chars(s) == sizeof(buf), "nstr_chars() return incorrect count");
+
+    r = nstr_substitute(s, true, NSTR_LITERAL(","), NSTR_LITERAL("::"), NULL);
+    cr_assert(r != NULL, "nstr_substitute() fails");
+    cr_expect(r->bytes == sizeof(exp) && nstr_chars(r) == sizeof(exp) && memcmp(r->start, exp, sizeof(exp)) == 0, "nstr_substitute() return incorrect content");
+
+    // 结果长度减少，匹配在开头和结尾
+    nstr_substitute(s, true, NSTR_LITERAL("a"), NSTR_LITERAL(""), r);
+    cr_expect(r->bytes == 400 && r->start[0] == ',' && r->start[399] == 'b', "nstr_substitute() return incorrect content when shrinking");
+    nstr_substitute(NSTR_LITERAL("xx"), true, NSTR_LITERAL("x"), NSTR_LITERAL(""), r);
+    cr_expect(nstr_is_blank(r), "nstr_substitute() return non-blank when removing all content");
+
+    // 没有匹配时引用源串
+    nstr_substitute(s, true, NSTR_LITERAL("#"), NSTR_LITERAL("::"), r);
+    cr_expect(r->ent == s->ent && r->start == s->start && r->bytes == s->bytes, "nstr_substitute() copies unmatched source");
+
+    // 结果写入定长串
+    nstr_substitute(NSTR_LITERAL("k=\xE4\xB8\xAD;k=v"), true, NSTR_LITERAL("k"), NSTR_LITERAL("key"), NSTR_FIXED_STR(fx));
+    cr_expect(NSTR_FIXED_STR(fx)->bytes == 13 && memcmp(NSTR_FIXED_STR(fx)->start, "key=\xE4\xB8\xAD;key=v", 13) == 0, "nstr_substitute() return incorrect content in fixed string");
+
+    nstr_delete(r);
+    nstr_delete(s);
+} // nstr_substitute
+
+Test(Function, nstr_substitute_pairs)
+{
+    const char_t cstr[] = {"<a href=\"x\">\xE4\xB8\xAD & b</a>"};
+    const char_t r_cstr[] = {"&lt;a href=&quot;x&quot;&gt;\xE4\xB8\xAD &amp; b&lt;/a&gt;"};
+    nstr_p pairs[] = {
+        NSTR_LITERAL("<"), NSTR_LITERAL("&lt;"),
+        NSTR_LITERAL(">"), NSTR_LITERAL("&gt;"),
+        NSTR_LITERAL("&"), NSTR_LITERAL("&amp;"),
+        NSTR_LITERAL("\""), NSTR_LITERAL("&quot;"),
+    };
+    nstr_p longest[] = {
+        NSTR_LITERAL("a"), NSTR_LITERAL("1"),
+        NSTR_LITERAL("ab"), NSTR_LITERAL("2"),
+        NSTR_LITERAL("abc"), NSTR_LITERAL(""),
+        NSTR_LITERAL("1"), NSTR_LITERAL("a"),
+    };
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p r = NULL;
+    nstr_replacer_p rp = NULL;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+
+    // 替换结果不再参与匹配，& 不会被二次转义
+    r = nstr_substitute_pairs(s, pairs, 4, NULL);
+    cr_assert(r != NULL, "nstr_substitute_pairs() fails");
+    cr_expect(r->bytes == sizeof(r_cstr) - 1 && memcmp(r->start, r_cstr, r->bytes) == 0, "nstr_substitute_pairs() return incorrect content");
+    cr_expect(nstr_chars(r) == sizeof(r_cstr) - 3, "nstr_substitute_pairs() return incorrect chars");
+
+    // 每个位置取最长的 from 串
+    nstr_substitute_pairs(NSTR_LITERAL("abcabax1"), longest, 4, r);
+    cr_expect(r->bytes == 4 && memcmp(r->start, "21xa", 4) == 0, "nstr_substitute_pairs() isn't leftmost-longest");
+
+    // 没有匹配时引用源串
+    nstr_substitute_pairs(s, longest + 6, 1, r);
+    cr_expect(r->ent == s->ent && r->bytes == s->bytes, "nstr_substitute_pairs() copies unmatched source");
+
+    rp = nstr_new_replacer(pairs, 4);
+    cr_assert(rp != NULL, "nstr_new_replacer() fails");
+    nstr_substitute_with(s, rp, r);
+    cr_expect(r->bytes == sizeof(r_cstr) - 1 && memcmp(r->start, r_cstr, r->bytes) == 0, "nstr_substitute_with() return incorrect content");
+    nstr_substitute_with(NSTR_LITERAL("&&"), rp, r);
+    cr_expect(r->bytes == 10 && memcmp(r->start, "&amp;&amp;", 10) == 0, "nstr_substitute_with() return incorrect content");
+    nstr_delete_replacer(rp);
+
+    nstr_delete(r);
+    nstr_delete(s);
+} // nstr_substitute_pairs
+
+Test(Function, nstr_compare_nocase)
+{
+    cr_expect(nstr_equal_nocase(NSTR_LITERAL("Content-Length"), NSTR_LITERAL("content-LENGTH")), "nstr_equal_nocase() fails on ASCII");
+    cr_expect(nstr_compare_nocase(NSTR_LITERAL("Host"), NSTR_LITERAL("hosts")) < 0, "nstr_compare_nocase() fails on prefix");
+    cr_expect(nstr_compare_nocase(NSTR_LITERAL("b"), NSTR_LITERAL("A")) > 0, "nstr_compare_nocase() compares unfolded bytes");
+    cr_expect(nstr_compare_nocase(NSTR_LITERAL("["), NSTR_LITERAL("{")) != 0, "nstr_compare_nocase() folds non-letters");
+
+    // 在非 ASCII 字符处按 Unicode 折叠比较
+    cr_expect(nstr_equal_nocase(NSTR_LITERAL_UTF8("Stra\xC3\x9F" "e \xCE\xA3\xCE\xA9"), NSTR_LITERAL_UTF8("STRA\xE1\xBA\x9E" "E \xCF\x83\xCF\x89")), "nstr_equal_nocase() fails on Unicode letters");
+    cr_expect(nstr_equal_nocase(NSTR_LITERAL_UTF8("\xE2\x84\xAA" "elvin"), NSTR_LITERAL_UTF8("kELVIN")), "nstr_equal_nocase() fails on KELVIN SIGN");
+    cr_expect(nstr_compare_nocase(NSTR_LITERAL_UTF8("\xC3\xA0"), NSTR_LITERAL_UTF8("\xC3\x81")) < 0, "nstr_compare_nocase() fails on different letters");
+} // nstr_compare_nocase
+
+Test(Function, nstr_start_end_with_nocase)
+{
+    nstr_p s = NSTR_LITERAL_UTF8("\xCE\xA3ome \xE4\xB8\xAD Text \xE2\x84\xAA");
+
+    cr_expect(nstr_start_with_nocase(NSTR_LITERAL("X-Forwarded-For: a"), NSTR_LITERAL("x-forwarded-")), "nstr_start_with_nocase() fails on ASCII");
+    cr_expect(! nstr_start_with_nocase(NSTR_LITERAL("X-F"), NSTR_LITERAL("x-forwarded-")), "nstr_start_with_nocase() accepts longer prefix");
+    cr_expect(nstr_end_with_nocase(NSTR_LITERAL("index.HTML"), NSTR_LITERAL(".html")), "nstr_end_with_nocase() fails on ASCII");
+    cr_expect(! nstr_end_with_nocase(NSTR_LITERAL("html"), NSTR_LITERAL(".html")), "nstr_end_with_nocase() accepts longer suffix");
+
+    cr_expect(nstr_start_with_nocase(s, NSTR_LITERAL_UTF8("\xCF\x83OME")), "nstr_start_with_nocase() fails on Unicode letters");
+    cr_expect(nstr_end_with_nocase(s, NSTR_LITERAL("text k")), "nstr_end_with_nocase() fails on KELVIN SIGN");
+    cr_expect(! nstr_end_with_nocase(s, NSTR_LITERAL("text x")), "nstr_end_with_nocase() accepts different suffix");
+} // nstr_start_end_with_nocase
+
+Test(Function, nstr_next_sub_nocase)
+{
+    const str_size_t r_ret[] = {1, 1, 4};
+    const str_size_t r_index[] = {1, 5, 10};
+    const str_size_t r_bytes[] = {5, 3, 3};
+    nstr_p s = NSTR_LITERAL_UTF8("x\xE2\x84\xAA" "ey kEY\xE4\xB8\xAD" " Key");
+    const char_t * start = NULL;
+    str_size_t index = 0;
+    str_size_t bytes = 0;
+    str_size_t ret = 0;
+    int cnt = 0;
+
+    // 源串含有 KELVIN SIGN ，需按 Unicode 折叠查找
+    while ((ret = nstr_next_sub_nocase(s, NSTR_LITERAL("KEY"), &start, &index, &bytes)) != STR_NOT_FOUND) {
+        cr_expect(cnt < 3 && ret == r_ret[cnt], "nstr_next_sub_nocase() return incorrect bytes on match %d: got %" STR_SIZE_FMT, cnt, ret);
+        cr_expect(cnt < 3 && index == r_index[cnt], "nstr_next_sub_nocase() return incorrect index on match %d: got %" STR_SIZE_FMT, cnt, index);
+        cr_expect(cnt < 3 && bytes == r_bytes[cnt], "nstr_next_sub_nocase() return incorrect match length on match %d: got %" STR_SIZE_FMT, cnt, bytes);
+        ++cnt;
+    } // while
+    cr_expect(cnt == 3 && start == NULL && index == 13, "nstr_next_sub_nocase() return incorrect count: expect %d, got %d", 3, cnt);
+
+    // 纯 ASCII 内容按 ASCII 折叠成块查找
+    cnt = 0;
+    while (nstr_next_sub_nocase(NSTR_LITERAL("Accept: text/HTML, text/html;q=0.9"), NSTR_LITERAL("Text/Html"), &start, &index, &bytes) != STR_NOT_FOUND) {
+        cr_expect(bytes == 9, "nstr_next_sub_nocase() return incorrect match length: got %" STR_SIZE_FMT, bytes);
+        ++cnt;
+    } // while
+    cr_expect(cnt == 2, "nstr_next_sub_nocase() return incorrect count: expect %d, got %d", 2, cnt);
+
+    cr_expect(nstr_contain_nocase(s, NSTR_LITERAL_UTF8("\xE4\xB8\xAD" " kEY")), "nstr_contain_nocase() fails on Unicode needle");
+    cr_expect(! nstr_contain_nocase(s, NSTR_LITERAL("keys")), "nstr_contain_nocase() finds missing needle");
+} // nstr_next_sub_nocase
+
+Test(Function, nstr_to_lower_upper)
+{
+    char_t buf[100] = {0};
+    nstr_p s = NULL;
+    nstr_p r = NULL;
+    int i = 0;
+
+    // 纯 ASCII 内容，长度超过一个向量块
+    for (i = 0; i < sizeof(buf) - 1; ++i) buf[i] = "Hello, World! [@`{]"[i % 19];
+    s = nstr_new(buf, sizeof(buf) - 1, true);
+
+    r = nstr_to_upper(s, NULL);
+    cr_assert(r != NULL, "nstr_to_upper() fails");
+    for (i = 0; i < sizeof(buf) - 1; ++i) {
+        if (r->start[i] != ((buf[i] >= 'a' && buf[i] <= 'z') ? buf[i] - 0x20 : buf[i])) break;
+    } // for
+    cr_expect(i == sizeof(buf) - 1 && r->bytes == s->bytes && r->start[r->bytes] == 0, "nstr_to_upper() return incorrect result at %d", i);
+    cr_expect(nstr_chars(r) == s->bytes, "nstr_to_upper() return incorrect chars");
+
+    // 已是大写，只增加引用
+    cr_expect(nstr_to_upper(r, r) == r && r->ent->slcs == 1, "nstr_to_upper() copies upper case input");
+    nstr_delete(r);
+    r = nstr_to_lower(NSTR_LITERAL("plain text, 123"), NULL);
+    cr_expect(r != NULL && r->ent == &nstr_literal_entity, "nstr_to_lower() copies lower case input");
+    nstr_delete(r);
+    nstr_delete(s);
+} // nstr_to_lower_upper
+
+Test(Function, nstr_case_unicode)
+{
+    nstr_p s = nstr_new((const char_t *)"Gro\xC3\x9F \xCE\xA3\xE4\xB8\xAD", 11, true); // Groß Σ中
+    nstr_p r = NULL;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(nstr_chars(s) == 7, "nstr_chars() return incorrect chars");
+
+    // ß 转为大写时变为两个字符，按确切长度生成
+    r = nstr_to_upper(s, NULL);
+    cr_assert(r != NULL, "nstr_to_upper() fails");
+    cr_expect(r->bytes == 11 && memcmp(r->start, "GROSS \xCE\xA3\xE4\xB8\xAD", 12) == 0, "nstr_to_upper() return incorrect result: %s", r->start);
+    cr_expect(r->chars == 8 && nstr_chars(r) == 8, "nstr_to_upper() return incorrect chars: %" STR_SIZE_FMT, nstr_chars(r));
+    nstr_delete(r);
+
+    r = nstr_to_lower(s, NULL);
+    cr_expect(r != NULL && r->bytes == 11 && memcmp(r->start, "gro\xC3\x9F \xCF\x83\xE4\xB8\xAD", 12) == 0, "nstr_to_lower() return incorrect result");
+    nstr_delete(r);
+
+    r = nstr_case_fold(s, NULL);
+    cr_expect(r != NULL && r->bytes == 11 && memcmp(r->start, "gross \xCF\x83\xE4\xB8\xAD", 12) == 0, "nstr_case_fold() return incorrect result");
+    cr_expect(nstr_equal_nocase(r, NSTR_LITERAL_UTF8("GROSS \xCF\x83\xE4\xB8\xAD")), "nstr_case_fold() result differs");
+
+    // 折叠结果不再变化
+    cr_expect(nstr_case_fold(r, r) == r && r->ent->slcs == 1, "nstr_case_fold() copies folded input");
+    nstr_delete(r);
+    nstr_delete(s);
+} // nstr_case_unicode
+
+Test(Function, nstr_normalize)
+{
+    nstr_p s = nstr_new((const char_t *)"caf\xC3\xA9 \xED\x95\x9C \xEF\xAC\x81", 13, true); // café 한 ﬁ
+    nstr_p d = NULL;
+    nstr_p r = NULL;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+
+    // 已是 NFC ，只增加引用
+    r = nstr_normalize(s, STR_NFC, NULL);
+    cr_expect(r != NULL && r->ent == s->ent && r->bytes == s->bytes, "nstr_normalize() copies NFC input");
+    cr_expect(nstr_is_normalized(s, STR_NFC) && ! nstr_is_normalized(s, STR_NFD), "nstr_is_normalized() return incorrect result");
+    nstr_delete(r);
+
+    d = nstr_normalize(s, STR_NFD, NULL);
+    cr_assert(d != NULL, "nstr_normalize() fails");
+    cr_expect(d->bytes == 20 && memcmp(d->start, "cafe\xCC\x81 \xE1\x84\x92\xE1\x85\xA1\xE1\x86\xAB \xEF\xAC\x81", 21) == 0, "nstr_normalize() return incorrect NFD result: %s", d->start);
+    cr_expect(nstr_chars(d) == 11 && nstr_is_normalized(d, STR_NFD), "nstr_normalize() return incorrect chars: %" STR_SIZE_FMT, nstr_chars(d));
+
+    // 往返后与原串相同
+    r = nstr_normalize(d, STR_NFC, NULL);
+    cr_expect(r != NULL && nstr_equal(r, s, STR_LOC_C), "nstr_normalize() round trip differs: %s", r->start);
+    nstr_delete(r);
+
+    r = nstr_normalize(d, STR_NFKC, NULL);
+    cr_expect(r != NULL && r->bytes == 12 && memcmp(r->start, "caf\xC3\xA9 \xED\x95\x9C fi", 13) == 0, "nstr_normalize() return incorrect NFKC result: %s", r->start);
+    nstr_delete(r);
+
+    // ASCII 串不受影响
+    r = nstr_normalize(NSTR_LITERAL("plain text"), STR_NFKD, NULL);
+    cr_expect(r != NULL && r->ent == &nstr_literal_entity, "nstr_normalize() copies ASCII input");
+    nstr_delete(r);
+    nstr_delete(d);
+    nstr_delete(s);
+} // nstr_normalize
+
+Test(Function, nstr_next_grapheme)
+{
+    const char_t cstr[] = {"e\xCC\x81\r\n\xF0\x9F\x87\xA8\xF0\x9F\x87\xB3\xED\x95\x9C\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2\x80\x8D\xF0\x9F\x91\xA7x"};
+    const str_size_t r_bytes[] = {3, 2, 8, 3, 18, 1};
+    const str_size_t r_index[] = {0, 2, 4, 6, 7, 12};
+    nstr_p s = nstr_new(cstr, sizeof(cstr) - 1, true);
+    nstr_p g = nstr_new_blank(STR_ENC_UTF8);
+    const char_t * start = NULL;
+    const char_t * pos = NULL;
+    str_size_t index = 0;
+    str_size_t bytes = 0;
+    int cnt = 0;
+
+    cr_assert(nstr_set_encoding(s, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(nstr_graphemes(s) == 6 && nstr_chars(s) == 13, "nstr_graphemes() return incorrect count: %" STR_SIZE_FMT, nstr_graphemes(s));
+
+    pos = s->start;
+    while ((bytes = nstr_next_grapheme(s, &start, &index, g)) > 0) {
+        if (cnt < 6) {
+            cr_expect(bytes == r_bytes[cnt] && g->start == pos && g->ent == s->ent, "nstr_next_grapheme() return incorrect cluster %d: bytes = %" STR_SIZE_FMT, cnt, bytes);
+            cr_expect(index == r_index[cnt], "nstr_next_grapheme() return incorrect index %d: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, cnt, r_index[cnt], index);
+        } // if
+        pos += bytes;
+        ++cnt;
+    } // while
+    cr_expect(cnt == 6 && start == NULL && index == nstr_chars(s), "nstr_next_grapheme() return incorrect count: expect 6, got %d", cnt);
+
+    // 纯 ASCII 串只合并 CR LF
+    cr_expect(nstr_graphemes(NSTR_LITERAL("a\r\nb\r\r\n")) == 5, "nstr_graphemes() return incorrect count for ASCII");
+    start = NULL;
+    cnt = 0;
+    while (nstr_next_grapheme(NSTR_LITERAL("a\r\nb"), &start, &index, g) > 0) ++cnt;
+    cr_expect(cnt == 3 && index == 4, "nstr_next_grapheme() return incorrect count for ASCII: %d", cnt);
+
+    nstr_delete(g);
+    nstr_delete(s);
+} // nstr_next_grapheme
+
+static int compare_root(const void * a, const void * b)
+{
+    return nstr_compare(*(nstr_p *)a, *(nstr_p *)b, STR_LOC_ROOT);
+} // compare_root
+
+Test(Function, nstr_compare_locale)
+{
+    const char * words[] = {"peach", "P\xC3\xA9" "ch\xC3\xA9", "Peach", "p\xC3\xA9" "ch\xC3\xA9", "apple", "\xC3\x85ngstr\xC3\xB6m", "zoo"};
+    const char * sorted[] = {"\xC3\x85ngstr\xC3\xB6m", "apple", "peach", "Peach", "p\xC3\xA9" "ch\xC3\xA9", "P\xC3\xA9" "ch\xC3\xA9", "zoo"};
+    const str_collation_rule_t rules[] = {{0x00F1, 'n', 1}};
+    const str_collation_rule_t bad[] = {{'x', 'a', 0}};
+    nstr_p ss[7] = {NULL};
+    nstr_p s1 = NULL;
+    nstr_p s2 = NULL;
+    nstr_view_t v1;
+    nstr_view_t v2;
+    coll_key_p key = NULL;
+    int loc = 0;
+    int i = 0;
+
+    for (i = 0; i < 7; ++i) {
+        ss[i] = nstr_new((const char_t *)words[i], strlen(words[i]), true);
+        cr_assert(nstr_set_encoding(ss[i], STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    } // for
+
+    qsort(ss, 7, sizeof(ss[0]), &compare_root);
+    for (i = 0; i < 7; ++i) {
+        cr_expect(ss[i]->bytes == strlen(sorted[i]) && memcmp(ss[i]->start, sorted[i], ss[i]->bytes) == 0, "nstr_compare() return incorrect order at %d: %s", i, ss[i]->start);
+    } // for
+
+    // 排序键缓存在实体上，再次比较时直接使用
+    key = ss[0]->ent->keys;
+    cr_expect(key != NULL && key->locale == STR_LOC_ROOT && key->start == ss[0]->start && key->next == NULL, "nstr_compare() does not cache sort key");
+    cr_expect(nstr_compare(ss[0], ss[1], STR_LOC_ROOT) < 0 && ss[0]->ent->keys == key, "nstr_compare() rebuilds cached sort key");
+    cr_expect(nstr_compare(ss[0], ss[1], STR_LOC_C) > 0, "nstr_compare() return incorrect result for STR_LOC_C");
+
+    // 规范等价的串相同
+    s1 = nstr_new((const char_t *)"e\xCC\x81", 3, true);
+    cr_expect(nstr_set_encoding(s1, STR_ENC_UTF8) && nstr_equal(s1, NSTR_LITERAL_UTF8("\xC3\xA9"), STR_LOC_ROOT), "nstr_compare() distinguishes canonical equivalents");
+
+    // 根排序规则按 DUCET：ß 展开为 ss ，ð 是 d 的变体
+    cr_expect(nstr_less(NSTR_LITERAL_UTF8("\xC3\x9F"), NSTR_LITERAL("st"), STR_LOC_ROOT) && nstr_less(NSTR_LITERAL_UTF8("\xC3\xB0"), NSTR_LITERAL("e"), STR_LOC_ROOT), "nstr_compare() does not follow DUCET");
+
+    // 裁剪排序规则
+    loc = nstr_add_locale(rules, 1);
+    cr_assert(loc >= STR_LOC_USER, "nstr_add_locale() fails: %d", loc);
+    s2 = nstr_new((const char_t *)"\xC3\xB1" "a", 3, true);
+    cr_expect(nstr_set_encoding(s2, STR_ENC_UTF8), "nstr_set_encoding() rejects valid UTF-8");
+    cr_expect(nstr_less(s2, NSTR_LITERAL("nz"), STR_LOC_ROOT) && nstr_greater(s2, NSTR_LITERAL("nz"), loc), "nstr_compare() ignores tailoring");
+    cr_expect(nstr_less(s2, NSTR_LITERAL("o"), loc), "nstr_compare() misplaces tailored character");
+    cr_expect(nstr_less(s2, NSTR_LITERAL("nz"), (str_locale_t)(loc + 100)), "nstr_compare() don't fall back to root for unknown locale");
+    cr_expect(nstr_add_locale(bad, 1) == STR_BAD_PATTERN, "nstr_add_locale() accepts invalid level");
+
+    v1 = nstr_view(s2);
+    v2 = nstr_view(NSTR_LITERAL("nz"));
+    cr_expect(nstr_view_compare(&v1, &v2, STR_LOC_ROOT) < 0 && nstr_view_compare(&v1, &v2, loc) > 0, "nstr_view_compare() ignores locale");
+
+    nstr_delete(s2);
+    nstr_delete(s1);
+    for (i = 0; i < 7; ++i) nstr_delete(ss[i]);
+} // nstr_compare_locale
@@ -0,0 +1,170 @@
+#include <criterion/criterion.h>
+
+#ifndef REGEX_SOURCE
+#define REGEX_SOURCE 1
+#include "str/regex.c"
+#endif
+
+typedef struct {
+    const char * pattern;
+    const char * text;
+    int start;          // 期望的匹配起始偏移量，-1 表示不匹配
+    int end;
+} regex_case_t;
+
+Test(Function, str_regex_find)
+{
+    const regex_case_t cases[] = {
+        {"abc", "xxabcxx", 2, 5},
+        {"a|ab", "ab", 0, 1},                   // 左侧优先
+        {"ab|a", "ab", 0, 2},
+        {"a*", "baaa", 0, 0},                   // 空匹配
+        {"a+", "baaa", 1, 4},
+        {"a+?", "baaa", 1, 2},
+        {"a{2,3}", "aaaa", 0, 3},
+        {"a{2,3}?", "aaaa", 0, 2},
+        {"a{2}", "a", -1, -1},
+        {"x{,2}", "x{,2}", 0, 5},               // 不符合格式的计数按字面处理
+        {"^b", "ab", -1, -1},
+        {"b$", "abb", 2, 3},
+        {"^$", "", 0, 0},
+        {"[a-c]+", "xxcabz", 2, 5},
+        {"[^a-c]+", "abcxyz", 3, 6},
+        {"\\d+\\.\\d+", "v = 12.50;", 4, 9},
+        {"\\w+", "  foo_1 ", 2, 7},
+        {"\\S+", " \t\n x", 4, 5},
+        {"a.c", "a\nc abc", 4, 7},              // . 不匹配 \n
+        {"中.", "abc中文", 3, 9},               // 按字符而非字节匹配
+        {"[文中]+", "abc中文字", 3, 9},
+        {"[^a]", "a中", 1, 4},
+        {"(?:ab)+c", "abababc", 0, 7},
+        {"(a|b)*abb", "babaabb", 0, 7},
+        {"x*y", "xxxxxxxxz", -1, -1},
+        {"(a*)*b", "aaab", 0, 4},               // 可匹配空串的循环
+    };
+    const char_t * caps[2] = {NULL};
+    str_regex_p re = NULL;
+    const char * text = NULL;
+    int32_t err = 0;
+    bool found = false;
+    int i = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        text = cases[i].text;
+        re = str_regex_new((const char_t *)cases[i].pattern, strlen(cases[i].pattern), &err, NULL);
+        cr_assert(re != NULL, "str_regex_new() fails on case %d: err = %d", i, err);
+
+        found = str_regex_find(re, (const char_t *)text, (const char_t *)text + strlen(text), (const char_t *)text, caps, 1);
+        if (cases[i].start < 0) {
+            cr_expect(! found, "str_regex_find() matches unexpectedly on case %d", i);
+        } else {
+            cr_expect(found, "str_regex_find() fails on case %d", i);
+            if (found) cr_expect(caps[0] - (const char_t *)text == cases[i].start && caps[1] - (const char_t *)text == cases[i].end, "str_regex_find() return incorrect range on case %d: expect [%d, %d), got [%d, %d)", i, cases[i].start, cases[i].end, (int)(caps[0] - (const char_t *)text), (int)(caps[1] - (const char_t *)text));
+        } // if
+
+        // 只判定是否匹配时结果一致
+        cr_expect(str_regex_find(re, (const char_t *)text, (const char_t *)text + strlen(text), (const char_t *)text, NULL, 0) == found, "str_regex_find() without captures disagrees on case %d", i);
+        str_regex_delete(re);
+    } // for
+} // str_regex_find
+
+Test(Function, str_regex_captures)
+{
+    const char text[] = {"key = value; k2 = v2"};
+    const char_t * caps[8] = {NULL};
+    str_regex_p re = NULL;
+    const char_t * pos = (const char_t *)text;
+    const char_t * end = (const char_t *)text + sizeof(text) - 1;
+    int32_t err = 0;
+
+    re = str_regex_new((const char_t *)"(\\w+) = (\\w+)(;)?(x)?", 21, &err, NULL);
+    cr_assert(re != NULL, "str_regex_new() fails: err = %d", err);
+    cr_expect(str_regex_groups(re) == 5, "str_regex_groups() return incorrect count: expect %d, got %u", 5, str_regex_groups(re));
+
+    cr_assert(str_regex_find(re, pos, end, pos, caps, 4), "str_regex_find() fails");
+    cr_expect(caps[2] - pos == 0 && caps[3] - pos == 3, "str_regex_find() return incorrect group 1");
+    cr_expect(caps[4] - pos == 6 && caps[5] - pos == 11, "str_regex_find() return incorrect group 2");
+    cr_expect(caps[6] - pos == 11 && caps[7] - pos == 12, "str_regex_find() return incorrect group 3");
+
+    // 从上次匹配结尾继续查找，未参与匹配的分组为 NULL
+    cr_assert(str_regex_find(re, pos, end, caps[1], caps, 4), "str_regex_find() fails on second match");
+    cr_expect(caps[2] - pos == 13 && caps[5] - pos == 20, "str_regex_find() return incorrect second match");
+    cr_expect(caps[6] == NULL && caps[7] == NULL, "str_regex_find() return non-NULL for unmatched group");
+    cr_expect(! str_regex_find(re, pos, end, caps[1], caps, 4), "str_regex_find() matches past the end");
+    str_regex_delete(re);
+
+    // 分组在重复中取最后一次
+    re = str_regex_new((const char_t *)"(?:(a)|b)+", 10, &err, NULL);
+    cr_assert(re != NULL, "str_regex_new() fails: err = %d", err);
+    cr_assert(str_regex_find(re, (const char_t *)"abab", (const char_t *)"abab" + 4, (const char_t *)"abab", caps, 2), "str_regex_find() fails");
+    cr_expect(caps[2] - caps[0] == 2 && caps[3] - caps[0] == 3, "str_regex_find() return incorrect group in repetition");
+    str_regex_delete(re);
+
+    // 重复体匹配空串的那一轮不计入（与 RE2 相同，Perl/PCRE 中分组 1 为空串 0..0）
+    re = str_regex_new((const char_t *)"(x*)*", 5, &err, NULL);
+    cr_assert(re != NULL, "str_regex_new() fails: err = %d", err);
+    cr_assert(str_regex_find(re, (const char_t *)"a", (const char_t *)"a" + 1, (const char_t *)"a", caps, 2), "str_regex_find() fails");
+    cr_expect(caps[1] == caps[0] && caps[2] == NULL && caps[3] == NULL, "str_regex_find() records empty iteration");
+    str_regex_delete(re);
+
+    // 空串分支不能结束重复，继续尝试后续分支（Perl/PCRE 匹配 0..0）
+    re = str_regex_new((const char_t *)"(?:[ab]?\?|c*[ab]+?)+b*?", 23, &err, NULL);
+    cr_assert(re != NULL, "str_regex_new() fails: err = %d", err);
+    cr_assert(str_regex_find(re, (const char_t *)"caacabaa", (const char_t *)"caacabaa" + 8, (const char_t *)"caacabaa", caps, 1), "str_regex_find() fails");
+    cr_expect(caps[1] - caps[0] == 8, "str_regex_find() return incorrect range for empty iteration: got %d", (int)(caps[1] - caps[0]));
+    str_regex_delete(re);
+} // str_regex_captures
+
+Test(Function, str_regex_syntax)
+{
+    const char * bad[] = {"(", "(a", "a)", "*a", "a|+", "[", "[a-", "[z-a]", "\\", "\\q", "a{3,2}", "a{1001}", "\xE4\xB8"};
+    const char * good[] = {"", "()", "a|", "|", "[]a]", "[-a]", "[a-]", "a{1000}", "\\.\\*\\[", "[\\d\\s]"};
+    str_regex_p re = NULL;
+    str_size_t pos = 0;
+    int32_t err = 0;
+    int i = 0;
+
+    for (i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        re = str_regex_new((const char_t *)bad[i], strlen(bad[i]), &err, &pos);
+        cr_expect(re == NULL && err == STR_REGEX_BAD_SYNTAX, "str_regex_new() accepts bad pattern \"%s\"", bad[i]);
+        str_regex_delete(re);
+    } // for
+    for (i = 0; i < sizeof(good) / sizeof(good[0]); ++i) {
+        re = str_regex_new((const char_t *)good[i], strlen(good[i]), &err, &pos);
+        cr_expect(re != NULL && err == 0, "str_regex_new() rejects pattern \"%s\": err = %d", good[i], err);
+        str_regex_delete(re);
+    } // for
+
+    re = str_regex_new((const char_t *)"(a{1000}){1000}", 15, &err, NULL);
+    cr_expect(re == NULL && err == STR_REGEX_TOO_LARGE, "str_regex_new() accepts too large pattern");
+} // str_regex_syntax
+
+Test(Function, str_regex_dfa_budget)
+{
+    char_t text[4000] = {0};
+    const char_t * caps[2] = {NULL};
+    str_regex_p re = NULL;
+    uint32_t seed = 7;
+    int32_t err = 0;
+    int last = -1;
+    int i = 0;
+
+    // 该模式的 DFA 有 2^11 个状态，超出缓存预算，扫描期间需要多次清空缓存
+    for (i = 0; i < sizeof(text); ++i) {
+        seed = seed * 1103515245 + 12345;
+        text[i] = 'a' + (seed >> 16) % 2;
+        if (text[i] == 'a' && i + 11 <= sizeof(text)) last = i;
+    } // for
+
+    re = str_regex_new((const char_t *)"(a|b)*a(a|b){10}", 16, &err, NULL);
+    cr_assert(re != NULL, "str_regex_new() fails: err = %d", err);
+    cr_assert(str_regex_find(re, text, text + sizeof(text), text, caps, 1), "str_regex_find() fails");
+    cr_expect(caps[0] == text && caps[1] == text + last + 11, "str_regex_find() return incorrect range: expect [0, %d), got [%d, %d)", last + 11, (int)(caps[0] - text), (int)(caps[1] - text));
+    cr_expect(re->dfa[0].used <= STR_REGEX_DFA_BUDGET, "DFA cache exceeds the budget");
+
+    // 结尾附近没有 a 时不匹配
+    memset(text + sizeof(text) - 11, 'b', 11);
+    text[sizeof(text) - 12] = 'b';
+    cr_expect(! str_regex_find(re, text + sizeof(text) - 12, text + sizeof(text), text + sizeof(text) - 12, NULL, 0), "str_regex_find() matches unexpectedly");
+    str_regex_delete(re);
+} // str_regex_dfa_budget
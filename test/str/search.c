@@ -0,0 +1,169 @@
+#include <criterion/criterion.h>
+
+#ifndef SEARCH_SOURCE
+#define SEARCH_SOURCE 1
+#include "str/search.c"
+#endif
+
+// 朴素查找，作为对照结果
+static const char_t * naive_find(const char_t * start, str_size_t bytes, const char_t * needle, str_size_t nbytes)
+{
+    str_size_t i = 0;
+
+    for (i = 0; i + nbytes <= bytes; ++i) {
+        if (memcmp(start + i, needle, nbytes) == 0) return start + i;
+    } // for
+    return NULL;
+} // naive_find
+
+static const char_t * naive_rfind(const char_t * start, str_size_t bytes, const char_t * needle, str_size_t nbytes)
+{
+    str_size_t i = bytes - nbytes + 1;
+
+    if (bytes < nbytes) return NULL;
+    while (i-- > 0) {
+        if (memcmp(start + i, needle, nbytes) == 0) return start + i;
+    } // while
+    return NULL;
+} // naive_rfind
+
+Test(Function, str_searcher_algo)
+{
+    str_searcher_t sr;
+
+    str_searcher_init(&sr, (const char_t *)",", 1);
+    cr_expect(sr.algo == STR_SEARCH_BYTE, "str_searcher_init() picks wrong algorithm for single byte");
+    str_searcher_init(&sr, (const char_t *)"\r\n", 2);
+    cr_expect(sr.algo == STR_SEARCH_PAIR, "str_searcher_init() picks wrong algorithm for short needle");
+    str_searcher_init(&sr, (const char_t *)"0123456789abcdef0123456789abcdef", 32);
+    cr_expect(sr.algo == STR_SEARCH_HORSPOOL && sr.shift['f'] == 16 && sr.shift['x'] == 32, "str_searcher_init() builds wrong shift table");
+} // str_searcher_algo
+
+Test(Function, str_searcher_find)
+{
+    char_t hay[4096] = {0};
+    char_t needle[300] = {0};
+    const str_size_t lens[] = {1, 2, 3, 7, 8, 9, 31, 32, 33, 100, 260};
+    str_searcher_t sr;
+    const char_t * expect = NULL;
+    const char_t * got = NULL;
+    uint32_t seed = 7;
+    str_size_t i = 0;
+    int n = 0;
+    int t = 0;
+
+    // 小字母表使部分匹配频繁出现
+    for (i = 0; i < sizeof(hay); ++i) {
+        seed = seed * 1103515245 + 12345;
+        hay[i] = 'a' + (seed >> 16) % 3;
+    } // for
+
+    for (n = 0; n < sizeof(lens) / sizeof(lens[0]); ++n) {
+        for (t = 0; t < 20; ++t) {
+            seed = seed * 1103515245 + 12345;
+            if (t % 2 == 0) {
+                memcpy(needle, hay + (seed >> 8) % (sizeof(hay) - lens[n]), lens[n]); // 必然出现
+            } else {
+                for (i = 0; i < lens[n]; ++i) needle[i] = 'a' + ((seed >> i % 24) + i) % 3;
+            } // if
+
+            str_searcher_init(&sr, needle, lens[n]);
+            expect = naive_find(hay, sizeof(hay), needle, lens[n]);
+            got = str_searcher_find(&sr, hay, sizeof(hay));
+            cr_expect(got == expect, "str_searcher_find() return incorrect position for %" STR_SIZE_FMT " bytes: expect %p, got %p", lens[n], expect, got);
+
+            // 结尾处的匹配和过短的范围
+            got = str_searcher_find(&sr, hay + sizeof(hay) - lens[n], lens[n]);
+            cr_expect(got == naive_find(hay + sizeof(hay) - lens[n], lens[n], needle, lens[n]), "str_searcher_find() misses match at end for %" STR_SIZE_FMT " bytes", lens[n]);
+            cr_expect(str_searcher_find(&sr, hay, lens[n] - 1) == NULL, "str_searcher_find() reads beyond range for %" STR_SIZE_FMT " bytes", lens[n]);
+        } // for
+    } // for
+} // str_searcher_find
+
+Test(Function, str_searcher_rfind)
+{
+    char_t hay[4096] = {0};
+    char_t needle[300] = {0};
+    const str_size_t lens[] = {1, 2, 3, 7, 8, 9, 31, 32, 33, 100, 260};
+    str_searcher_t sr;
+    const char_t * expect = NULL;
+    const char_t * got = NULL;
+    uint32_t seed = 11;
+    str_size_t i = 0;
+    str_size_t bytes = 0;
+    int n = 0;
+    int t = 0;
+
+    for (i = 0; i < sizeof(hay); ++i) {
+        seed = seed * 1103515245 + 12345;
+        hay[i] = 'a' + (seed >> 16) % 3;
+    } // for
+
+    for (n = 0; n < sizeof(lens) / sizeof(lens[0]); ++n) {
+        for (t = 0; t < 20; ++t) {
+            seed = seed * 1103515245 + 12345;
+            if (t % 2 == 0) {
+                memcpy(needle, hay + (seed >> 8) % (sizeof(hay) - lens[n]), lens[n]); // 必然出现
+            } else {
+                for (i = 0; i < lens[n]; ++i) needle[i] = 'a' + ((seed >> i % 24) + i) % 3;
+            } // if
+
+            // 范围长度不是 8 的倍数，覆盖逐块检查后剩余的部分
+            bytes = sizeof(hay) - t;
+            str_searcher_init(&sr, needle, lens[n]);
+            expect = naive_rfind(hay, bytes, needle, lens[n]);
+            got = str_searcher_rfind(&sr, hay, bytes);
+            cr_expect(got == expect, "str_searcher_rfind() return incorrect position for %" STR_SIZE_FMT " bytes: expect %p, got %p", lens[n], expect, got);
+
+            // 开头处的匹配和过短的范围
+            got = str_searcher_rfind(&sr, hay, lens[n] + t % 3);
+            cr_expect(got == naive_rfind(hay, lens[n] + t % 3, needle, lens[n]), "str_searcher_rfind() misses match at start for %" STR_SIZE_FMT " bytes", lens[n]);
+            cr_expect(str_searcher_rfind(&sr, hay, lens[n] - 1) == NULL, "str_searcher_rfind() reads beyond range for %" STR_SIZE_FMT " bytes", lens[n]);
+        } // for
+    } // for
+} // str_searcher_rfind
+
+Test(Function, str_searcher_find_nocase)
+{
+    char_t hay[1024] = {0};
+    char_t lower[1024] = {0};
+    char_t needle[40] = {0};
+    const str_size_t lens[] = {1, 2, 3, 8, 9, 33};
+    str_searcher_t sr;
+    const char_t * expect = NULL;
+    const char_t * got = NULL;
+    uint32_t seed = 7;
+    str_size_t i = 0;
+    int n = 0;
+    int t = 0;
+
+    // 大小写混合的小字母表，对照结果在全部转为小写的副本中查找
+    for (i = 0; i < sizeof(hay); ++i) {
+        seed = seed * 1103515245 + 12345;
+        hay[i] = "abAB[{"[(seed >> 16) % 6];
+        lower[i] = (hay[i] >= 'A' && hay[i] <= 'Z') ? hay[i] + 0x20 : hay[i];
+    } // for
+
+    for (n = 0; n < sizeof(lens) / sizeof(lens[0]); ++n) {
+        for (t = 0; t < 20; ++t) {
+            seed = seed * 1103515245 + 12345;
+            i = (seed >> 8) % (sizeof(hay) - lens[n]);
+            memcpy(needle, lower + i, lens[n]);
+            expect = naive_find(lower, sizeof(lower), needle, lens[n]);
+
+            // 模式串的首尾字母改为大写
+            if (t % 2 && needle[0] >= 'a' && needle[0] <= 'z') needle[0] -= 0x20;
+            if (t % 2 && needle[lens[n] - 1] >= 'a' && needle[lens[n] - 1] <= 'z') needle[lens[n] - 1] -= 0x20;
+
+            str_searcher_init_nocase(&sr, needle, lens[n]);
+            got = str_searcher_find(&sr, hay, sizeof(hay));
+            cr_expect(got - hay == expect - lower, "str_searcher_find() return incorrect position for nocase needle of %" STR_SIZE_FMT " bytes: expect %d, got %d", lens[n], (int)(expect - lower), (int)(got - hay));
+        } // for
+    } // for
+
+    // '[' 与 '{' 相差 0x20 ，但不是字母
+    memcpy(hay, "A[xxxxxxxxxxA{", 14);
+    str_searcher_init_nocase(&sr, (const char_t *)"a{", 2);
+    got = str_searcher_find(&sr, hay, 14);
+    cr_expect(got - hay == 12, "str_searcher_find() folds non-letters: expect 12, got %d", (int)(got - hay));
+} // str_searcher_find_nocase
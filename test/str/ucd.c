@@ -0,0 +1,362 @@
+#include <criterion/criterion.h>
+
+#ifndef UCD_SOURCE
+#define UCD_SOURCE 1
+#include "str/ucd.c"
+#endif
+
+Test(Function, ucd_fold)
+{
+    const uchar_t cases[][2] = {
+        {'A', 'a'}, {'z', 'z'}, {'@', '@'}, {'[', '['},
+        {0x00C0, 0x00E0},   // À
+        {0x00DF, 0x00DF},   // ß 没有单字符折叠形式
+        {0x1E9E, 0x00DF},   // ẞ
+        {0x03A3, 0x03C3},   // Σ
+        {0x03C2, 0x03C3},   // ς
+        {0x0130, 0x0130},   // İ 的折叠结果是两个字符
+        {0x212A, 'k'},      // KELVIN SIGN
+        {0x017F, 's'},      // ſ
+        {0x0410, 0x0430},   // А
+        {0x13A0, 0x13A0},   // Cherokee 的小写字母折叠为大写字母
+        {0xAB70, 0x13A0},
+        {0x10400, 0x10428}, // Deseret
+        {0x4E2D, 0x4E2D},   // 中
+        {0x10FFFF, 0x10FFFF},
+    };
+    uchar_t ch = 0;
+    int i = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        ch = ucd_fold(cases[i][0]);
+        cr_expect(ch == cases[i][1], "ucd_fold(U+%04X) return incorrect code point: expect U+%04X, got U+%04X", cases[i][0], cases[i][1], ch);
+    } // for
+} // ucd_fold
+
+Test(Function, ucd_fold_aliased_in)
+{
+    cr_expect(ucd_fold_aliased_in((const char_t *)"Kit", 3), "ucd_fold_aliased_in() misses 'K'");
+    cr_expect(ucd_fold_aliased_in((const char_t *)"bus", 3), "ucd_fold_aliased_in() misses 's'");
+    cr_expect(! ucd_fold_aliased_in((const char_t *)"HTTP-Header", 11), "ucd_fold_aliased_in() return true for plain letters");
+    cr_expect(! ucd_fold_aliased_in((const char_t *)"\xE2\x84\xAA", 3), "ucd_fold_aliased_in() return true for non-ASCII bytes");
+} // ucd_fold_aliased_in
+
+Test(Function, ucd_fold_compare)
+{
+    const char * p1 = "\xCE\xA3\xCE\xA9\xCE\xA3"; // ΣΩΣ
+    const char * p2 = "\xCF\x83\xCF\x89\xCF\x82"; // σως
+    str_size_t m1 = 0;
+    str_size_t m2 = 0;
+    int ret = 0;
+
+    ret = ucd_fold_compare((const char_t *)p1, 6, (const char_t *)p2, 6, &m1, &m2);
+    cr_expect(ret == 0 && m1 == 6 && m2 == 6, "ucd_fold_compare() fails on Greek letters: ret = %d, m1 = %" STR_SIZE_FMT ", m2 = %" STR_SIZE_FMT, ret, m1, m2);
+
+    // 折叠前后的字符占用不同字节数
+    ret = ucd_fold_compare((const char_t *)"\xE2\x84\xAA" "elvin", 8, (const char_t *)"KELVIN", 6, &m1, &m2);
+    cr_expect(ret == 0 && m1 == 8 && m2 == 6, "ucd_fold_compare() fails on KELVIN SIGN: ret = %d, m1 = %" STR_SIZE_FMT ", m2 = %" STR_SIZE_FMT, ret, m1, m2);
+
+    // 前缀较小
+    ret = ucd_fold_compare((const char_t *)"ab", 2, (const char_t *)"AB\xC3\x80", 4, &m1, &m2);
+    cr_expect(ret < 0 && m1 == 2 && m2 == 2, "ucd_fold_compare() fails on prefix: ret = %d, m1 = %" STR_SIZE_FMT ", m2 = %" STR_SIZE_FMT, ret, m1, m2);
+
+    ret = ucd_fold_compare((const char_t *)"a\xC3\xA1", 3, (const char_t *)"A\xC3\xA0", 3, &m1, &m2);
+    cr_expect(ret > 0 && m1 == 1 && m2 == 1, "ucd_fold_compare() fails on different letters: ret = %d, m1 = %" STR_SIZE_FMT ", m2 = %" STR_SIZE_FMT, ret, m1, m2);
+
+    // 结尾处截断的字符按异常字节处理，不越界读取
+    ret = ucd_fold_compare((const char_t *)"a\xE4\xB8", 3, (const char_t *)"A\xE4\xB8", 3, NULL, NULL);
+    cr_expect(ret == 0, "ucd_fold_compare() fails on truncated character: ret = %d", ret);
+} // ucd_fold_compare
+
+Test(Function, ucd_fold_suffix)
+{
+    cr_expect(ucd_fold_suffix((const char_t *)"\xE4\xB8\xAD\xCE\xA3\xCE\xA9", 7, (const char_t *)"\xCF\x83\xCF\x89", 4), "ucd_fold_suffix() fails on Greek letters");
+    cr_expect(ucd_fold_suffix((const char_t *)"Mark", 4, (const char_t *)"\xE2\x84\xAA", 3), "ucd_fold_suffix() fails on KELVIN SIGN");
+    cr_expect(ucd_fold_suffix((const char_t *)"abc", 3, (const char_t *)"", 0), "ucd_fold_suffix() fails on blank suffix");
+    cr_expect(! ucd_fold_suffix((const char_t *)"bc", 2, (const char_t *)"ABC", 3), "ucd_fold_suffix() accepts longer suffix");
+    cr_expect(! ucd_fold_suffix((const char_t *)"\xE4\xB8\xAD", 3, (const char_t *)"\xB8\xAD", 2), "ucd_fold_suffix() matches inside a character");
+} // ucd_fold_suffix
+
+Test(Function, ucd_case)
+{
+    const struct {
+        uchar_t ch;
+        uint32_t kind;
+        int32_t n;
+        uchar_t out[UCD_CASE_MAX];
+    } cases[] = {
+        {'a', UCD_CASE_UPPER, 1, {'A'}},
+        {'A', UCD_CASE_UPPER, 1, {'A'}},
+        {'A', UCD_CASE_FOLD, 1, {'a'}},
+        {'{', UCD_CASE_UPPER, 1, {'{'}},
+        {0x00DF, UCD_CASE_UPPER, 2, {'S', 'S'}},            // ß
+        {0x00DF, UCD_CASE_LOWER, 1, {0x00DF}},
+        {0x00DF, UCD_CASE_FOLD, 2, {'s', 's'}},
+        {0x1E9E, UCD_CASE_LOWER, 1, {0x00DF}},              // ẞ
+        {0x0130, UCD_CASE_LOWER, 2, {'i', 0x0307}},         // İ
+        {0x0390, UCD_CASE_UPPER, 3, {0x0399, 0x0308, 0x0301}},
+        {0xFB03, UCD_CASE_UPPER, 3, {'F', 'F', 'I'}},       // ﬃ
+        {0x212A, UCD_CASE_LOWER, 1, {'k'}},                 // KELVIN SIGN
+        {0x0131, UCD_CASE_UPPER, 1, {'I'}},                 // ı
+        {0x4E2D, UCD_CASE_UPPER, 1, {0x4E2D}},              // 中
+        {0x10428, UCD_CASE_UPPER, 1, {0x10400}},            // Deseret
+    };
+    uchar_t out[UCD_CASE_MAX] = {0};
+    int32_t n = 0;
+    int i = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        n = ucd_case(cases[i].ch, cases[i].kind, out);
+        cr_expect(n == cases[i].n && memcmp(out, cases[i].out, sizeof(out[0]) * n) == 0, "ucd_case(U+%04X, %d) return incorrect mapping: n = %d, out[0] = U+%04X", cases[i].ch, cases[i].kind, n, out[0]);
+    } // for
+} // ucd_case
+
+Test(Function, ucd_case_convert)
+{
+    const char_t src[] = {"Stra\xC3\x9F" "e \xE4\xB8\xAD \xCE\xB1\xCE\x92 \xEF\xAC\x83x \xFF"}; // Straße 中 αΒ ﬃx 加异常字节
+    const char_t upper[] = {"STRASSE \xE4\xB8\xAD \xCE\x91\xCE\x92 FFIX \xFF"};
+    char_t dst[64] = {0};
+    str_size_t first = 0;
+    str_size_t extra = 0;
+    str_size_t bytes = 0;
+    char_t * end = NULL;
+
+    bytes = ucd_case_measure(src, sizeof(src) - 1, UCD_CASE_UPPER, &first, &extra);
+    cr_expect(bytes == sizeof(upper) - 1, "ucd_case_measure() return incorrect bytes: expect %d, got %" STR_SIZE_FMT, (int)sizeof(upper) - 1, bytes);
+    cr_expect(first == 1 && extra == 3, "ucd_case_measure() return incorrect first/extra: got %" STR_SIZE_FMT "/%" STR_SIZE_FMT, first, extra);
+
+    end = ucd_case_convert(dst, src, sizeof(src) - 1, UCD_CASE_UPPER);
+    cr_expect(end - dst == bytes && memcmp(dst, upper, bytes) == 0, "ucd_case_convert() return incorrect result: %s", dst);
+
+    // 没有需要转换的字符
+    bytes = ucd_case_measure(upper, sizeof(upper) - 1, UCD_CASE_UPPER, &first, &extra);
+    cr_expect(bytes == sizeof(upper) - 1 && first == bytes && extra == 0, "ucd_case_measure() reports changes on upper case input: first = %" STR_SIZE_FMT, first);
+
+    bytes = ucd_case_measure(src, sizeof(src) - 1, UCD_CASE_LOWER, &first, &extra);
+    cr_expect(bytes == sizeof(src) - 1 && first == 0 && extra == 0, "ucd_case_measure() return incorrect result for lower case: bytes = %" STR_SIZE_FMT ", first = %" STR_SIZE_FMT, bytes, first);
+} // ucd_case_convert
+
+Test(Function, ucd_ccc)
+{
+    cr_expect(ucd_ccc('a') == 0, "ucd_ccc('a') is not 0");
+    cr_expect(ucd_ccc(0x0301) == 230, "ucd_ccc(U+0301) return incorrect class: %d", ucd_ccc(0x0301));
+    cr_expect(ucd_ccc(0x0323) == 220, "ucd_ccc(U+0323) return incorrect class: %d", ucd_ccc(0x0323));
+    cr_expect(ucd_ccc(0x3099) == 8, "ucd_ccc(U+3099) return incorrect class: %d", ucd_ccc(0x3099));
+    cr_expect(ucd_ccc(0x4E2D) == 0 && ucd_ccc(0x10FFFF) == 0, "ucd_ccc() return non-zero class for starters");
+} // ucd_ccc
+
+Test(Function, ucd_norm_span)
+{
+    const char_t nfc[] = {"caf\xC3\xA9 \xED\x95\x9C \xE4\xB8\xAD"}; // café 한 中
+    const char_t nfd[] = {"cafe\xCC\x81 x"}; // cafe + U+0301
+    str_size_t begin = 0;
+    str_size_t end = 0;
+
+    begin = ucd_norm_span(nfc, sizeof(nfc) - 1, UCD_NFC, &end);
+    cr_expect(begin == sizeof(nfc) - 1 && end == begin, "ucd_norm_span() rejects NFC input: begin = %" STR_SIZE_FMT, begin);
+
+    // 分解形式中 é 和韩文音节都需要分解，片段从前一个稳定字符开始
+    begin = ucd_norm_span(nfc, sizeof(nfc) - 1, UCD_NFD, &end);
+    cr_expect(begin == 2 && end == 5, "ucd_norm_span() return incorrect span: %" STR_SIZE_FMT " ~ %" STR_SIZE_FMT, begin, end);
+    begin = ucd_norm_span(nfc + end, sizeof(nfc) - 1 - end, UCD_NFD, &end);
+    cr_expect(begin == 0 && end == 4, "ucd_norm_span() return incorrect span: %" STR_SIZE_FMT " ~ %" STR_SIZE_FMT, begin, end);
+
+    // 组合字符连同前面的起始字符一起规范化
+    begin = ucd_norm_span(nfd, sizeof(nfd) - 1, UCD_NFC, &end);
+    cr_expect(begin == 3 && end == 6, "ucd_norm_span() return incorrect span: %" STR_SIZE_FMT " ~ %" STR_SIZE_FMT, begin, end);
+    begin = ucd_norm_span(nfd, sizeof(nfd) - 1, UCD_NFD, &end);
+    cr_expect(begin == sizeof(nfd) - 1, "ucd_norm_span() rejects NFD input: begin = %" STR_SIZE_FMT, begin);
+} // ucd_norm_span
+
+Test(Function, ucd_normalize)
+{
+    const struct {
+        const char * name;
+        uint32_t form;
+        const char * src;
+        const char * dst;
+    } cases[] = {
+        {"e+acute", UCD_NFC, "e\xCC\x81", "\xC3\xA9"},
+        {"e-acute", UCD_NFD, "\xC3\xA9", "e\xCC\x81"},
+        {"angstrom", UCD_NFC, "\xE2\x84\xAB", "\xC3\x85"},                  // U+212B 单一映射为 U+00C5
+        {"angstrom", UCD_NFD, "\xE2\x84\xAB", "A\xCC\x8A"},
+        {"hangul", UCD_NFD, "\xED\x95\x9C", "\xE1\x84\x92\xE1\x85\xA1\xE1\x86\xAB"}, // 한
+        {"hangul", UCD_NFC, "\xE1\x84\x92\xE1\x85\xA1\xE1\x86\xAB", "\xED\x95\x9C"},
+        {"ligature", UCD_NFC, "\xEF\xAC\x81", "\xEF\xAC\x81"},              // ﬁ 只有兼容分解
+        {"ligature", UCD_NFKC, "\xEF\xAC\x81", "fi"},
+        {"reorder", UCD_NFD, "a\xCC\x81\xCC\xA3", "a\xCC\xA3\xCC\x81"},    // ccc 230 与 220 交换
+        {"reorder", UCD_NFC, "a\xCC\x81\xCC\xA3", "\xE1\xBA\xA1\xCC\x81"}, // 先与 U+0323 组合为 ạ
+        {"blocked", UCD_NFC, "a\xCC\x81\xCC\x81", "\xC3\xA1\xCC\x81"},     // 第二个 U+0301 被阻隔
+        {"bad-byte", UCD_NFC, "e\xFF\xCC\x81", "e\xFF\xCC\x81"},
+    };
+    ucd_buffer_t out = {0};
+    int i = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        out.used = 0;
+        cr_assert(ucd_normalize((const char_t *)cases[i].src, strlen(cases[i].src), cases[i].form, &out), "ucd_normalize() fails");
+        cr_expect(out.used == strlen(cases[i].dst) && memcmp(out.data, cases[i].dst, out.used) == 0, "ucd_normalize(%s, %d) return incorrect result: bytes = %" STR_SIZE_FMT, cases[i].name, cases[i].form, out.used);
+    } // for
+    free(out.data);
+} // ucd_normalize
+
+Test(Function, ucd_normalize_long)
+{
+    char_t src[3 + 4 * 300] = {"a"};
+    ucd_buffer_t out = {0};
+    int i = 0;
+
+    // 超出栈上缓冲区的组合字符序列：U+0301 U+0323 交替，排序后 U+0323 全部在前
+    for (i = 0; i < 300; ++i) memcpy(src + 1 + 4 * i, "\xCC\x81\xCC\xA3", 4);
+    cr_assert(ucd_normalize(src, 1 + 4 * 300, UCD_NFD, &out), "ucd_normalize() fails");
+    cr_expect(out.used == 1 + 4 * 300, "ucd_normalize() return incorrect bytes: %" STR_SIZE_FMT, out.used);
+    for (i = 0; i < 300; ++i) {
+        if (memcmp(out.data + 1 + 2 * i, "\xCC\xA3", 2) != 0 || memcmp(out.data + 601 + 2 * i, "\xCC\x81", 2) != 0) break;
+    } // for
+    cr_expect(i == 300, "ucd_normalize() return incorrect order at %d", i);
+    free(out.data);
+} // ucd_normalize_long
+
+Test(Function, ucd_gcb)
+{
+    cr_expect(ucd_gcb('a') == UCD_GCB_OTHER && ucd_gcb('\r') == UCD_GCB_CR && ucd_gcb('\n') == UCD_GCB_LF && ucd_gcb('\t') == UCD_GCB_CONTROL, "ucd_gcb() return incorrect property for ASCII");
+    cr_expect(ucd_gcb(0x0301) == UCD_GCB_EXTEND && ucd_gcb(0x200D) == UCD_GCB_ZWJ && ucd_gcb(0x1F3FB) == UCD_GCB_EXTEND, "ucd_gcb() return incorrect property for marks");
+    cr_expect(ucd_gcb(0x0903) == UCD_GCB_SPACING_MARK && ucd_gcb(0x0600) == UCD_GCB_PREPEND && ucd_gcb(0x1F1E8) == UCD_GCB_RI, "ucd_gcb() return incorrect property");
+    cr_expect(ucd_gcb(0x1100) == UCD_GCB_L && ucd_gcb(0x1161) == UCD_GCB_V && ucd_gcb(0x11A8) == UCD_GCB_T, "ucd_gcb() return incorrect property for jamo");
+    cr_expect(ucd_gcb(0xAC00) == UCD_GCB_LV && ucd_gcb(0xAC01) == UCD_GCB_LVT && ucd_gcb(0x1F468) == UCD_GCB_EXT_PICT, "ucd_gcb() return incorrect property");
+    cr_expect(ucd_gcb(0x4E2D) == UCD_GCB_OTHER && ucd_gcb(0x10FFFF) == UCD_GCB_OTHER && ucd_gcb(UCD_BAD_BYTE | 0xFF) == UCD_GCB_CONTROL, "ucd_gcb() return incorrect property");
+} // ucd_gcb
+
+Test(Function, ucd_grapheme)
+{
+    const struct {
+        const char * name;
+        const char * str;
+        str_size_t bytes;
+        str_size_t chars;
+    } cases[] = {
+        {"ascii", "ab", 1, 1},
+        {"crlf", "\r\nx", 2, 2},
+        {"cr", "\r\r\n", 1, 1},
+        {"combining", "e\xCC\x81\xCC\xA3x", 5, 3},                                      // e U+0301 U+0323
+        {"control", "\t\xCC\x81", 1, 1},                                                 // 控制字符后不接组合字符
+        {"jamo", "\xE1\x84\x80\xE1\x85\xA1\xE1\x86\xA8\xE1\x84\x80", 9, 3},              // L V T | L
+        {"syllable", "\xEA\xB0\x80\xE1\x86\xA8\xEA\xB0\x80", 6, 2},                      // LV T | LV
+        {"flags", "\xF0\x9F\x87\xA8\xF0\x9F\x87\xB3\xF0\x9F\x87\xA8", 8, 2},             // RI RI | RI
+        {"zwj-seq", "\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9x", 11, 3},            // 👨 ZWJ 👩
+        {"modifier", "\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD\xF0\x9F\x91\x8D", 8, 2},         // 👍🏽 | 👍
+        {"zwj-other", "a\xE2\x80\x8D\xF0\x9F\x91\xA9", 4, 2},                            // a ZWJ | 👩
+        {"prepend", "\xD8\x80" "a", 3, 2},                                               // U+0600 a
+        {"spacing", "\xE0\xA4\x95\xE0\xA4\x83", 6, 2},                                   // क ः
+        {"bad-byte", "\xFF\xCC\x81", 1, 1},
+    };
+    str_size_t bytes = 0;
+    str_size_t chars = 0;
+    int i = 0;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        bytes = ucd_grapheme((const char_t *)cases[i].str, strlen(cases[i].str), &chars);
+        cr_expect(bytes == cases[i].bytes && chars == cases[i].chars, "ucd_grapheme(%s) return incorrect cluster: bytes = %" STR_SIZE_FMT ", chars = %" STR_SIZE_FMT, cases[i].name, bytes, chars);
+    } // for
+} // ucd_grapheme
+
+Test(Function, ucd_graphemes)
+{
+    char_t buf[120] = {0};
+    str_size_t i = 0;
+    str_size_t cnt = 0;
+
+    // 长段 ASCII 中夹杂 CR LF ，段尾字符与组合字符同簇
+    for (i = 0; i < 100; ++i) buf[i] = (i % 10 == 3) ? '\r' : (i % 10 == 4) ? '\n' : 'a' + i % 26;
+    cnt = ucd_graphemes(buf, 100);
+    cr_expect(cnt == 90, "ucd_graphemes() return incorrect count: expect 90, got %" STR_SIZE_FMT, cnt);
+
+    memcpy(buf + 100, "\xCC\x81\xE4\xB8\xAD\r", 6);
+    cnt = ucd_graphemes(buf, 106);
+    cr_expect(cnt == 92, "ucd_graphemes() return incorrect count: expect 92, got %" STR_SIZE_FMT, cnt);
+
+    buf[99] = '\r';
+    buf[100] = '\n';
+    cnt = ucd_graphemes(buf, 101);
+    cr_expect(cnt == 90, "ucd_graphemes() return incorrect count: expect 90, got %" STR_SIZE_FMT, cnt);
+    cr_expect(ucd_graphemes(buf, 0) == 0, "ucd_graphemes() return non-zero count for empty range");
+} // ucd_graphemes
+
+// 生成排序键并按字节比较
+static int coll_compare(const char * s1, const char * s2, const ucd_tailor_t * tailor)
+{
+    ucd_buffer_t k1 = {0};
+    ucd_buffer_t k2 = {0};
+    int ret = 0;
+
+    cr_assert(ucd_coll_key((const char_t *)s1, strlen(s1), tailor, &k1) && ucd_coll_key((const char_t *)s2, strlen(s2), tailor, &k2), "ucd_coll_key() fails");
+    ret = memcmp(k1.data, k2.data, (k1.used < k2.used) ? k1.used : k2.used);
+    if (ret == 0) ret = (k1.used > k2.used) - (k1.used < k2.used);
+    free(k1.data);
+    free(k2.data);
+    return ret;
+} // coll_compare
+
+Test(Function, ucd_coll_key)
+{
+    // 各组内按根排序规则递增排列，NULL 分隔各组
+    const char * order[] = {
+        " ", "-", "$", "1", "10", "2", "a", "A", "ab", "B", "c", NULL,
+        "resume", "Resume", "r\xC3\xA9sum\xC3\xA9", "rt", NULL,   // résumé：次要差异优先于第三级差异
+        "l", "\xC5\x82", "lz", "m", NULL,                         // ł 是 l 的变体
+        "fi", "\xEF\xAC\x81", "fj", NULL,                        // ﬁ 展开为 fi 的权重
+        "ss", "\xC3\x9F", "st", NULL,                             // ß 展开为 ss 的权重
+        "ae", "\xC3\xA6", "af", "b", NULL,                         // æ
+        "oe", "\xC5\x93", "of", "p", NULL,                         // œ
+        "d", "\xC3\xB0", "dz", "e", NULL,                          // ð 是 d 的变体
+        "z", "\xE4\xB8\x81", "\xE4\xB8\xAD", NULL,               // 丁 中 按隐式权重排在字母之后
+    };
+    ucd_buffer_t key = {0};
+    int i = 0;
+
+    for (i = 1; i < sizeof(order) / sizeof(order[0]); ++i) {
+        if (! order[i - 1] || ! order[i]) continue;
+        cr_expect(coll_compare(order[i - 1], order[i], NULL) < 0, "ucd_coll_key() return incorrect order: %s >= %s", order[i - 1], order[i]);
+    } // for
+
+    // 规范等价的串排序键相同，可忽略字符（软连字符）不影响排序键
+    cr_expect(coll_compare("\xC3\xA9", "e\xCC\x81", NULL) == 0, "ucd_coll_key() distinguishes canonical equivalents");
+    cr_expect(coll_compare("a\xCC\x81\xCC\xA3", "a\xCC\xA3\xCC\x81", NULL) == 0, "ucd_coll_key() depends on mark order");
+    cr_expect(coll_compare("ab", "a\xC2\xAD" "b", NULL) == 0, "ucd_coll_key() does not ignore SOFT HYPHEN");
+
+    // и 与其后未被阻断的短音符组成收缩 й（不连续匹配），下加点不阻断
+    cr_expect(coll_compare("\xD0\xB8\xCC\xA3\xCC\x86", "\xD0\xB8\xD1\x8F", NULL) > 0, "ucd_coll_key() misses discontiguous contraction");
+    cr_expect(coll_compare("\xD0\xB9\xCC\xA3", "\xD0\xB8\xCC\xA3\xCC\x86", NULL) == 0, "ucd_coll_key() distinguishes canonical equivalents with contraction");
+
+    // a 的 DUCET 权重为 [.1FA2.0020.0002]，各级之间以 0x01 分隔
+    cr_assert(ucd_coll_key((const char_t *)"a", 1, NULL, &key), "ucd_coll_key() fails");
+    cr_expect(key.used == 6 && key.data[0] == 0x1F && key.data[1] == 0xA2 && key.data[2] == 0x01 && key.data[3] == 0x02 && key.data[4] == 0x01 && key.data[5] == 0x02, "ucd_coll_key() return incorrect key layout");
+    free(key.data);
+} // ucd_coll_key
+
+Test(Function, ucd_tailor)
+{
+    const ucd_coll_rule_t rules[] = {
+        {0x00F1, 'n', UCD_LEVEL_PRIMARY},       // ñ 是 n 之后的独立字母
+        {'w', 'v', UCD_LEVEL_SECONDARY},        // w 是 v 的变体
+        {0x00E6, 'a', UCD_LEVEL_PRIMARY},       // æ
+        {0x00E5, 'a', UCD_LEVEL_PRIMARY},       // å 排在 æ 之后
+    };
+    const ucd_coll_rule_t bad[] = {{'x', 0x00AD, UCD_LEVEL_PRIMARY}};
+    ucd_tailor_p t = NULL;
+    int err = 0;
+
+    t = ucd_tailor_new(rules, sizeof(rules) / sizeof(rules[0]), &err);
+    cr_assert(t != NULL, "ucd_tailor_new() fails: %d", err);
+
+    cr_expect(coll_compare("\xC3\xB1" "a", "nz", NULL) < 0 && coll_compare("\xC3\xB1" "a", "nz", t) > 0, "ucd_tailor_new() does not move n-tilde");
+    cr_expect(coll_compare("\xC3\xB1" "a", "n\xCC\x83" "a", t) == 0, "ucd_tailor_new() distinguishes canonical equivalents");
+    cr_expect(coll_compare("\xC3\xB1", "\xC3\x91", t) < 0 && coll_compare("\xC3\x91", "o", t) < 0, "ucd_tailor_new() misplaces upper case N-tilde");
+    cr_expect(coll_compare("wa", "vb", NULL) > 0 && coll_compare("wa", "vb", t) < 0 && coll_compare("v", "w", t) < 0, "ucd_tailor_new() does not treat w as variant of v");
+    cr_expect(coll_compare("az", "\xC3\xA6", t) < 0 && coll_compare("\xC3\xA6", "\xC3\xA5", t) < 0 && coll_compare("\xC3\xA5", "b", t) < 0, "ucd_tailor_new() return incorrect order for ae/a-ring");
+    cr_expect(coll_compare("a", "b", t) < 0 && coll_compare("n", "o", t) < 0, "ucd_tailor_new() changes untailored characters");
+    free(t);
+
+    cr_expect(ucd_tailor_new(bad, 1, &err) == NULL && err == UCD_BAD_RULE, "ucd_tailor_new() accepts ignorable anchor");
+    cr_expect(ucd_tailor_new(rules, -1, &err) == NULL && err == UCD_BAD_RULE, "ucd_tailor_new() accepts negative count");
+} // ucd_tailor
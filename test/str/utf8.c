@@ -10,8 +10,8 @@ typedef struct UT_STRING_CASE {
     uint32_t chars;
     uint32_t i_bytes;
     uint32_t i_chars;
-    uint32_t r_bytes;
-    uint32_t r_chars;
+    str_size_t r_bytes;
+    str_size_t r_chars;
     uint32_t measure_ret;
     bool count_ret;
     const char_t name[80];
@@ -176,8 +176,8 @@ Test(Function, utf8_count)
 {
     ut_string_case_p c = NULL;
     int32_t i = 0;
-    uint32_t r_bytes = 0;
-    uint32_t r_chars = 0;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
     bool ret = false;
 
     // 正常用例
@@ -186,8 +186,8 @@ Test(Function, utf8_count)
         r_bytes = c->i_bytes;
         r_chars = c->i_chars;
         ret = utf8_count(c->str, &r_bytes, &r_chars);
-        cr_expect(r_bytes == c->r_bytes, "%s: utf8_count('%s') return incorrect bytes: expect %d, got %d", c->name, c->repr, c->r_bytes, r_bytes);
-        cr_expect(r_chars == c->r_chars, "%s: utf8_count('%s') return incorrect chars: expect %d, got %d", c->name, c->repr, c->r_chars, r_chars);
+        cr_expect(r_bytes == c->r_bytes, "%s: utf8_count('%s') return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_bytes, r_bytes);
+        cr_expect(r_chars == c->r_chars, "%s: utf8_count('%s') return incorrect chars: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_chars, r_chars);
         cr_expect(ret == c->count_ret, "%s: utf8_count('%s') return incorrect result: expect %d, got %d", c->name, c->repr, c->count_ret, ret);
     } // for
 
@@ -197,18 +197,96 @@ Test(Function, utf8_count)
         r_bytes = c->i_bytes;
         r_chars = c->i_chars;
         ret = utf8_count(c->str, &r_bytes, &r_chars);
-        cr_expect(r_bytes == c->r_bytes, "%s: utf8_count('%s') return incorrect bytes: expect %d, got %d", c->name, c->repr, c->r_bytes, r_bytes);
-        cr_expect(r_chars == c->r_chars, "%s: utf8_count('%s') return incorrect chars: expect %d, got %d", c->name, c->repr, c->r_chars, r_chars);
+        cr_expect(r_bytes == c->r_bytes, "%s: utf8_count('%s') return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_bytes, r_bytes);
+        cr_expect(r_chars == c->r_chars, "%s: utf8_count('%s') return incorrect chars: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_chars, r_chars);
         cr_expect(ret == c->count_ret, "%s: utf8_count('%s') return incorrect result: expect %d, got %d", c->name, c->repr, c->count_ret, ret);
     } // for
 } // utf8_count
 
+Test(Function, utf8_validate)
+{
+    ut_string_case_p c = NULL;
+    int32_t i = 0;
+    str_size_t r_bytes = 0;
+    bool ret = false;
+
+    // 正常用例
+    for (i = 0; i < sizeof(sc) / sizeof(sc[0]); ++i) {
+        c = &sc[i];
+        r_bytes = c->i_bytes;
+        ret = utf8_validate(c->str, &r_bytes);
+        cr_expect(r_bytes == c->r_bytes, "%s: utf8_validate('%s') return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_bytes, r_bytes);
+        cr_expect(ret == true, "%s: utf8_validate('%s') return incorrect result: expect %d, got %d", c->name, c->repr, true, ret);
+    } // for
+
+    // 异常用例
+    for (i = 0; i < sizeof(bc) / sizeof(bc[0]); ++i) {
+        c = &bc[i];
+        r_bytes = c->i_bytes;
+        ret = utf8_validate(c->str, &r_bytes);
+        cr_expect(r_bytes < c->i_bytes, "%s: utf8_validate('%s') return incorrect bytes: expect < %d, got %" STR_SIZE_FMT, c->name, c->repr, c->i_bytes, r_bytes);
+        cr_expect(ret == false, "%s: utf8_validate('%s') return incorrect result: expect %d, got %d", c->name, c->repr, false, ret);
+    } // for
+} // utf8_validate
+
+Test(Function, utf8_chars)
+{
+    ut_string_case_p c = NULL;
+    int32_t i = 0;
+    uint32_t ret = 0;
+
+    for (i = 0; i < sizeof(sc) / sizeof(sc[0]); ++i) {
+        c = &sc[i];
+        ret = utf8_chars(c->str, c->i_bytes);
+        cr_expect(ret == c->r_chars, "%s: utf8_chars('%s') return incorrect chars: expect %" STR_SIZE_FMT ", got %d", c->name, c->repr, c->r_chars, ret);
+    } // for
+} // utf8_chars
+
+Test(Function, utf8_rseek)
+{
+    const char_t str[32] = {S8_STR S8_STR S3_STR S1_STR S1_STR S2_STR}; // 留出余量，utf8_count() 会预读跟随字节
+    str_size_t bytes = strlen((const char *)str);
+    ut_string_case_p c = NULL;
+    int32_t i = 0;
+    str_size_t n = 0;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
+    str_size_t ret = 0;
+
+    // 倒数 n 个字符的起点，应等于正数 r_chars - n 个字符的终点
+    for (i = 0; i < sizeof(sc) / sizeof(sc[0]); ++i) {
+        c = &sc[i];
+        for (n = 0; n <= c->r_chars + 1; ++n) {
+            r_chars = n;
+            ret = utf8_rseek(c->str, c->i_bytes, &r_chars);
+            cr_expect(r_chars == (n < c->r_chars ? n : c->r_chars), "%s: utf8_rseek('%s', %" STR_SIZE_FMT ") return incorrect chars: got %" STR_SIZE_FMT, c->name, c->repr, n, r_chars);
+
+            r_bytes = c->i_bytes;
+            r_chars = c->r_chars - r_chars;
+            utf8_count(c->str, &r_bytes, &r_chars);
+            cr_expect(ret == c->i_bytes - r_bytes, "%s: utf8_rseek('%s', %" STR_SIZE_FMT ") return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, n, c->i_bytes - r_bytes, ret);
+        } // for
+    } // for
+
+    // 跨越多个整块
+    for (n = 0; n <= 13; ++n) {
+        r_chars = n;
+        ret = utf8_rseek(str, bytes, &r_chars);
+        cr_expect(r_chars == (n < 12 ? n : 12), "utf8_rseek(%" STR_SIZE_FMT ") return incorrect chars: got %" STR_SIZE_FMT, n, r_chars);
+
+        r_bytes = bytes;
+        r_chars = 12 - r_chars;
+        utf8_count(str, &r_bytes, &r_chars);
+        cr_expect(ret == bytes - r_bytes, "utf8_rseek(%" STR_SIZE_FMT ") return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, n, bytes - r_bytes, ret);
+    } // for
+} // utf8_rseek
+
 Test(Function, utf8_verify_plain)
 {
     ut_string_case_p c = NULL;
     int32_t i = 0;
-    uint32_t r_bytes = 0;
-    uint32_t r_chars = 0;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
     bool ret = false;
 
     // 正常用例
@@ -216,8 +294,8 @@ Test(Function, utf8_verify_plain)
         c = &sc[i];
         r_bytes = c->i_bytes;
         ret = utf8_verify_plain(c->str, &r_bytes, &r_chars);
-        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_plain('%s') return incorrect bytes: expect %d, got %d", c->name, c->repr, c->r_bytes, r_bytes);
-        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_plain('%s') return incorrect chars: expect %d, got %d", c->name, c->repr, c->r_chars, r_chars);
+        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_plain('%s') return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_bytes, r_bytes);
+        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_plain('%s') return incorrect chars: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_chars, r_chars);
         cr_expect(ret == true, "%s: utf8_verify_plain('%s') return incorrect result: expect %d, got %d", c->name, c->repr, true, ret);
     } // for
 
@@ -226,25 +304,25 @@ Test(Function, utf8_verify_plain)
         c = &bc[i];
         r_bytes = c->i_bytes;
         ret = utf8_verify_plain(c->str, &r_bytes, &r_chars);
-        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_plain('%s') return incorrect bytes: expect %d, got %d", c->name, c->repr, c->r_bytes, r_bytes);
-        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_plain('%s') return incorrect chars: expect %d, got %d", c->name, c->repr, c->r_chars, r_chars);
+        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_plain('%s') return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_bytes, r_bytes);
+        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_plain('%s') return incorrect chars: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_chars, r_chars);
         cr_expect(ret == false, "%s: utf8_verify_plain('%s') return incorrect result: expect %d, got %d", c->name, c->repr, false, ret);
     } // for
 
     // Aligned strings
     r_bytes = strlen(S1_STR);
     ret = utf8_verify_plain((const char_t *)S1_STR, &r_bytes, &r_chars);
-    cr_expect(r_bytes == strlen(S1_STR), "%s: utf8_verify_plain('%s') return incorrect bytes: expect %lu, got %d", "s1-aligned", S1_REPR, strlen(S1_STR), r_bytes);
+    cr_expect(r_bytes == strlen(S1_STR), "%s: utf8_verify_plain('%s') return incorrect bytes: expect %lu, got %" STR_SIZE_FMT, "s1-aligned", S1_REPR, strlen(S1_STR), r_bytes);
     cr_expect(ret == true, "%s: utf8_verify_plain('%s') return incorrect result: expect %d, got %d", "s1-aligned", S1_REPR, true, ret);
 
     r_bytes = strlen(S8_STR);
     ret = utf8_verify_plain((const char_t *)S8_STR, &r_bytes, &r_chars);
-    cr_expect(r_bytes == strlen(S8_STR), "%s: utf8_verify_plain('%s') return incorrect bytes: expect %lu, got %d", "s8-aligned", S8_REPR, strlen(S8_STR), r_bytes);
+    cr_expect(r_bytes == strlen(S8_STR), "%s: utf8_verify_plain('%s') return incorrect bytes: expect %lu, got %" STR_SIZE_FMT, "s8-aligned", S8_REPR, strlen(S8_STR), r_bytes);
     cr_expect(ret == true, "%s: utf8_verify_plain('%s') return incorrect result: expect %d, got %d", "s8-aligned", S8_REPR, true, ret);
 
     r_bytes = strlen(S17_STR);
     ret = utf8_verify_plain((const char_t *)S17_STR, &r_bytes, &r_chars);
-    cr_expect(r_bytes == strlen(S17_STR), "%s: utf8_verify_plain('%s') return incorrect bytes: expect %lu, got %d", "s17-aligned", S17_REPR, strlen(S17_STR), r_bytes);
+    cr_expect(r_bytes == strlen(S17_STR), "%s: utf8_verify_plain('%s') return incorrect bytes: expect %lu, got %" STR_SIZE_FMT, "s17-aligned", S17_REPR, strlen(S17_STR), r_bytes);
     cr_expect(ret == true, "%s: utf8_verify_plain('%s') return incorrect result: expect %d, got %d", "s17-aligned", S17_REPR, true, ret);
 } // utf8_verify_plain
 
@@ -252,8 +330,8 @@ Test(Function, utf8_verify_by_lookup)
 {
     ut_string_case_p c = NULL;
     int32_t i = 0;
-    uint32_t r_bytes = 0;
-    uint32_t r_chars = 0;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
     bool ret = false;
 
     // 正常用例
@@ -261,8 +339,8 @@ Test(Function, utf8_verify_by_lookup)
         c = &sc[i];
         r_bytes = c->i_bytes;
         ret = utf8_verify_by_lookup(c->str, &r_bytes, &r_chars);
-        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %d, got %d", c->name, c->repr, c->r_bytes, r_bytes);
-        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_by_lookup('%s') return incorrect chars: expect %d, got %d", c->name, c->repr, c->r_chars, r_chars);
+        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_bytes, r_bytes);
+        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_by_lookup('%s') return incorrect chars: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_chars, r_chars);
         cr_expect(ret == true, "%s: utf8_verify_by_lookup('%s') return incorrect result: expect %d, got %d", c->name, c->repr, true, ret);
     } // for
 
@@ -271,8 +349,8 @@ Test(Function, utf8_verify_by_lookup)
         c = &bc[i];
         r_bytes = c->i_bytes;
         ret = utf8_verify_by_lookup(c->str, &r_bytes, &r_chars);
-        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %d, got %d", c->name, c->repr, c->r_bytes, r_bytes);
-        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_by_lookup('%s') return incorrect chars: expect %d, got %d", c->name, c->repr, c->r_chars, r_chars);
+        cr_expect(r_bytes == c->r_bytes, "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_bytes, r_bytes);
+        cr_expect(r_chars == c->r_chars, "%s: utf8_verify_by_lookup('%s') return incorrect chars: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, c->name, c->repr, c->r_chars, r_chars);
         cr_expect(ret == false, "%s: utf8_verify_by_lookup('%s') return incorrect result: expect %d, got %d", c->name, c->repr, false, ret);
     } // for
 
@@ -280,17 +358,17 @@ Test(Function, utf8_verify_by_lookup)
     r_bytes = strlen(S1_STR);
     r_chars = 0;
     ret = utf8_verify_by_lookup((const char_t *)S1_STR, &r_bytes, &r_chars);
-    cr_expect(r_bytes == strlen(S1_STR), "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %lu, got %d", "s1-aligned", S1_REPR, strlen(S1_STR), r_bytes);
+    cr_expect(r_bytes == strlen(S1_STR), "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %lu, got %" STR_SIZE_FMT, "s1-aligned", S1_REPR, strlen(S1_STR), r_bytes);
     cr_expect(ret == true, "%s: utf8_verify_by_lookup('%s') return incorrect result: expect %d, got %d", "s1-aligned", S1_REPR, true, ret);
 
     r_bytes = strlen(S8_STR);
     ret = utf8_verify_by_lookup((const char_t *)S8_STR, &r_bytes, &r_chars);
-    cr_expect(r_bytes == strlen(S8_STR), "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %lu, got %d", "s8-aligned", S8_REPR, strlen(S8_STR), r_bytes);
+    cr_expect(r_bytes == strlen(S8_STR), "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %lu, got %" STR_SIZE_FMT, "s8-aligned", S8_REPR, strlen(S8_STR), r_bytes);
     cr_expect(ret == true, "%s: utf8_verify_by_lookup('%s') return incorrect result: expect %d, got %d", "s8-aligned", S8_REPR, true, ret);
 
     r_bytes = strlen(S17_STR);
     ret = utf8_verify_by_lookup((const char_t *)S17_STR, &r_bytes, &r_chars);
-    cr_expect(r_bytes == strlen(S17_STR), "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %lu, got %d", "s17-aligned", S17_REPR, strlen(S17_STR), r_bytes);
+    cr_expect(r_bytes == strlen(S17_STR), "%s: utf8_verify_by_lookup('%s') return incorrect bytes: expect %lu, got %" STR_SIZE_FMT, "s17-aligned", S17_REPR, strlen(S17_STR), r_bytes);
     cr_expect(ret == true, "%s: utf8_verify_by_lookup('%s') return incorrect result: expect %d, got %d", "s17-aligned", S17_REPR, true, ret);
 } // utf8_verify_by_lookup
 
@@ -365,3 +443,26 @@ Test(Function, utf8_encode)
         } // for
     } // for
 } // utf8_encode
+
+Test(Function, utf8_checkpoints)
+{
+    const char_t str[] = {S8_STR S8_STR S3_STR S1_STR S1_STR S2_STR};
+    str_size_t offs[8] = {0};
+    str_size_t bytes = sizeof(str) - 1;
+    str_size_t r_bytes = 0;
+    str_size_t r_chars = 0;
+    uint32_t cnt = 0;
+    uint32_t i = 0;
+    uint32_t step = 0;
+
+    for (step = 1; step <= 4; ++step) {
+        cnt = utf8_checkpoints(str, bytes, step, offs, sizeof(offs) / sizeof(offs[0]));
+        cr_expect(cnt == (step <= 1 ? 8 : (12 + step - 1) / step), "utf8_checkpoints(step %d) return incorrect count: got %d", step, cnt);
+        for (i = 0; i < cnt; ++i) {
+            r_bytes = bytes;
+            r_chars = i * step;
+            utf8_count(str, &r_bytes, &r_chars);
+            cr_expect(offs[i] == r_bytes, "utf8_checkpoints(step %d) return incorrect offset %d: expect %" STR_SIZE_FMT ", got %" STR_SIZE_FMT, step, i, r_bytes, offs[i]);
+        } // for
+    } // for
+} // utf8_checkpoints